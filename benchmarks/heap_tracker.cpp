@@ -0,0 +1,35 @@
+#include "heap_tracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+using orbat::bench::HeapTracker;
+
+// Replacement global allocation functions feeding HeapTracker. Each block
+// carries its size in a header so operator delete can account for it; the
+// array and nothrow forms forward to these.
+namespace {
+constexpr std::size_t HEADER = alignof(std::max_align_t);
+}
+
+void* operator new(std::size_t size) {
+    if (void* block = std::malloc(size + HEADER)) {
+        *static_cast<std::size_t*>(block) = size;
+        HeapTracker::allocated(size);
+        return static_cast<char*>(block) + HEADER;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - HEADER;
+    HeapTracker::freed(*static_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace orbat {
+namespace bench {
+
+/**
+ * @brief Heap usage of the benchmark process.
+ *
+ * Fed by the replacement global operator new/delete in heap_tracker.cpp,
+ * which every benchmark executable links. Besides allocation counts it
+ * tracks live heap bytes and their high-water mark, so a benchmark can
+ * report the peak memory of one case rather than of the whole process.
+ *
+ * Example:
+ *   HeapTracker::Snapshot start = HeapTracker::start();
+ *   for (auto _ : state) { ... }
+ *   HeapTracker::report(state, start);
+ */
+class HeapTracker {
+public:
+    /**
+     * @brief Counters at the start of a measurement.
+     */
+    struct Snapshot {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t live = 0;
+    };
+
+    /**
+     * @brief Record an allocation. Called from operator new.
+     */
+    static void allocated(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        uint64_t live = live_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = peak_.load(std::memory_order_relaxed);
+        while (live > peak && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Record a deallocation. Called from operator delete.
+     */
+    static void freed(size_t bytes) noexcept { live_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+    /**
+     * @brief Start a measurement: take a snapshot and reset the high-water mark.
+     */
+    static Snapshot start() noexcept {
+        Snapshot snapshot;
+        snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+        snapshot.bytes = bytes_.load(std::memory_order_relaxed);
+        snapshot.live = live_.load(std::memory_order_relaxed);
+        peak_.store(snapshot.live, std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    /**
+     * @brief Add heap counters to a finished benchmark.
+     *
+     * Reports allocations and allocated bytes per iteration, and the peak
+     * heap in use above the level at start(), in bytes.
+     *
+     * @param state Benchmark state (after the timing loop)
+     * @param start Snapshot taken before the timing loop
+     */
+    static void report(benchmark::State& state, const Snapshot& start) {
+        using benchmark::Counter;
+        state.counters["allocs"] = Counter(
+            static_cast<double>(allocations_.load(std::memory_order_relaxed) - start.allocations),
+            Counter::kAvgIterations);
+        state.counters["alloc_bytes"] =
+            Counter(static_cast<double>(bytes_.load(std::memory_order_relaxed) - start.bytes),
+                    Counter::kAvgIterations, Counter::kIs1024);
+        state.counters["peak_heap"] =
+            Counter(static_cast<double>(peak_.load(std::memory_order_relaxed) - start.live),
+                    Counter::kDefaults, Counter::kIs1024);
+    }
+
+private:
+    static inline std::atomic<uint64_t> allocations_{0};
+    static inline std::atomic<uint64_t> bytes_{0};
+    static inline std::atomic<uint64_t> live_{0};
+    static inline std::atomic<uint64_t> peak_{0};
+};
+
+}  // namespace bench
+}  // namespace orbat
@@ -0,0 +1,313 @@
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "cli/file_parser.hpp"
+#include "perf_report.hpp"
+
+using orbat::bench::PerfReport;
+using orbat::cli::FileParser;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::MarkowitzOptimizer;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Nominal input file sizes in MB (10^6 bytes). The 1000 MB case runs once
+// per repetition: a 1 GB covariance file holds about 7000 assets, and
+// validating and factorizing it takes minutes.
+const std::vector<int64_t> SIZES_MB = {1, 10, 100};
+const std::vector<int64_t> LARGE_SIZES_MB = {1000};
+
+enum class Kind { ReturnsCSV, ReturnsJSON, CovarianceCSV, CovarianceJSON, Problem };
+
+// Deterministic value in [-1, 1) for a key (splitmix64)
+double noise(uint64_t key) {
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<double>(key >> 11) * 0x1.0p-52 - 1.0;
+}
+
+double expectedReturn(size_t i) {
+    return 0.08 + 0.04 * noise(i);
+}
+
+// Symmetric and strictly diagonally dominant, hence positive-definite
+double covariance(size_t i, size_t j, size_t n) {
+    if (i == j) {
+        return 0.04 + 0.01 * (1.0 + noise(i));
+    }
+    uint64_t key = static_cast<uint64_t>(std::min(i, j)) * n + std::max(i, j);
+    return 0.03 / static_cast<double>(n) * noise(key);
+}
+
+// Buffered writer of shortest round-trip decimal numbers
+class NumberWriter {
+public:
+    explicit NumberWriter(const fs::path& path) : out_(path, std::ios::binary) {
+        if (!out_) {
+            throw std::runtime_error("Cannot create " + path.string());
+        }
+    }
+
+    ~NumberWriter() { flush(); }
+
+    void number(double value) {
+        reserve(32);
+        auto result = std::to_chars(buffer_.data() + used_, buffer_.data() + buffer_.size(), value);
+        used_ = static_cast<size_t>(result.ptr - buffer_.data());
+    }
+
+    void text(const char* s) {
+        for (; *s; ++s) {
+            reserve(1);
+            buffer_[used_++] = *s;
+        }
+    }
+
+private:
+    std::ofstream out_;
+    std::vector<char> buffer_ = std::vector<char>(1 << 20);
+    size_t used_ = 0;
+
+    void reserve(size_t bytes) {
+        if (used_ + bytes > buffer_.size()) {
+            flush();
+        }
+    }
+
+    void flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+};
+
+void writeReturns(const fs::path& path, size_t n, bool json) {
+    NumberWriter out(path);
+    out.text(json ? "[" : "");
+    for (size_t i = 0; i < n; ++i) {
+        out.number(expectedReturn(i));
+        out.text(json ? (i + 1 < n ? ",\n" : "]\n") : "\n");
+    }
+}
+
+void writeCovariance(const fs::path& path, size_t n, bool json) {
+    NumberWriter out(path);
+    out.text(json ? "[" : "");
+    for (size_t i = 0; i < n; ++i) {
+        out.text(json ? "[" : "");
+        for (size_t j = 0; j < n; ++j) {
+            out.number(covariance(i, j, n));
+            if (j + 1 < n) {
+                out.text(",");
+            }
+        }
+        out.text(json ? (i + 1 < n ? "],\n" : "]]\n") : "\n");
+    }
+}
+
+// Bytes per value including its separator, averaged over a sample
+double bytesPerValue(bool covarianceValues) {
+    char buffer[32];
+    double total = 0.0;
+    for (size_t k = 0; k < 1000; ++k) {
+        double value = covarianceValues ? covariance(k, k + 1, 1000) : expectedReturn(k);
+        total += static_cast<double>(std::to_chars(buffer, buffer + 32, value).ptr - buffer) + 1;
+    }
+    return total / 1000.0;
+}
+
+struct InputFiles {
+    std::vector<fs::path> paths;  // Problem: returns, then covariance
+    size_t assets = 0;
+    int64_t bytes = 0;
+};
+
+// Generated inputs of the current benchmark. Only one set is kept on disk;
+// benchmarks run in registration order, so each set is written once.
+class InputCache {
+public:
+    ~InputCache() {
+        std::error_code ignored;
+        fs::remove_all(dir_, ignored);
+    }
+
+    const InputFiles& get(Kind kind, int64_t megabytes) {
+        auto key = std::make_pair(kind, megabytes);
+        if (key != key_) {
+            clear();
+            key_ = key;
+            generate(kind, megabytes);
+        }
+        return files_;
+    }
+
+private:
+    fs::path dir_ = fs::temp_directory_path() /
+                    ("orbat_ingestion_" + std::to_string(static_cast<long long>(::getpid())));
+    std::pair<Kind, int64_t> key_{Kind::Problem, -1};
+    InputFiles files_;
+
+    void clear() {
+        for (const auto& path : files_.paths) {
+            fs::remove(path);
+        }
+        files_ = InputFiles();
+    }
+
+    void generate(Kind kind, int64_t megabytes) {
+        fs::create_directories(dir_);
+        const double target = static_cast<double>(megabytes) * 1e6;
+        const bool json = kind == Kind::ReturnsJSON || kind == Kind::CovarianceJSON;
+        const std::string ext = json ? ".json" : ".csv";
+
+        if (kind == Kind::ReturnsCSV || kind == Kind::ReturnsJSON) {
+            files_.assets = static_cast<size_t>(target / bytesPerValue(false));
+            files_.paths = {dir_ / ("returns" + ext)};
+            writeReturns(files_.paths[0], files_.assets, json);
+        } else {
+            files_.assets = static_cast<size_t>(std::sqrt(target / bytesPerValue(true)));
+            if (kind == Kind::Problem) {
+                files_.paths = {dir_ / "returns.csv", dir_ / "covariance.csv"};
+                writeReturns(files_.paths[0], files_.assets, false);
+            } else {
+                files_.paths = {dir_ / ("covariance" + ext)};
+            }
+            writeCovariance(files_.paths.back(), files_.assets, json);
+        }
+        for (const auto& path : files_.paths) {
+            files_.bytes += static_cast<int64_t>(fs::file_size(path));
+        }
+    }
+};
+
+InputCache& inputs() {
+    static InputCache cache;
+    return cache;
+}
+
+void sizeArgs(benchmark::internal::Benchmark* b, bool large) {
+    b->ArgName("MB");
+    for (int64_t mb : large ? LARGE_SIZES_MB : SIZES_MB) {
+        b->Arg(mb);
+    }
+    if (large) {
+        b->Iterations(1);
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+void smallFiles(benchmark::internal::Benchmark* b) {
+    sizeArgs(b, false);
+}
+
+void largeFiles(benchmark::internal::Benchmark* b) {
+    sizeArgs(b, true);
+}
+
+// Loads one generated file per iteration and reports throughput in bytes of
+// input per second, the number of assets read and hardware counters
+template <typename Load>
+void runLoader(benchmark::State& state, Kind kind, Load load) {
+    const InputFiles& files = inputs().get(kind, state.range(0));
+    const std::string path = files.paths[0].string();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        auto loaded = load(path);
+        benchmark::DoNotOptimize(loaded.size());
+    }
+    PerfReport::report(state, counters);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * files.bytes);
+    state.counters["assets"] = static_cast<double>(files.assets);
+}
+
+}  // namespace
+
+// Includes the O(n³) positive-definiteness check of the CovarianceMatrix constructor
+static void BM_CovarianceFromCSV(benchmark::State& state) {
+    runLoader(state, Kind::CovarianceCSV,
+              [](const std::string& path) { return CovarianceMatrix::fromCSV(path); });
+}
+BENCHMARK(BM_CovarianceFromCSV)->Apply(smallFiles);
+BENCHMARK(BM_CovarianceFromCSV)->Apply(largeFiles);
+
+static void BM_CovarianceFromJSON(benchmark::State& state) {
+    runLoader(state, Kind::CovarianceJSON,
+              [](const std::string& path) { return CovarianceMatrix::fromJSON(path); });
+}
+BENCHMARK(BM_CovarianceFromJSON)->Apply(smallFiles);
+BENCHMARK(BM_CovarianceFromJSON)->Apply(largeFiles);
+
+static void BM_ReturnsFromCSV(benchmark::State& state) {
+    runLoader(state, Kind::ReturnsCSV,
+              [](const std::string& path) { return ExpectedReturns::fromCSV(path); });
+}
+BENCHMARK(BM_ReturnsFromCSV)->Apply(smallFiles);
+BENCHMARK(BM_ReturnsFromCSV)->Apply(largeFiles);
+
+static void BM_ReturnsFromJSON(benchmark::State& state) {
+    runLoader(state, Kind::ReturnsJSON,
+              [](const std::string& path) { return ExpectedReturns::fromJSON(path); });
+}
+BENCHMARK(BM_ReturnsFromJSON)->Apply(smallFiles);
+BENCHMARK(BM_ReturnsFromJSON)->Apply(largeFiles);
+
+// The CLI's loaders; parseCovarianceData reads without validating
+static void BM_FileParserReturns(benchmark::State& state) {
+    runLoader(state, Kind::ReturnsCSV,
+              [](const std::string& path) { return FileParser::parseReturns(path); });
+}
+BENCHMARK(BM_FileParserReturns)->Apply(smallFiles);
+BENCHMARK(BM_FileParserReturns)->Apply(largeFiles);
+
+static void BM_FileParserCovariance(benchmark::State& state) {
+    runLoader(state, Kind::CovarianceCSV,
+              [](const std::string& path) { return FileParser::parseCovarianceData(path).data(); });
+}
+BENCHMARK(BM_FileParserCovariance)->Apply(smallFiles);
+BENCHMARK(BM_FileParserCovariance)->Apply(largeFiles);
+
+// From CSV files on disk to a minimum-variance portfolio, as `orbat mpt`
+// does it: parse and validate both files, then factorize and solve. The size
+// is that of the covariance file; load_s and solve_s split each iteration.
+static void BM_TimeToFirstSolve(benchmark::State& state) {
+    using benchmark::Counter;
+    using Clock = std::chrono::steady_clock;
+    const InputFiles& files = inputs().get(Kind::Problem, state.range(0));
+    double loadSeconds = 0.0;
+    double solveSeconds = 0.0;
+    for (auto _ : state) {
+        Clock::time_point start = Clock::now();
+        ExpectedReturns returns = FileParser::parseReturns(files.paths[0].string());
+        CovarianceMatrix covariance = FileParser::parseCovariance(files.paths[1].string());
+        Clock::time_point loaded = Clock::now();
+        MarkowitzOptimizer optimizer(returns, covariance);
+        benchmark::DoNotOptimize(optimizer.minimumVariance().success());
+        loadSeconds += std::chrono::duration<double>(loaded - start).count();
+        solveSeconds += std::chrono::duration<double>(Clock::now() - loaded).count();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * files.bytes);
+    state.counters["assets"] = static_cast<double>(files.assets);
+    state.counters["load_s"] = Counter(loadSeconds, Counter::kAvgIterations);
+    state.counters["solve_s"] = Counter(solveSeconds, Counter::kAvgIterations);
+}
+BENCHMARK(BM_TimeToFirstSolve)->Apply(smallFiles);
+BENCHMARK(BM_TimeToFirstSolve)->Apply(largeFiles);
@@ -0,0 +1,343 @@
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/random.hpp"
+#include "orbat/core/sobol.hpp"
+#include "orbat/core/vector.hpp"
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "perf_report.hpp"
+
+using orbat::bench::PerfReport;
+using orbat::core::CounterRng;
+using orbat::core::Matrix;
+using orbat::core::Vector;
+
+namespace {
+
+// Problem sizes from 8 to 5,000. The cubic operations run the two largest
+// sizes once per repetition; a 5,000 x 5,000 product takes minutes.
+constexpr int64_t SIZES[] = {8, 32, 128, 512, 1000};
+constexpr int64_t LARGE_SIZES[] = {2000, 5000};
+
+void smallSizes(benchmark::internal::Benchmark* b) {
+    for (int64_t n : SIZES) {
+        b->Arg(n);
+    }
+}
+
+void largeSizes(benchmark::internal::Benchmark* b) {
+    for (int64_t n : LARGE_SIZES) {
+        b->Arg(n);
+    }
+}
+
+void allSizes(benchmark::internal::Benchmark* b) {
+    smallSizes(b);
+    largeSizes(b);
+}
+
+// Uniform in (-1, 1)
+Vector randomVector(size_t n, uint64_t seed) {
+    CounterRng rng(seed);
+    Vector v(n);
+    rng.fillUniform(v);
+    for (double& x : v.data()) {
+        x = 2.0 * x - 1.0;
+    }
+    return v;
+}
+
+Matrix randomMatrix(size_t n, uint64_t seed) {
+    CounterRng rng(seed);
+    Matrix m(n, n);
+    rng.fillUniform(m);
+    for (double& x : m.data()) {
+        x = 2.0 * x - 1.0;
+    }
+    return m;
+}
+
+// Symmetric and strictly diagonally dominant, hence positive-definite
+Matrix spdMatrix(size_t n, uint64_t seed) {
+    Matrix m = randomMatrix(n, seed);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            m(j, i) = m(i, j);
+        }
+        m(i, i) = static_cast<double>(n) + 1.0;
+    }
+    return m;
+}
+
+// Report floating-point operations per second given the work per iteration
+void setFlops(benchmark::State& state, double flopsPerIteration) {
+    state.counters["FLOPS"] = benchmark::Counter(
+        flopsPerIteration, benchmark::Counter::kIsIterationInvariantRate,
+        benchmark::Counter::kIs1000);
+}
+
+void setBytes(benchmark::State& state, size_t doublesPerIteration) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(doublesPerIteration * sizeof(double)));
+}
+
+}  // namespace
+
+// Matrix::operator*(Matrix): 2n³ flops
+static void BM_MatrixMultiply(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = randomMatrix(n, 1);
+    Matrix b = randomMatrix(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix c = a * b;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 2.0 * n * n * n);
+}
+BENCHMARK(BM_MatrixMultiply)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MatrixMultiply)->Apply(largeSizes)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Matrix::operator*(Vector): 2n² flops
+static void BM_MatrixVector(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = randomMatrix(n, 1);
+    Vector x = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector y = a * x;
+        benchmark::DoNotOptimize(y.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 2.0 * n * n);
+    setBytes(state, n * n + n);
+}
+BENCHMARK(BM_MatrixVector)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+// Matrix::cholesky(): n³/3 flops
+static void BM_Cholesky(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = spdMatrix(n, 1);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix l = a.cholesky();
+        benchmark::DoNotOptimize(l.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, n * n * n / 3.0);
+}
+BENCHMARK(BM_Cholesky)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Cholesky)->Apply(largeSizes)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Matrix::inverse(): Cholesky plus a forward and back solve per column, 7n³/3 flops
+static void BM_Inverse(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = spdMatrix(n, 1);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix inv = a.inverse();
+        benchmark::DoNotOptimize(inv.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 7.0 * n * n * n / 3.0);
+}
+BENCHMARK(BM_Inverse)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Inverse)->Apply(largeSizes)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Matrix::solveLower(): n² flops
+static void BM_SolveLower(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix l = spdMatrix(n, 1).cholesky();
+    Vector b = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector x = l.solveLower(b);
+        benchmark::DoNotOptimize(x.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n * n);
+}
+BENCHMARK(BM_SolveLower)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+// Matrix::solveUpper(): n² flops
+static void BM_SolveUpper(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix u = spdMatrix(n, 1).cholesky().transpose();
+    Vector b = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector x = u.solveUpper(b);
+        benchmark::DoNotOptimize(x.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n * n);
+}
+BENCHMARK(BM_SolveUpper)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+// Matrix::transpose(): data movement only
+static void BM_Transpose(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = randomMatrix(n, 1);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix t = a.transpose();
+        benchmark::DoNotOptimize(t.data().data());
+    }
+    PerfReport::report(state, counters);
+    setBytes(state, 2 * n * n);
+}
+BENCHMARK(BM_Transpose)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+// Element-wise matrix operations: n² flops
+static void BM_MatrixAdd(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = randomMatrix(n, 1);
+    Matrix b = randomMatrix(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix c = a + b;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n * n);
+    setBytes(state, 3 * n * n);
+}
+BENCHMARK(BM_MatrixAdd)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_MatrixScale(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Matrix a = randomMatrix(n, 1);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Matrix c = a * 1.5;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n * n);
+    setBytes(state, 2 * n * n);
+}
+BENCHMARK(BM_MatrixScale)->Apply(allSizes)->Unit(benchmark::kMicrosecond);
+
+// Vector::dot(): 2n flops
+static void BM_VectorDot(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Vector a = randomVector(n, 1);
+    Vector b = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.dot(b));
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 2.0 * n);
+    setBytes(state, 2 * n);
+}
+BENCHMARK(BM_VectorDot)->Apply(allSizes);
+
+// Element-wise vector operations: n flops
+static void BM_VectorAdd(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Vector a = randomVector(n, 1);
+    Vector b = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector c = a + b;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n);
+    setBytes(state, 3 * n);
+}
+BENCHMARK(BM_VectorAdd)->Apply(allSizes);
+
+static void BM_VectorSubtract(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Vector a = randomVector(n, 1);
+    Vector b = randomVector(n, 2);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector c = a - b;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n);
+    setBytes(state, 3 * n);
+}
+BENCHMARK(BM_VectorSubtract)->Apply(allSizes);
+
+static void BM_VectorScale(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Vector a = randomVector(n, 1);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        Vector c = a * 1.5;
+        benchmark::DoNotOptimize(c.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n);
+    setBytes(state, 2 * n);
+}
+BENCHMARK(BM_VectorScale)->Apply(allSizes);
+
+// In-place update, no allocation: n flops
+static void BM_VectorAddInPlace(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Vector a = randomVector(n, 1);
+    Vector b = randomVector(n, 2) * 1e-12;
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        a += b;
+        benchmark::DoNotOptimize(a.data().data());
+    }
+    PerfReport::report(state, counters);
+    setFlops(state, 1.0 * n);
+    setBytes(state, 3 * n);
+}
+BENCHMARK(BM_VectorAddInPlace)->Apply(allSizes);
+
+// CounterRng bulk fills of n values (each benchmark size squared, as for a
+// block of scenarios)
+static void BM_FillUniform(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    CounterRng rng(1);
+    Matrix m(n, n);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        rng.fillUniform(m);
+        benchmark::DoNotOptimize(m.data().data());
+    }
+    PerfReport::report(state, counters);
+    setBytes(state, n * n);
+}
+BENCHMARK(BM_FillUniform)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_FillNormal(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    CounterRng rng(1);
+    Matrix m(n, n);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        rng.fillNormal(m);
+        benchmark::DoNotOptimize(m.data().data());
+    }
+    PerfReport::report(state, counters);
+    setBytes(state, n * n);
+}
+BENCHMARK(BM_FillNormal)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_SobolFillNormal(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    orbat::core::SobolSequence sobol(n, true, 1);
+    Matrix m(n, n);
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        sobol.seek(0);
+        sobol.fillNormal(m);
+        benchmark::DoNotOptimize(m.data().data());
+    }
+    PerfReport::report(state, counters);
+    setBytes(state, n * n);
+}
+BENCHMARK(BM_SobolFillNormal)->Apply(smallSizes)->Unit(benchmark::kMicrosecond);
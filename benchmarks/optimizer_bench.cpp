@@ -0,0 +1,338 @@
+#include "orbat/optimizer/backtest.hpp"
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/monte_carlo.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
+#include "orbat/optimizer/resampled_frontier.hpp"
+#include "orbat/optimizer/risk_analytics.hpp"
+#include "orbat/optimizer/stress_test.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "heap_tracker.hpp"
+#include "perf_report.hpp"
+
+using orbat::bench::HeapTracker;
+using orbat::bench::PerfReport;
+using orbat::optimizer::BacktestEngine;
+using orbat::optimizer::BacktestOptions;
+using orbat::optimizer::BacktestParameters;
+using orbat::optimizer::BlackLittermanOptimizer;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MonteCarloEngine;
+using orbat::optimizer::PackedConstraints;
+using orbat::optimizer::ResampledFrontierEngine;
+using orbat::optimizer::ResamplingOptions;
+using orbat::optimizer::RiskAnalytics;
+using orbat::optimizer::SimulationOptions;
+using orbat::optimizer::StressTestEngine;
+using orbat::optimizer::SyntheticOptions;
+using orbat::optimizer::SyntheticProblem;
+
+namespace {
+
+// Asset counts; from 2000 up each case runs once per repetition, because
+// every run factorizes the covariance matrix (minutes at 5000).
+const std::vector<int64_t> SIZES = {10, 100, 500};
+const std::vector<int64_t> LARGE_SIZES = {2000, 5000};
+const std::vector<int64_t> VIEW_COUNTS = {1, 10, 50};
+
+// One problem per size, generated on first use and shared by all cases
+const SyntheticProblem& problem(size_t n) {
+    static std::map<size_t, std::unique_ptr<SyntheticProblem>> cache;
+    auto& entry = cache[n];
+    if (!entry) {
+        SyntheticOptions options;
+        options.assets = n;
+        options.factors = std::min<size_t>(10, n - 1);
+        options.conditionNumber = 1e4;
+        entry = std::make_unique<SyntheticProblem>(SyntheticProblem::generate(options));
+    }
+    return *entry;
+}
+
+// Constrained cases: long-only, at most max(5%, 3/n) per asset, five sectors of at most 40%
+ConstraintSet constraints(size_t n, bool constrained) {
+    ConstraintSet set;
+    if (!constrained) {
+        return set;
+    }
+    auto limits = std::make_shared<PackedConstraints>(
+        n, 0.0, std::min(1.0, std::max(0.05, 3.0 / static_cast<double>(n))));
+    for (size_t s = 0; s < 5; ++s) {
+        limits->addSector(std::string("S") + std::to_string(s + 1), 0.0, 0.4);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        limits->setSector(i, i % 5);
+    }
+    set.add(limits);
+    return set;
+}
+
+// Args: {assets, constrained (0/1)}
+void markowitzArgs(benchmark::internal::Benchmark* b, bool large) {
+    b->ArgNames({"n", "constrained"});
+    for (int64_t n : large ? LARGE_SIZES : SIZES) {
+        b->Args({n, 0});
+        b->Args({n, 1});
+    }
+    if (large) {
+        b->Iterations(1);
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+void markowitzSmall(benchmark::internal::Benchmark* b) {
+    markowitzArgs(b, false);
+}
+
+void markowitzLarge(benchmark::internal::Benchmark* b) {
+    markowitzArgs(b, true);
+}
+
+// Args: {assets, views}
+void viewArgs(benchmark::internal::Benchmark* b, bool large) {
+    b->ArgNames({"n", "views"});
+    for (int64_t n : large ? LARGE_SIZES : SIZES) {
+        for (int64_t k : VIEW_COUNTS) {
+            b->Args({n, k});
+        }
+    }
+    if (large) {
+        b->Iterations(1);
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+void viewsSmall(benchmark::internal::Benchmark* b) {
+    viewArgs(b, false);
+}
+
+void viewsLarge(benchmark::internal::Benchmark* b) {
+    viewArgs(b, true);
+}
+
+// Runs one Markowitz method end to end: optimizer construction (including
+// factorization) plus the solve, as a caller with fresh inputs would
+template <typename Solve>
+void runMarkowitz(benchmark::State& state, Solve solve) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const SyntheticProblem& p = problem(n);
+    ConstraintSet set = constraints(n, state.range(1) != 0);
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        MarkowitzOptimizer optimizer(p.returns(), p.covariance(), set);
+        auto result = solve(optimizer, p);
+        benchmark::DoNotOptimize(result);
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+
+}  // namespace
+
+static void BM_MinimumVariance(benchmark::State& state) {
+    runMarkowitz(state, [](const MarkowitzOptimizer& optimizer, const SyntheticProblem&) {
+        return optimizer.minimumVariance().success();
+    });
+}
+BENCHMARK(BM_MinimumVariance)->Apply(markowitzSmall);
+BENCHMARK(BM_MinimumVariance)->Apply(markowitzLarge);
+
+static void BM_Optimize(benchmark::State& state) {
+    runMarkowitz(state, [](const MarkowitzOptimizer& optimizer, const SyntheticProblem&) {
+        return optimizer.optimize(1.0).success();
+    });
+}
+BENCHMARK(BM_Optimize)->Apply(markowitzSmall);
+BENCHMARK(BM_Optimize)->Apply(markowitzLarge);
+
+// Target: the average expected return, inside the feasible range in both variants
+static void BM_TargetReturn(benchmark::State& state) {
+    runMarkowitz(state, [](const MarkowitzOptimizer& optimizer, const SyntheticProblem& p) {
+        double target = p.returns().data().sum() / static_cast<double>(p.size());
+        return optimizer.targetReturn(target).success();
+    });
+}
+BENCHMARK(BM_TargetReturn)->Apply(markowitzSmall);
+BENCHMARK(BM_TargetReturn)->Apply(markowitzLarge);
+
+// 20 frontier points
+static void BM_EfficientFrontier(benchmark::State& state) {
+    runMarkowitz(state, [](const MarkowitzOptimizer& optimizer, const SyntheticProblem&) {
+        return optimizer.efficientFrontier(20).size();
+    });
+}
+BENCHMARK(BM_EfficientFrontier)->Apply(markowitzSmall);
+BENCHMARK(BM_EfficientFrontier)->Apply(markowitzLarge);
+
+// Posterior returns and optimization with k relative views
+static void BM_BlackLitterman(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const SyntheticProblem& p = problem(n);
+    auto views = p.views(static_cast<size_t>(state.range(1)));
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        BlackLittermanOptimizer optimizer(p.marketWeights(), p.covariance(), 2.5);
+        for (const auto& view : views) {
+            optimizer.addView(view);
+        }
+        benchmark::DoNotOptimize(optimizer.optimize().success());
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_BlackLitterman)->Apply(viewsSmall);
+BENCHMARK(BM_BlackLitterman)->Apply(viewsLarge);
+
+// P&L of 10 portfolios over 10000 normal scenarios on one thread
+static void BM_MonteCarloEvaluate(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const SyntheticProblem& p = problem(n);
+    MonteCarloEngine engine(p.returns(), p.covariance());
+    orbat::core::Matrix portfolios(10, n, 1.0 / static_cast<double>(n));
+    SimulationOptions options;
+    options.scenarios = 10000;
+    options.threads = 1;
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.evaluate(portfolios, options).front().mean());
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_MonteCarloEvaluate)
+    ->ArgNames({"n"})
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(500)
+    ->Unit(benchmark::kMillisecond);
+
+// Historical 95%/99% VaR and ES of p portfolios of 100 assets over 2520 periods
+static void BM_HistoricalVaR(benchmark::State& state) {
+    const size_t portfolioCount = static_cast<size_t>(state.range(0));
+    const size_t n = 100;
+    const SyntheticProblem& p = problem(n);
+    MonteCarloEngine engine(p.returns(), p.covariance());
+    SimulationOptions options;
+    options.scenarios = 2520;
+    options.threads = 1;
+    const orbat::core::Matrix history = engine.simulate(options);
+    orbat::core::Matrix portfolios(portfolioCount, n, 1.0 / static_cast<double>(n));
+    RiskAnalytics risk;
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(risk.historical(history, portfolios).front().valueAtRisk(0.99));
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_HistoricalVaR)
+    ->ArgNames({"portfolios"})
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Ten years of daily returns on 100 assets, rebalanced every 21 periods; the sets use
+// different windows, so each one estimates and factorizes on its own
+static void BM_Backtest(benchmark::State& state) {
+    const size_t setCount = static_cast<size_t>(state.range(0));
+    const size_t n = 100;
+    const SyntheticProblem& p = problem(n);
+    MonteCarloEngine engine(p.returns(), p.covariance());
+    SimulationOptions simulation;
+    simulation.scenarios = 2520;
+    simulation.threads = 1;
+    BacktestEngine backtest(engine.simulate(simulation) * 0.01);
+    std::vector<BacktestParameters> sets(setCount);
+    for (size_t s = 0; s < setCount; ++s) {
+        sets[s].window = 252 + 21 * s;
+        sets[s].transactionCost = 0.0005;
+    }
+    BacktestOptions options;
+    options.threads = 1;
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backtest.run(sets, options).front().cumulativeReturn());
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_Backtest)->ArgNames({"sets"})->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+
+// 500 parametric samples of 50 ranks each, across the hardware threads; each sample has
+// 60 periods, or one more period than assets for large universes
+static void BM_ResampledFrontier(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const SyntheticProblem& p = problem(n);
+    ResampledFrontierEngine engine(p.returns(), p.covariance());
+    ResamplingOptions options;
+    options.samples = 500;
+    options.observations = std::max<size_t>(60, n + 1);
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.compute(options).points.back().risk);
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_ResampledFrontier)->ArgName("n")->Arg(50)->Arg(500)->Unit(benchmark::kMillisecond);
+
+// 10,000 portfolios on 500 assets under 500 scenarios, half of them factor shocks
+static void BM_StressTest(benchmark::State& state) {
+    const size_t portfolios = static_cast<size_t>(state.range(0));
+    const size_t n = 500;
+    const size_t scenarios = 500;
+    const SyntheticProblem& p = problem(n);
+    MonteCarloEngine engine(p.returns(), p.covariance());
+    SimulationOptions simulation;
+    simulation.scenarios = scenarios / 2;
+    simulation.threads = 1;
+    const orbat::core::Matrix history = engine.simulate(simulation);
+    StressTestEngine stress(p.covariance());
+    for (size_t s = 0; s < scenarios / 2; ++s) {
+        stress.addHistoricalScenario("historical", history, s, s + 1);
+        stress.addFactorScenario("factor", std::vector<size_t>{s % 10, 10 + s % 7},
+                                 orbat::core::Vector({history(s, 0), history(s, 1)}));
+    }
+    simulation.scenarios = portfolios;
+    simulation.seed = 7;
+    const orbat::core::Matrix weights =
+        engine.simulate(simulation) * (1.0 / static_cast<double>(n));
+
+    HeapTracker::Snapshot start = HeapTracker::start();
+    PerfReport::Snapshot counters = PerfReport::start();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stress.evaluate(weights).worstLoss(0));
+    }
+    HeapTracker::report(state, start);
+    PerfReport::report(state, counters);
+}
+BENCHMARK(BM_StressTest)
+    ->ArgName("portfolios")
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
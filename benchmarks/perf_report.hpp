@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "cli/hardware_counters.hpp"
+
+namespace orbat {
+namespace bench {
+
+/**
+ * @brief CPU hardware counters of benchmark cases (Linux perf_event_open).
+ *
+ * The counters are opened once, on first use, for the thread running the
+ * benchmarks (see cli::HardwareCounters). Events the machine does not count
+ * are left out of the report; the reason is printed once on stderr. Set
+ * ORBAT_BENCH_COUNTERS=0 to leave hardware counters out entirely.
+ *
+ * Example:
+ *   PerfReport::Snapshot start = PerfReport::start();
+ *   for (auto _ : state) { ... }
+ *   PerfReport::report(state, start);
+ */
+class PerfReport {
+public:
+    using Snapshot = cli::HardwareCounts;
+
+    /**
+     * @brief Read the counters before the timing loop.
+     */
+    static Snapshot start() {
+        const cli::HardwareCounters* c = counters();
+        return c != nullptr ? c->read() : Snapshot();
+    }
+
+    /**
+     * @brief Add hardware counters to a finished benchmark.
+     *
+     * Reports cycles, instructions, cache_misses, branch_misses and hw_flops
+     * per iteration, and IPC (instructions per cycle), for the events that
+     * are counted.
+     *
+     * @param state Benchmark state (after the timing loop)
+     * @param start Snapshot taken before the timing loop
+     */
+    static void report(benchmark::State& state, const Snapshot& start) {
+        using benchmark::Counter;
+        using cli::HardwareEvent;
+        const cli::HardwareCounters* c = counters();
+        if (c == nullptr) {
+            return;
+        }
+        cli::HardwareCounts used = c->read() - start;
+        auto add = [&state, &used](const char* name, HardwareEvent event) {
+            if (auto value = used[event]) {
+                state.counters[name] = Counter(*value, Counter::kAvgIterations);
+            }
+        };
+        add("cycles", HardwareEvent::CYCLES);
+        add("instructions", HardwareEvent::INSTRUCTIONS);
+        add("cache_misses", HardwareEvent::CACHE_MISSES);
+        add("branch_misses", HardwareEvent::BRANCH_MISSES);
+        add("hw_flops", HardwareEvent::FLOPS);
+        if (auto ipc = used.ipc()) {
+            state.counters["IPC"] = *ipc;
+        }
+    }
+
+private:
+    // nullptr when disabled or when no event is counted
+    static const cli::HardwareCounters* counters() {
+        static const cli::HardwareCounters* instance = open();
+        return instance;
+    }
+
+    static const cli::HardwareCounters* open() {
+        const char* setting = std::getenv("ORBAT_BENCH_COUNTERS");
+        if (setting != nullptr && std::string(setting) == "0") {
+            return nullptr;
+        }
+        static cli::HardwareCounters counters;
+        if (!counters.status().empty()) {
+            std::cerr << "Hardware counters: " << counters.status() << "\n";
+        }
+        return counters.available() ? &counters : nullptr;
+    }
+};
+
+}  // namespace bench
+}  // namespace orbat
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace core {
+
+/**
+ * @brief Kind of container whose storage is tracked.
+ */
+enum class AllocationSite { VECTOR, MATRIX };
+
+/**
+ * @brief Allocation counters of one container kind or entry point.
+ */
+struct AllocationStats {
+    uint64_t calls = 0;        // Entry points: completed calls (0 for sites)
+    uint64_t allocations = 0;  // Storage blocks allocated
+    uint64_t bytes = 0;        // Total bytes allocated
+    uint64_t liveBytes = 0;    // Sites: bytes currently allocated (0 for entry points)
+    uint64_t peakBytes = 0;    // Highest live bytes (entry points: within one call)
+};
+
+class AllocationScope;
+
+/**
+ * @brief Opt-in accounting of core::Vector and core::Matrix storage.
+ *
+ * Compiled in only when ORBAT_ALLOCATION_TRACKING is defined (CMake option
+ * of the same name); otherwise the containers use plain std::vector storage,
+ * enabled() is false and every query returns zeros.
+ *
+ * When enabled, every heap block owned by a Vector or Matrix is counted per
+ * container kind (allocations, bytes, live and peak live bytes), and, through
+ * AllocationScope, per optimizer entry point active on the allocating thread.
+ * Storage adopted from a std::vector (e.g. Vector(std::vector<double>&&))
+ * counts as an allocation. Changes made through data() to the underlying
+ * std::vector are not seen until the container next reallocates.
+ *
+ * Example:
+ *   AllocationTracker::reset();
+ *   MarkowitzResult result = optimizer.minimumVariance();
+ *   AllocationStats stats =
+ *       AllocationTracker::entryPoint("MarkowitzOptimizer::minimumVariance");
+ *   std::cout << stats.allocations << " allocations, peak " << stats.peakBytes;
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Check whether tracking is compiled in.
+     */
+    static constexpr bool enabled() {
+#ifdef ORBAT_ALLOCATION_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Record a storage block. Called by the tracked containers.
+     * @param site Container kind
+     * @param bytes Block size
+     */
+    static void allocated(AllocationSite site, size_t bytes) noexcept;
+
+    /**
+     * @brief Record the release of a storage block.
+     * @param site Container kind
+     * @param bytes Block size
+     */
+    static void freed(AllocationSite site, size_t bytes) noexcept;
+
+    /**
+     * @brief Get the counters of one container kind.
+     */
+    static AllocationStats site(AllocationSite site) noexcept {
+        const Counters& c = counters(site);
+        AllocationStats stats;
+        stats.allocations = c.allocations.load(std::memory_order_relaxed);
+        stats.bytes = c.bytes.load(std::memory_order_relaxed);
+        stats.liveBytes = c.live.load(std::memory_order_relaxed);
+        stats.peakBytes = c.peak.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * @brief Get the counters of one entry point (zeros if never called).
+     * @param name Entry point name, e.g. "MarkowitzOptimizer::optimize"
+     */
+    static AllocationStats entryPoint(const std::string& name) {
+        std::lock_guard<std::mutex> lock(entryMutex_);
+        auto it = entryPoints_.find(name);
+        return it == entryPoints_.end() ? AllocationStats() : it->second;
+    }
+
+    /**
+     * @brief Get the counters of every entry point called so far, by name.
+     */
+    static std::map<std::string, AllocationStats> entryPoints() {
+        std::lock_guard<std::mutex> lock(entryMutex_);
+        return entryPoints_;
+    }
+
+    /**
+     * @brief Get the display name of a container kind.
+     */
+    static const char* siteName(AllocationSite site) {
+        return site == AllocationSite::VECTOR ? "core::Vector" : "core::Matrix";
+    }
+
+    /**
+     * @brief Zero the counters.
+     *
+     * Live bytes still belong to existing containers and are kept; peaks
+     * restart from them. Entry point counters are cleared.
+     */
+    static void reset() {
+        for (AllocationSite site : {AllocationSite::VECTOR, AllocationSite::MATRIX}) {
+            Counters& c = counters(site);
+            c.allocations.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+            c.peak.store(c.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(entryMutex_);
+        entryPoints_.clear();
+    }
+
+private:
+    friend class AllocationScope;
+
+    struct Counters {  // std::atomic value-initializes to zero
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> live;
+        std::atomic<uint64_t> peak;
+    };
+
+    static inline Counters vector_;
+    static inline Counters matrix_;
+    static inline std::mutex entryMutex_;
+    static inline std::map<std::string, AllocationStats> entryPoints_;
+    static inline thread_local std::vector<AllocationScope*> active_;
+
+    static Counters& counters(AllocationSite site) noexcept {
+        return site == AllocationSite::VECTOR ? vector_ : matrix_;
+    }
+};
+
+/**
+ * @brief RAII guard attributing container allocations to an entry point.
+ *
+ * Allocations and releases on the constructing thread count towards every
+ * scope active on it, so nested entry points (efficientFrontier calling
+ * targetReturn) are inclusive. The call's totals are added to the entry
+ * point's counters when the scope ends. Library code uses it through
+ * ORBAT_ALLOCATION_SCOPE, which compiles to nothing when tracking is off.
+ */
+class AllocationScope {
+public:
+    explicit AllocationScope(const char* name) : name_(name) {
+        AllocationTracker::active_.push_back(this);
+    }
+
+    ~AllocationScope() {
+        auto& active = AllocationTracker::active_;
+        active.erase(std::find(active.begin(), active.end(), this));
+        std::lock_guard<std::mutex> lock(AllocationTracker::entryMutex_);
+        AllocationStats& stats = AllocationTracker::entryPoints_[name_];
+        stats.calls += 1;
+        stats.allocations += allocations_;
+        stats.bytes += bytes_;
+        stats.peakBytes = std::max(stats.peakBytes, peak_);
+    }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    friend class AllocationTracker;
+
+    const char* name_;
+    uint64_t allocations_ = 0;
+    uint64_t bytes_ = 0;
+    int64_t live_ = 0;  // Negative when blocks from before the call are freed
+    uint64_t peak_ = 0;
+
+    void allocated(size_t bytes) noexcept {
+        allocations_ += 1;
+        bytes_ += bytes;
+        live_ += static_cast<int64_t>(bytes);
+        if (live_ > 0) {
+            peak_ = std::max(peak_, static_cast<uint64_t>(live_));
+        }
+    }
+
+    void freed(size_t bytes) noexcept { live_ -= static_cast<int64_t>(bytes); }
+};
+
+inline void AllocationTracker::allocated(AllocationSite site, size_t bytes) noexcept {
+    Counters& c = counters(site);
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    uint64_t live = c.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t peak = c.peak.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    for (AllocationScope* scope : active_) {
+        scope->allocated(bytes);
+    }
+}
+
+inline void AllocationTracker::freed(AllocationSite site, size_t bytes) noexcept {
+    counters(site).live.fetch_sub(bytes, std::memory_order_relaxed);
+    for (AllocationScope* scope : active_) {
+        scope->freed(bytes);
+    }
+}
+
+#ifdef ORBAT_ALLOCATION_TRACKING
+
+/**
+ * @brief std::vector<double> that reports its heap block to AllocationTracker.
+ *
+ * Used as the storage of Vector and Matrix when tracking is compiled in.
+ * The capacity recorded for the block is re-synchronized after every
+ * operation that can reallocate; moves transfer the record.
+ */
+template <AllocationSite Site>
+class TrackedStorage : public std::vector<double> {
+    using Base = std::vector<double>;
+
+public:
+    TrackedStorage() = default;
+    TrackedStorage(size_t size, double value) : Base(size, value) { sync(); }
+    TrackedStorage(std::initializer_list<double> init) : Base(init) { sync(); }
+    TrackedStorage(const Base& data) : Base(data) { sync(); }
+    TrackedStorage(Base&& data) noexcept : Base(std::move(data)) { sync(); }
+    TrackedStorage(const TrackedStorage& other) : Base(other) { sync(); }
+    TrackedStorage(TrackedStorage&& other) noexcept
+        : Base(std::move(other)), recorded_(std::exchange(other.recorded_, 0)) {}
+
+    TrackedStorage& operator=(const TrackedStorage& other) {
+        Base::operator=(other);
+        sync();
+        return *this;
+    }
+
+    TrackedStorage& operator=(TrackedStorage&& other) noexcept {
+        if (this != &other) {
+            release();
+            Base::operator=(std::move(other));
+            recorded_ = std::exchange(other.recorded_, 0);
+        }
+        return *this;
+    }
+
+    ~TrackedStorage() { release(); }
+
+    void resize(size_t size, double value = 0.0) {
+        Base::resize(size, value);
+        sync();
+    }
+
+    void reserve(size_t capacity) {
+        Base::reserve(capacity);
+        sync();
+    }
+
+    void assign(size_t size, double value) {
+        Base::assign(size, value);
+        sync();
+    }
+
+    template <typename Iterator>
+    iterator insert(const_iterator pos, Iterator first, Iterator last) {
+        iterator it = Base::insert(pos, first, last);
+        sync();
+        return it;
+    }
+
+private:
+    size_t recorded_ = 0;  // Bytes reported for the current block
+
+    void sync() noexcept {
+        size_t bytes = capacity() * sizeof(double);
+        if (bytes != recorded_) {
+            release();
+            if (bytes > 0) {
+                AllocationTracker::allocated(Site, bytes);
+            }
+            recorded_ = bytes;
+        }
+    }
+
+    void release() noexcept {
+        if (recorded_ > 0) {
+            AllocationTracker::freed(Site, recorded_);
+            recorded_ = 0;
+        }
+    }
+};
+
+#define ORBAT_ALLOCATION_SCOPE(name) ::orbat::core::AllocationScope orbatAllocationScope_(name)
+
+#else
+
+template <AllocationSite>
+using TrackedStorage = std::vector<double>;
+
+#define ORBAT_ALLOCATION_SCOPE(name) static_cast<void>(0)
+
+#endif
+
+}  // namespace core
+}  // namespace orbat
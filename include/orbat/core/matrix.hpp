@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orbat/core/allocation_tracker.hpp"
 #include "orbat/core/constants.hpp"
 #include "orbat/core/vector.hpp"
 
@@ -281,16 +282,48 @@ public:
         }
 
         Matrix result(rows_, other.cols_);
+        multiplyInto(other, result);
+        return result;
+    }
+
+    /**
+     * @brief Matrix multiplication into an existing matrix.
+     *
+     * Runs in i-k-j order, so the inner loop streams contiguous rows of
+     * other and result and vectorizes; each element still sums its products
+     * in k order, giving the same result as operator*. Reusing result across
+     * calls avoids an allocation per product.
+     *
+     * @param other Matrix to multiply with
+     * @param result Receives this * other (resized as needed)
+     * @throws std::invalid_argument if dimensions are incompatible or result
+     *         is this or other
+     */
+    void multiplyInto(const Matrix& other, Matrix& result) const {
+        if (cols_ != other.rows_) {
+            throw std::invalid_argument(
+                "Matrix multiplication requires cols of first matrix to match "
+                "rows of second");
+        }
+        if (&result == this || &result == &other) {
+            // result is cleared before the operands are read
+            throw std::invalid_argument("Matrix multiplication result must not alias an operand");
+        }
+
+        const size_t n = other.cols_;
+        result.rows_ = rows_;
+        result.cols_ = n;
+        result.data_.assign(rows_ * n, 0.0);
         for (size_t i = 0; i < rows_; ++i) {
-            for (size_t j = 0; j < other.cols_; ++j) {
-                double sum = 0.0;
-                for (size_t k = 0; k < cols_; ++k) {
-                    sum += (*this)(i, k) * other(k, j);
+            double* out = result.data_.data() + i * n;
+            for (size_t k = 0; k < cols_; ++k) {
+                const double a = data_[i * cols_ + k];
+                const double* row = other.data_.data() + k * n;
+                for (size_t j = 0; j < n; ++j) {
+                    out[j] += a * row[j];
                 }
-                result(i, j) = sum;
             }
         }
-        return result;
     }
 
     /**
@@ -628,7 +661,7 @@ public:
 private:
     size_t rows_;
     size_t cols_;
-    std::vector<double> data_;  // Row-major order
+    TrackedStorage<AllocationSite::MATRIX> data_;  // Row-major order
 };
 
 /**
@@ -0,0 +1,530 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace core {
+
+/**
+ * @brief Monotonic event count.
+ */
+class MetricCounter {
+public:
+    void add(uint64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+    void reset() noexcept { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Value that can go up and down (e.g. resident snapshots).
+ */
+class MetricGauge {
+public:
+    void set(double value) noexcept { value_.store(value, std::memory_order_relaxed); }
+
+    void add(double delta) noexcept { value_.fetch_add(delta, std::memory_order_relaxed); }
+
+    double value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+    void reset() noexcept { set(0.0); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief Lock-free latency histogram with HDR-style log-linear buckets.
+ *
+ * Durations are recorded in nanoseconds. Values below 64 ns get a bucket
+ * each; above that, every power of two is split into 32 equal buckets, so
+ * any recorded value is known to within 1/32 (about 3%) over the whole
+ * 64-bit range. Recording is a few relaxed atomic operations and never
+ * allocates or locks.
+ *
+ * Readers see a consistent total only when no thread is recording; under
+ * concurrent updates quantiles may miss the newest samples.
+ *
+ * Example:
+ *   LatencyHistogram latency;
+ *   latency.record(1500);                  // 1.5 µs
+ *   double p99 = latency.quantile(0.99);   // nanoseconds
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;  // 64
+    static constexpr uint64_t HALF = SUB_BUCKETS / 2;                          // 32
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS) * HALF + SUB_BUCKETS;
+
+    /**
+     * @brief Record one duration.
+     * @param nanos Duration in nanoseconds
+     */
+    void record(uint64_t nanos) noexcept {
+        counts_[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (nanos > max && !max_.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Get the number of recorded values.
+     */
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the sum of recorded values (nanoseconds).
+     */
+    uint64_t sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the largest recorded value (nanoseconds, exact).
+     */
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Estimate a quantile.
+     * @param q Quantile in [0, 1], e.g. 0.99
+     * @return Upper bound of the bucket holding the q-th value (nanoseconds),
+     *         capped at max(); 0 if nothing was recorded
+     */
+    double quantile(double q) const noexcept {
+        uint64_t total = 0;
+        std::array<uint64_t, BUCKETS> counts;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return 0.0;
+        }
+        q = std::clamp(q, 0.0, 1.0);
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+                                                  std::ceil(q * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return static_cast<double>(std::min(bucketUpper(i), max()));
+            }
+        }
+        return static_cast<double>(max());
+    }
+
+    /**
+     * @brief Count the values in buckets whose upper bound is at most a limit.
+     * @param nanos Limit in nanoseconds
+     */
+    uint64_t countAtOrBelow(uint64_t nanos) const noexcept {
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKETS && bucketUpper(i) <= nanos; ++i) {
+            total += counts_[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void reset() noexcept {
+        for (auto& c : counts_) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the bucket of a value.
+     */
+    static size_t bucketIndex(uint64_t value) noexcept {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BUCKET_BITS;
+        return static_cast<size_t>(shift * HALF + (value >> shift));
+    }
+
+    /**
+     * @brief Get the largest value that falls in a bucket.
+     */
+    static uint64_t bucketUpper(size_t index) noexcept {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / HALF) - 1;
+        uint64_t sub = index % HALF + HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief RAII timer recording its lifetime into a histogram.
+ */
+class LatencyTimer {
+public:
+    explicit LatencyTimer(LatencyHistogram& histogram) noexcept
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~LatencyTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Metric labels, e.g. {{"entry_point", "optimize"}}.
+ */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Named counters, gauges and latency histograms, exported in the
+ * Prometheus text exposition format.
+ *
+ * Registering a metric takes a lock and returns a reference that stays
+ * valid for the registry's lifetime; callers keep it (typically in a
+ * function-local static) so that updates are lock-free. Registering the
+ * same name and labels again returns the same metric.
+ *
+ * Histograms are exported as Prometheus histograms in seconds with fixed
+ * bucket bounds (1 µs to 10 s, 1-2.5-5 per decade), plus two gauge
+ * families computed from the full-resolution buckets: <name>_max and
+ * <name>_quantile{quantile="0.5|0.9|0.99|0.999"}.
+ *
+ * The optimizer entry points record into global() under
+ * orbat_entry_point_duration_seconds (see ORBAT_LATENCY_TIMER).
+ *
+ * Example:
+ *   auto& jobs = MetricsRegistry::global().counter("orbat_jobs_total", "Jobs run");
+ *   jobs.add();
+ *   MetricsRegistry::global().writePrometheus("/var/lib/node_exporter/orbat.prom");
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Get the process-wide registry.
+     */
+    static MetricsRegistry& global() {
+        static MetricsRegistry* registry = new MetricsRegistry();  // Never destroyed
+        return *registry;
+    }
+
+    /**
+     * @brief Get or register a counter.
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    MetricCounter& counter(const std::string& name, const std::string& help,
+                           const MetricLabels& labels = {}) {
+        return get<MetricCounter>(Type::COUNTER, name, help, labels);
+    }
+
+    /**
+     * @brief Get or register a gauge.
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    MetricGauge& gauge(const std::string& name, const std::string& help,
+                       const MetricLabels& labels = {}) {
+        return get<MetricGauge>(Type::GAUGE, name, help, labels);
+    }
+
+    /**
+     * @brief Get or register a latency histogram (recorded in nanoseconds).
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    LatencyHistogram& histogram(const std::string& name, const std::string& help,
+                                const MetricLabels& labels = {}) {
+        return get<LatencyHistogram>(Type::HISTOGRAM, name, help, labels);
+    }
+
+    /**
+     * @brief Zero every metric. Registrations (and references) are kept.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, family] : families_) {
+            for (auto& [key, series] : family.series) {
+                if (series.counter) {
+                    series.counter->reset();
+                }
+                if (series.gauge) {
+                    series.gauge->reset();
+                }
+                if (series.histogram) {
+                    series.histogram->reset();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Write a snapshot in the Prometheus text format (version 0.0.4).
+     * @param out Destination stream
+     */
+    void writePrometheus(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ostringstream text;
+        text.precision(9);
+        for (const auto& [name, family] : families_) {
+            if (family.type == Type::HISTOGRAM) {
+                writeHistogramFamily(text, name, family);
+                continue;
+            }
+            text << "# HELP " << name << " " << family.help << "\n# TYPE " << name << " "
+                 << (family.type == Type::COUNTER ? "counter" : "gauge") << "\n";
+            for (const auto& [key, series] : family.series) {
+                text << name << key << " ";
+                if (series.counter) {
+                    text << series.counter->value();
+                } else {
+                    text << series.gauge->value();
+                }
+                text << "\n";
+            }
+        }
+        out << text.str();
+    }
+
+    /**
+     * @brief Write a snapshot to a file, replacing it atomically.
+     * @param path Output path
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void writePrometheus(const std::string& path) const {
+        std::ostringstream text;
+        writePrometheus(text);
+        writeFile(path, text.str());
+    }
+
+    /**
+     * @brief Replace a file atomically with exposition text.
+     *
+     * The text goes to "<path>.tmp" and is renamed over path, so a reader
+     * (e.g. node_exporter's textfile collector) never sees a partial file.
+     * Used to write the snapshots of several registries as one file.
+     *
+     * @param path Output path
+     * @param text File contents
+     * @throws std::runtime_error if the file cannot be written
+     */
+    static void writeFile(const std::string& path, const std::string& text) {
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream file(temp);
+            file << text;
+            if (!file) {
+                throw std::runtime_error("Cannot write metrics file: " + path);
+            }
+        }
+        if (std::rename(temp.c_str(), path.c_str()) != 0) {
+            std::remove(temp.c_str());
+            throw std::runtime_error("Cannot write metrics file: " + path);
+        }
+    }
+
+    /**
+     * @brief Fixed histogram bucket bounds of the export, in seconds.
+     */
+    static const std::vector<double>& exportBounds() {
+        static const std::vector<double> bounds = [] {
+            std::vector<double> b;
+            for (double decade = 1e-6; decade < 5.0; decade *= 10.0) {
+                b.insert(b.end(), {decade, 2.5 * decade, 5.0 * decade});
+            }
+            b.push_back(10.0);
+            return b;
+        }();
+        return bounds;
+    }
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Series {
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+        MetricLabels labels;
+    };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, Series> series;  // By formatted label set
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+
+    template <typename Metric>
+    Metric& get(Type type, const std::string& name, const std::string& help,
+                const MetricLabels& labels) {
+        validateName(name);
+        for (const auto& [label, value] : labels) {
+            validateName(label);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = families_.try_emplace(name, Family{type, help, {}});
+        if (!inserted && it->second.type != type) {
+            throw std::invalid_argument("Metric " + name + " is already registered as " +
+                                        "another type");
+        }
+        Series& series = it->second.series[formatLabels(labels)];
+        series.labels = labels;
+        std::unique_ptr<Metric>& slot = member<Metric>(series);
+        if (!slot) {
+            slot = std::make_unique<Metric>();
+        }
+        return *slot;
+    }
+
+    template <typename Metric>
+    static std::unique_ptr<Metric>& member(Series& series) {
+        if constexpr (std::is_same_v<Metric, MetricCounter>) {
+            return series.counter;
+        } else if constexpr (std::is_same_v<Metric, MetricGauge>) {
+            return series.gauge;
+        } else {
+            return series.histogram;
+        }
+    }
+
+    static void validateName(const std::string& name) {
+        bool valid = !name.empty() && !(name[0] >= '0' && name[0] <= '9');
+        for (char c : name) {
+            valid = valid && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                              (c >= '0' && c <= '9') || c == '_' || c == ':');
+        }
+        if (!valid) {
+            throw std::invalid_argument("Invalid metric or label name: '" + name + "'");
+        }
+    }
+
+    // {a="x",b="y"} with Prometheus escaping; "" without labels. extra is
+    // appended inside the braces (e.g. le="0.001").
+    static std::string formatLabels(const MetricLabels& labels, const std::string& extra = "") {
+        if (labels.empty() && extra.empty()) {
+            return "";
+        }
+        std::string text = "{";
+        for (const auto& [label, value] : labels) {
+            text += (text.size() > 1 ? "," : "") + label + "=\"";
+            for (char c : value) {
+                if (c == '\\' || c == '"') {
+                    text += '\\';
+                    text += c;
+                } else if (c == '\n') {
+                    text += "\\n";
+                } else {
+                    text += c;
+                }
+            }
+            text += "\"";
+        }
+        if (!extra.empty()) {
+            text += (text.size() > 1 ? "," : "") + extra;
+        }
+        return text + "}";
+    }
+
+    static std::string number(double value) {
+        std::ostringstream oss;
+        oss.precision(9);
+        oss << value;
+        return oss.str();
+    }
+
+    static void writeHistogramFamily(std::ostream& out, const std::string& name,
+                                     const Family& family) {
+        out << "# HELP " << name << " " << family.help << "\n# TYPE " << name << " histogram\n";
+        for (const auto& [key, series] : family.series) {
+            const LatencyHistogram& h = *series.histogram;
+            for (double bound : exportBounds()) {
+                out << name << "_bucket"
+                    << formatLabels(series.labels, "le=\"" + number(bound) + "\"") << " "
+                    << h.countAtOrBelow(static_cast<uint64_t>(bound * 1e9)) << "\n";
+            }
+            out << name << "_bucket" << formatLabels(series.labels, "le=\"+Inf\"") << " "
+                << h.count() << "\n"
+                << name << "_sum" << key << " " << static_cast<double>(h.sum()) * 1e-9 << "\n"
+                << name << "_count" << key << " " << h.count() << "\n";
+        }
+        out << "# HELP " << name << "_max Largest observation of " << name << "\n# TYPE "
+            << name << "_max gauge\n";
+        for (const auto& [key, series] : family.series) {
+            out << name << "_max" << key << " "
+                << static_cast<double>(series.histogram->max()) * 1e-9 << "\n";
+        }
+        out << "# HELP " << name << "_quantile Quantiles of " << name
+            << " from log-linear buckets (3% resolution)\n# TYPE " << name
+            << "_quantile gauge\n";
+        for (const auto& [key, series] : family.series) {
+            for (const char* q : {"0.5", "0.9", "0.99", "0.999"}) {
+                out << name << "_quantile"
+                    << formatLabels(series.labels, std::string("quantile=\"") + q + "\"") << " "
+                    << series.histogram->quantile(std::stod(q)) * 1e-9 << "\n";
+            }
+        }
+    }
+};
+
+/**
+ * @brief Record the duration of the enclosing scope as an optimizer entry
+ * point call (orbat_entry_point_duration_seconds{entry_point=...}).
+ *
+ * The histogram is looked up once per call site; each call then costs two
+ * clock reads and a few relaxed atomic updates. Compiles to nothing with
+ * ORBAT_DISABLE_METRICS (CMake: -DORBAT_METRICS=OFF).
+ */
+#ifndef ORBAT_DISABLE_METRICS
+#define ORBAT_METRICS_CONCAT_(a, b) a##b
+#define ORBAT_METRICS_NAME_(prefix, line) ORBAT_METRICS_CONCAT_(prefix, line)
+#define ORBAT_LATENCY_TIMER(entryPoint)                                                         \
+    static ::orbat::core::LatencyHistogram& ORBAT_METRICS_NAME_(orbatLatency_, __LINE__) =      \
+        ::orbat::core::MetricsRegistry::global().histogram(                                     \
+            "orbat_entry_point_duration_seconds", "Time spent in optimizer entry points",       \
+            {{"entry_point", entryPoint}});                                                      \
+    ::orbat::core::LatencyTimer ORBAT_METRICS_NAME_(orbatLatencyTimer_, __LINE__)(              \
+        ORBAT_METRICS_NAME_(orbatLatency_, __LINE__))
+#else
+#define ORBAT_LATENCY_TIMER(entryPoint) static_cast<void>(0)
+#endif
+
+}  // namespace core
+}  // namespace orbat
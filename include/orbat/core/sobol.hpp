@@ -0,0 +1,505 @@
+#pragma once
+
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/random.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace orbat {
+namespace core {
+
+namespace detail {
+
+// AS 241 rational approximation of the normal quantile for |q| <= 0.425, q = p - 1/2
+inline double centralNormalQuantile(double q) {
+    const double r = 0.180625 - q * q;
+    return q *
+           (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r +
+                 6.7265770927008700853e+4) * r + 4.5921953931549871457e+4) * r +
+               1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r +
+             1.3314166789178437745e+2) * r + 3.3871328727963666080e+0) /
+           (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r +
+                 3.9307895800092710610e+4) * r + 2.1213794301586595867e+4) * r +
+               5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r +
+             4.2313330701600911252e+1) * r + 1.0);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Inverse of the standard normal CDF (Wichura's AS 241, PPND16).
+ *
+ * Relative accuracy is about 1e-16 over the whole range.
+ *
+ * @param p Probability in (0, 1); 0 and 1 give -inf and +inf
+ * @return z with Φ(z) = p
+ */
+inline double inverseNormalCdf(double p) {
+    if (p <= 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (p >= 1.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double q = p - 0.5;
+    if (std::abs(q) <= 0.425) {
+        return detail::centralNormalQuantile(q);
+    }
+    double r = std::sqrt(-std::log(q < 0.0 ? p : 1.0 - p));
+    double z = 0.0;
+    if (r <= 5.0) {
+        r -= 1.6;
+        z = (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r +
+                  2.41780725177450611770e-1) * r + 1.27045825245236838258e+0) * r +
+                3.64784832476320460504e+0) * r + 5.76949722146069140550e+0) * r +
+              4.63033784615654529590e+0) * r + 1.42343711074968357734e+0) /
+            (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r +
+                  1.51986665636164571966e-2) * r + 1.48103976427480074590e-1) * r +
+                6.89767334985100004550e-1) * r + 1.67638483018380384940e+0) * r +
+              2.05319162663775882187e+0) * r + 1.0);
+    } else {
+        r -= 5.0;
+        z = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r +
+                  1.24266094738807843860e-3) * r + 2.65321895265761230930e-2) * r +
+                2.96560571828504891230e-1) * r + 1.78482653991729133580e+0) * r +
+              5.46378491116411436990e+0) * r + 6.65790464350110377720e+0) /
+            (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r +
+                  1.84631831751005468180e-5) * r + 7.86869131145613259100e-4) * r +
+                1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r +
+              5.99832206555887937690e-1) * r + 1.0);
+    }
+    return q < 0.0 ? -z : z;
+}
+
+/**
+ * @brief Apply the inverse normal CDF to a buffer in place.
+ *
+ * Values within 0.425 of 1/2 (about 85% of uniforms) all go through the
+ * central rational approximation in one branch-free loop, which the
+ * compiler vectorizes; only the tails are then redone one by one. Gives
+ * the same results as the scalar inverseNormalCdf().
+ *
+ * @param values Probabilities in (0, 1), replaced by normal quantiles
+ * @param count Number of values
+ */
+inline void inverseNormalCdf(double* values, size_t count) {
+    constexpr size_t CHUNK = 256;
+    std::array<double, CHUNK> p;
+    for (size_t start = 0; start < count; start += CHUNK) {
+        const size_t n = std::min(CHUNK, count - start);
+        double* z = values + start;
+        std::copy(z, z + n, p.begin());
+        for (size_t i = 0; i < n; ++i) {
+            z[i] = detail::centralNormalQuantile(p[i] - 0.5);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (!(std::abs(p[i] - 0.5) <= 0.425)) {
+                z[i] = inverseNormalCdf(p[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Scrambled Sobol low-discrepancy sequence.
+ *
+ * Quasi-Monte Carlo points cover the unit cube far more evenly than
+ * random ones: for smooth integrands the error of an average over N
+ * points falls close to 1/N instead of 1/√N. Each coordinate of point n
+ * is the XOR of the direction numbers selected by the bits of n's Gray
+ * code, so consecutive points differ by a single XOR per dimension
+ * (Antonov and Saleev) and any point can be reached directly.
+ *
+ * Direction numbers follow Joe and Kuo ("Constructing Sobol sequences with
+ * better two-dimensional projections", SIAM J. Sci. Comput. 2008): the
+ * primitive polynomials are enumerated in their order, and the first 64
+ * dimensions use their published initial numbers. Further dimensions, up to
+ * MAX_DIMENSIONS, use fixed pseudo-random odd initial numbers rather than
+ * a 1.7 MB table; they are valid Sobol directions but without the
+ * optimized two-dimensional projections.
+ *
+ * Scrambling applies a random linear matrix scramble and digital shift
+ * (Matoušek) per dimension. It keeps the stratification of the points,
+ * removes the point at the origin and makes estimates from different seeds
+ * independent, so their spread measures the error. Points are
+ * (k + 1/2) / 2^32, never exactly 0 or 1, so they can go straight into
+ * inverseNormalCdf().
+ *
+ * Copies share the direction numbers, so a parallel worker takes a copy,
+ * seek()s to the first point of its block and fills from there: the
+ * points do not depend on how the work is split.
+ *
+ * Example:
+ *   SobolSequence sobol(n, true, seed);
+ *   Matrix z(4096, n);    // Powers of two balance the points best
+ *   sobol.fillNormal(z);  // One scenario of normals per row
+ */
+class SobolSequence {
+public:
+    static constexpr size_t MAX_DIMENSIONS = 21201;              // Joe-Kuo range
+    static constexpr uint64_t MAX_POINTS = uint64_t{1} << 32;  // 32-bit coordinates
+
+    /**
+     * @brief Construct a sequence positioned at its first point.
+     * @param dimensions Number of coordinates per point
+     * @param scramble Apply a random scramble and shift
+     * @param seed Scrambling seed
+     * @throws std::invalid_argument if dimensions is 0 or above MAX_DIMENSIONS
+     */
+    explicit SobolSequence(size_t dimensions, bool scramble = true, uint64_t seed = 0)
+        : dimensions_(dimensions) {
+        if (dimensions == 0 || dimensions > MAX_DIMENSIONS) {
+            throw std::invalid_argument("Sobol dimensions must be between 1 and 21201");
+        }
+        tables_ = std::make_shared<const Tables>(dimensions, scramble, seed);
+        seek(0);
+    }
+
+    /**
+     * @brief Get the number of coordinates per point.
+     */
+    size_t dimensions() const { return dimensions_; }
+
+    /**
+     * @brief Get the index of the next point.
+     */
+    uint64_t position() const { return index_; }
+
+    /**
+     * @brief Move to a point in O(dimensions · 32).
+     * @param index Index of the next point to produce
+     * @throws std::out_of_range if index is above MAX_POINTS
+     */
+    void seek(uint64_t index) {
+        if (index > MAX_POINTS) {
+            throw std::out_of_range("Sobol point index out of range");
+        }
+        const Tables& t = *tables_;
+        state_ = t.shift;
+        const uint64_t gray = index ^ (index >> 1);
+        for (size_t k = 0; k < BITS_; ++k) {
+            if ((gray >> k) & 1) {
+                const uint32_t* v = t.directions.data() + k * dimensions_;
+                for (size_t j = 0; j < dimensions_; ++j) {
+                    state_[j] ^= v[j];
+                }
+            }
+        }
+        index_ = index;
+    }
+
+    /**
+     * @brief Skip points.
+     * @param points Number of points to skip
+     * @throws std::out_of_range if this passes MAX_POINTS
+     */
+    void discard(uint64_t points) {
+        if (points > MAX_POINTS - index_) {
+            throw std::out_of_range("Sobol point index out of range");
+        }
+        seek(index_ + points);
+    }
+
+    /**
+     * @brief Fill a buffer with points in (0, 1)^dimensions.
+     * @param out Destination, points × dimensions in row-major order
+     * @param points Number of points
+     * @throws std::out_of_range if this passes MAX_POINTS
+     */
+    void fillUniform(double* out, size_t points) {
+        if (points > MAX_POINTS - index_) {
+            throw std::out_of_range("Sobol sequence exhausted");
+        }
+        const uint32_t* directions = tables_->directions.data();
+        for (size_t p = 0; p < points; ++p, out += dimensions_) {
+            for (size_t j = 0; j < dimensions_; ++j) {
+                out[j] = (static_cast<double>(state_[j]) + 0.5) * 0x1.0p-32;
+            }
+            // Gray code step: point n + 1 flips the direction of n + 1's lowest set bit
+            ++index_;
+            if (index_ < MAX_POINTS) {
+                const uint32_t* v =
+                    directions + static_cast<size_t>(std::countr_zero(index_)) * dimensions_;
+                for (size_t j = 0; j < dimensions_; ++j) {
+                    state_[j] ^= v[j];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Fill a buffer with points mapped to independent standard normals.
+     * @param out Destination, points × dimensions in row-major order
+     * @param points Number of points
+     * @throws std::out_of_range if this passes MAX_POINTS
+     */
+    void fillNormal(double* out, size_t points) {
+        fillUniform(out, points);
+        inverseNormalCdf(out, points * dimensions_);
+    }
+
+    /**
+     * @brief Fill a matrix with one point per row.
+     * @throws std::invalid_argument if the matrix does not have one column per dimension
+     */
+    void fillUniform(Matrix& m) {
+        checkColumns(m);
+        fillUniform(m.data().data(), m.rows());
+    }
+
+    /**
+     * @brief Fill a matrix with one point of normals per row.
+     * @throws std::invalid_argument if the matrix does not have one column per dimension
+     */
+    void fillNormal(Matrix& m) {
+        checkColumns(m);
+        fillNormal(m.data().data(), m.rows());
+    }
+
+    /**
+     * @brief Get the first primitive polynomials over GF(2) in Joe-Kuo order.
+     *
+     * Ordered by degree, then by value. Bit i is the coefficient of x^i, so
+     * x² + x + 1 is 7. Dimension d > 0 of the sequence uses polynomial d - 1.
+     *
+     * @param count Number of polynomials
+     * @return The polynomials
+     */
+    static std::vector<uint32_t> primitivePolynomials(size_t count) {
+        static std::mutex mutex;
+        static std::vector<uint32_t> found;
+        static uint32_t candidate = 1;
+        std::lock_guard<std::mutex> lock(mutex);
+        while (found.size() < count) {
+            candidate += 2;  // The constant term must be 1
+            // An even number of terms means x + 1 divides the polynomial
+            if ((std::popcount(candidate) % 2 == 1 || candidate == 3) &&
+                isPrimitive(candidate)) {
+                found.push_back(candidate);
+            }
+        }
+        return std::vector<uint32_t>(found.begin(), found.begin() + count);
+    }
+
+private:
+    static constexpr size_t BITS_ = 32;
+    static constexpr size_t TABLE_DIMENSIONS = 64;
+
+    // Joe-Kuo initial direction numbers m_1..m_s for dimensions 1..63
+    static constexpr uint16_t INITIAL[TABLE_DIMENSIONS - 1][9] = {
+        {1},
+        {1, 3},
+        {1, 3, 1},
+        {1, 1, 1},
+        {1, 1, 3, 3},
+        {1, 3, 5, 13},
+        {1, 1, 5, 5, 17},
+        {1, 1, 5, 5, 5},
+        {1, 1, 7, 11, 19},
+        {1, 1, 5, 1, 1},
+        {1, 1, 1, 3, 11},
+        {1, 3, 5, 5, 31},
+        {1, 3, 3, 9, 7, 49},
+        {1, 1, 1, 15, 21, 21},
+        {1, 3, 1, 13, 27, 49},
+        {1, 1, 1, 15, 7, 5},
+        {1, 3, 1, 15, 13, 25},
+        {1, 1, 5, 5, 19, 61},
+        {1, 3, 7, 11, 23, 15, 103},
+        {1, 3, 7, 13, 13, 15, 69},
+        {1, 1, 3, 13, 7, 35, 63},
+        {1, 3, 5, 9, 1, 25, 53},
+        {1, 3, 1, 13, 9, 35, 107},
+        {1, 3, 1, 5, 27, 61, 31},
+        {1, 1, 5, 11, 19, 41, 61},
+        {1, 3, 5, 3, 3, 13, 69},
+        {1, 1, 7, 13, 1, 19, 1},
+        {1, 3, 7, 5, 13, 19, 59},
+        {1, 1, 3, 9, 25, 29, 41},
+        {1, 3, 5, 13, 23, 1, 55},
+        {1, 3, 7, 3, 13, 59, 17},
+        {1, 3, 1, 3, 5, 53, 69},
+        {1, 1, 5, 5, 23, 33, 13},
+        {1, 1, 7, 7, 1, 61, 123},
+        {1, 1, 7, 9, 13, 61, 49},
+        {1, 3, 3, 5, 3, 55, 33},
+        {1, 3, 1, 15, 31, 13, 49, 245},
+        {1, 3, 5, 15, 31, 59, 63, 97},
+        {1, 3, 1, 11, 11, 11, 77, 249},
+        {1, 3, 1, 11, 27, 43, 71, 9},
+        {1, 1, 7, 15, 21, 11, 81, 45},
+        {1, 3, 7, 3, 25, 31, 65, 79},
+        {1, 3, 1, 1, 19, 11, 3, 205},
+        {1, 1, 5, 9, 19, 21, 29, 157},
+        {1, 3, 7, 11, 1, 33, 89, 185},
+        {1, 3, 3, 3, 15, 9, 79, 71},
+        {1, 3, 7, 11, 15, 39, 119, 27},
+        {1, 1, 3, 1, 11, 31, 97, 225},
+        {1, 1, 1, 3, 23, 43, 57, 177},
+        {1, 3, 7, 7, 17, 17, 37, 71},
+        {1, 3, 1, 5, 27, 63, 123, 213},
+        {1, 1, 3, 5, 11, 43, 53, 133},
+        {1, 3, 5, 5, 29, 17, 47, 173, 479},
+        {1, 3, 3, 11, 3, 1, 109, 9, 69},
+        {1, 1, 1, 5, 17, 39, 23, 5, 343},
+        {1, 3, 1, 5, 25, 15, 31, 103, 499},
+        {1, 1, 1, 11, 11, 17, 63, 105, 183},
+        {1, 1, 5, 11, 9, 29, 97, 231, 363},
+        {1, 1, 5, 15, 19, 45, 41, 7, 383},
+        {1, 3, 7, 7, 31, 19, 83, 137, 221},
+        {1, 1, 1, 3, 23, 15, 111, 223, 83},
+        {1, 1, 5, 13, 31, 15, 55, 25, 161},
+        {1, 1, 3, 13, 25, 47, 39, 87, 257},
+    };
+
+    /**
+     * @brief Direction numbers and shifts, shared by copies of a sequence.
+     *
+     * directions[k * dimensions + j] is direction k of dimension j, so a
+     * Gray code step XORs one contiguous row into the state.
+     */
+    struct Tables {
+        std::vector<uint32_t> directions;
+        std::vector<uint32_t> shift;
+
+        Tables(size_t dimensions, bool scramble, uint64_t seed)
+            : directions(BITS_ * dimensions), shift(dimensions, 0) {
+            const std::vector<uint32_t> polynomials = primitivePolynomials(dimensions - 1);
+            std::array<uint32_t, BITS_> v;
+            for (size_t j = 0; j < dimensions; ++j) {
+                if (j == 0) {
+                    for (size_t k = 0; k < BITS_; ++k) {
+                        v[k] = uint32_t{1} << (BITS_ - 1 - k);  // van der Corput
+                    }
+                } else {
+                    const uint32_t poly = polynomials[j - 1];
+                    const size_t s = static_cast<size_t>(std::bit_width(poly)) - 1;
+                    const uint32_t a = (poly >> 1) & ((uint32_t{1} << (s - 1)) - 1);
+                    // Fixed key: the same directions for every scrambling seed
+                    CounterRng initial(0x536F626F6CULL, j);
+                    for (size_t k = 0; k < s; ++k) {
+                        // m_{k+1} is odd and below 2^(k+1)
+                        uint32_t m = j < TABLE_DIMENSIONS
+                                         ? INITIAL[j - 1][k]
+                                         : (static_cast<uint32_t>(initial()) &
+                                            ((uint32_t{2} << k) - 1)) | 1;
+                        v[k] = m << (BITS_ - 1 - k);
+                    }
+                    for (size_t k = s; k < BITS_; ++k) {
+                        uint32_t value = v[k - s] ^ (v[k - s] >> s);
+                        for (size_t l = 1; l < s; ++l) {
+                            if ((a >> (s - 1 - l)) & 1) {
+                                value ^= v[k - l];
+                            }
+                        }
+                        v[k] = value;
+                    }
+                }
+                if (scramble) {
+                    scrambleDimension(v, shift[j], seed, j);
+                }
+                for (size_t k = 0; k < BITS_; ++k) {
+                    directions[k * dimensions + j] = v[k];
+                }
+            }
+        }
+
+        // Multiply the directions by a random lower-triangular matrix over
+        // GF(2) (digit i depends on digits 0..i, most significant first) and
+        // draw a random digital shift
+        static void scrambleDimension(std::array<uint32_t, BITS_>& v, uint32_t& shift,
+                                      uint64_t seed, size_t dimension) {
+            // A key of its own, so the scramble is independent of CounterRng(seed) streams
+            CounterRng rng(seed ^ 0x9E3779B97F4A7C15ULL, dimension);
+            std::array<uint32_t, BITS_> rows;
+            for (size_t i = 0; i < BITS_; ++i) {
+                const uint32_t digit = uint32_t{1} << (BITS_ - 1 - i);
+                const uint32_t above = ~(digit | (digit - 1));
+                rows[i] = digit | (static_cast<uint32_t>(rng()) & above);
+            }
+            for (uint32_t& direction : v) {
+                uint32_t scrambled = 0;
+                for (size_t i = 0; i < BITS_; ++i) {
+                    scrambled |= static_cast<uint32_t>(std::popcount(rows[i] & direction) & 1)
+                                 << (BITS_ - 1 - i);
+                }
+                direction = scrambled;
+            }
+            shift = static_cast<uint32_t>(rng());
+        }
+    };
+
+    size_t dimensions_ = 0;
+    std::shared_ptr<const Tables> tables_;
+    std::vector<uint32_t> state_;  // Coordinates of point index_ as 32-bit fractions
+    uint64_t index_ = 0;
+
+    void checkColumns(const Matrix& m) const {
+        if (m.cols() != dimensions_) {
+            throw std::invalid_argument("Matrix must have one column per Sobol dimension");
+        }
+    }
+
+    // x^k mod poly over GF(2), by square-and-multiply
+    static uint64_t powerOfX(uint64_t k, uint32_t poly) {
+        const int degree = std::bit_width(poly) - 1;
+        auto multiply = [&](uint64_t a, uint64_t b) {
+            uint64_t product = 0;
+            for (; b != 0; b >>= 1) {
+                if (b & 1) {
+                    product ^= a;
+                }
+                a <<= 1;
+                if ((a >> degree) & 1) {
+                    a ^= poly;
+                }
+            }
+            return product;
+        };
+        uint64_t result = 1;
+        uint64_t base = degree > 1 ? 2 : 2 ^ poly;  // x mod poly
+        for (; k != 0; k >>= 1) {
+            if (k & 1) {
+                result = multiply(result, base);
+            }
+            base = multiply(base, base);
+        }
+        return result;
+    }
+
+    // Primitive iff x has multiplicative order exactly 2^degree - 1 mod poly
+    static bool isPrimitive(uint32_t poly) {
+        const uint64_t order = (uint64_t{1} << (std::bit_width(poly) - 1)) - 1;
+        if (powerOfX(order, poly) != 1) {
+            return false;
+        }
+        uint64_t rest = order;
+        for (uint64_t q = 2; rest > 1; ++q) {
+            if (q * q > rest) {
+                q = rest;  // What remains is prime
+            }
+            if (rest % q == 0) {
+                if (powerOfX(order / q, poly) == 1) {
+                    return false;
+                }
+                while (rest % q == 0) {
+                    rest /= q;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+}  // namespace core
+}  // namespace orbat
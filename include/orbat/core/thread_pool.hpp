@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace core {
+
+/**
+ * @brief Fixed-size pool of worker threads executing queued tasks.
+ *
+ * Tasks are executed in FIFO order by the first idle worker. submit() returns
+ * a std::future that carries the task's result or exception. parallelFor()
+ * splits an index range into chunks and blocks until all chunks complete.
+ *
+ * The destructor drains the queue: every task submitted before destruction
+ * runs to completion before the workers are joined.
+ *
+ * Example:
+ *   ThreadPool pool(4);
+ *   auto future = pool.submit([] { return 42; });
+ *   int answer = future.get();
+ *
+ *   std::vector<double> squares(1000);
+ *   pool.parallelFor(0, squares.size(), [&](size_t i) { squares[i] = double(i) * i; });
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Construct a pool with the given number of workers.
+     * @param numThreads Number of worker threads (0 = defaultThreadCount())
+     */
+    explicit ThreadPool(size_t numThreads = 0) : stopping_(false), active_(0) {
+        if (numThreads == 0) {
+            numThreads = defaultThreadCount();
+        }
+        workers_.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    /**
+     * @brief Finish all queued tasks and join the workers.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        taskAvailable_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of worker threads.
+     * @return Worker count
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Get the default worker count for this machine.
+     * @return std::thread::hardware_concurrency(), or 1 if unknown
+     */
+    static size_t defaultThreadCount() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Check whether the calling thread is a worker of any ThreadPool.
+     * @return true when called from inside a pool task
+     */
+    static bool inWorkerThread() { return workerFlag(); }
+
+    /**
+     * @brief Queue a task for execution.
+     * @param task Callable taking no arguments
+     * @return Future holding the task's return value or exception
+     * @throws std::runtime_error if the pool is shutting down
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                throw std::runtime_error("Cannot submit to a stopped thread pool");
+            }
+            tasks_.emplace([packaged] { (*packaged)(); });
+        }
+        taskAvailable_.notify_one();
+        return future;
+    }
+
+    /**
+     * @brief Run body(i) for every i in [begin, end) across the workers.
+     *
+     * The range is split into contiguous chunks (about four per worker) so
+     * that uneven iteration costs still balance. Blocks until every chunk has
+     * finished. If any iteration throws, the first exception is rethrown after
+     * all chunks complete.
+     *
+     * When called from inside a pool task the loop runs inline on the calling
+     * thread, which avoids deadlock from nested parallelism.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param body Callable taking a size_t index
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F&& body) {
+        if (end <= begin) {
+            return;
+        }
+        const size_t count = end - begin;
+        if (inWorkerThread() || workers_.size() == 1 || count == 1) {
+            for (size_t i = begin; i < end; ++i) {
+                body(i);
+            }
+            return;
+        }
+
+        const size_t numChunks = std::min(count, workers_.size() * 4);
+        const size_t chunkSize = (count + numChunks - 1) / numChunks;
+        std::vector<std::future<void>> futures;
+        futures.reserve(numChunks);
+        for (size_t start = begin; start < end; start += chunkSize) {
+            size_t stop = std::min(end, start + chunkSize);
+            futures.push_back(submit([&body, start, stop] {
+                for (size_t i = start; i < stop; ++i) {
+                    body(i);
+                }
+            }));
+        }
+
+        std::exception_ptr firstError;
+        for (auto& future : futures) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+    }
+
+    /**
+     * @brief Block until the queue is empty and no task is running.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return tasks_.empty() && active_ == 0; });
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable idle_;
+    bool stopping_;
+    size_t active_;
+
+    static bool& workerFlag() {
+        thread_local bool isWorker = false;
+        return isWorker;
+    }
+
+    void workerLoop() {
+        workerFlag() = true;
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                taskAvailable_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;  // Stopping and fully drained
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+                ++active_;
+            }
+
+            task();  // packaged_task captures exceptions in the future
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --active_;
+                if (tasks_.empty() && active_ == 0) {
+                    idle_.notify_all();
+                }
+            }
+        }
+    }
+};
+
+}  // namespace core
+}  // namespace orbat
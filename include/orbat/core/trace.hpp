@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace orbat {
+namespace core {
+
+/**
+ * @brief One completed span.
+ */
+struct TraceEvent {
+    const char* name = "";      // Static string, e.g. "MarkowitzOptimizer::optimize"
+    const char* category = "";  // Phase: parse, validate, factorize, solve, serialize, ...
+    int64_t startNs = 0;        // Since the tracer's epoch (process start)
+    int64_t durationNs = 0;
+    uint32_t thread = 0;  // Tracer thread id (1, 2, ... in order of first span)
+};
+
+/**
+ * @brief Low-overhead timeline of scoped spans, dumped as Chrome trace JSON.
+ *
+ * Library entry points and the CLI mark their phases with ORBAT_TRACE_SPAN.
+ * Spans are only recorded while tracing is enabled; when it is disabled a
+ * span costs one relaxed atomic load. Each thread writes to its own ring
+ * buffer of fixed capacity (the oldest spans are overwritten when it is
+ * full), so recording never allocates after a thread's first span and
+ * threads do not contend. Buffers of exited threads are kept until clear().
+ *
+ * Building with ORBAT_DISABLE_TRACING (CMake: -DORBAT_TRACING=OFF) compiles
+ * the spans out entirely.
+ *
+ * The dump loads in chrome://tracing and https://ui.perfetto.dev.
+ *
+ * Example:
+ *   Tracer::enable();
+ *   MarkowitzResult result = optimizer.minimumVariance();
+ *   Tracer::writeChromeTrace("trace.json");
+ */
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16384;
+
+    /**
+     * @brief Check whether spans are compiled in.
+     */
+    static constexpr bool compiledIn() {
+#ifdef ORBAT_DISABLE_TRACING
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Start or stop recording spans.
+     */
+    static void enable(bool on = true) noexcept { enabled_.store(on, std::memory_order_relaxed); }
+
+    static void disable() noexcept { enable(false); }
+
+    /**
+     * @brief Check whether spans are being recorded.
+     */
+    static bool enabled() noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the ring buffer size (spans per thread) of threads that have
+     * not recorded yet.
+     * @throws std::invalid_argument if capacity is zero
+     */
+    static void setCapacity(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Trace buffer capacity must be positive");
+        }
+        capacity_.store(capacity, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Name the calling thread in the dump (default: "thread <id>").
+     */
+    static void setThreadName(const std::string& name) {
+        Buffer& buffer = local();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    /**
+     * @brief Record a span. Called by TraceSpan.
+     */
+    static void record(const char* name, const char* category, int64_t startNs,
+                       int64_t durationNs) {
+        Buffer& buffer = local();
+        std::lock_guard<std::mutex> lock(buffer.mutex);  // Only contended by dumps
+        TraceEvent& event = buffer.events[buffer.next];
+        if (buffer.size == buffer.events.size()) {
+            ++buffer.dropped;
+        } else {
+            ++buffer.size;
+        }
+        event.name = name;
+        event.category = category;
+        event.startNs = startNs;
+        event.durationNs = durationNs;
+        event.thread = buffer.thread;
+        buffer.next = (buffer.next + 1) % buffer.events.size();
+    }
+
+    /**
+     * @brief Get the nanoseconds since the tracer's epoch.
+     */
+    static int64_t now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - epoch_)
+            .count();
+    }
+
+    /**
+     * @brief Get the recorded spans of all threads, ordered by start time.
+     */
+    static std::vector<TraceEvent> events() {
+        std::vector<TraceEvent> all;
+        for (const auto& buffer : buffers()) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            size_t first = (buffer->next + buffer->events.size() - buffer->size) %
+                           buffer->events.size();
+            for (size_t k = 0; k < buffer->size; ++k) {
+                all.push_back(buffer->events[(first + k) % buffer->events.size()]);
+            }
+        }
+        std::stable_sort(all.begin(), all.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            return a.startNs < b.startNs;
+        });
+        return all;
+    }
+
+    /**
+     * @brief Get the number of spans overwritten because a buffer was full.
+     */
+    static uint64_t dropped() {
+        uint64_t total = 0;
+        for (const auto& buffer : buffers()) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            total += buffer->dropped;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Discard all recorded spans and the buffers of exited threads.
+     */
+    static void clear() {
+        std::lock_guard<std::mutex> registryLock(registryMutex_);
+        auto& all = registry_;
+        all.erase(std::remove_if(all.begin(), all.end(),
+                                 [](const std::shared_ptr<Buffer>& b) { return b->exited; }),
+                  all.end());
+        for (const auto& buffer : all) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->next = 0;
+            buffer->size = 0;
+            buffer->dropped = 0;
+        }
+    }
+
+    /**
+     * @brief Write the recorded spans in Chrome trace event format.
+     *
+     * Spans are complete events ("ph":"X") with times in microseconds; each
+     * thread gets a thread_name metadata event. The number of overwritten
+     * spans is in otherData.droppedEvents.
+     *
+     * @param out Destination stream
+     */
+    static void writeChromeTrace(std::ostream& out) {
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        const long pid = processId();
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers()) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << buffer->thread << ",\"args\":{\"name\":\"";
+            writeEscaped(out, buffer->name.empty() ? "thread " + std::to_string(buffer->thread)
+                                                   : buffer->name);
+            out << "\"}}";
+            first = false;
+        }
+        out << std::fixed << std::setprecision(3);
+        for (const TraceEvent& event : events()) {
+            out << (first ? "" : ",") << "\n{\"name\":\"";
+            writeEscaped(out, event.name);
+            out << "\",\"cat\":\"";
+            writeEscaped(out, event.category);
+            out << "\",\"ph\":\"X\",\"ts\":" << static_cast<double>(event.startNs) * 1e-3
+                << ",\"dur\":" << static_cast<double>(event.durationNs) * 1e-3
+                << ",\"pid\":" << pid << ",\"tid\":" << event.thread << "}";
+            first = false;
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped()
+            << "}}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Write the recorded spans to a Chrome trace file.
+     * @param path Output path
+     * @throws std::runtime_error if the file cannot be written
+     */
+    static void writeChromeTrace(const std::string& path) {
+        std::ofstream file(path);
+        writeChromeTrace(file);
+        if (!file) {
+            throw std::runtime_error("Cannot write trace file: " + path);
+        }
+    }
+
+private:
+    struct Buffer {
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        size_t next = 0;  // Slot of the next span
+        size_t size = 0;  // Spans held (at most events.size())
+        uint64_t dropped = 0;
+        uint32_t thread = 0;
+        std::string name;
+        bool exited = false;  // Guarded by registryMutex_
+    };
+
+    // Owned by the thread; marks the buffer for removal by clear() on exit
+    struct Local {
+        std::shared_ptr<Buffer> buffer;
+
+        ~Local() {
+            if (buffer) {
+                std::lock_guard<std::mutex> lock(registryMutex_);
+                buffer->exited = true;
+            }
+        }
+    };
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<size_t> capacity_{DEFAULT_CAPACITY};
+    static inline std::atomic<uint32_t> nextThread_{1};
+    static inline const std::chrono::steady_clock::time_point epoch_ =
+        std::chrono::steady_clock::now();
+    static inline std::mutex registryMutex_;
+    static inline std::vector<std::shared_ptr<Buffer>> registry_;
+
+    static Buffer& local() {
+        thread_local Local state;
+        if (!state.buffer) {
+            auto buffer = std::make_shared<Buffer>();
+            buffer->events.resize(capacity_.load(std::memory_order_relaxed));
+            buffer->thread = nextThread_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            registry_.push_back(buffer);
+            state.buffer = std::move(buffer);
+        }
+        return *state.buffer;
+    }
+
+    static std::vector<std::shared_ptr<Buffer>> buffers() {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        return registry_;
+    }
+
+    static long processId() {
+#if defined(__unix__) || defined(__APPLE__)
+        return static_cast<long>(::getpid());
+#else
+        return 1;
+#endif
+    }
+
+    static void writeEscaped(std::ostream& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) >= 0x20) {
+                out << c;
+            }
+        }
+    }
+};
+
+/**
+ * @brief RAII span: records [construction, destruction) while tracing is enabled.
+ *
+ * Whether a span is recorded is decided when it starts. Names and categories
+ * must outlive the dump (string literals). Use ORBAT_TRACE_SPAN in library
+ * code so the span compiles away with ORBAT_DISABLE_TRACING.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) noexcept
+        : name_(name), category_(category), start_(Tracer::enabled() ? Tracer::now() : -1) {}
+
+    ~TraceSpan() {
+        if (start_ >= 0) {
+            try {
+                Tracer::record(name_, category_, start_, Tracer::now() - start_);
+            } catch (...) {  // A thread's first span allocates its buffer
+            }
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t start_;  // -1 when not recording
+};
+
+#ifndef ORBAT_DISABLE_TRACING
+#define ORBAT_TRACE_CONCAT_(a, b) a##b
+#define ORBAT_TRACE_NAME_(line) ORBAT_TRACE_CONCAT_(orbatTraceSpan_, line)
+#define ORBAT_TRACE_SPAN(name, category) \
+    ::orbat::core::TraceSpan ORBAT_TRACE_NAME_(__LINE__)(name, category)
+#else
+#define ORBAT_TRACE_SPAN(name, category) static_cast<void>(0)
+#endif
+
+}  // namespace core
+}  // namespace orbat
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orbat/core/allocation_tracker.hpp"
 #include "orbat/core/constants.hpp"
 
 #include <algorithm>
@@ -295,7 +296,7 @@ public:
     }
 
 private:
-    std::vector<double> data_;
+    TrackedStorage<AllocationSite::VECTOR> data_;  // std::vector<double> unless tracked
 };
 
 /**
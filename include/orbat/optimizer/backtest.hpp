@@ -0,0 +1,913 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/constants.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/monte_carlo.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Portfolio chosen at each rebalance of a backtest.
+ */
+enum class BacktestStrategy {
+    MINIMUM_VARIANCE,  // MarkowitzOptimizer::minimumVariance()
+    MEAN_VARIANCE,     // MarkowitzOptimizer::optimize(riskAversion)
+    TARGET_RETURN      // MarkowitzOptimizer::targetReturn(targetReturn)
+};
+
+/**
+ * @brief One parameter set of a backtest.
+ *
+ * Returns, target returns and costs are per period of the return history.
+ */
+struct BacktestParameters {
+    std::string name{};             // Label of the parameter set in reports
+    size_t window = 252;            // Estimation window in periods (at least 2)
+    size_t rebalanceInterval = 21;  // Periods between rebalances
+    double shrinkage = 0.0;         // Shrinkage of Σ toward its diagonal, in [0, 1]
+    BacktestStrategy strategy = BacktestStrategy::MINIMUM_VARIANCE;
+    double riskAversion = 1.0;        // λ passed to optimize() (MEAN_VARIANCE)
+    double targetReturn = 0.0;        // Target passed to targetReturn() (TARGET_RETURN)
+    double transactionCost = 0.0;     // Cost per unit of turnover, charged as a return drag
+    double rebalanceThreshold = 0.0;  // Skip trades whose turnover is below this (no-trade band)
+    ConstraintSet constraints{};      // Constraints of every rebalance (not checkpointed)
+};
+
+/**
+ * @brief Options controlling how backtests are run.
+ */
+struct BacktestOptions {
+    size_t threads = 0;              // Worker threads (0 = hardware concurrency, 1 = caller's)
+    std::string checkpointPath{};    // Checkpoint file to resume from and update (empty = none)
+    size_t checkpointInterval = 12;  // Rebalances between checkpoint writes
+};
+
+/**
+ * @brief Outcome of one rebalance.
+ */
+struct BacktestRebalance {
+    size_t period = 0;          // Row of the return history from which the holdings apply
+    core::Vector weights{};     // Holdings after the rebalance
+    double turnover = 0.0;      // Sum of absolute weight changes (0 when not traded)
+    double expectedRisk = 0.0;  // Ex-ante volatility of the optimized portfolio
+    bool traded = false;        // False when the turnover fell inside the no-trade band
+};
+
+/**
+ * @brief Result of backtesting one parameter set.
+ */
+struct BacktestReport {
+    std::string name{};                           // BacktestParameters::name
+    size_t firstPeriod = 0;                       // Row of returns[0] (the window length)
+    std::vector<double> returns{};                // Net return of each period after the window
+    std::vector<BacktestRebalance> rebalances{};  // Successful rebalances in order
+    double totalTurnover = 0.0;                   // Sum of rebalance turnovers
+    double totalCost = 0.0;                       // Sum of transaction costs
+    size_t failedRebalances = 0;                  // Rebalances that kept the previous holdings
+
+    /**
+     * @brief Summarize the period returns (mean, volatility, extremes).
+     */
+    PnLStatistics statistics() const {
+        PnLStatistics summary;
+        for (double value : returns) {
+            summary.add(value);
+        }
+        return summary;
+    }
+
+    /**
+     * @brief Get the compounded return over the whole backtest.
+     */
+    double cumulativeReturn() const {
+        double wealth = 1.0;
+        for (double value : returns) {
+            wealth *= 1.0 + value;
+        }
+        return wealth - 1.0;
+    }
+
+    /**
+     * @brief Get the geometric mean return per year.
+     * @param periodsPerYear Periods of the return history in a year
+     */
+    double annualizedReturn(double periodsPerYear = 252.0) const {
+        if (returns.empty()) {
+            return 0.0;
+        }
+        double years = static_cast<double>(returns.size()) / periodsPerYear;
+        return std::pow(1.0 + cumulativeReturn(), 1.0 / years) - 1.0;
+    }
+
+    /**
+     * @brief Get the volatility of period returns scaled to a year.
+     * @param periodsPerYear Periods of the return history in a year
+     */
+    double annualizedVolatility(double periodsPerYear = 252.0) const {
+        return statistics().stddev() * std::sqrt(periodsPerYear);
+    }
+
+    /**
+     * @brief Get the largest peak-to-trough loss of wealth, as a positive fraction.
+     */
+    double maxDrawdown() const {
+        double wealth = 1.0;
+        double peak = 1.0;
+        double drawdown = 0.0;
+        for (double value : returns) {
+            wealth *= 1.0 + value;
+            peak = std::max(peak, wealth);
+            drawdown = std::max(drawdown, 1.0 - wealth / peak);
+        }
+        return drawdown;
+    }
+
+    /**
+     * @brief Get the mean turnover per successful rebalance.
+     */
+    double averageTurnover() const {
+        return rebalances.empty() ? 0.0
+                                  : totalTurnover / static_cast<double>(rebalances.size());
+    }
+};
+
+/**
+ * @brief Sample mean and covariance of a window sliding over a return history.
+ *
+ * Keeps the sums of the window's returns and of their outer products, so
+ * sliding the window by k periods costs k rank-one updates in and k out,
+ * O(kn²), instead of O(wn²) to re-estimate a window of w periods from
+ * scratch. Returns are taken relative to the first row of the window to
+ * limit cancellation, and the sums are recomputed from scratch after the
+ * window has slid RESYNC_WINDOWS window lengths, so rounding errors cannot
+ * build up over long histories.
+ *
+ * The history is referenced, not copied, and must outlive the estimator.
+ *
+ * Example:
+ *   RollingEstimator estimator(history, 252);
+ *   estimator.advance(252);  // Periods [0, 252)
+ *   estimator.advance(273);  // Periods [21, 273), 21 updates each way
+ *   MarkowitzOptimizer optimizer(estimator.mean(), estimator.covariance());
+ */
+class RollingEstimator {
+public:
+    static constexpr size_t RESYNC_WINDOWS = 8;  // Window lengths slid between resyncs
+
+    /**
+     * @brief Construct an estimator over a history.
+     * @param history Periods × assets matrix of returns
+     * @param window Periods in the window (at least 2)
+     * @throws std::invalid_argument if the window is shorter than 2 or the history is empty
+     */
+    RollingEstimator(const core::Matrix& history, size_t window)
+        : history_(&history), window_(window), shift_(history.cols()), sum_(history.cols()),
+          products_(history.cols(), history.cols()), centered_(history.cols()) {
+        if (history.rows() == 0 || history.cols() == 0) {
+            throw std::invalid_argument("Return history cannot be empty");
+        }
+        if (window < 2) {
+            throw std::invalid_argument("Estimation window must span at least 2 periods");
+        }
+    }
+
+    /**
+     * @brief Get the window length.
+     */
+    size_t window() const { return window_; }
+
+    /**
+     * @brief Get the end of the current window (0 before the first advance()).
+     */
+    size_t end() const { return end_; }
+
+    /**
+     * @brief Move the window to the periods [end - window, end).
+     *
+     * Updates the sums incrementally when the window moves forward by less
+     * than its length, and recomputes them otherwise.
+     *
+     * @param end One past the last period of the window
+     * @throws std::out_of_range if the window does not fit in the history
+     */
+    void advance(size_t end) {
+        if (end < window_ || end > history_->rows()) {
+            throw std::out_of_range("Estimation window outside the return history");
+        }
+        const size_t step = end - end_;
+        if (end_ == 0 || end < end_ || step >= window_ ||
+            slid_ + step > RESYNC_WINDOWS * window_) {
+            reset(end);
+            return;
+        }
+        accumulate(end_, end, 1.0);
+        accumulate(end_ - window_, end - window_, -1.0);
+        slid_ += step;
+        end_ = end;
+    }
+
+    /**
+     * @brief Get the sample mean of the window.
+     * @throws std::logic_error before the first advance()
+     */
+    ExpectedReturns mean() const {
+        requireWindow();
+        const size_t n = sum_.size();
+        const double inverseCount = 1.0 / static_cast<double>(window_);
+        core::Vector mean(n);
+        for (size_t i = 0; i < n; ++i) {
+            mean[i] = shift_[i] + sum_[i] * inverseCount;
+        }
+        return ExpectedReturns(std::move(mean));
+    }
+
+    /**
+     * @brief Get the sample covariance of the window.
+     * @param shrinkage Weight δ of the diagonal target: (1 - δ)S + δ diag(S)
+     * @throws std::logic_error before the first advance()
+     * @throws std::invalid_argument if δ is outside [0, 1] or the estimate is
+     *         not positive-definite (e.g. fewer periods than assets)
+     */
+    CovarianceMatrix covariance(double shrinkage = 0.0) const {
+        requireWindow();
+        if (!(shrinkage >= 0.0 && shrinkage <= 1.0)) {
+            throw std::invalid_argument("Shrinkage must be between 0 and 1");
+        }
+        const size_t n = sum_.size();
+        const double count = static_cast<double>(window_);
+        const double offDiagonal = 1.0 - shrinkage;
+        core::Matrix covariance(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i; j < n; ++j) {
+                double value = (products_(i, j) - sum_[i] * sum_[j] / count) / (count - 1.0);
+                if (j != i) {
+                    value *= offDiagonal;
+                    covariance(j, i) = value;
+                }
+                covariance(i, j) = value;
+            }
+        }
+        return CovarianceMatrix(std::move(covariance));
+    }
+
+private:
+    void requireWindow() const {
+        if (end_ == 0) {
+            throw std::logic_error("Estimation window not set; call advance() first");
+        }
+    }
+
+    void reset(size_t end) {
+        const size_t n = sum_.size();
+        const double* first = history_->data().data() + (end - window_) * n;
+        std::copy(first, first + n, shift_.data().begin());
+        std::fill(sum_.data().begin(), sum_.data().end(), 0.0);
+        std::fill(products_.data().begin(), products_.data().end(), 0.0);
+        accumulate(end - window_, end, 1.0);
+        end_ = end;
+        slid_ = 0;
+    }
+
+    // Add (sign = 1) or remove (sign = -1) periods [begin, end); only the
+    // upper triangle of the products is kept
+    void accumulate(size_t begin, size_t end, double sign) {
+        const size_t n = sum_.size();
+        double* centered = centered_.data().data();
+        double* products = products_.data().data();
+        for (size_t r = begin; r < end; ++r) {
+            const double* row = history_->data().data() + r * n;
+            for (size_t i = 0; i < n; ++i) {
+                centered[i] = row[i] - shift_[i];
+                sum_[i] += sign * centered[i];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                const double scaled = sign * centered[i];
+                double* productRow = products + i * n;
+                for (size_t j = i; j < n; ++j) {
+                    productRow[j] += scaled * centered[j];
+                }
+            }
+        }
+    }
+
+    const core::Matrix* history_;
+    size_t window_;
+    size_t end_ = 0;
+    size_t slid_ = 0;        // Periods slid incrementally since the last reset
+    core::Vector shift_;     // First row of the window at the last reset
+    core::Vector sum_;       // Sum of shifted returns
+    core::Matrix products_;  // Sum of outer products of shifted returns (upper triangle)
+    core::Vector centered_;  // Scratch row
+};
+
+/**
+ * @brief Constants describing the backtest checkpoint format.
+ *
+ * Layout (all integers and doubles little-endian):
+ *
+ *   char[4]  magic "ORBK"
+ *   uint16   format version (currently 1)
+ *   uint32   parameter set count S
+ *   S x { uint64 length, state }
+ *
+ *   state:
+ *     uint64   fingerprint of the parameter set and asset count
+ *     uint64   next period to run (0 = not started)
+ *     uint64   hash of the return history before that period
+ *     uint32   asset count n, n doubles of holdings
+ *     uint64   return count, returns
+ *     double   total turnover, double total cost, uint64 failed rebalances
+ *     uint32   rebalance count, each:
+ *                uint64 period, uint8 traded, double turnover,
+ *                double expected risk, n doubles of weights
+ */
+struct BacktestCheckpointFormat {
+    static constexpr char MAGIC[4] = {'O', 'R', 'B', 'K'};
+    static constexpr uint16_t VERSION = 1;
+};
+
+/**
+ * @brief Rolling-window backtests of Markowitz allocation strategies.
+ *
+ * Each parameter set starts with the window of its first w periods and
+ * rebalances every rebalanceInterval periods from period w on: it
+ * re-estimates μ and Σ over the last w periods with a RollingEstimator,
+ * optimizes, and trades from its drifted holdings to the new weights unless
+ * the turnover is inside the no-trade band (the first allocation is always
+ * made). Holdings then drift with the
+ * asset returns until the next rebalance; weights that do not sum to one
+ * leave the rest in cash at zero return.
+ *
+ * Each step starts from the state the previous one left: the estimator's
+ * sums slide forward instead of being recomputed, turnover and the no-trade
+ * band are measured against the drifted holdings, and when a window cannot
+ * be estimated or optimized (for instance a singular covariance matrix) the
+ * previous holdings are kept and counted in failedRebalances. The solves are
+ * closed-form, so there is no iterative solver to seed with the previous
+ * weights.
+ *
+ * Parameter sets sharing a window, rebalance interval and shrinkage see the
+ * same estimates, so they are grouped: each group factorizes Σ once per
+ * rebalance and every member's optimizer reuses that factorization. Groups
+ * are independent and run in parallel on a thread pool; results do not
+ * depend on the thread count.
+ *
+ * With a checkpoint path, run() resumes every parameter set from the state
+ * saved in the file (if it exists), and saves all states every
+ * checkpointInterval rebalances of a group and at the end. The file is
+ * written to a temporary name and renamed, so it is never left half
+ * written. A checkpoint also resumes against a longer history that extends
+ * the one it was written with, so a finished backtest can be extended as
+ * new returns arrive. Resumed runs match uninterrupted ones up to rounding
+ * (the estimator restarts its sums from scratch).
+ *
+ * Example:
+ *   BacktestEngine engine(dailyReturns);  // Periods × assets
+ *   BacktestParameters monthly;
+ *   monthly.name = "min-variance";
+ *   monthly.window = 504;
+ *   monthly.transactionCost = 0.0005;
+ *   BacktestOptions options;
+ *   options.checkpointPath = "backtest.ckpt";
+ *   BacktestReport report = engine.run(monthly, options);
+ *   std::cout << report.annualizedReturn() << " " << report.averageTurnover() << std::endl;
+ */
+class BacktestEngine {
+public:
+    /**
+     * @brief Construct an engine over a return history.
+     * @param returns Periods × assets matrix of simple returns, oldest first
+     * @throws std::invalid_argument if the history is empty or not finite
+     */
+    explicit BacktestEngine(core::Matrix returns) : returns_(std::move(returns)) {
+        if (returns_.rows() == 0 || returns_.cols() == 0) {
+            throw std::invalid_argument("Return history cannot be empty");
+        }
+        for (double value : returns_.data()) {
+            if (!std::isfinite(value)) {
+                throw std::invalid_argument("Return history must be finite");
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of periods in the history.
+     */
+    size_t periods() const { return returns_.rows(); }
+
+    /**
+     * @brief Get the number of assets.
+     */
+    size_t assets() const { return returns_.cols(); }
+
+    /**
+     * @brief Backtest one parameter set.
+     * @param parameters Parameter set
+     * @param options Run options
+     * @return Report of the parameter set
+     * @throws std::invalid_argument if the parameters or options are invalid
+     * @throws std::runtime_error if the checkpoint cannot be read, does not
+     *         match, or cannot be written
+     */
+    BacktestReport run(const BacktestParameters& parameters,
+                       const BacktestOptions& options = {}) const {
+        return std::move(run(std::vector<BacktestParameters>{parameters}, options).front());
+    }
+
+    /**
+     * @brief Backtest several parameter sets in parallel.
+     * @param parameterSets Parameter sets
+     * @param options Run options
+     * @return One report per parameter set, in order
+     * @throws std::invalid_argument if the parameters or options are invalid
+     * @throws std::runtime_error if the checkpoint cannot be read, does not
+     *         match, or cannot be written
+     */
+    std::vector<BacktestReport> run(const std::vector<BacktestParameters>& parameterSets,
+                                    const BacktestOptions& options = {}) const {
+        ORBAT_ALLOCATION_SCOPE("BacktestEngine::run");
+        ORBAT_TRACE_SPAN("BacktestEngine::run", "backtest");
+        ORBAT_LATENCY_TIMER("BacktestEngine::run");
+        validate(parameterSets, options);
+
+        // Parameter sets with the same estimates share a group
+        std::vector<Group> groups;
+        std::map<std::tuple<size_t, size_t, double>, size_t> groupIndex;
+        for (size_t s = 0; s < parameterSets.size(); ++s) {
+            const BacktestParameters& parameters = parameterSets[s];
+            auto key = std::make_tuple(parameters.window, parameters.rebalanceInterval,
+                                       parameters.shrinkage);
+            auto [it, inserted] = groupIndex.emplace(key, groups.size());
+            if (inserted) {
+                groups.push_back(Group{});
+            }
+            Member member{s, fingerprint(parameters), core::Vector(assets()), BacktestReport{},
+                          0.0};
+            member.report.name = parameters.name;
+            member.report.firstPeriod = parameters.window;
+            groups[it->second].members.push_back(std::move(member));
+        }
+
+        std::unique_ptr<CheckpointWriter> writer;
+        if (!options.checkpointPath.empty()) {
+            std::vector<std::string> blocks = readCheckpoint(options.checkpointPath);
+            if (!blocks.empty() && blocks.size() != parameterSets.size()) {
+                throw std::runtime_error("Checkpoint does not match the parameter sets");
+            }
+            for (Group& group : groups) {
+                restore(group, blocks);
+            }
+            writer = std::make_unique<CheckpointWriter>(options.checkpointPath, std::move(blocks),
+                                                        parameterSets.size());
+        }
+        for (Group& group : groups) {
+            if (group.period == 0) {
+                const size_t window = parameterSets[group.members.front().set].window;
+                group.period = window;
+                group.hash = hashRows(0, window, FNV_OFFSET);
+            }
+        }
+
+        auto task = [&](size_t g) {
+            runGroup(parameterSets, groups[g], writer.get(), options.checkpointInterval);
+        };
+        size_t threads = options.threads == 0 ? core::ThreadPool::defaultThreadCount()
+                                              : options.threads;
+        if (threads == 1 || groups.size() == 1 || core::ThreadPool::inWorkerThread()) {
+            for (size_t g = 0; g < groups.size(); ++g) {
+                task(g);
+            }
+        } else {
+            // On an exception the pool destructor drains the remaining groups
+            core::ThreadPool pool(std::min(threads, groups.size()));
+            std::vector<std::future<void>> pending;
+            pending.reserve(groups.size());
+            for (size_t g = 0; g < groups.size(); ++g) {
+                pending.push_back(pool.submit([&task, g] { task(g); }));
+            }
+            for (auto& future : pending) {
+                future.get();
+            }
+        }
+
+        std::vector<BacktestReport> reports(parameterSets.size());
+        for (Group& group : groups) {
+            for (Member& member : group.members) {
+                reports[member.set] = std::move(member.report);
+            }
+        }
+        return reports;
+    }
+
+private:
+    static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    // State of one parameter set
+    struct Member {
+        size_t set;
+        uint64_t fingerprint;
+        core::Vector holdings;  // Weights at the start of the next period
+        BacktestReport report;
+        double pendingCost;  // Cost of the rebalance, charged to the next period
+    };
+
+    // Parameter sets sharing a window, rebalance interval and shrinkage
+    struct Group {
+        std::vector<Member> members{};
+        size_t period = 0;  // Next period to run (0 = not started)
+        uint64_t hash = 0;  // Hash of the return history before period
+    };
+
+    // Serializes checkpoint writes of groups running on different threads
+    class CheckpointWriter {
+    public:
+        CheckpointWriter(std::string path, std::vector<std::string> blocks, size_t sets)
+            : path_(std::move(path)), blocks_(std::move(blocks)) {
+            blocks_.resize(sets);
+        }
+
+        void save(const Group& group, size_t assets) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const Member& member : group.members) {
+                blocks_[member.set] = encode(member, group, assets);
+            }
+            std::string file(BacktestCheckpointFormat::MAGIC, 4);
+            detail::appendLE(file, BacktestCheckpointFormat::VERSION, 2);
+            detail::appendLE(file, blocks_.size(), 4);
+            for (const std::string& block : blocks_) {
+                detail::appendLE(file, block.size(), 8);
+                file += block;
+            }
+
+            const std::string temporary = path_ + ".tmp";
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                out.write(file.data(), static_cast<std::streamsize>(file.size()));
+                if (!out) {
+                    throw std::runtime_error("Cannot write backtest checkpoint");
+                }
+            }
+            if (std::rename(temporary.c_str(), path_.c_str()) != 0) {
+                throw std::runtime_error("Cannot replace backtest checkpoint");
+            }
+        }
+
+    private:
+        std::string path_;
+        std::vector<std::string> blocks_;  // Encoded state per parameter set (empty = none)
+        std::mutex mutex_;
+    };
+
+    // Bounds-checked little-endian reads from a checkpoint
+    class CheckpointReader {
+    public:
+        explicit CheckpointReader(const std::string& bytes) : bytes_(bytes) {}
+
+        uint64_t integer(size_t count) {
+            require(count);
+            uint64_t value = detail::decodeLE(bytes_.data() + offset_, count);
+            offset_ += count;
+            return value;
+        }
+
+        double real() { return std::bit_cast<double>(integer(8)); }
+
+        // Read a count of items of itemBytes each, checking they fit in what is left
+        size_t count(size_t bytes, size_t itemBytes) {
+            uint64_t value = integer(bytes);
+            if (value > (bytes_.size() - offset_) / itemBytes) {
+                throw std::runtime_error("Invalid backtest checkpoint");
+            }
+            return static_cast<size_t>(value);
+        }
+
+        std::string bytes(size_t count) {
+            require(count);
+            std::string value = bytes_.substr(offset_, count);
+            offset_ += count;
+            return value;
+        }
+
+        bool done() const { return offset_ == bytes_.size(); }
+
+    private:
+        void require(size_t count) const {
+            if (count > bytes_.size() - offset_) {
+                throw std::runtime_error("Invalid backtest checkpoint");
+            }
+        }
+
+        const std::string& bytes_;
+        size_t offset_ = 0;
+    };
+
+    void validate(const std::vector<BacktestParameters>& parameterSets,
+                  const BacktestOptions& options) const {
+        if (parameterSets.empty()) {
+            throw std::invalid_argument("At least one parameter set is required");
+        }
+        if (!options.checkpointPath.empty() && options.checkpointInterval == 0) {
+            throw std::invalid_argument("Checkpoint interval must be positive");
+        }
+        for (const BacktestParameters& parameters : parameterSets) {
+            if (parameters.window < 2 || parameters.window >= periods()) {
+                throw std::invalid_argument(
+                    "Estimation window must span at least 2 periods and be shorter than the "
+                    "return history");
+            }
+            if (parameters.rebalanceInterval == 0) {
+                throw std::invalid_argument("Rebalance interval must be positive");
+            }
+            if (!(parameters.shrinkage >= 0.0 && parameters.shrinkage <= 1.0)) {
+                throw std::invalid_argument("Shrinkage must be between 0 and 1");
+            }
+            if (!(parameters.transactionCost >= 0.0) || !(parameters.rebalanceThreshold >= 0.0)) {
+                throw std::invalid_argument(
+                    "Transaction cost and rebalance threshold must be non-negative");
+            }
+        }
+    }
+
+    void runGroup(const std::vector<BacktestParameters>& parameterSets, Group& group,
+                  CheckpointWriter* writer, size_t checkpointInterval) const {
+        const BacktestParameters& shared = parameterSets[group.members.front().set];
+        RollingEstimator estimator(returns_, shared.window);
+        size_t sinceCheckpoint = 0;
+        for (; group.period < periods(); ++group.period) {
+            const size_t t = group.period;
+            if ((t - shared.window) % shared.rebalanceInterval == 0) {
+                if (writer != nullptr && sinceCheckpoint == checkpointInterval) {
+                    writer->save(group, assets());
+                    sinceCheckpoint = 0;
+                }
+                rebalance(parameterSets, group, estimator, t);
+                ++sinceCheckpoint;
+            }
+            for (Member& member : group.members) {
+                applyPeriod(member, t);
+            }
+            group.hash = hashRows(t, t + 1, group.hash);
+        }
+        if (writer != nullptr) {
+            writer->save(group, assets());
+        }
+    }
+
+    void rebalance(const std::vector<BacktestParameters>& parameterSets, Group& group,
+                   RollingEstimator& estimator, size_t t) const {
+        const BacktestParameters& shared = parameterSets[group.members.front().set];
+        estimator.advance(t);
+        ExpectedReturns mean;
+        CovarianceMatrix covariance;
+        std::shared_ptr<const CovarianceFactorization> factorization;
+        try {
+            mean = estimator.mean();
+            covariance = estimator.covariance(shared.shrinkage);
+            factorization = CovarianceFactorization::create(covariance);
+        } catch (const std::invalid_argument&) {
+            factorization.reset();  // Not positive-definite: every member keeps its holdings
+        } catch (const std::runtime_error&) {
+            factorization.reset();
+        }
+
+        for (Member& member : group.members) {
+            const BacktestParameters& parameters = parameterSets[member.set];
+            MarkowitzResult target{};
+            if (factorization) {
+                MarkowitzOptimizer optimizer(mean, covariance, parameters.constraints,
+                                             factorization);
+                target = solve(optimizer, parameters);
+            }
+            if (!target.success()) {
+                ++member.report.failedRebalances;
+                continue;
+            }
+
+            double turnover = 0.0;
+            for (size_t i = 0; i < assets(); ++i) {
+                turnover += std::abs(target.weights[i] - member.holdings[i]);
+            }
+            // The first allocation is always made; later ones respect the no-trade band
+            const bool invested = !member.report.rebalances.empty();
+            const bool traded = !invested || turnover >= parameters.rebalanceThreshold;
+            if (traded) {
+                member.holdings = std::move(target.weights);
+                member.pendingCost = parameters.transactionCost * turnover;
+                member.report.totalTurnover += turnover;
+                member.report.totalCost += member.pendingCost;
+            }
+            member.report.rebalances.push_back(BacktestRebalance{
+                t, member.holdings, traded ? turnover : 0.0, target.risk, traded});
+        }
+    }
+
+    static MarkowitzResult solve(const MarkowitzOptimizer& optimizer,
+                                 const BacktestParameters& parameters) {
+        switch (parameters.strategy) {
+        case BacktestStrategy::MEAN_VARIANCE:
+            return optimizer.optimize(parameters.riskAversion);
+        case BacktestStrategy::TARGET_RETURN:
+            return optimizer.targetReturn(parameters.targetReturn);
+        case BacktestStrategy::MINIMUM_VARIANCE:
+        default:
+            return optimizer.minimumVariance();
+        }
+    }
+
+    // Earn period t's returns and let the holdings drift with them
+    void applyPeriod(Member& member, size_t t) const {
+        const size_t n = assets();
+        const double* row = returns_.data().data() + t * n;
+        double* holdings = member.holdings.data().data();
+        double gross = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            gross += holdings[i] * row[i];
+        }
+        member.report.returns.push_back(gross - member.pendingCost);
+        member.pendingCost = 0.0;
+
+        const double growth = 1.0 + gross;
+        if (growth <= core::EPSILON) {
+            std::fill(holdings, holdings + n, 0.0);  // Wiped out
+            return;
+        }
+        const double inverseGrowth = 1.0 / growth;
+        for (size_t i = 0; i < n; ++i) {
+            holdings[i] *= (1.0 + row[i]) * inverseGrowth;
+        }
+    }
+
+    uint64_t hashRows(size_t begin, size_t end, uint64_t hash) const {
+        const size_t n = assets();
+        const double* values = returns_.data().data();
+        for (size_t k = begin * n; k < end * n; ++k) {
+            hash = (hash ^ std::bit_cast<uint64_t>(values[k])) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // Identifies a parameter set in checkpoints (constraints are not included)
+    uint64_t fingerprint(const BacktestParameters& parameters) const {
+        uint64_t hash = FNV_OFFSET;
+        auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * FNV_PRIME; };
+        for (char c : parameters.name) {
+            mix(static_cast<unsigned char>(c));
+        }
+        mix(assets());
+        mix(parameters.window);
+        mix(parameters.rebalanceInterval);
+        mix(std::bit_cast<uint64_t>(parameters.shrinkage));
+        mix(static_cast<uint64_t>(parameters.strategy));
+        mix(std::bit_cast<uint64_t>(parameters.riskAversion));
+        mix(std::bit_cast<uint64_t>(parameters.targetReturn));
+        mix(std::bit_cast<uint64_t>(parameters.transactionCost));
+        mix(std::bit_cast<uint64_t>(parameters.rebalanceThreshold));
+        return hash;
+    }
+
+    static std::string encode(const Member& member, const Group& group, size_t assets) {
+        const BacktestReport& report = member.report;
+        std::string block;
+        detail::appendLE(block, member.fingerprint, 8);
+        detail::appendLE(block, group.period, 8);
+        detail::appendLE(block, group.hash, 8);
+        detail::appendLE(block, assets, 4);
+        for (size_t i = 0; i < assets; ++i) {
+            detail::appendDoubleLE(block, member.holdings[i]);
+        }
+        detail::appendLE(block, report.returns.size(), 8);
+        for (double value : report.returns) {
+            detail::appendDoubleLE(block, value);
+        }
+        detail::appendDoubleLE(block, report.totalTurnover);
+        detail::appendDoubleLE(block, report.totalCost);
+        detail::appendLE(block, report.failedRebalances, 8);
+        detail::appendLE(block, report.rebalances.size(), 4);
+        for (const BacktestRebalance& rebalance : report.rebalances) {
+            detail::appendLE(block, rebalance.period, 8);
+            detail::appendLE(block, rebalance.traded ? 1 : 0, 1);
+            detail::appendDoubleLE(block, rebalance.turnover);
+            detail::appendDoubleLE(block, rebalance.expectedRisk);
+            for (size_t i = 0; i < assets; ++i) {
+                detail::appendDoubleLE(block, rebalance.weights[i]);
+            }
+        }
+        return block;
+    }
+
+    // Read the state blocks of a checkpoint (none if the file does not exist)
+    static std::vector<std::string> readCheckpoint(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return {};
+        }
+        std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CheckpointReader reader(file);
+        if (reader.bytes(4) != std::string(BacktestCheckpointFormat::MAGIC, 4) ||
+            reader.integer(2) != BacktestCheckpointFormat::VERSION) {
+            throw std::runtime_error("Invalid backtest checkpoint");
+        }
+        std::vector<std::string> blocks(reader.count(4, 8));
+        for (std::string& block : blocks) {
+            block = reader.bytes(reader.count(8, 1));
+        }
+        if (!reader.done()) {
+            throw std::runtime_error("Invalid backtest checkpoint");
+        }
+        return blocks;
+    }
+
+    // Load a group's saved state, checking it belongs to these parameters and returns
+    void restore(Group& group, const std::vector<std::string>& blocks) const {
+        if (blocks.empty()) {
+            return;
+        }
+        // Groups that had not saved yet when the checkpoint was written start afresh
+        const size_t n = assets();
+        if (blocks[group.members.front().set].empty()) {
+            return;
+        }
+        bool first = true;
+        for (Member& member : group.members) {
+            CheckpointReader reader(blocks[member.set]);
+            if (blocks[member.set].empty() || reader.integer(8) != member.fingerprint) {
+                throw std::runtime_error("Checkpoint does not match the parameter sets");
+            }
+            const size_t period = reader.integer(8);
+            const uint64_t hash = reader.integer(8);
+            if (first) {
+                if (period > periods() || hashRows(0, period, FNV_OFFSET) != hash) {
+                    throw std::runtime_error("Checkpoint does not match the return history");
+                }
+                group.period = period;
+                group.hash = hash;
+                first = false;
+            } else if (period != group.period || hash != group.hash) {
+                throw std::runtime_error("Invalid backtest checkpoint");
+            }
+            if (reader.integer(4) != n) {
+                throw std::runtime_error("Invalid backtest checkpoint");
+            }
+            for (size_t i = 0; i < n; ++i) {
+                member.holdings[i] = reader.real();
+            }
+            BacktestReport& report = member.report;
+            report.returns.resize(reader.count(8, 8));
+            for (double& value : report.returns) {
+                value = reader.real();
+            }
+            report.totalTurnover = reader.real();
+            report.totalCost = reader.real();
+            report.failedRebalances = reader.integer(8);
+            report.rebalances.resize(reader.count(4, 25 + 8 * n));
+            for (BacktestRebalance& rebalance : report.rebalances) {
+                rebalance.period = reader.integer(8);
+                rebalance.traded = reader.integer(1) != 0;
+                rebalance.turnover = reader.real();
+                rebalance.expectedRisk = reader.real();
+                rebalance.weights = core::Vector(n);
+                for (size_t i = 0; i < n; ++i) {
+                    rebalance.weights[i] = reader.real();
+                }
+            }
+            if (!reader.done()) {
+                throw std::runtime_error("Invalid backtest checkpoint");
+            }
+        }
+    }
+
+    core::Matrix returns_;
+};
+
+}  // namespace optimizer
+}  // namespace orbat
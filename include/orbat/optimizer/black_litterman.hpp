@@ -1,7 +1,10 @@
 #pragma once
 
+#include "orbat/core/allocation_tracker.hpp"
 #include "orbat/core/constants.hpp"
 #include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/trace.hpp"
 #include "orbat/core/vector.hpp"
 #include "orbat/optimizer/covariance_matrix.hpp"
 #include "orbat/optimizer/expected_returns.hpp"
@@ -11,6 +14,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace orbat {
@@ -118,6 +122,23 @@ public:
         views_.push_back(view);
     }
 
+    /**
+     * @brief Reuse a precomputed factorization of the covariance matrix.
+     *
+     * Avoids refactorizing Σ when many optimizations share one covariance
+     * matrix. The factorization must have been computed from the same matrix.
+     *
+     * @param factorization Shared factorization (nullptr restores on-demand factorization)
+     * @throws std::invalid_argument if the factorization dimension doesn't match
+     */
+    void setCovarianceFactorization(std::shared_ptr<const CovarianceFactorization> factorization) {
+        if (factorization && factorization->size() != covariance_.size()) {
+            throw std::invalid_argument(
+                "Covariance factorization dimension must match covariance matrix");
+        }
+        factorization_ = std::move(factorization);
+    }
+
     /**
      * @brief Clear all views.
      */
@@ -154,6 +175,9 @@ public:
      * @return Posterior expected returns
      */
     ExpectedReturns computePosteriorReturns() const {
+        ORBAT_ALLOCATION_SCOPE("BlackLittermanOptimizer::computePosteriorReturns");
+        ORBAT_TRACE_SPAN("BlackLittermanOptimizer::computePosteriorReturns", "solve");
+        ORBAT_LATENCY_TIMER("BlackLittermanOptimizer::computePosteriorReturns");
         if (views_.empty()) {
             // No views: return equilibrium returns
             return ExpectedReturns(equilibriumReturns_);
@@ -194,11 +218,9 @@ public:
             }
         }
 
-        // Compute τΣ
-        core::Matrix tauSigma = covariance_.data() * tau_;
-
-        // Compute (τΣ)^(-1)
-        core::Matrix tauSigmaInv = tauSigma.inverse();
+        // Compute (τΣ)^(-1) = Σ^(-1) / τ; τΣ itself is only needed without a factorization
+        core::Matrix tauSigmaInv = factorization_ ? factorization_->inverse() * (1.0 / tau_)
+                                                  : (covariance_.data() * tau_).inverse();
 
         // Compute Ω^(-1)
         core::Matrix OmegaInv = Omega.inverse();
@@ -236,6 +258,8 @@ public:
      * @return Markowitz optimization result
      */
     MarkowitzResult optimize(double lambda = -1.0) const {
+        ORBAT_ALLOCATION_SCOPE("BlackLittermanOptimizer::optimize");
+        ORBAT_TRACE_SPAN("BlackLittermanOptimizer::optimize", "solve");
         // Use market risk aversion if not specified
         if (lambda < 0.0) {
             lambda = riskAversion_;
@@ -245,6 +269,11 @@ public:
         ExpectedReturns posteriorReturns = computePosteriorReturns();
 
         // Create Markowitz optimizer with posterior returns
+        if (factorization_) {
+            MarkowitzOptimizer markowitz(posteriorReturns, covariance_, ConstraintSet(),
+                                         factorization_);
+            return markowitz.optimize(lambda);
+        }
         MarkowitzOptimizer markowitz(posteriorReturns, covariance_);
 
         // Optimize with given risk aversion
@@ -283,6 +312,9 @@ private:
     core::Vector equilibriumReturns_;  // Implied equilibrium returns
     std::vector<View> views_;          // Investor views
 
+    // Optional shared factorization of covariance_ (nullptr = factorize on demand)
+    std::shared_ptr<const CovarianceFactorization> factorization_;
+
     /**
      * @brief Validate optimizer inputs.
      * @throws std::invalid_argument if validation fails
@@ -518,6 +518,22 @@ public:
      */
     const std::vector<std::shared_ptr<Constraint>>& getConstraints() const { return constraints_; }
 
+    /**
+     * @brief Find the first constraint of a given type.
+     *
+     * @tparam T Constraint type
+     * @return Pointer to the constraint, or nullptr if the set has none
+     */
+    template <typename T>
+    const T* find() const {
+        for (const auto& constraint : constraints_) {
+            if (auto* typed = dynamic_cast<const T*>(constraint.get())) {
+                return typed;
+            }
+        }
+        return nullptr;
+    }
+
     /**
      * @brief Detect if the constraint set contains obviously infeasible combinations.
      *
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Precomputed factorization of a covariance matrix.
+ *
+ * Holds the Cholesky factor L (Σ = LL'), the inverse Σ^-1 and the vector
+ * Σ^-1 1 that every fully-invested closed-form solution needs. Computing
+ * these is O(n³); once built, each optimizer solve reuses them and costs
+ * O(n²).
+ *
+ * Instances are immutable after construction and therefore safe to share
+ * between threads and between optimizers that use the same covariance
+ * matrix. Share them through std::shared_ptr<const CovarianceFactorization>.
+ *
+ * Example:
+ *   auto factor = CovarianceFactorization::create(cov);
+ *   MarkowitzOptimizer a(returnsA, cov, constraints, factor);
+ *   MarkowitzOptimizer b(returnsB, cov, constraints, factor);  // No refactorization
+ */
+class CovarianceFactorization {
+public:
+    /**
+     * @brief Factorize a covariance matrix.
+     * @param covariance Covariance matrix (must be positive-definite)
+     * @throws std::invalid_argument if the matrix is empty
+     * @throws std::runtime_error if the matrix is not positive-definite
+     */
+    explicit CovarianceFactorization(const CovarianceMatrix& covariance) {
+        ORBAT_ALLOCATION_SCOPE("CovarianceFactorization");
+        ORBAT_TRACE_SPAN("CovarianceFactorization", "factorize");
+        if (covariance.empty()) {
+            throw std::invalid_argument("Cannot factorize an empty covariance matrix");
+        }
+
+        const size_t n = covariance.size();
+        cholesky_ = covariance.data().cholesky();
+        core::Matrix LT = cholesky_.transpose();
+
+        // Same column-by-column solve as Matrix::inverse(), reusing the factor
+        inverse_ = core::Matrix(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            core::Vector ei(n, 0.0);
+            ei[i] = 1.0;
+            core::Vector y = cholesky_.solveLower(ei);
+            inverse_.setColumn(i, LT.solveUpper(y));
+        }
+
+        inverseOnes_ = inverse_ * core::Vector(n, 1.0);
+    }
+
+    /**
+     * @brief Create a shared factorization.
+     * @param covariance Covariance matrix (must be positive-definite)
+     * @return Shared pointer to the immutable factorization
+     * @throws std::runtime_error if the matrix is not positive-definite
+     */
+    static std::shared_ptr<const CovarianceFactorization> create(
+        const CovarianceMatrix& covariance) {
+        return std::make_shared<const CovarianceFactorization>(covariance);
+    }
+
+    /**
+     * @brief Get the dimension (number of assets).
+     * @return Number of assets
+     */
+    size_t size() const { return cholesky_.rows(); }
+
+    /**
+     * @brief Get the lower triangular Cholesky factor L with Σ = LL'.
+     * @return Cholesky factor
+     */
+    const core::Matrix& cholesky() const { return cholesky_; }
+
+    /**
+     * @brief Get the inverse covariance matrix Σ^-1.
+     * @return Inverse matrix
+     */
+    const core::Matrix& inverse() const { return inverse_; }
+
+    /**
+     * @brief Get Σ^-1 1, the inverse applied to the vector of ones.
+     * @return Precomputed vector
+     */
+    const core::Vector& inverseOnes() const { return inverseOnes_; }
+
+    /**
+     * @brief Compute Σ^-1 b.
+     * @param b Right-hand side vector
+     * @return Solution x of Σx = b
+     * @throws std::invalid_argument if dimensions don't match
+     */
+    core::Vector solve(const core::Vector& b) const {
+        if (b.size() != size()) {
+            throw std::invalid_argument("Vector size must match covariance dimension");
+        }
+        return inverse_ * b;
+    }
+
+private:
+    core::Matrix cholesky_;
+    core::Matrix inverse_;
+    core::Vector inverseOnes_;
+};
+
+}  // namespace optimizer
+}  // namespace orbat
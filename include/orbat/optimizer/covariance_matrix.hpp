@@ -2,6 +2,7 @@
 
 #include "orbat/core/constants.hpp"
 #include "orbat/core/matrix.hpp"
+#include "orbat/core/trace.hpp"
 
 #include <cmath>
 #include <fstream>
@@ -174,6 +175,7 @@ public:
      * @throws std::invalid_argument if data is invalid or not square/symmetric
      */
     static CovarianceMatrix fromCSV(const std::string& filename) {
+        ORBAT_TRACE_SPAN("CovarianceMatrix::fromCSV", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open file: " + filename);
@@ -318,6 +320,7 @@ public:
      * @throws std::invalid_argument if data is invalid or not square/symmetric
      */
     static CovarianceMatrix fromJSON(const std::string& filename) {
+        ORBAT_TRACE_SPAN("CovarianceMatrix::fromJSON", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open file: " + filename);
@@ -404,6 +407,7 @@ public:
      * @throws std::invalid_argument if validation fails
      */
     void validate() const {
+        ORBAT_TRACE_SPAN("CovarianceMatrix::validate", "validate");
         if (matrix_.empty()) {
             throw std::invalid_argument("Covariance matrix cannot be empty");
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/result_sink.hpp"
 
 #include <fstream>
 #include <iomanip>
@@ -255,5 +256,69 @@ inline std::string frontierToJSONString(const std::vector<MarkowitzResult>& fron
     return oss.str();
 }
 
+/**
+ * @brief Stream efficient frontier portfolios into a result sink.
+ *
+ * Each successful portfolio is written as one record whose id is its index
+ * along the frontier. Failed optimizations are skipped, matching the CSV and
+ * JSON exporters. The sink is not finished, so callers may append further
+ * records before calling finish().
+ *
+ * @param frontier Vector of MarkowitzResult representing efficient portfolios
+ * @param sink Destination sink
+ * @return Number of portfolios written
+ */
+inline size_t exportFrontier(const std::vector<MarkowitzResult>& frontier, ResultSink& sink) {
+    size_t written = 0;
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        if (!frontier[i].success()) {
+            continue;  // Skip failed optimizations
+        }
+        sink.write(frontier[i], std::to_string(i));
+        ++written;
+    }
+    return written;
+}
+
+/**
+ * @brief Export efficient frontier portfolios in any supported output format.
+ *
+ * Writes to the named file, or to stdout when filename is "-". JSON output
+ * uses "frontier" as the name of the portfolio array; NDJSON, CSV and binary
+ * output write one record per successful portfolio (see result_sink.hpp).
+ *
+ * Example:
+ *   exportFrontier(frontier, "frontier.ndjson", OutputFormat::NDJSON);
+ *   exportFrontier(frontier, "-", OutputFormat::BINARY, labels);  // pipe to stdout
+ *
+ * @param frontier Vector of MarkowitzResult representing efficient portfolios
+ * @param filename Output file path, or "-" for stdout
+ * @param format Output format
+ * @param assetLabels Optional vector of asset labels
+ * @throws std::runtime_error if file cannot be opened
+ * @throws std::invalid_argument if frontier is empty
+ */
+inline void exportFrontier(const std::vector<MarkowitzResult>& frontier,
+                           const std::string& filename, OutputFormat format,
+                           const std::vector<std::string>& assetLabels = {}) {
+    if (frontier.empty()) {
+        throw std::invalid_argument("Cannot export empty frontier");
+    }
+
+    OutputTarget target(filename);
+    SinkOptions options;
+    options.assetLabels = assetLabels;
+    options.includeIds = true;
+
+    std::unique_ptr<ResultSink> sink;
+    if (format == OutputFormat::JSON) {
+        sink = std::make_unique<JsonResultSink>(target.stream(), options, "frontier");
+    } else {
+        sink = makeResultSink(format, target.stream(), options);
+    }
+    exportFrontier(frontier, *sink);
+    sink->finish();
+}
+
 }  // namespace optimizer
 }  // namespace orbat
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "orbat/core/trace.hpp"
 #include "orbat/core/vector.hpp"
 
 #include <fstream>
@@ -175,6 +176,7 @@ public:
      * @throws std::invalid_argument if data is invalid
      */
     static ExpectedReturns fromCSV(const std::string& filename) {
+        ORBAT_TRACE_SPAN("ExpectedReturns::fromCSV", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open file: " + filename);
@@ -269,6 +271,7 @@ public:
      * @throws std::invalid_argument if data is invalid
      */
     static ExpectedReturns fromJSON(const std::string& filename) {
+        ORBAT_TRACE_SPAN("ExpectedReturns::fromJSON", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open file: " + filename);
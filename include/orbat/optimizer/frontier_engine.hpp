@@ -0,0 +1,343 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/constants.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Options controlling how a frontier is computed.
+ */
+struct FrontierOptions {
+    size_t points = 50;      // Grid points, or initial grid when refining adaptively
+    double tolerance = 0.0;  // Adaptive refinement tolerance in risk units (0 = fixed grid)
+    size_t threads = 0;      // Worker threads (0 = hardware concurrency, 1 = caller's thread)
+    size_t chunkSize = 256;  // Grid points per parallel task (fixed grid only)
+    size_t maxDepth = 16;    // Maximum bisection depth per initial segment
+};
+
+/**
+ * @brief Parallel, streaming efficient frontier computation.
+ *
+ * Every point on the unconstrained frontier is a combination of the same two
+ * vectors, w(r) = a(r)·Σ⁻¹μ + b(r)·Σ⁻¹1, with variance (Cr² - 2Br + A) / (AC - B²).
+ * The engine solves for Σ⁻¹μ and Σ⁻¹1 once (reusing a shared covariance
+ * factorization when given one), so each further point costs O(n) instead of
+ * a fresh O(n²) solve. Points whose closed-form weights violate the
+ * constraint set fall back to MarkowitzOptimizer::targetReturn().
+ *
+ * The return range is split into chunks that run on a thread pool. Results
+ * are handed to the caller in frontier order as soon as each chunk and all
+ * chunks before it are done, and only a bounded number of chunks is in
+ * flight at a time, so arbitrarily large frontiers stream in constant memory.
+ *
+ * With a positive tolerance, each segment of the initial grid is bisected
+ * until the frontier's risk at the midpoint is within tolerance of the chord
+ * between its endpoints, placing extra points where the frontier bends.
+ *
+ * Example:
+ *   FrontierEngine engine(returns, covariance);
+ *   FrontierOptions options;
+ *   options.points = 100000;
+ *   options.threads = 8;
+ *   auto sink = makeResultSink(OutputFormat::CSV, out);
+ *   engine.compute(options, *sink);
+ *   sink->finish();
+ */
+class FrontierEngine {
+public:
+    /**
+     * @brief Callback receiving frontier points in order.
+     *
+     * The index is the point's position along the emitted frontier.
+     */
+    using PointCallback = std::function<void(size_t index, const MarkowitzResult& result)>;
+
+    /**
+     * @brief Construct an engine and precompute the frontier basis.
+     * @param returns Expected returns
+     * @param covariance Covariance matrix
+     * @param constraints Constraint set applied to every point
+     * @param factorization Shared factorization of covariance (nullptr = factorize here)
+     * @throws std::invalid_argument if the inputs are inconsistent
+     * @throws std::runtime_error if the covariance matrix cannot be factorized
+     */
+    FrontierEngine(const ExpectedReturns& returns, const CovarianceMatrix& covariance,
+                   const ConstraintSet& constraints = ConstraintSet(),
+                   std::shared_ptr<const CovarianceFactorization> factorization = nullptr)
+        : optimizer_(returns, covariance, constraints,
+                     factorization ? std::move(factorization)
+                                   : CovarianceFactorization::create(covariance)),
+          mu_(returns.data()), constraints_(constraints) {
+        const CovarianceFactorization& factor = *optimizer_.covarianceFactorization();
+        covInvMu_ = factor.solve(mu_);
+        covInvOnes_ = factor.inverseOnes();
+
+        core::Vector ones(mu_.size(), 1.0);
+        A_ = mu_.dot(covInvMu_);
+        B_ = mu_.dot(covInvOnes_);
+        C_ = ones.dot(covInvOnes_);
+        det_ = A_ * C_ - B_ * B_;
+        minAssetReturn_ = *std::min_element(mu_.data().begin(), mu_.data().end());
+        maxAssetReturn_ = *std::max_element(mu_.data().begin(), mu_.data().end());
+    }
+
+    /**
+     * @brief Compute the minimum-variance portfolio for a target return.
+     *
+     * Equivalent to MarkowitzOptimizer::targetReturn() on the same inputs.
+     *
+     * @param target Target portfolio return
+     * @return Optimization result
+     */
+    MarkowitzResult point(double target) const {
+        ORBAT_ALLOCATION_SCOPE("FrontierEngine::point");
+        ORBAT_TRACE_SPAN("FrontierEngine::point", "solve");
+        if (std::abs(det_) < core::EPSILON || target < minAssetReturn_ ||
+            target > maxAssetReturn_) {
+            return optimizer_.targetReturn(target);  // Edge cases and failure reporting
+        }
+
+        double a = (C_ * target - B_) / det_;
+        double b = (A_ - B_ * target) / det_;
+        const size_t n = mu_.size();
+        core::Vector weights(n);
+        for (size_t i = 0; i < n; ++i) {
+            weights[i] = covInvMu_[i] * a + covInvOnes_[i] * b;
+        }
+        if (!constraints_.empty() && !constraints_.isFeasible(weights)) {
+            return optimizer_.targetReturn(target);
+        }
+
+        double expectedReturn = mu_.dot(weights);
+        double variance = (C_ * target * target - 2.0 * B_ * target + A_) / det_;
+        double risk = std::sqrt(std::max(0.0, variance));
+        double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
+        // Σw = Σ Σ⁻¹(aμ + b1) = aμ + b1, so risk attribution needs no product with Σ
+        core::Vector covarianceWeights(n);
+        for (size_t i = 0; i < n; ++i) {
+            covarianceWeights[i] = mu_[i] * a + b;
+        }
+        return MarkowitzResult{std::move(weights), expectedReturn, risk, sharpeRatio, true,
+                               "Target return portfolio computed", std::move(covarianceWeights)};
+    }
+
+    /**
+     * @brief Get the return range spanned by the frontier.
+     * @return (minimum-variance portfolio return, maximum asset return)
+     * @throws std::runtime_error if the minimum variance portfolio cannot be computed
+     */
+    std::pair<double, double> returnRange() const {
+        MarkowitzResult minVar = optimizer_.minimumVariance();
+        if (!minVar.success()) {
+            throw std::runtime_error("Minimum variance portfolio failed: " + minVar.message);
+        }
+        return {minVar.expectedReturn, maxAssetReturn_};
+    }
+
+    /**
+     * @brief Compute the frontier and stream its points to a callback.
+     *
+     * The callback runs on the calling thread, in frontier order. Points that
+     * fail to optimize are skipped, matching efficientFrontier().
+     *
+     * @param options Frontier options
+     * @param emit Callback receiving each point
+     * @return Number of points emitted
+     * @throws std::invalid_argument if the options are invalid
+     * @throws std::runtime_error if the minimum variance portfolio cannot be computed
+     */
+    size_t compute(const FrontierOptions& options, const PointCallback& emit) const {
+        ORBAT_ALLOCATION_SCOPE("FrontierEngine::compute");
+        ORBAT_TRACE_SPAN("FrontierEngine::compute", "solve");
+        validate(options);
+        auto [low, high] = returnRange();
+        const bool adaptive = options.tolerance > 0.0;
+        const size_t grid = options.points;
+        // Fixed grids run in chunks of grid points; adaptive runs refine one segment per task
+        const size_t chunkSize = adaptive ? 1 : options.chunkSize;
+        const size_t numTasks = adaptive ? grid - 1 : (grid + chunkSize - 1) / chunkSize;
+
+        auto gridReturn = [low, high, grid](size_t i) {
+            double t = static_cast<double>(i) / static_cast<double>(grid - 1);
+            return low + t * (high - low);
+        };
+        auto task = [&, adaptive](size_t c) {
+            std::vector<MarkowitzResult> out;
+            if (adaptive) {
+                refineSegment(gridReturn(c), gridReturn(c + 1), c + 2 == grid, options, out);
+            } else {
+                size_t end = std::min(grid, (c + 1) * chunkSize);
+                out.reserve(end - c * chunkSize);
+                for (size_t i = c * chunkSize; i < end; ++i) {
+                    appendIfConverged(point(gridReturn(i)), out);
+                }
+            }
+            return out;
+        };
+
+        size_t emitted = 0;
+        auto emitChunk = [&](const std::vector<MarkowitzResult>& chunk) {
+            for (const auto& result : chunk) {
+                emit(emitted++, result);
+            }
+        };
+
+        size_t threads = options.threads == 0 ? core::ThreadPool::defaultThreadCount()
+                                              : options.threads;
+        if (threads == 1 || numTasks == 1 || core::ThreadPool::inWorkerThread()) {
+            for (size_t c = 0; c < numTasks; ++c) {
+                emitChunk(task(c));
+            }
+            return emitted;
+        }
+
+        // Keep a bounded window of chunks in flight and emit them in order
+        core::ThreadPool pool(threads);
+        const size_t maxInFlight = 4 * pool.size();
+        std::deque<std::future<std::vector<MarkowitzResult>>> inFlight;
+        size_t next = 0;
+        while (next < numTasks || !inFlight.empty()) {
+            while (next < numTasks && inFlight.size() < maxInFlight) {
+                size_t c = next++;
+                inFlight.push_back(pool.submit([&task, c] { return task(c); }));
+            }
+            // On an exception the pool destructor drains the remaining chunks
+            std::vector<MarkowitzResult> chunk = inFlight.front().get();
+            inFlight.pop_front();
+            emitChunk(chunk);
+        }
+        return emitted;
+    }
+
+    /**
+     * @brief Compute the frontier and stream its points into a result sink.
+     *
+     * Each record's id is its index along the frontier, as written by
+     * exportFrontier(). The sink is not finished.
+     *
+     * @param options Frontier options
+     * @param sink Destination sink
+     * @return Number of points written
+     */
+    size_t compute(const FrontierOptions& options, ResultSink& sink) const {
+        return compute(options, [&sink](size_t index, const MarkowitzResult& result) {
+            sink.write(result, std::to_string(index));
+        });
+    }
+
+    /**
+     * @brief Compute the frontier into memory.
+     * @param options Frontier options
+     * @return Frontier points in order of increasing return
+     */
+    std::vector<MarkowitzResult> compute(const FrontierOptions& options) const {
+        std::vector<MarkowitzResult> frontier;
+        compute(options, [&frontier](size_t, const MarkowitzResult& result) {
+            frontier.push_back(result);
+        });
+        return frontier;
+    }
+
+    /**
+     * @brief Get the number of assets.
+     * @return Number of assets
+     */
+    size_t size() const { return mu_.size(); }
+
+private:
+    MarkowitzOptimizer optimizer_;
+    core::Vector mu_;
+    ConstraintSet constraints_;
+    core::Vector covInvMu_;    // Σ⁻¹μ
+    core::Vector covInvOnes_;  // Σ⁻¹1
+    double A_ = 0.0;           // μ'Σ⁻¹μ
+    double B_ = 0.0;           // μ'Σ⁻¹1
+    double C_ = 0.0;           // 1'Σ⁻¹1
+    double det_ = 0.0;         // AC - B²
+    double minAssetReturn_ = 0.0;
+    double maxAssetReturn_ = 0.0;
+
+    static void validate(const FrontierOptions& options) {
+        if (options.points < 2) {
+            throw std::invalid_argument("Number of points must be at least 2");
+        }
+        if (!std::isfinite(options.tolerance) || options.tolerance < 0.0) {
+            throw std::invalid_argument("Tolerance must be a non-negative number");
+        }
+        if (options.chunkSize == 0) {
+            throw std::invalid_argument("Chunk size must be at least 1");
+        }
+    }
+
+    static void appendIfConverged(MarkowitzResult result, std::vector<MarkowitzResult>& out) {
+        if (result.success()) {
+            out.push_back(std::move(result));
+        }
+    }
+
+    /**
+     * @brief Refine one segment of the initial grid.
+     *
+     * Emits the segment's left endpoint, the bisection points in order, and
+     * the right endpoint only for the last segment.
+     */
+    void refineSegment(double low, double high, bool last, const FrontierOptions& options,
+                       std::vector<MarkowitzResult>& out) const {
+        MarkowitzResult left = point(low);
+        MarkowitzResult right = point(high);
+        if (left.success()) {
+            out.push_back(left);
+        }
+        if (left.success() && right.success()) {
+            bisect(low, left.risk, high, right.risk, 0, options, out);
+        }
+        if (last) {
+            appendIfConverged(std::move(right), out);
+        }
+    }
+
+    void bisect(double r0, double risk0, double r1, double risk1, size_t depth,
+                const FrontierOptions& options, std::vector<MarkowitzResult>& out) const {
+        if (depth >= options.maxDepth) {
+            return;
+        }
+        double mid = 0.5 * (r0 + r1);
+        MarkowitzResult middle = point(mid);
+        if (!middle.success()) {
+            return;
+        }
+        // Risk is convex in return, so the chord lies above the frontier
+        if (0.5 * (risk0 + risk1) - middle.risk <= options.tolerance) {
+            return;
+        }
+        double riskMid = middle.risk;
+        bisect(r0, risk0, mid, riskMid, depth + 1, options, out);
+        out.push_back(std::move(middle));
+        bisect(mid, riskMid, r1, risk1, depth + 1, options, out);
+    }
+};
+
+}  // namespace optimizer
+}  // namespace orbat
@@ -1,19 +1,29 @@
 #pragma once
 
+#include "orbat/core/allocation_tracker.hpp"
 #include "orbat/core/constants.hpp"
 #include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/trace.hpp"
 #include "orbat/core/vector.hpp"
 #include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
 #include "orbat/optimizer/covariance_matrix.hpp"
 #include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
+#include "orbat/optimizer/risk_attribution.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
 #include <iomanip>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace orbat {
@@ -33,6 +43,7 @@ struct MarkowitzResult {
     double sharpeRatio;     // Sharpe ratio (expectedReturn - riskFreeRate) / risk
     bool converged;         // Whether optimization converged
     std::string message;    // Status or error message
+    core::Vector covarianceWeights{};  // Σw behind risk (empty if not computed; not serialized)
 
     /**
      * @brief Check if the optimization was successful.
@@ -40,6 +51,22 @@ struct MarkowitzResult {
      */
     bool success() const { return converged; }
 
+    /**
+     * @brief Decompose the portfolio's risk into per-asset contributions.
+     *
+     * Reuses covarianceWeights, so this is O(n) with no covariance product.
+     *
+     * @return Marginal, component and percentage contributions to risk
+     * @throws std::logic_error if the result does not carry Σw (failed,
+     *         deserialized or hand-built results; use RiskAttribution::compute)
+     */
+    RiskContributions riskContributions() const {
+        if (covarianceWeights.size() != weights.size() || weights.empty()) {
+            throw std::logic_error("Result does not carry the covariance-weighted portfolio");
+        }
+        return RiskAttribution::fromCovarianceWeights(weights, covarianceWeights);
+    }
+
     /**
      * @brief Calculate Sharpe ratio with a custom risk-free rate.
      *
@@ -196,6 +223,8 @@ struct MarkowitzResult {
                 return "true";
             } else if (json.substr(pos, 5) == "false") {
                 return "false";
+            } else if (json.substr(pos, 4) == "null") {
+                return "null";
             } else {
                 // Numeric value
                 while (end < json.length() &&
@@ -210,9 +239,13 @@ struct MarkowitzResult {
         // Parse fields
         result.converged = (findValue("converged") == "true");
         result.message = findValue("message");
-        result.expectedReturn = std::stod(findValue("expectedReturn"));
-        result.risk = std::stod(findValue("risk"));
-        result.sharpeRatio = std::stod(findValue("sharpeRatio"));
+        // Non-finite numbers are written as null
+        auto toNumber = [](const std::string& value) {
+            return value == "null" ? std::numeric_limits<double>::quiet_NaN() : std::stod(value);
+        };
+        result.expectedReturn = toNumber(findValue("expectedReturn"));
+        result.risk = toNumber(findValue("risk"));
+        result.sharpeRatio = toNumber(findValue("sharpeRatio"));
 
         // Parse weights array
         std::string weightsStr = findValue("weights");
@@ -226,7 +259,7 @@ struct MarkowitzResult {
             token.erase(0, token.find_first_not_of(" \t\n\r"));
             token.erase(token.find_last_not_of(" \t\n\r") + 1);
             if (!token.empty()) {
-                weightsVec.push_back(std::stod(token));
+                weightsVec.push_back(toNumber(token));
             }
         }
 
@@ -275,7 +308,8 @@ public:
      * @throws std::invalid_argument if dimensions don't match or data is invalid
      */
     MarkowitzOptimizer(const ExpectedReturns& expectedReturns, const CovarianceMatrix& covariance)
-        : expectedReturns_(expectedReturns), covariance_(covariance), maxIterations_(1000),
+        : expectedReturns_(expectedReturns), covariance_(covariance),
+          factorization_(std::make_shared<FactorizationState>()), maxIterations_(1000),
           tolerance_(1e-8) {
         validate();
     }
@@ -291,10 +325,42 @@ public:
     MarkowitzOptimizer(const ExpectedReturns& expectedReturns, const CovarianceMatrix& covariance,
                        const ConstraintSet& constraints)
         : expectedReturns_(expectedReturns), covariance_(covariance), constraints_(constraints),
-          maxIterations_(1000), tolerance_(1e-8) {
+          factorization_(std::make_shared<FactorizationState>()), maxIterations_(1000),
+          tolerance_(1e-8) {
         validate();
     }
 
+    /**
+     * @brief Construct a Markowitz optimizer with a precomputed covariance factorization.
+     *
+     * Use this when many optimizers share one covariance matrix (batch jobs,
+     * frontier sweeps, a long-running server) so the O(n³) factorization is
+     * done once instead of once per optimizer.
+     *
+     * @param expectedReturns Expected returns for each asset
+     * @param covariance Covariance matrix of asset returns
+     * @param constraints Portfolio constraints to enforce
+     * @param factorization Factorization of covariance (shared, immutable)
+     * @throws std::invalid_argument if dimensions don't match, data is invalid or
+     *         factorization is null or of the wrong size
+     */
+    MarkowitzOptimizer(const ExpectedReturns& expectedReturns, const CovarianceMatrix& covariance,
+                       const ConstraintSet& constraints,
+                       std::shared_ptr<const CovarianceFactorization> factorization)
+        : expectedReturns_(expectedReturns), covariance_(covariance), constraints_(constraints),
+          factorization_(std::make_shared<FactorizationState>()), maxIterations_(1000),
+          tolerance_(1e-8) {
+        validate();
+        if (!factorization) {
+            throw std::invalid_argument("Covariance factorization cannot be null");
+        }
+        if (factorization->size() != covariance_.size()) {
+            throw std::invalid_argument(
+                "Covariance factorization dimension must match covariance matrix");
+        }
+        factorization_->factorization = std::move(factorization);
+    }
+
     /**
      * @brief Set maximum iterations for the optimizer.
      * @param maxIter Maximum iterations (must be > 0)
@@ -325,6 +391,19 @@ public:
      */
     void addConstraint(std::shared_ptr<Constraint> constraint) { constraints_.add(constraint); }
 
+    /**
+     * @brief Get the covariance factorization used by this optimizer.
+     *
+     * Factorizes the covariance matrix on the first call unless a
+     * factorization was supplied.
+     *
+     * @return Shared factorization, or nullptr if the covariance could not be factorized
+     */
+    std::shared_ptr<const CovarianceFactorization> covarianceFactorization() const {
+        ensureFactorized();
+        return factorization_->factorization;
+    }
+
     /**
      * @brief Compute the minimum variance portfolio.
      *
@@ -336,24 +415,21 @@ public:
      * @return Optimization result with optimal weights
      */
     MarkowitzResult minimumVariance() const {
-        const size_t n = expectedReturns_.size();
+        ORBAT_ALLOCATION_SCOPE("MarkowitzOptimizer::minimumVariance");
+        ORBAT_TRACE_SPAN("MarkowitzOptimizer::minimumVariance", "solve");
+        ORBAT_LATENCY_TIMER("MarkowitzOptimizer::minimumVariance");
 
         // For minimum variance with fully invested constraint:
         // Solution is w = (Σ^-1 * 1) / (1' * Σ^-1 * 1)
         // where 1 is a vector of ones
 
         try {
-            // Get inverse of covariance matrix
-            core::Matrix covInv = covariance_.data().inverse();
-
-            // Create ones vector
-            core::Vector ones(n, 1.0);
-
-            // Compute Σ^-1 * 1
-            core::Vector covInvOnes = covInv * ones;
+            // Σ^-1 * 1 is precomputed by the factorization
+            const CovarianceFactorization& factor = factorization();
+            const core::Vector& covInvOnes = factor.inverseOnes();
 
             // Compute 1' * Σ^-1 * 1 (scalar)
-            double denominator = ones.dot(covInvOnes);
+            double denominator = covInvOnes.sum();
 
             if (std::abs(denominator) < core::EPSILON) {
                 return MarkowitzResult{{}, 0.0, 0.0, 0.0, false, "Singular covariance matrix"};
@@ -373,13 +449,18 @@ public:
 
             // Compute portfolio statistics
             double expectedReturn = expectedReturns_.data().dot(weights);
-            double variance = computeVariance(weights);
+            core::Vector covarianceWeights;
+            double variance = computeVariance(weights, covarianceWeights);
             double risk = std::sqrt(std::max(0.0, variance));
             double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
 
-            return MarkowitzResult{weights, expectedReturn,
-                                   risk,    sharpeRatio,
-                                   true,    "Minimum variance portfolio computed"};
+            return MarkowitzResult{std::move(weights),
+                                   expectedReturn,
+                                   risk,
+                                   sharpeRatio,
+                                   true,
+                                   "Minimum variance portfolio computed",
+                                   std::move(covarianceWeights)};
 
         } catch (const std::exception& e) {
             return MarkowitzResult{{},  0.0,   0.0,
@@ -403,6 +484,9 @@ public:
      * @throws std::invalid_argument if lambda is negative
      */
     MarkowitzResult optimize(double lambda) const {
+        ORBAT_ALLOCATION_SCOPE("MarkowitzOptimizer::optimize");
+        ORBAT_TRACE_SPAN("MarkowitzOptimizer::optimize", "solve");
+        ORBAT_LATENCY_TIMER("MarkowitzOptimizer::optimize");
         if (lambda < 0.0) {
             throw std::invalid_argument("Risk aversion parameter must be non-negative");
         }
@@ -412,8 +496,6 @@ public:
             return minimumVariance();
         }
 
-        const size_t n = expectedReturns_.size();
-
         try {
             // For mean-variance with risk aversion:
             // Solution is w = (Σ^-1 * (λμ + γ1)) / (1' * Σ^-1 * (λμ + γ1))
@@ -421,16 +503,15 @@ public:
             //
             // Simplifying: w = Σ^-1 * (λμ + γ1) where γ = (1 - λ*1'*Σ^-1*μ) / (1'*Σ^-1*1)
 
-            core::Matrix covInv = covariance_.data().inverse();
-            core::Vector ones(n, 1.0);
-            core::Vector mu = expectedReturns_.data();
+            const CovarianceFactorization& factor = factorization();
+            const core::Vector& mu = expectedReturns_.data();
 
             // Compute helper quantities
-            core::Vector covInvMu = covInv * mu;
-            core::Vector covInvOnes = covInv * ones;
+            core::Vector covInvMu = factor.solve(mu);
+            const core::Vector& covInvOnes = factor.inverseOnes();
 
-            double onesCovInvMu = ones.dot(covInvMu);
-            double onesCovInvOnes = ones.dot(covInvOnes);
+            double onesCovInvMu = covInvMu.sum();
+            double onesCovInvOnes = covInvOnes.sum();
 
             if (std::abs(onesCovInvOnes) < core::EPSILON) {
                 return MarkowitzResult{{}, 0.0, 0.0, 0.0, false, "Singular covariance matrix"};
@@ -451,12 +532,18 @@ public:
 
             // Compute portfolio statistics
             double expectedReturn = mu.dot(weights);
-            double variance = computeVariance(weights);
+            core::Vector covarianceWeights;
+            double variance = computeVariance(weights, covarianceWeights);
             double risk = std::sqrt(std::max(0.0, variance));
             double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
 
-            return MarkowitzResult{weights,     expectedReturn, risk,
-                                   sharpeRatio, true,           "Mean-variance portfolio computed"};
+            return MarkowitzResult{std::move(weights),
+                                   expectedReturn,
+                                   risk,
+                                   sharpeRatio,
+                                   true,
+                                   "Mean-variance portfolio computed",
+                                   std::move(covarianceWeights)};
 
         } catch (const std::exception& e) {
             return MarkowitzResult{{},  0.0,   0.0,
@@ -478,7 +565,9 @@ public:
      * @return Optimization result with optimal weights
      */
     MarkowitzResult targetReturn(double targetReturn) const {
-        const size_t n = expectedReturns_.size();
+        ORBAT_ALLOCATION_SCOPE("MarkowitzOptimizer::targetReturn");
+        ORBAT_TRACE_SPAN("MarkowitzOptimizer::targetReturn", "solve");
+        ORBAT_LATENCY_TIMER("MarkowitzOptimizer::targetReturn");
 
         try {
             // Compute feasible return range
@@ -498,17 +587,16 @@ public:
             //   μ'w = targetReturn
             //   1'w = 1
 
-            core::Matrix covInv = covariance_.data().inverse();
-            core::Vector ones(n, 1.0);
-            core::Vector mu = expectedReturns_.data();
+            const CovarianceFactorization& factor = factorization();
+            const core::Vector& mu = expectedReturns_.data();
 
             // Compute helper quantities
-            core::Vector covInvMu = covInv * mu;
-            core::Vector covInvOnes = covInv * ones;
+            core::Vector covInvMu = factor.solve(mu);
+            const core::Vector& covInvOnes = factor.inverseOnes();
 
             double A = mu.dot(covInvMu);
             double B = mu.dot(covInvOnes);
-            double C = ones.dot(covInvOnes);
+            double C = covInvOnes.sum();
 
             double det = A * C - B * B;
             if (std::abs(det) < core::EPSILON) {
@@ -532,12 +620,18 @@ public:
 
             // Compute portfolio statistics
             double expectedReturn = mu.dot(weights);
-            double variance = computeVariance(weights);
+            core::Vector covarianceWeights;
+            double variance = computeVariance(weights, covarianceWeights);
             double risk = std::sqrt(std::max(0.0, variance));
             double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
 
-            return MarkowitzResult{weights,     expectedReturn, risk,
-                                   sharpeRatio, true,           "Target return portfolio computed"};
+            return MarkowitzResult{std::move(weights),
+                                   expectedReturn,
+                                   risk,
+                                   sharpeRatio,
+                                   true,
+                                   "Target return portfolio computed",
+                                   std::move(covarianceWeights)};
 
         } catch (const std::exception& e) {
             return MarkowitzResult{{},  0.0,   0.0,
@@ -554,6 +648,8 @@ public:
      * @return Vector of optimization results representing the efficient frontier
      */
     std::vector<MarkowitzResult> efficientFrontier(size_t numPoints = 50) const {
+        ORBAT_ALLOCATION_SCOPE("MarkowitzOptimizer::efficientFrontier");
+        ORBAT_TRACE_SPAN("MarkowitzOptimizer::efficientFrontier", "solve");
         if (numPoints < 2) {
             throw std::invalid_argument("Number of points must be at least 2");
         }
@@ -587,64 +683,70 @@ public:
         return frontier;
     }
 
-private:
-    ExpectedReturns expectedReturns_;
-    CovarianceMatrix covariance_;
-    ConstraintSet constraints_;
-    size_t maxIterations_;
-    double tolerance_;
-
     /**
-     * @brief Validate that the optimizer inputs are consistent.
-     * @throws std::invalid_argument if validation fails
+     * @brief Check inputs the way the constructors do, without building an optimizer.
+     *
+     * For callers that solve the problem themselves but accept the same
+     * inputs (for example, ResampledFrontierEngine).
+     *
+     * @param expectedReturns Expected returns for each asset
+     * @param covariance Covariance matrix of asset returns
+     * @param constraints Portfolio constraints
+     * @throws std::invalid_argument if the inputs are empty, the dimensions
+     *         don't match or the constraints are infeasible
      */
-    void validate() const {
-        if (expectedReturns_.empty()) {
+    static void validateInputs(const ExpectedReturns& expectedReturns,
+                               const CovarianceMatrix& covariance,
+                               const ConstraintSet& constraints) {
+        if (expectedReturns.empty()) {
             throw std::invalid_argument("Expected returns cannot be empty");
         }
-        if (covariance_.empty()) {
+        if (covariance.empty()) {
             throw std::invalid_argument("Covariance matrix cannot be empty");
         }
-        if (expectedReturns_.size() != covariance_.size()) {
+        if (expectedReturns.size() != covariance.size()) {
             throw std::invalid_argument(
                 "Expected returns and covariance matrix dimensions must match");
         }
 
         // Check if constraint set has obvious infeasibility
-        if (!constraints_.empty()) {
-            if (constraints_.hasInfeasibleCombination(expectedReturns_.size())) {
+        if (!constraints.empty()) {
+            if (constraints.hasInfeasibleCombination(expectedReturns.size())) {
                 throw std::invalid_argument("Constraint set contains infeasible combinations");
             }
+            if (const auto* packed = constraints.find<PackedConstraints>()) {
+                if (packed->size() != expectedReturns.size()) {
+                    throw std::invalid_argument(
+                        "Packed constraints and expected returns dimensions must match");
+                }
+                packed->validate();
+            }
         }
     }
 
     /**
-     * @brief Compute portfolio variance given weights.
-     * @param weights Portfolio weights
-     * @return Portfolio variance w'Σw
-     */
-    double computeVariance(const core::Vector& weights) const {
-        core::Vector Sw = covariance_.data() * weights;
-        return weights.dot(Sw);
-    }
-
-    /**
-     * @brief Solve constrained quadratic programming problem.
+     * @brief Project weights onto a constraint set.
      *
-     * Uses a simple iterative method to handle constraints.
-     * This is a simplified solver for demonstration purposes.
+     * When every constraint can be expressed as packed limits (see
+     * PackedConstraints::fromConstraintSet()), this is the exact Euclidean
+     * projection onto the fully invested portfolios within them. Otherwise
+     * negative weights are clipped and the rest rescaled to be fully
+     * invested, repeated until the weights are feasible or maxIterations is
+     * reached.
      *
-     * @param initialWeights Initial guess for weights
-     * @param lambda Risk aversion parameter
-     * @return Optimization result
+     * @param constraints Constraint set
+     * @param weights Weights to project (modified in place)
+     * @param maxIterations Maximum number of clip-and-rescale steps
      */
-    MarkowitzResult solveConstrainedQP(const core::Vector& initialWeights,
-                                       double lambda [[maybe_unused]]) const {
-        const size_t n = expectedReturns_.size();
-        core::Vector weights = initialWeights;
+    static void projectOntoConstraints(const ConstraintSet& constraints, core::Vector& weights,
+                                       size_t maxIterations = 1000) {
+        const size_t n = weights.size();
+        if (auto packed = PackedConstraints::fromConstraintSet(constraints, n)) {
+            packed->project(weights);
+            return;
+        }
 
-        // Simple projection method: project onto constraints iteratively
-        for (size_t iter = 0; iter < maxIterations_; ++iter) {
+        for (size_t iter = 0; iter < maxIterations; ++iter) {
             // Project onto long-only constraint if present
             for (size_t i = 0; i < n; ++i) {
                 if (weights[i] < 0.0) {
@@ -662,33 +764,496 @@ private:
             }
 
             // Check constraint feasibility
-            if (constraints_.isFeasible(weights)) {
+            if (constraints.isFeasible(weights)) {
                 break;
             }
         }
+    }
 
-        // Compute portfolio statistics
-        double expectedReturn = expectedReturns_.data().dot(weights);
-        double variance = computeVariance(weights);
-        double risk = std::sqrt(std::max(0.0, variance));
-        double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
+private:
+    ExpectedReturns expectedReturns_;
+    CovarianceMatrix covariance_;
+    ConstraintSet constraints_;
+    // Factorization computed on first use. Copies of an optimizer share it,
+    // as they share the covariance matrix it was computed from.
+    struct FactorizationState {
+        std::once_flag once;
+        std::shared_ptr<const CovarianceFactorization> factorization;
+        std::exception_ptr error;  // Why the covariance matrix could not be factorized
+    };
+
+    std::shared_ptr<FactorizationState> factorization_;
+    size_t maxIterations_;
+    double tolerance_;
+
+    /**
+     * @brief Factorize the covariance matrix once, on first use.
+     *
+     * A failed factorization is kept and rethrown by factorization(), so the
+     * solve methods report it as an unsuccessful result on every call
+     * without factorizing again.
+     */
+    void ensureFactorized() const {
+        FactorizationState& state = *factorization_;
+        std::call_once(state.once, [&state, this] {
+            if (state.factorization) {
+                return;  // Supplied by the caller
+            }
+            try {
+                state.factorization = CovarianceFactorization::create(covariance_);
+            } catch (...) {
+                state.error = std::current_exception();
+            }
+        });
+    }
+
+    /**
+     * @brief Get the covariance factorization.
+     * @return Factorization
+     * @throws The error raised when the covariance matrix was factorized
+     */
+    const CovarianceFactorization& factorization() const {
+        ensureFactorized();
+        if (factorization_->error) {
+            std::rethrow_exception(factorization_->error);
+        }
+        return *factorization_->factorization;
+    }
+
+    /**
+     * @brief Validate that the optimizer inputs are consistent.
+     * @throws std::invalid_argument if validation fails
+     */
+    void validate() const { validateInputs(expectedReturns_, covariance_, constraints_); }
 
-        return MarkowitzResult{weights,     expectedReturn, risk,
-                               sharpeRatio, true,           "Constrained portfolio computed"};
+    /**
+     * @brief Compute portfolio variance given weights.
+     * @param weights Portfolio weights
+     * @param covarianceWeights Receives Σw, kept for risk attribution
+     * @return Portfolio variance w'Σw
+     */
+    double computeVariance(const core::Vector& weights, core::Vector& covarianceWeights) const {
+        covarianceWeights = covariance_.data() * weights;
+        return weights.dot(covarianceWeights);
+    }
+
+    /**
+     * @brief Solve the constrained problem: minimize (1/2)w'Σw - λμ'w.
+     *
+     * Constraint sets that can be expressed as packed limits are solved
+     * exactly: limits without sectors by the active-set method of
+     * solveOverBounds(), and limits with sectors (or when that method fails)
+     * by accelerated projected gradient over the limits. Other constraint
+     * sets fall back to projecting the unconstrained solution onto the
+     * constraints.
+     *
+     * @param initialWeights Unconstrained solution, used as the starting point
+     * @param lambda Risk aversion parameter
+     * @return Optimization result
+     */
+    MarkowitzResult solveConstrainedQP(const core::Vector& initialWeights, double lambda) const {
+        core::Vector weights = initialWeights;
+        auto packed = PackedConstraints::fromConstraintSet(constraints_, weights.size());
+        if (!packed) {
+            projectOntoConstraints(constraints_, weights, maxIterations_);
+            return constrainedResult(std::move(weights), "Constrained portfolio computed");
+        }
+        packed->validate();
+        if (packed->sectorCount() == 0 && solveOverBounds(*packed, lambda, nullptr, weights)) {
+            return constrainedResult(std::move(weights), "Constrained portfolio computed");
+        }
+        if (!minimizeOverLimits(*packed, lambda, weights)) {
+            return MarkowitzResult{{}, 0.0, 0.0, 0.0, false, "Constrained solver did not converge"};
+        }
+        return constrainedResult(std::move(weights), "Constrained portfolio computed");
     }
 
     /**
-     * @brief Solve constrained QP with target return constraint.
+     * @brief Solve the constrained problem with a target return.
+     *
+     * Limits without sectors take μ'w = target as a second equality in
+     * solveOverBounds(), after checking the target lies within the returns
+     * the limits allow. Otherwise the minimum-variance portfolio with
+     * μ'w = target minimizes (1/2)w'Σw - ρμ'w within the limits for some
+     * multiplier ρ, and its return is non-decreasing in ρ. ρ is bracketed by
+     * doubling and found by bisection, each solve starting from the previous
+     * one. Other constraint sets fall back to solveConstrainedQP() without
+     * the target.
      *
-     * @param initialWeights Initial guess for weights
+     * @param initialWeights Unconstrained solution, used as the starting point
      * @param targetReturn Target portfolio return
      * @return Optimization result
      */
     MarkowitzResult solveConstrainedQPWithTarget(const core::Vector& initialWeights,
-                                                 double targetReturn [[maybe_unused]]) const {
-        // For simplicity, use the same projection method
-        // A more sophisticated implementation would handle the return constraint explicitly
-        return solveConstrainedQP(initialWeights, 0.0);
+                                                 double targetReturn) const {
+        auto packed = PackedConstraints::fromConstraintSet(constraints_, initialWeights.size());
+        if (!packed) {
+            return solveConstrainedQP(initialWeights, 0.0);
+        }
+        packed->validate();
+        const core::Vector& mu = expectedReturns_.data();
+        core::Vector weights = initialWeights;
+        if (packed->sectorCount() == 0) {
+            auto [lowest, highest] = returnRange(*packed);
+            if (targetReturn < lowest - tolerance_ || targetReturn > highest + tolerance_) {
+                return MarkowitzResult{{},  0.0,   0.0,
+                                       0.0, false, "Target return is not achievable under the "
+                                                   "constraints"};
+            }
+            if (solveOverBounds(*packed, 0.0, &targetReturn, weights)) {
+                return constrainedResult(std::move(weights), "Target return portfolio computed");
+            }
+        }
+        if (!minimizeOverLimits(*packed, 0.0, weights)) {
+            return MarkowitzResult{{}, 0.0, 0.0, 0.0, false, "Constrained solver did not converge"};
+        }
+        const double baseReturn = mu.dot(weights);
+        if (std::abs(baseReturn - targetReturn) <= tolerance_) {
+            return constrainedResult(std::move(weights), "Target return portfolio computed");
+        }
+
+        // ρ in units of return per variance; the first step weighs both terms alike
+        const double direction = targetReturn > baseReturn ? 1.0 : -1.0;
+        auto [minMu, maxMu] = std::minmax_element(mu.data().begin(), mu.data().end());
+        double step = stepBound() / std::max(*maxMu - *minMu, core::EPSILON);
+        double inner = 0.0;  // Multiplier on the base side of the target
+        double outer = 0.0;  // Multiplier past the target, once found
+        core::Vector innerWeights = weights;
+        bool bracketed = false;
+        for (int doubling = 0; doubling < 64 && !bracketed; ++doubling, step *= 2.0) {
+            outer = direction * step;
+            if (!minimizeOverLimits(*packed, outer, weights)) {
+                return MarkowitzResult{
+                    {}, 0.0, 0.0, 0.0, false, "Constrained solver did not converge"};
+            }
+            double r = mu.dot(weights);
+            if (std::abs(r - targetReturn) <= tolerance_) {
+                return constrainedResult(std::move(weights), "Target return portfolio computed");
+            }
+            if ((r - targetReturn) * direction > 0.0) {
+                bracketed = true;
+            } else {
+                inner = outer;
+                innerWeights = weights;
+            }
+        }
+        if (!bracketed) {
+            return MarkowitzResult{
+                {}, 0.0, 0.0, 0.0, false, "Target return is not achievable under the constraints"};
+        }
+
+        weights = innerWeights;
+        for (size_t iter = 0; iter < 200; ++iter) {
+            double rho = 0.5 * (inner + outer);
+            if (!minimizeOverLimits(*packed, rho, weights)) {
+                return MarkowitzResult{
+                    {}, 0.0, 0.0, 0.0, false, "Constrained solver did not converge"};
+            }
+            double r = mu.dot(weights);
+            if (std::abs(r - targetReturn) <= tolerance_ ||
+                std::abs(outer - inner) <= 1e-15 * std::abs(outer)) {
+                return constrainedResult(std::move(weights), "Target return portfolio computed");
+            }
+            if ((r - targetReturn) * direction > 0.0) {
+                outer = rho;
+            } else {
+                inner = rho;
+            }
+        }
+        return MarkowitzResult{{}, 0.0, 0.0, 0.0, false, "Constrained solver did not converge"};
+    }
+
+    /**
+     * @brief Minimize (1/2)w'Σw - λμ'w over per-asset bounds and the budget.
+     *
+     * Block principal pivoting: each asset is either free or held at one of
+     * its bounds. For a given split, the free weights and the multipliers of
+     * the equalities solve the KKT system of the free block (a Cholesky
+     * factorization of Σ over the free assets and a Schur complement of at
+     * most 2x2), and the multipliers of the held bounds follow from the
+     * gradient. Every asset whose weight leaves its bounds, or whose bound
+     * multiplier has the wrong sign, then changes side. After three rounds
+     * that do not reduce the number of such assets only the last one
+     * changes side, which rules out cycling.
+     *
+     * @param limits Validated limits without sectors
+     * @param lambda Weight of the return term
+     * @param target Required return μ'w, or nullptr for none
+     * @param weights Starting point in, solution out (unchanged on failure)
+     * @return true if the optimal split was found
+     */
+    bool solveOverBounds(const PackedConstraints& limits, double lambda, const double* target,
+                         core::Vector& weights) const {
+        const size_t n = weights.size();
+        const core::Matrix& sigma = covariance_.data();
+        const core::Vector& mu = expectedReturns_.data();
+        const std::vector<double>& lower = limits.lowerBounds();
+        const std::vector<double>& upper = limits.upperBounds();
+
+        std::vector<int> side(n);  // -1 at the lower bound, +1 at the upper bound, 0 free
+        for (size_t i = 0; i < n; ++i) {
+            side[i] = weights[i] <= lower[i] ? -1 : (weights[i] >= upper[i] ? 1 : 0);
+        }
+        core::Vector w(n);
+        std::vector<size_t> freeAssets;
+        std::vector<size_t> infeasible;
+        size_t fewest = n + 1;   // Fewest infeasible assets after any round
+        int fullExchanges = 3;   // Rounds left before exchanging one asset at a time
+        for (size_t iter = 0; iter < maxIterations_; ++iter) {
+            freeAssets.clear();
+            double budget = 1.0;
+            double goal = target ? *target : 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (side[i] == 0) {
+                    freeAssets.push_back(i);
+                } else {
+                    w[i] = side[i] < 0 ? lower[i] : upper[i];
+                    budget -= w[i];
+                    goal -= mu[i] * w[i];
+                }
+            }
+            const size_t f = freeAssets.size();
+            if (f == 0) {
+                return false;
+            }
+
+            // Σ_FF w_F = λμ_F - Σ_FB w_B + y1 1 + y2 μ_F, with 1'w = 1 and μ'w = target
+            core::Matrix block(f, f);
+            core::Vector rhs(f);
+            core::Vector ones(f, 1.0);
+            core::Vector returns(f);
+            for (size_t a = 0; a < f; ++a) {
+                const size_t i = freeAssets[a];
+                double value = lambda * mu[i];
+                for (size_t j = 0; j < n; ++j) {
+                    if (side[j] != 0) {
+                        value -= sigma(i, j) * w[j];
+                    }
+                }
+                rhs[a] = value;
+                returns[a] = mu[i];
+                for (size_t b = 0; b < f; ++b) {
+                    block(a, b) = sigma(i, freeAssets[b]);
+                }
+            }
+            core::Matrix factor;
+            try {
+                factor = block.cholesky();
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            const core::Matrix factorT = factor.transpose();
+            auto solve = [&](const core::Vector& b) {
+                return factorT.solveUpper(factor.solveLower(b));
+            };
+            const core::Vector base = solve(rhs);
+            const core::Vector byBudget = solve(ones);
+            const double s11 = ones.dot(byBudget);
+            const double e1 = budget - ones.dot(base);
+            double y1 = e1 / s11;
+            double y2 = 0.0;
+            core::Vector byReturn(f);
+            if (target) {
+                byReturn = solve(returns);
+                const double s12 = ones.dot(byReturn);
+                const double s22 = returns.dot(byReturn);
+                const double e2 = goal - returns.dot(base);
+                const double det = s11 * s22 - s12 * s12;
+                if (!(det > 1e-12 * s11 * s22)) {
+                    return false;  // Free returns are (nearly) all equal
+                }
+                y1 = (e1 * s22 - e2 * s12) / det;
+                y2 = (s11 * e2 - s12 * e1) / det;
+            }
+            for (size_t a = 0; a < f; ++a) {
+                w[freeAssets[a]] = base[a] + y1 * byBudget[a] + y2 * byReturn[a];
+            }
+
+            // Bound multipliers z = Σw - λμ - y1 1 - y2 μ, checked against the gradient's scale
+            core::Vector multipliers = sigma * w;
+            double scale = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                const double terms[] = {multipliers[i], lambda * mu[i], y1, y2 * mu[i]};
+                multipliers[i] = terms[0] - terms[1] - terms[2] - terms[3];
+                for (double term : terms) {
+                    scale = std::max(scale, std::abs(term));
+                }
+            }
+            const double multiplierTolerance = tolerance_ * scale;
+            infeasible.clear();
+            for (size_t i = 0; i < n; ++i) {
+                const bool wrongSide =
+                    side[i] == 0 ? (w[i] < lower[i] - tolerance_ || w[i] > upper[i] + tolerance_)
+                                 : side[i] * multipliers[i] > multiplierTolerance;
+                if (wrongSide) {
+                    infeasible.push_back(i);
+                }
+            }
+            if (infeasible.empty()) {
+                weights = std::move(w);
+                return true;
+            }
+            if (infeasible.size() < fewest) {
+                fewest = infeasible.size();
+                fullExchanges = 3;
+            } else if (fullExchanges > 0) {
+                --fullExchanges;
+            } else {
+                infeasible.erase(infeasible.begin(), infeasible.end() - 1);
+            }
+            for (size_t i : infeasible) {
+                side[i] = side[i] != 0 ? 0 : (w[i] < lower[i] ? -1 : 1);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Lowest and highest return μ'w of fully invested weights within bounds.
+     *
+     * Starting from every asset at its lower bound, the remaining budget
+     * fills the assets in order of return, lowest first or highest first.
+     */
+    std::pair<double, double> returnRange(const PackedConstraints& limits) const {
+        const core::Vector& mu = expectedReturns_.data();
+        const std::vector<double>& lower = limits.lowerBounds();
+        const std::vector<double>& upper = limits.upperBounds();
+        std::vector<size_t> order(mu.size());
+        double base = 0.0;
+        double room = 1.0;
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+            base += mu[i] * lower[i];
+            room -= lower[i];
+        }
+        std::sort(order.begin(), order.end(), [&mu](size_t a, size_t b) { return mu[a] < mu[b]; });
+        auto fill = [&](auto first, auto last) {
+            double value = base;
+            for (double left = room; first != last && left > 0.0; ++first) {
+                double amount = std::min(left, upper[*first] - lower[*first]);
+                value += amount * mu[*first];
+                left -= amount;
+            }
+            return value;
+        };
+        return {fill(order.begin(), order.end()), fill(order.rbegin(), order.rend())};
+    }
+
+    /**
+     * @brief Minimize (1/2)w'Σw - λμ'w over packed limits.
+     *
+     * Accelerated projected gradient with step 1/L, where L bounds the
+     * largest eigenvalue of Σ. Momentum restarts whenever the step points
+     * uphill. With G the gradient mapping and m = 1 / trace(Σ^-1) a lower
+     * bound on the smallest eigenvalue, the objective after a step is within
+     * 2|G|²/m of the optimum; the iteration stops when that bound is below
+     * the tolerance relative to the size of the objective's terms. The
+     * iteration limit grows with sqrt(L/m), the rate at which this method
+     * converges.
+     *
+     * @param limits Validated limits
+     * @param lambda Weight of the return term
+     * @param weights Starting point in, solution out
+     * @return true if the iteration converged within the iteration limit
+     */
+    bool minimizeOverLimits(const PackedConstraints& limits, double lambda,
+                            core::Vector& weights) const {
+        const size_t n = weights.size();
+        const double* sigma = covariance_.data().data().data();
+        const double* mu = expectedReturns_.data().data().data();
+        const double lipschitz = stepBound();
+        const double inverseStep = 1.0 / lipschitz;
+        const core::Matrix& inverse = factorization().inverse();
+        double inverseTrace = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            inverseTrace += inverse(i, i);
+        }
+        const double rounds = std::sqrt(lipschitz * inverseTrace) *
+                              std::max(1.0, std::log(1.0 / tolerance_));
+        const size_t iterationLimit =
+            maxIterations_ + static_cast<size_t>(std::min(rounds, 1e8));
+
+        core::Vector x = weights;
+        limits.project(x);
+        core::Vector y = x;
+        core::Vector next(n);
+        double t = 1.0;
+        for (size_t iter = 0; iter < iterationLimit; ++iter) {
+            // next = P(y - (Σy - λμ) / L)
+            double quadratic = 0.0;  // y'Σy
+            double linear = 0.0;     // λμ'y
+            for (size_t i = 0; i < n; ++i) {
+                const double* row = sigma + i * n;
+                double product = 0.0;
+                for (size_t j = 0; j < n; ++j) {
+                    product += row[j] * y[j];
+                }
+                quadratic += y[i] * product;
+                linear += lambda * mu[i] * y[i];
+                next[i] = y[i] - (product - lambda * mu[i]) * inverseStep;
+            }
+            limits.project(next);
+
+            double stepNorm = 0.0;  // |y - next|², so |G|² = L²|y - next|²
+            double uphill = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                stepNorm += (next[i] - y[i]) * (next[i] - y[i]);
+                uphill += (y[i] - next[i]) * (next[i] - x[i]);
+            }
+            const double gapBound = 2.0 * lipschitz * lipschitz * stepNorm * inverseTrace;
+            if (gapBound <= tolerance_ * tolerance_ * (0.5 * quadratic + std::abs(linear))) {
+                weights = std::move(next);
+                return true;
+            }
+            if (uphill > 0.0) {
+                t = 1.0;
+                y = next;
+            } else {
+                double tNext = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+                double momentum = (t - 1.0) / tNext;
+                for (size_t i = 0; i < n; ++i) {
+                    y[i] = next[i] + momentum * (next[i] - x[i]);
+                }
+                t = tNext;
+            }
+            std::swap(x, next);
+        }
+        weights = std::move(x);
+        return false;
+    }
+
+    /**
+     * @brief Upper bound on the largest eigenvalue of Σ.
+     *
+     * The smaller of the trace and the largest absolute row sum.
+     */
+    double stepBound() const {
+        const core::Matrix& sigma = covariance_.data();
+        const size_t n = sigma.rows();
+        double trace = 0.0;
+        double rowSum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            trace += sigma(i, i);
+            double sum = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                sum += std::abs(sigma(i, j));
+            }
+            rowSum = std::max(rowSum, sum);
+        }
+        return std::max(std::min(trace, rowSum), core::EPSILON);
+    }
+
+    /**
+     * @brief Evaluate constrained weights as a successful result.
+     */
+    MarkowitzResult constrainedResult(core::Vector weights, const char* message) const {
+        double expectedReturn = expectedReturns_.data().dot(weights);
+        core::Vector covarianceWeights;
+        double variance = computeVariance(weights, covarianceWeights);
+        double risk = std::sqrt(std::max(0.0, variance));
+        double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
+        return MarkowitzResult{std::move(weights), expectedReturn, risk, sharpeRatio, true,
+                               message, std::move(covarianceWeights)};
     }
 };
 
@@ -0,0 +1,447 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/random.hpp"
+#include "orbat/core/sobol.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Distribution of simulated asset returns.
+ */
+enum class ScenarioDistribution {
+    NORMAL,    // Multivariate normal N(μ, Σ)
+    STUDENT_T  // Multivariate Student-t with covariance Σ (heavier, jointly fat tails)
+};
+
+/**
+ * @brief How the normals behind the scenarios are sampled.
+ */
+enum class ScenarioSampling {
+    PSEUDO_RANDOM,  // Independent draws from core::CounterRng
+    SOBOL           // Scrambled Sobol points (quasi-Monte Carlo)
+};
+
+/**
+ * @brief Options controlling a Monte Carlo simulation.
+ */
+struct SimulationOptions {
+    size_t scenarios = 100000;  // Number of scenarios
+    size_t blockSize = 1024;    // Scenarios per block (unit of parallel work and of RNG streams)
+    ScenarioDistribution distribution = ScenarioDistribution::NORMAL;
+    ScenarioSampling sampling = ScenarioSampling::PSEUDO_RANDOM;
+    double degreesOfFreedom = 5.0;  // Student-t degrees of freedom (> 2)
+    uint64_t seed = 42;             // Random seed (same seed and block size = same scenarios)
+    size_t threads = 0;  // Worker threads (0 = hardware concurrency, 1 = caller's thread)
+};
+
+/**
+ * @brief Streaming summary statistics of a P&L distribution.
+ *
+ * Accumulates count, mean, sum of squared deviations, minimum and maximum
+ * in one pass (Welford), and merges partial summaries exactly (Chan et al.),
+ * so blocks summarized on different threads combine into the same result
+ * as one sequential pass up to rounding.
+ */
+class PnLStatistics {
+public:
+    /**
+     * @brief Add one observation.
+     * @param value P&L of one scenario
+     */
+    void add(double value) {
+        ++count_;
+        double delta = value - mean_;
+        mean_ += delta / static_cast<double>(count_);
+        m2_ += delta * (value - mean_);
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    /**
+     * @brief Merge another summary into this one.
+     * @param other Summary of further observations
+     */
+    void merge(const PnLStatistics& other) {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = other;
+            return;
+        }
+        double n1 = static_cast<double>(count_);
+        double n2 = static_cast<double>(other.count_);
+        double delta = other.mean_ - mean_;
+        count_ += other.count_;
+        double n = static_cast<double>(count_);
+        mean_ += delta * n2 / n;
+        m2_ += other.m2_ + delta * delta * n1 * n2 / n;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    /**
+     * @brief Get the number of observations.
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Get the mean P&L (0 when empty).
+     */
+    double mean() const { return mean_; }
+
+    /**
+     * @brief Get the sample variance (0 with fewer than two observations).
+     */
+    double variance() const {
+        return count_ > 1 ? m2_ / static_cast<double>(count_ - 1) : 0.0;
+    }
+
+    /**
+     * @brief Get the sample standard deviation.
+     */
+    double stddev() const { return std::sqrt(variance()); }
+
+    /**
+     * @brief Get the smallest P&L (+inf when empty).
+     */
+    double min() const { return min_; }
+
+    /**
+     * @brief Get the largest P&L (-inf when empty).
+     */
+    double max() const { return max_; }
+
+private:
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;  // Sum of squared deviations from the mean
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief Parallel Monte Carlo simulation of asset and portfolio returns.
+ *
+ * Scenarios are drawn as x = μ + s·L z, where L is the Cholesky factor of Σ
+ * (Σ = LL'), z is a vector of independent standard normals and s = 1 for
+ * the normal distribution. For Student-t, s = sqrt((ν - 2) / g) with
+ * g ~ χ²(ν) shared by all assets of a scenario, which gives jointly fat
+ * tails with covariance exactly Σ.
+ *
+ * Scenarios are generated in blocks: a block's normals form a matrix Z
+ * (one row per scenario) and its returns are the single product Z L'. Each
+ * block draws from its own random stream, stream b of the seed for block
+ * b, so blocks are independent of each other and of the thread that runs
+ * them: the same seed and block size give the same scenarios with any
+ * number of threads. The streams come from core::CounterRng, so the
+ * scenarios do not depend on the standard library either.
+ *
+ * With ScenarioSampling::SOBOL the normals are instead the scenarios'
+ * points of one scrambled Sobol sequence (one dimension per asset) mapped
+ * through the inverse normal CDF. Block b seeks to its first scenario, so
+ * the points do not depend on the block size or thread count. Estimates
+ * then converge at close to 1/N instead of 1/√N; scenario counts that are
+ * powers of two balance the points best. Student-t scales still come from
+ * the pseudo-random streams.
+ *
+ * evaluate() never forms the asset returns. Portfolio P&L is w'x =
+ * w'μ + s·z'(L'w), so with V = L'W' precomputed for all portfolios at once,
+ * a block of P&L is Z V: O(n·p) per scenario instead of O(n²) for p
+ * portfolios. It uses the same normals as simulate(), so the P&L equals the
+ * simulated returns times the weights up to rounding.
+ *
+ * Blocks run on a thread pool with a bounded number in flight and reach
+ * callbacks on the calling thread in scenario order, so any number of
+ * scenarios streams in constant memory. Statistics are merged in block
+ * order and do not depend on the thread count either.
+ *
+ * Example:
+ *   MonteCarloEngine engine(returns, covariance);
+ *   SimulationOptions options;
+ *   options.scenarios = 1000000;
+ *   options.distribution = ScenarioDistribution::STUDENT_T;
+ *   PnLStatistics pnl = engine.evaluate(weights, options);
+ *   std::cout << pnl.mean() << " ± " << pnl.stddev() << std::endl;
+ */
+class MonteCarloEngine {
+public:
+    /**
+     * @brief Callback receiving blocks in scenario order.
+     *
+     * The matrix has one row per scenario, starting at scenario first; its
+     * columns are assets (simulate) or portfolios (evaluate). It is only
+     * valid during the call.
+     */
+    using BlockCallback = std::function<void(size_t first, const core::Matrix& block)>;
+
+    /**
+     * @brief Construct an engine.
+     * @param returns Expected returns μ
+     * @param covariance Covariance matrix Σ
+     * @param factorization Shared factorization of covariance (nullptr = factorize here)
+     * @throws std::invalid_argument if the dimensions do not match
+     * @throws std::runtime_error if the covariance matrix cannot be factorized
+     */
+    MonteCarloEngine(const ExpectedReturns& returns, const CovarianceMatrix& covariance,
+                     std::shared_ptr<const CovarianceFactorization> factorization = nullptr)
+        : mu_(returns.data()) {
+        if (returns.size() != covariance.size()) {
+            throw std::invalid_argument(
+                "Expected returns and covariance matrix dimensions must match");
+        }
+        if (factorization && factorization->size() != covariance.size()) {
+            throw std::invalid_argument("Factorization does not match the covariance matrix");
+        }
+        choleskyT_ = factorization ? factorization->cholesky().transpose()
+                                   : covariance.data().cholesky().transpose();
+    }
+
+    /**
+     * @brief Simulate asset returns and stream them in blocks.
+     * @param options Simulation options
+     * @param emit Callback receiving each block of scenarios × assets
+     * @return Number of blocks emitted
+     * @throws std::invalid_argument if the options are invalid
+     */
+    size_t simulate(const SimulationOptions& options, const BlockCallback& emit) const {
+        ORBAT_ALLOCATION_SCOPE("MonteCarloEngine::simulate");
+        ORBAT_TRACE_SPAN("MonteCarloEngine::simulate", "simulate");
+        ORBAT_LATENCY_TIMER("MonteCarloEngine::simulate");
+        validate(options);
+        const auto sobol = sobolSequence(options);
+        auto task = [&](size_t b) {
+            Draws draws = draw(options, b, sobol.get());
+            core::Matrix block;
+            draws.normals.multiplyInto(choleskyT_, block);
+            const size_t n = size();
+            double* row = block.data().data();
+            for (size_t s = 0; s < block.rows(); ++s, row += n) {
+                for (size_t j = 0; j < n; ++j) {
+                    row[j] = mu_[j] + draws.scale[s] * row[j];
+                }
+            }
+            return block;
+        };
+        return runBlocks<core::Matrix>(options, task, [&](size_t b, core::Matrix& block) {
+            emit(b * options.blockSize, block);
+        });
+    }
+
+    /**
+     * @brief Simulate asset returns into memory.
+     * @param options Simulation options
+     * @return Scenarios × assets matrix of returns
+     * @throws std::invalid_argument if the options are invalid
+     */
+    core::Matrix simulate(const SimulationOptions& options) const {
+        validate(options);
+        core::Matrix scenarios(options.scenarios, size());
+        simulate(options, [&scenarios](size_t first, const core::Matrix& block) {
+            std::copy(block.data().begin(), block.data().end(),
+                      scenarios.data().begin() + first * scenarios.cols());
+        });
+        return scenarios;
+    }
+
+    /**
+     * @brief Simulate the P&L of several portfolios.
+     *
+     * All portfolios see the same scenarios.
+     *
+     * @param portfolios Portfolios × assets matrix of weights (one portfolio per row)
+     * @param options Simulation options
+     * @param emit Optional callback receiving each block of scenarios × portfolios P&L
+     * @return P&L statistics per portfolio
+     * @throws std::invalid_argument if the options or dimensions are invalid
+     */
+    std::vector<PnLStatistics> evaluate(const core::Matrix& portfolios,
+                                        const SimulationOptions& options,
+                                        const BlockCallback& emit = nullptr) const {
+        ORBAT_ALLOCATION_SCOPE("MonteCarloEngine::evaluate");
+        ORBAT_TRACE_SPAN("MonteCarloEngine::evaluate", "simulate");
+        ORBAT_LATENCY_TIMER("MonteCarloEngine::evaluate");
+        validate(options);
+        if (portfolios.rows() == 0 || portfolios.cols() != size()) {
+            throw std::invalid_argument("Portfolio weights must have one column per asset");
+        }
+        const size_t p = portfolios.rows();
+        const core::Matrix loadings = choleskyT_ * portfolios.transpose();  // V = L'W'
+        const core::Vector offsets = portfolios * mu_;                      // W μ
+
+        struct Block {
+            core::Matrix pnl;
+            std::vector<PnLStatistics> stats;
+        };
+        const auto sobol = sobolSequence(options);
+        auto task = [&](size_t b) {
+            Draws draws = draw(options, b, sobol.get());
+            Block block{core::Matrix(), std::vector<PnLStatistics>(p)};
+            draws.normals.multiplyInto(loadings, block.pnl);
+            double* row = block.pnl.data().data();
+            for (size_t s = 0; s < block.pnl.rows(); ++s, row += p) {
+                for (size_t j = 0; j < p; ++j) {
+                    row[j] = offsets[j] + draws.scale[s] * row[j];
+                    block.stats[j].add(row[j]);
+                }
+            }
+            return block;
+        };
+
+        std::vector<PnLStatistics> stats(p);
+        runBlocks<Block>(options, task, [&](size_t b, Block& block) {
+            for (size_t j = 0; j < p; ++j) {
+                stats[j].merge(block.stats[j]);
+            }
+            if (emit) {
+                emit(b * options.blockSize, block.pnl);
+            }
+        });
+        return stats;
+    }
+
+    /**
+     * @brief Simulate the P&L of one portfolio.
+     * @param weights Portfolio weights
+     * @param options Simulation options
+     * @return P&L statistics
+     * @throws std::invalid_argument if the options or dimensions are invalid
+     */
+    PnLStatistics evaluate(const core::Vector& weights, const SimulationOptions& options) const {
+        core::Matrix portfolios(1, weights.size());
+        portfolios.setRow(0, weights);
+        return evaluate(portfolios, options).front();
+    }
+
+    /**
+     * @brief Get the number of assets.
+     * @return Number of assets
+     */
+    size_t size() const { return mu_.size(); }
+
+private:
+    core::Vector mu_;
+    core::Matrix choleskyT_;  // L', so that a block of returns is Z L'
+
+    // Normals of one block (scenarios × assets) and each scenario's scale s
+    struct Draws {
+        core::Matrix normals;
+        std::vector<double> scale;
+    };
+
+    static void validate(const SimulationOptions& options) {
+        if (options.scenarios == 0) {
+            throw std::invalid_argument("Number of scenarios must be at least 1");
+        }
+        if (options.blockSize == 0) {
+            throw std::invalid_argument("Block size must be at least 1");
+        }
+        if (options.distribution == ScenarioDistribution::STUDENT_T &&
+            !(std::isfinite(options.degreesOfFreedom) && options.degreesOfFreedom > 2.0)) {
+            throw std::invalid_argument("Student-t degrees of freedom must be greater than 2");
+        }
+        if (options.sampling == ScenarioSampling::SOBOL &&
+            options.scenarios > core::SobolSequence::MAX_POINTS) {
+            throw std::invalid_argument("Sobol sampling supports at most 2^32 scenarios");
+        }
+    }
+
+    // The scrambled Sobol sequence shared by all blocks (nullptr for pseudo-random sampling)
+    std::shared_ptr<const core::SobolSequence> sobolSequence(
+        const SimulationOptions& options) const {
+        if (options.sampling != ScenarioSampling::SOBOL) {
+            return nullptr;
+        }
+        if (size() > core::SobolSequence::MAX_DIMENSIONS) {
+            throw std::invalid_argument("Sobol sampling supports at most 21201 assets");
+        }
+        return std::make_shared<const core::SobolSequence>(size(), true, options.seed);
+    }
+
+    // Block b draws from stream b of the seed: all normals, then one χ² per
+    // scenario. With Sobol sampling the normals are the block's Sobol points.
+    Draws draw(const SimulationOptions& options, size_t b,
+               const core::SobolSequence* sobol) const {
+        const size_t first = b * options.blockSize;
+        const size_t rows = std::min(options.blockSize, options.scenarios - first);
+        core::CounterRng rng(options.seed, b);
+        Draws draws{core::Matrix(rows, size()), std::vector<double>(rows, 1.0)};
+        if (sobol) {
+            core::SobolSequence points = *sobol;
+            points.seek(first);
+            points.fillNormal(draws.normals);
+        } else {
+            rng.fillNormal(draws.normals);
+        }
+        if (options.distribution == ScenarioDistribution::STUDENT_T) {
+            const double nu = options.degreesOfFreedom;
+            for (double& scale : draws.scale) {
+                scale = std::sqrt((nu - 2.0) / rng.chiSquared(nu));
+            }
+        }
+        return draws;
+    }
+
+    /**
+     * @brief Run one task per block and consume the results in block order.
+     *
+     * Keeps a bounded window of blocks in flight, as FrontierEngine does
+     * with its chunks; runs inline with one thread or inside a pool worker.
+     */
+    template <typename Block, typename Task, typename Consume>
+    static size_t runBlocks(const SimulationOptions& options, const Task& task,
+                            const Consume& consume) {
+        const size_t numBlocks = (options.scenarios + options.blockSize - 1) / options.blockSize;
+        size_t threads = options.threads == 0 ? core::ThreadPool::defaultThreadCount()
+                                              : options.threads;
+        if (threads == 1 || numBlocks == 1 || core::ThreadPool::inWorkerThread()) {
+            for (size_t b = 0; b < numBlocks; ++b) {
+                Block block = task(b);
+                consume(b, block);
+            }
+            return numBlocks;
+        }
+
+        core::ThreadPool pool(threads);
+        const size_t maxInFlight = 4 * pool.size();
+        std::deque<std::future<Block>> inFlight;
+        size_t next = 0;
+        size_t done = 0;
+        while (next < numBlocks || !inFlight.empty()) {
+            while (next < numBlocks && inFlight.size() < maxInFlight) {
+                size_t b = next++;
+                inFlight.push_back(pool.submit([&task, b] { return task(b); }));
+            }
+            // On an exception the pool destructor drains the remaining blocks
+            Block block = inFlight.front().get();
+            inFlight.pop_front();
+            consume(done++, block);
+        }
+        return numBlocks;
+    }
+};
+
+}  // namespace optimizer
+}  // namespace orbat
@@ -0,0 +1,541 @@
+#pragma once
+
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/constraint.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Per-asset bounds and sector limits stored as flat arrays.
+ *
+ * PackedConstraints holds everything a large constraint file describes in a
+ * handful of contiguous arrays: a lower and upper bound per asset, the
+ * sector index of each asset, and a lower and upper limit on the total
+ * weight of each sector. A single instance is added to a ConstraintSet in
+ * place of thousands of individual constraint objects, and
+ * MarkowitzOptimizer uses project() in its constrained solver.
+ *
+ * Validation and feasibility checks are linear in the number of assets, and
+ * project() is linear per bisection step.
+ *
+ * Example:
+ *   PackedConstraints limits(3, 0.0, 0.6);   // Every asset in [0%, 60%]
+ *   limits.setBounds(0, 0.1, 0.5);           // Asset 0 in [10%, 50%]
+ *   size_t tech = limits.addSector("Tech", 0.0, 0.7);
+ *   limits.setSector(1, tech);
+ *   limits.setSector(2, tech);
+ *   limits.validate();
+ *
+ *   ConstraintSet constraints;
+ *   constraints.add(std::make_shared<PackedConstraints>(std::move(limits)));
+ */
+class PackedConstraints : public Constraint {
+public:
+    /// Sector index of assets that belong to no sector.
+    static constexpr uint32_t NO_SECTOR = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief Construct constraints with the same bounds for every asset.
+     *
+     * @param numAssets Number of assets
+     * @param lowerBound Lower bound for every asset (default: 0.0)
+     * @param upperBound Upper bound for every asset (default: 1.0)
+     * @param tolerance Tolerance for feasibility checks (default: 1e-8)
+     * @throws std::invalid_argument if numAssets is 0, lower > upper or tolerance < 0
+     */
+    explicit PackedConstraints(size_t numAssets, double lowerBound = 0.0,
+                               double upperBound = 1.0, double tolerance = 1e-8)
+        : PackedConstraints(std::vector<double>(numAssets, lowerBound),
+                            std::vector<double>(numAssets, upperBound), tolerance) {}
+
+    /**
+     * @brief Construct constraints from per-asset bound arrays.
+     *
+     * @param lowerBounds Lower bound of each asset
+     * @param upperBounds Upper bound of each asset
+     * @param tolerance Tolerance for feasibility checks (default: 1e-8)
+     * @throws std::invalid_argument if the arrays are empty or differ in size, or tolerance < 0
+     */
+    PackedConstraints(std::vector<double> lowerBounds, std::vector<double> upperBounds,
+                      double tolerance = 1e-8)
+        : lower_(std::move(lowerBounds)), upper_(std::move(upperBounds)),
+          sectorOf_(lower_.size(), NO_SECTOR), tolerance_(tolerance) {
+        if (lower_.empty()) {
+            throw std::invalid_argument("Packed constraints need at least one asset");
+        }
+        if (lower_.size() != upper_.size()) {
+            throw std::invalid_argument("Lower and upper bounds must have the same size");
+        }
+        if (tolerance < 0.0) {
+            throw std::invalid_argument("Tolerance must be non-negative");
+        }
+    }
+
+    /**
+     * @brief Get the number of assets.
+     */
+    size_t size() const { return lower_.size(); }
+
+    /**
+     * @brief Set the bounds of one asset.
+     *
+     * @param asset Asset index
+     * @param lowerBound Lower bound
+     * @param upperBound Upper bound
+     * @throws std::out_of_range if asset is out of range
+     */
+    void setBounds(size_t asset, double lowerBound, double upperBound) {
+        checkAsset(asset);
+        lower_[asset] = lowerBound;
+        upper_[asset] = upperBound;
+    }
+
+    /**
+     * @brief Add a sector with limits on its total weight.
+     *
+     * @param name Sector name (used in messages only)
+     * @param lowerLimit Minimum total weight of the sector
+     * @param upperLimit Maximum total weight of the sector
+     * @return Index of the new sector
+     */
+    size_t addSector(const std::string& name, double lowerLimit, double upperLimit) {
+        sectorNames_.push_back(name);
+        sectorLower_.push_back(lowerLimit);
+        sectorUpper_.push_back(upperLimit);
+        return sectorNames_.size() - 1;
+    }
+
+    /**
+     * @brief Set the limits of an existing sector.
+     *
+     * @param sector Sector index
+     * @param lowerLimit Minimum total weight of the sector
+     * @param upperLimit Maximum total weight of the sector
+     * @throws std::out_of_range if sector is out of range
+     */
+    void setSectorLimits(size_t sector, double lowerLimit, double upperLimit) {
+        checkSector(sector);
+        sectorLower_[sector] = lowerLimit;
+        sectorUpper_[sector] = upperLimit;
+    }
+
+    /**
+     * @brief Assign an asset to a sector.
+     *
+     * @param asset Asset index
+     * @param sector Sector index, or NO_SECTOR
+     * @throws std::out_of_range if asset or sector is out of range
+     */
+    void setSector(size_t asset, size_t sector) {
+        checkAsset(asset);
+        if (sector != NO_SECTOR) {
+            checkSector(sector);
+        }
+        sectorOf_[asset] = static_cast<uint32_t>(sector);
+    }
+
+    /**
+     * @brief Get the number of sectors.
+     */
+    size_t sectorCount() const { return sectorNames_.size(); }
+
+    /**
+     * @brief Get per-asset lower bounds.
+     */
+    const std::vector<double>& lowerBounds() const { return lower_; }
+
+    /**
+     * @brief Get per-asset upper bounds.
+     */
+    const std::vector<double>& upperBounds() const { return upper_; }
+
+    /**
+     * @brief Get the sector index of each asset (NO_SECTOR if none).
+     */
+    const std::vector<uint32_t>& sectors() const { return sectorOf_; }
+
+    /**
+     * @brief Get a sector name.
+     * @param sector Sector index
+     */
+    const std::string& sectorName(size_t sector) const {
+        checkSector(sector);
+        return sectorNames_[sector];
+    }
+
+    /**
+     * @brief Get a sector's minimum total weight.
+     * @param sector Sector index
+     */
+    double sectorLower(size_t sector) const {
+        checkSector(sector);
+        return sectorLower_[sector];
+    }
+
+    /**
+     * @brief Get a sector's maximum total weight.
+     * @param sector Sector index
+     */
+    double sectorUpper(size_t sector) const {
+        checkSector(sector);
+        return sectorUpper_[sector];
+    }
+
+    /**
+     * @brief Get the tolerance for feasibility checks.
+     */
+    double getTolerance() const { return tolerance_; }
+
+    /**
+     * @brief Check that the limits admit a fully invested portfolio.
+     *
+     * Checks in one pass over the assets that every bound is finite with
+     * lower <= upper, that the bounds allow weights summing to 1, and that
+     * every sector's limits are ordered and reachable from its members'
+     * bounds. Each sector can then hold any total between the larger of its
+     * lower limit and its members' lower bounds and the smaller of its upper
+     * limit and their upper bounds; together with the bounds of assets in
+     * no sector, those ranges must allow a total of 1.
+     *
+     * @throws std::invalid_argument describing the first problem found
+     */
+    void validate() const {
+        double sumLower = 0.0;
+        double sumUpper = 0.0;
+        std::vector<double> memberLower(sectorNames_.size(), 0.0);
+        std::vector<double> memberUpper(sectorNames_.size(), 0.0);
+        for (size_t i = 0; i < lower_.size(); ++i) {
+            if (!std::isfinite(lower_[i]) || !std::isfinite(upper_[i])) {
+                throw std::invalid_argument("Bounds of asset " + std::to_string(i) +
+                                            " must be finite");
+            }
+            if (lower_[i] > upper_[i]) {
+                throw std::invalid_argument("Lower bound exceeds upper bound for asset " +
+                                            std::to_string(i));
+            }
+            sumLower += lower_[i];
+            sumUpper += upper_[i];
+            if (sectorOf_[i] != NO_SECTOR) {
+                memberLower[sectorOf_[i]] += lower_[i];
+                memberUpper[sectorOf_[i]] += upper_[i];
+            }
+        }
+        if (sumLower > 1.0 + tolerance_) {
+            throw std::invalid_argument("Lower bounds sum to more than 1");
+        }
+        if (sumUpper < 1.0 - tolerance_) {
+            throw std::invalid_argument("Upper bounds sum to less than 1");
+        }
+        for (size_t s = 0; s < sectorNames_.size(); ++s) {
+            const std::string label = "Sector '" + sectorNames_[s] + "'";
+            if (!(sectorLower_[s] <= sectorUpper_[s])) {
+                throw std::invalid_argument(label + " has a lower limit above its upper limit");
+            }
+            if (memberLower[s] > sectorUpper_[s] + tolerance_) {
+                throw std::invalid_argument(label + ": member lower bounds exceed its upper limit");
+            }
+            if (memberUpper[s] < sectorLower_[s] - tolerance_) {
+                throw std::invalid_argument(label +
+                                            ": member upper bounds cannot reach its lower limit");
+            }
+            // Replace the members' bounds by the range the sector can hold
+            sumLower += std::max(sectorLower_[s], memberLower[s]) - memberLower[s];
+            sumUpper += std::min(sectorUpper_[s], memberUpper[s]) - memberUpper[s];
+        }
+        if (sumLower > 1.0 + tolerance_) {
+            throw std::invalid_argument("Sector lower limits force a total weight above 1");
+        }
+        if (sumUpper < 1.0 - tolerance_) {
+            throw std::invalid_argument("Sector upper limits keep the total weight below 1");
+        }
+    }
+
+    /**
+     * @brief Check if weights satisfy every asset bound and sector limit.
+     *
+     * Full investment is not checked here; combine with
+     * FullyInvestedConstraint if required.
+     *
+     * @param weights Portfolio weights vector
+     * @return true if all bounds and limits hold within tolerance
+     */
+    bool isFeasible(const core::Vector& weights) const override {
+        if (weights.size() != lower_.size()) {
+            return false;
+        }
+        std::vector<double> sectorWeight(sectorNames_.size(), 0.0);
+        for (size_t i = 0; i < weights.size(); ++i) {
+            if (weights[i] < lower_[i] - tolerance_ || weights[i] > upper_[i] + tolerance_) {
+                return false;
+            }
+            if (sectorOf_[i] != NO_SECTOR) {
+                sectorWeight[sectorOf_[i]] += weights[i];
+            }
+        }
+        for (size_t s = 0; s < sectorWeight.size(); ++s) {
+            if (sectorWeight[s] < sectorLower_[s] - tolerance_ ||
+                sectorWeight[s] > sectorUpper_[s] + tolerance_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the name of this constraint.
+     *
+     * @return "PackedConstraints"
+     */
+    std::string getName() const override { return "PackedConstraints"; }
+
+    /**
+     * @brief Get the description of this constraint.
+     *
+     * @return Summary of the asset and sector counts
+     */
+    std::string getDescription() const override {
+        return "Per-asset bounds for " + std::to_string(lower_.size()) + " assets and limits on " +
+               std::to_string(sectorNames_.size()) + " sectors";
+    }
+
+    /**
+     * @brief Project weights onto the fully invested portfolios within the limits.
+     *
+     * Replaces v by the nearest w (in Euclidean distance) with every asset
+     * within its bounds, every sector within its limits and Σw = 1. For a
+     * budget multiplier τ the problem splits by sector: each weight becomes
+     * clamp(v_i - τ, lower_i, upper_i), and a sector whose total falls
+     * outside its limits is shifted back onto the nearest limit. The budget
+     * this gives is non-increasing in τ, so τ is found by bisection. Each
+     * step is linear in the number of assets.
+     *
+     * The limits must admit a fully invested portfolio (see validate()).
+     *
+     * @param weights Weights to project in place (size must match)
+     * @throws std::invalid_argument if the size does not match, or if no
+     *         weights within the limits sum to 1
+     */
+    void project(core::Vector& weights) const {
+        if (weights.size() != lower_.size()) {
+            throw std::invalid_argument("Weights size does not match packed constraints");
+        }
+        const size_t n = lower_.size();
+        const size_t sectors = sectorNames_.size();
+        std::vector<double> sectorSum(sectors, 0.0);
+        auto budgetAt = [&](double tau) {
+            std::fill(sectorSum.begin(), sectorSum.end(), 0.0);
+            double total = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                double x = std::clamp(weights[i] - tau, lower_[i], upper_[i]);
+                if (sectorOf_[i] == NO_SECTOR) {
+                    total += x;
+                } else {
+                    sectorSum[sectorOf_[i]] += x;
+                }
+            }
+            for (size_t s = 0; s < sectors; ++s) {
+                total += std::clamp(sectorSum[s], sectorLower_[s], sectorUpper_[s]);
+            }
+            return total;
+        };
+
+        // Every weight is at its upper bound at low and at its lower bound at high
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < n; ++i) {
+            low = std::min(low, weights[i] - upper_[i]);
+            high = std::max(high, weights[i] - lower_[i]);
+        }
+        if (budgetAt(low) < 1.0 - tolerance_ || budgetAt(high) > 1.0 + tolerance_) {
+            throw std::invalid_argument("Packed limits cannot reach a total weight of 1");
+        }
+        for (int iter = 0; iter < 200 && high - low > 1e-15 * (1.0 + std::abs(high)); ++iter) {
+            double mid = 0.5 * (low + high);
+            if (budgetAt(mid) > 1.0) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        const double tau = 0.5 * (low + high);
+        budgetAt(tau);
+
+        std::vector<size_t> outside;  // Assets of sectors held at a limit
+        for (size_t i = 0; i < n; ++i) {
+            const uint32_t s = sectorOf_[i];
+            if (s != NO_SECTOR &&
+                (sectorSum[s] < sectorLower_[s] || sectorSum[s] > sectorUpper_[s])) {
+                weights[i] -= tau;
+                outside.push_back(i);
+            } else {
+                weights[i] = std::clamp(weights[i] - tau, lower_[i], upper_[i]);
+            }
+        }
+        if (outside.empty()) {
+            return;
+        }
+        std::stable_sort(outside.begin(), outside.end(),
+                         [this](size_t a, size_t b) { return sectorOf_[a] < sectorOf_[b]; });
+        for (size_t first = 0; first < outside.size();) {
+            const uint32_t s = sectorOf_[outside[first]];
+            size_t last = first;
+            while (last < outside.size() && sectorOf_[outside[last]] == s) {
+                ++last;
+            }
+            shiftToSum(weights, outside.data() + first, outside.data() + last,
+                       std::clamp(sectorSum[s], sectorLower_[s], sectorUpper_[s]));
+            first = last;
+        }
+    }
+
+    /**
+     * @brief Express a constraint set as packed limits, if it can be.
+     *
+     * Long-only, box and fully invested constraints and at most one
+     * PackedConstraints are merged into one set of limits, intersecting
+     * their bounds. Bounds that full investment implies are added, so a
+     * long-only set gives every asset the upper bound 1.
+     *
+     * @param constraints Constraint set
+     * @param numAssets Number of assets
+     * @return The merged limits, or std::nullopt if the set holds another
+     *         constraint type, more than one PackedConstraints, or leaves a
+     *         weight unbounded
+     */
+    static std::optional<PackedConstraints> fromConstraintSet(const ConstraintSet& constraints,
+                                                              size_t numAssets) {
+        const double inf = std::numeric_limits<double>::infinity();
+        std::optional<PackedConstraints> packed;
+        std::vector<double> lower(numAssets, -inf);
+        std::vector<double> upper(numAssets, inf);
+        for (const auto& constraint : constraints.getConstraints()) {
+            const Constraint* c = constraint.get();
+            if (auto* limits = dynamic_cast<const PackedConstraints*>(c)) {
+                if (packed || limits->size() != numAssets) {
+                    return std::nullopt;
+                }
+                packed = *limits;
+            } else if (dynamic_cast<const LongOnlyConstraint*>(c)) {
+                for (double& bound : lower) {
+                    bound = std::max(bound, 0.0);
+                }
+            } else if (auto* box = dynamic_cast<const BoxConstraint*>(c)) {
+                if (!box->hasUniformBounds() && box->getLowerBounds().size() != numAssets) {
+                    return std::nullopt;
+                }
+                const bool uniform = box->hasUniformBounds();
+                for (size_t i = 0; i < numAssets; ++i) {
+                    lower[i] = std::max(lower[i], uniform ? box->getUniformLower()
+                                                          : box->getLowerBounds()[i]);
+                    upper[i] = std::min(upper[i], uniform ? box->getUniformUpper()
+                                                          : box->getUpperBounds()[i]);
+                }
+            } else if (!dynamic_cast<const FullyInvestedConstraint*>(c)) {
+                return std::nullopt;
+            }
+        }
+        if (!packed) {
+            packed = PackedConstraints(numAssets, -inf, inf);
+        }
+        for (size_t i = 0; i < numAssets; ++i) {
+            packed->lower_[i] = std::max(packed->lower_[i], lower[i]);
+            packed->upper_[i] = std::min(packed->upper_[i], upper[i]);
+        }
+
+        // With Σw = 1, w_i = 1 - Σ_{j≠i} w_j bounds each weight by the others' bounds
+        double sumLower = 0.0;
+        double sumUpper = 0.0;
+        for (size_t i = 0; i < numAssets; ++i) {
+            sumLower += packed->lower_[i];
+            sumUpper += packed->upper_[i];
+        }
+        for (size_t i = 0; i < numAssets; ++i) {
+            if (std::isfinite(sumLower)) {
+                packed->upper_[i] =
+                    std::min(packed->upper_[i], 1.0 - (sumLower - packed->lower_[i]));
+            }
+            if (std::isfinite(sumUpper)) {
+                packed->lower_[i] =
+                    std::max(packed->lower_[i], 1.0 - (sumUpper - packed->upper_[i]));
+            }
+            if (!std::isfinite(packed->lower_[i]) || !std::isfinite(packed->upper_[i])) {
+                return std::nullopt;
+            }
+        }
+        return packed;
+    }
+
+private:
+    std::vector<double> lower_;
+    std::vector<double> upper_;
+    std::vector<uint32_t> sectorOf_;
+    std::vector<std::string> sectorNames_;
+    std::vector<double> sectorLower_;
+    std::vector<double> sectorUpper_;
+    double tolerance_;
+
+    void checkAsset(size_t asset) const {
+        if (asset >= lower_.size()) {
+            throw std::out_of_range("Asset index out of range");
+        }
+    }
+
+    void checkSector(size_t sector) const {
+        if (sector >= sectorNames_.size()) {
+            throw std::out_of_range("Sector index out of range");
+        }
+    }
+
+    /**
+     * @brief Replace w[i] by clamp(w[i] - shift, lower[i], upper[i]) for the
+     * given assets, with the shift chosen by bisection so they sum to target.
+     *
+     * The sum is non-increasing in the shift, so the target is bracketed by
+     * the shifts that put every asset at its upper and at its lower bound.
+     * If the target lies outside that range the assets end at the nearer end.
+     */
+    void shiftToSum(core::Vector& weights, const size_t* first, const size_t* last,
+                    double target) const {
+        if (first == last) {
+            return;
+        }
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        for (const size_t* it = first; it != last; ++it) {
+            low = std::min(low, weights[*it] - upper_[*it]);
+            high = std::max(high, weights[*it] - lower_[*it]);
+        }
+        auto sumAt = [&](double shift) {
+            double sum = 0.0;
+            for (const size_t* it = first; it != last; ++it) {
+                sum += std::clamp(weights[*it] - shift, lower_[*it], upper_[*it]);
+            }
+            return sum;
+        };
+        for (int iter = 0; iter < 200 && high - low > 1e-15 * (1.0 + std::abs(high)); ++iter) {
+            double mid = 0.5 * (low + high);
+            if (sumAt(mid) > target) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        double shift = 0.5 * (low + high);
+        for (const size_t* it = first; it != last; ++it) {
+            weights[*it] = std::clamp(weights[*it] - shift, lower_[*it], upper_[*it]);
+        }
+    }
+};
+
+}  // namespace optimizer
+}  // namespace orbat
@@ -0,0 +1,554 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/constants.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/random.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/backtest.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief How the samples behind a resampled frontier are drawn.
+ */
+enum class ResamplingMethod {
+    PARAMETRIC,  // Normal returns N(μ, Σ)
+    BOOTSTRAP    // Rows of a return history, drawn with replacement
+};
+
+/**
+ * @brief Options controlling a resampled frontier.
+ */
+struct ResamplingOptions {
+    size_t samples = 500;     // Resampled frontiers R
+    size_t observations = 0;  // Periods per sample, more than the assets (0 = history length)
+    size_t points = 50;       // Frontier points, matched across samples by rank
+    uint64_t seed = 42;       // Random seed (same seed = same samples, with any thread count)
+    size_t threads = 0;       // Worker threads (0 = hardware concurrency, 1 = caller's thread)
+    size_t chunkSize = 4;     // Samples per parallel task
+};
+
+/**
+ * @brief Rank-averaged portfolios of a resampled frontier.
+ */
+struct ResampledFrontier {
+    std::vector<MarkowitzResult> points{};  // Averaged portfolios, evaluated with μ and Σ
+    size_t samples = 0;                     // Samples averaged
+    size_t failedSamples = 0;               // Samples without a positive-definite covariance
+};
+
+/**
+ * @brief Michaud's resampled efficient frontier.
+ *
+ * Draws R samples of T periods of returns, estimates μ_r and Σ_r from each,
+ * and solves each sample's frontier at the same ranks: point k of sample r
+ * has the return low_r + k / (M - 1) · (high_r - low_r), from the sample's
+ * minimum-variance return to its highest asset return, as in
+ * FrontierEngine. The resampled portfolio at rank k averages the weights of
+ * point k over all samples. It is reported with its return and risk under
+ * the original μ and Σ.
+ *
+ * Samples come from N(μ, Σ) (PARAMETRIC) or from the rows of a return
+ * history (BOOTSTRAP). Each sample's frontier uses FrontierEngine's closed
+ * form: every point is a·Σ_r⁻¹μ_r + b·Σ_r⁻¹1, so once the two basis
+ * vectors and the scalars μ_r'Σ_r⁻¹μ_r, μ_r'Σ_r⁻¹1 and 1'Σ_r⁻¹1 are known,
+ * each point costs O(n). Points that violate the constraint set are
+ * projected onto it with MarkowitzOptimizer::projectOntoConstraints(), the
+ * fallback of a constrained targetReturn().
+ *
+ * Samples are never formed in asset space. With L the Cholesky factor of Σ
+ * (Σ = LL'), the engine draws whitened returns z with x = μ + Lz: standard
+ * normals, or rows of the history whitened once as L⁻¹(x - μ). Then
+ * μ_r = μ + L m and Σ_r = L S L', where m and S are the mean and covariance
+ * of the sample's z, and
+ *
+ *   Σ_r⁻¹v = L'⁻¹ G'⁻¹ G⁻¹ L⁻¹v   with S = GG'.
+ *
+ * L⁻¹μ and L⁻¹1 are computed once, so a sample costs the O(Tn²) scatter
+ * matrix of its z, an O(n³/6) Cholesky factorization of S and a few O(n²)
+ * triangular solves. Skipped work includes the O(Tn²) product LZ, the
+ * O(n³) inverse of Σ_r and its validation.
+ *
+ * Sample r draws from stream r of the seed (core::CounterRng). Samples run
+ * in chunks on a thread pool. Each worker reuses one workspace for the
+ * sample draws, the scatter matrix and the basis vectors, so samples do not
+ * allocate. Chunk sums are merged in chunk order, so the frontier does not
+ * depend on the thread count.
+ *
+ * Example:
+ *   ResampledFrontierEngine engine(returns, covariance, longOnly);
+ *   ResamplingOptions options;
+ *   options.samples = 500;
+ *   options.observations = 120;  // Months of data behind the estimates
+ *   ResampledFrontier frontier = engine.compute(options);
+ *   for (const MarkowitzResult& point : frontier.points) { ... }
+ */
+class ResampledFrontierEngine {
+public:
+    /**
+     * @brief Construct an engine that samples from N(μ, Σ).
+     * @param returns Expected returns μ
+     * @param covariance Covariance matrix Σ
+     * @param constraints Constraint set applied to every point
+     * @param factorization Shared factorization of covariance (nullptr = factorize here)
+     * @throws std::invalid_argument if the inputs are inconsistent
+     * @throws std::runtime_error if the covariance matrix cannot be factorized
+     */
+    ResampledFrontierEngine(const ExpectedReturns& returns, const CovarianceMatrix& covariance,
+                            const ConstraintSet& constraints = ConstraintSet(),
+                            std::shared_ptr<const CovarianceFactorization> factorization = nullptr)
+        : method_(ResamplingMethod::PARAMETRIC), returns_(returns), covariance_(covariance),
+          constraints_(constraints),
+          factorization_(factorization ? std::move(factorization)
+                                       : CovarianceFactorization::create(covariance)) {
+        initialize();
+    }
+
+    /**
+     * @brief Construct an engine that bootstraps the periods of a return history.
+     *
+     * μ and Σ are the sample mean and covariance of the history.
+     *
+     * @param history Periods × assets matrix of returns (more periods than assets)
+     * @param constraints Constraint set applied to every point
+     * @throws std::invalid_argument if the history is too short or its
+     *         covariance is not positive-definite
+     */
+    explicit ResampledFrontierEngine(const core::Matrix& history,
+                                     const ConstraintSet& constraints = ConstraintSet())
+        : method_(ResamplingMethod::BOOTSTRAP), constraints_(constraints) {
+        if (history.rows() <= history.cols()) {
+            throw std::invalid_argument("Return history needs more periods than assets");
+        }
+        RollingEstimator estimator(history, history.rows());
+        estimator.advance(history.rows());
+        returns_ = estimator.mean();
+        covariance_ = estimator.covariance();
+        factorization_ = CovarianceFactorization::create(covariance_);
+        initialize();
+
+        // Whitened periods L⁻¹(x - μ)
+        const size_t n = returns_.size();
+        whitened_ = core::Matrix(history.rows(), n);
+        for (size_t t = 0; t < history.rows(); ++t) {
+            double* row = whitened_.data().data() + t * n;
+            for (size_t i = 0; i < n; ++i) {
+                row[i] = history(t, i) - returns_[i];
+            }
+            forwardSolve(cholesky(), n, row);
+        }
+    }
+
+    /**
+     * @brief Get the sampling method.
+     */
+    ResamplingMethod method() const { return method_; }
+
+    /**
+     * @brief Get μ (estimated from the history when bootstrapping).
+     */
+    const ExpectedReturns& expectedReturns() const { return returns_; }
+
+    /**
+     * @brief Get Σ (estimated from the history when bootstrapping).
+     */
+    const CovarianceMatrix& covariance() const { return covariance_; }
+
+    /**
+     * @brief Compute the resampled frontier.
+     * @param options Resampling options
+     * @return Rank-averaged portfolios in order of rank (no points if every sample failed)
+     * @throws std::invalid_argument if the options are invalid
+     */
+    ResampledFrontier compute(const ResamplingOptions& options = {}) const {
+        ORBAT_ALLOCATION_SCOPE("ResampledFrontierEngine::compute");
+        ORBAT_TRACE_SPAN("ResampledFrontierEngine::compute", "solve");
+        ORBAT_LATENCY_TIMER("ResampledFrontierEngine::compute");
+        const size_t observations = observationCount(options);
+        const size_t n = returns_.size();
+        const size_t numTasks = (options.samples + options.chunkSize - 1) / options.chunkSize;
+
+        // Workspaces are handed from task to task, so there is one per worker
+        std::mutex workspaceMutex;
+        std::vector<std::unique_ptr<Workspace>> idle;
+        auto task = [&](size_t c) {
+            std::unique_ptr<Workspace> workspace;
+            {
+                std::lock_guard<std::mutex> lock(workspaceMutex);
+                if (!idle.empty()) {
+                    workspace = std::move(idle.back());
+                    idle.pop_back();
+                }
+            }
+            if (!workspace) {
+                workspace = std::make_unique<Workspace>(observations, n);
+            }
+            ChunkSums sums{core::Matrix(options.points, n), 0, 0};
+            const size_t end = std::min(options.samples, (c + 1) * options.chunkSize);
+            for (size_t r = c * options.chunkSize; r < end; ++r) {
+                if (addSample(r, options, *workspace, sums.weights)) {
+                    ++sums.samples;
+                } else {
+                    ++sums.failed;
+                }
+            }
+            std::lock_guard<std::mutex> lock(workspaceMutex);
+            idle.push_back(std::move(workspace));
+            return sums;
+        };
+
+        ChunkSums total{core::Matrix(options.points, n), 0, 0};
+        auto merge = [&total](const ChunkSums& sums) {
+            double* out = total.weights.data().data();
+            const double* in = sums.weights.data().data();
+            for (size_t k = 0; k < total.weights.data().size(); ++k) {
+                out[k] += in[k];
+            }
+            total.samples += sums.samples;
+            total.failed += sums.failed;
+        };
+
+        size_t threads = options.threads == 0 ? core::ThreadPool::defaultThreadCount()
+                                              : options.threads;
+        if (threads == 1 || numTasks == 1 || core::ThreadPool::inWorkerThread()) {
+            for (size_t c = 0; c < numTasks; ++c) {
+                merge(task(c));
+            }
+        } else {
+            // Keep a bounded window of chunks in flight and merge them in order
+            core::ThreadPool pool(std::min(threads, numTasks));
+            const size_t maxInFlight = 4 * pool.size();
+            std::deque<std::future<ChunkSums>> inFlight;
+            size_t next = 0;
+            while (next < numTasks || !inFlight.empty()) {
+                while (next < numTasks && inFlight.size() < maxInFlight) {
+                    size_t c = next++;
+                    inFlight.push_back(pool.submit([&task, c] { return task(c); }));
+                }
+                // On an exception the pool destructor drains the remaining chunks
+                ChunkSums sums = inFlight.front().get();
+                inFlight.pop_front();
+                merge(sums);
+            }
+        }
+        return finish(total);
+    }
+
+private:
+    // Per-worker buffers reused across samples
+    struct Workspace {
+        Workspace(size_t observations, size_t n)
+            : draws(observations, n), scatter(n, n), mean(n), muBasis(n), onesBasis(n),
+              weights(n) {}
+
+        core::Matrix draws;      // Whitened returns z of the sample, one row per period
+        core::Matrix scatter;    // Covariance S of z, then its Cholesky factor G (lower)
+        core::Vector mean;       // Mean m of z
+        core::Vector muBasis;    // Σ_r⁻¹μ_r
+        core::Vector onesBasis;  // Σ_r⁻¹1
+        core::Vector weights;    // Point being added
+    };
+
+    // Sums of the weights at each rank over a chunk of samples
+    struct ChunkSums {
+        core::Matrix weights;  // Ranks × assets
+        size_t samples;
+        size_t failed;
+    };
+
+    void initialize() {
+        const size_t n = returns_.size();
+        if (n == 0 || covariance_.size() != n) {
+            throw std::invalid_argument(
+                "Expected returns and covariance matrix dimensions must match");
+        }
+        if (factorization_->size() != n) {
+            throw std::invalid_argument(
+                "Covariance factorization dimension must match covariance matrix");
+        }
+        MarkowitzOptimizer::validateInputs(returns_, covariance_, constraints_);
+
+        whitenedMean_ = returns_.data();
+        forwardSolve(cholesky(), n, whitenedMean_.data().data());
+        whitenedOnes_ = core::Vector(n, 1.0);
+        forwardSolve(cholesky(), n, whitenedOnes_.data().data());
+    }
+
+    const double* cholesky() const { return factorization_->cholesky().data().data(); }
+
+    size_t observationCount(const ResamplingOptions& options) const {
+        if (options.samples == 0 || options.chunkSize == 0) {
+            throw std::invalid_argument("Sample count and chunk size must be positive");
+        }
+        if (options.points < 2) {
+            throw std::invalid_argument("Number of points must be at least 2");
+        }
+        size_t observations = options.observations;
+        if (observations == 0) {
+            if (method_ == ResamplingMethod::PARAMETRIC) {
+                throw std::invalid_argument(
+                    "Parametric resampling needs the number of observations per sample");
+            }
+            observations = whitened_.rows();
+        }
+        if (observations <= returns_.size()) {
+            throw std::invalid_argument("Each sample needs more observations than assets");
+        }
+        return observations;
+    }
+
+    // Draw sample r and add its frontier to sums; false if its covariance is singular
+    bool addSample(size_t r, const ResamplingOptions& options, Workspace& workspace,
+                   core::Matrix& sums) const {
+        const size_t n = returns_.size();
+        const size_t observations = workspace.draws.rows();
+        double* draws = workspace.draws.data().data();
+        core::CounterRng rng(options.seed, r);
+        if (method_ == ResamplingMethod::PARAMETRIC) {
+            rng.fillNormal(workspace.draws);
+        } else {
+            for (size_t t = 0; t < observations; ++t) {
+                const double* row = whitened_.data().data() + rng.below(whitened_.rows()) * n;
+                std::copy(row, row + n, draws + t * n);
+            }
+        }
+
+        // Mean, then covariance of the centered draws in the lower triangle
+        double* mean = workspace.mean.data().data();
+        std::fill(mean, mean + n, 0.0);
+        for (size_t t = 0; t < observations; ++t) {
+            for (size_t i = 0; i < n; ++i) {
+                mean[i] += draws[t * n + i];
+            }
+        }
+        const double inverseCount = 1.0 / static_cast<double>(observations);
+        for (size_t i = 0; i < n; ++i) {
+            mean[i] *= inverseCount;
+        }
+        for (size_t t = 0; t < observations; ++t) {
+            double* row = draws + t * n;
+            for (size_t i = 0; i < n; ++i) {
+                row[i] -= mean[i];
+            }
+        }
+        // Four periods per pass, so each row of the triangle is loaded and stored once per pass
+        double* scatter = workspace.scatter.data().data();
+        std::fill(scatter, scatter + n * n, 0.0);
+        size_t t = 0;
+        for (; t + 4 <= observations; t += 4) {
+            const double* r0 = draws + t * n;
+            const double* r1 = r0 + n;
+            const double* r2 = r1 + n;
+            const double* r3 = r2 + n;
+            for (size_t i = 0; i < n; ++i) {
+                const double v0 = r0[i];
+                const double v1 = r1[i];
+                const double v2 = r2[i];
+                const double v3 = r3[i];
+                double* out = scatter + i * n;
+                for (size_t j = 0; j <= i; ++j) {
+                    out[j] += v0 * r0[j] + v1 * r1[j] + v2 * r2[j] + v3 * r3[j];
+                }
+            }
+        }
+        for (; t < observations; ++t) {
+            const double* row = draws + t * n;
+            for (size_t i = 0; i < n; ++i) {
+                const double value = row[i];
+                double* out = scatter + i * n;
+                for (size_t j = 0; j <= i; ++j) {
+                    out[j] += value * row[j];
+                }
+            }
+        }
+        const double inverseDegrees = 1.0 / static_cast<double>(observations - 1);
+        for (size_t k = 0; k < n * n; ++k) {
+            scatter[k] *= inverseDegrees;
+        }
+        if (!choleskyInPlace(scatter, n)) {
+            return false;
+        }
+
+        // q = G⁻¹L⁻¹v gives v'Σ_r⁻¹w = q_v·q_w and Σ_r⁻¹v = L'⁻¹G'⁻¹q_v
+        double* muBasis = workspace.muBasis.data().data();
+        double* onesBasis = workspace.onesBasis.data().data();
+        for (size_t i = 0; i < n; ++i) {
+            muBasis[i] = whitenedMean_[i] + mean[i];
+        }
+        std::copy(whitenedOnes_.data().begin(), whitenedOnes_.data().end(), onesBasis);
+        forwardSolve(scatter, n, muBasis);
+        forwardSolve(scatter, n, onesBasis);
+        double A = 0.0;
+        double B = 0.0;
+        double C = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            A += muBasis[i] * muBasis[i];
+            B += muBasis[i] * onesBasis[i];
+            C += onesBasis[i] * onesBasis[i];
+        }
+        const double det = A * C - B * B;
+        if (std::abs(det) < core::EPSILON || !std::isfinite(det)) {
+            return false;
+        }
+        for (double* basis : {muBasis, onesBasis}) {
+            backwardSolveTransposed(scatter, n, basis);
+            backwardSolveTransposed(cholesky(), n, basis);
+        }
+
+        // Highest asset return of μ_r = μ + Lm
+        const double* factor = cholesky();
+        double high = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < n; ++i) {
+            double value = returns_[i];
+            for (size_t j = 0; j <= i; ++j) {
+                value += factor[i * n + j] * mean[j];
+            }
+            high = std::max(high, value);
+        }
+        const double low = B / C;  // Minimum-variance return
+
+        const size_t points = sums.rows();
+        core::Vector& weights = workspace.weights;
+        for (size_t k = 0; k < points; ++k) {
+            double target = low + static_cast<double>(k) / static_cast<double>(points - 1) *
+                                      (high - low);
+            double a = (C * target - B) / det;
+            double b = (A - B * target) / det;
+            for (size_t i = 0; i < n; ++i) {
+                weights[i] = a * muBasis[i] + b * onesBasis[i];
+            }
+            if (!constraints_.empty() && !constraints_.isFeasible(weights)) {
+                MarkowitzOptimizer::projectOntoConstraints(constraints_, weights);
+            }
+            double* out = sums.data().data() + k * n;
+            for (size_t i = 0; i < n; ++i) {
+                out[i] += weights[i];
+            }
+        }
+        return true;
+    }
+
+    // Average the sums and evaluate every point under μ and Σ
+    ResampledFrontier finish(ChunkSums& total) const {
+        ResampledFrontier frontier;
+        frontier.samples = total.samples;
+        frontier.failedSamples = total.failed;
+        if (total.samples == 0) {
+            return frontier;
+        }
+        core::Matrix& weights = total.weights;
+        const double inverseSamples = 1.0 / static_cast<double>(total.samples);
+        for (double& value : weights.data()) {
+            value *= inverseSamples;
+        }
+        core::Matrix covarianceWeights;
+        weights.multiplyInto(covariance_.data(), covarianceWeights);  // Rows are (Σw)'
+
+        frontier.points.reserve(weights.rows());
+        for (size_t k = 0; k < weights.rows(); ++k) {
+            core::Vector w = weights.getRow(k);
+            core::Vector sw = covarianceWeights.getRow(k);
+            double expectedReturn = returns_.data().dot(w);
+            double risk = std::sqrt(std::max(0.0, w.dot(sw)));
+            double sharpeRatio = (risk > core::EPSILON) ? (expectedReturn / risk) : 0.0;
+            frontier.points.push_back(MarkowitzResult{std::move(w), expectedReturn, risk,
+                                                      sharpeRatio, true,
+                                                      "Resampled frontier portfolio computed",
+                                                      std::move(sw)});
+        }
+        return frontier;
+    }
+
+    // Dot product of the first n entries, with independent partial sums so
+    // the loop is not one long chain of dependent additions
+    static double dot(const double* a, const double* b, size_t n) {
+        double s0 = 0.0;
+        double s1 = 0.0;
+        double s2 = 0.0;
+        double s3 = 0.0;
+        size_t k = 0;
+        for (; k + 4 <= n; k += 4) {
+            s0 += a[k] * b[k];
+            s1 += a[k + 1] * b[k + 1];
+            s2 += a[k + 2] * b[k + 2];
+            s3 += a[k + 3] * b[k + 3];
+        }
+        for (; k < n; ++k) {
+            s0 += a[k] * b[k];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    // Cholesky factorization of the lower triangle of a row-major matrix, in
+    // place; false if it is not positive-definite
+    static bool choleskyInPlace(double* a, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            double* rowI = a + i * n;
+            for (size_t j = 0; j <= i; ++j) {
+                const double* rowJ = a + j * n;
+                double sum = rowI[j] - dot(rowI, rowJ, j);
+                if (j < i) {
+                    rowI[j] = sum / rowJ[j];
+                } else if (sum > 0.0 && std::isfinite(sum)) {
+                    rowI[i] = std::sqrt(sum);
+                } else {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Solve Lx = b in place for lower triangular, row-major L
+    static void forwardSolve(const double* lower, size_t n, double* x) {
+        for (size_t i = 0; i < n; ++i) {
+            const double* row = lower + i * n;
+            x[i] = (x[i] - dot(row, x, i)) / row[i];
+        }
+    }
+
+    // Solve L'x = b in place, reading L by rows
+    static void backwardSolveTransposed(const double* lower, size_t n, double* x) {
+        for (size_t i = n; i-- > 0;) {
+            const double* row = lower + i * n;
+            x[i] /= row[i];
+            for (size_t j = 0; j < i; ++j) {
+                x[j] -= row[j] * x[i];
+            }
+        }
+    }
+
+    ResamplingMethod method_;
+    ExpectedReturns returns_;
+    CovarianceMatrix covariance_;
+    ConstraintSet constraints_;
+    std::shared_ptr<const CovarianceFactorization> factorization_;
+    core::Vector whitenedMean_;  // L⁻¹μ
+    core::Vector whitenedOnes_;  // L⁻¹1
+    core::Matrix whitened_;      // L⁻¹(x - μ) per period of the history (BOOTSTRAP)
+};
+
+}  // namespace optimizer
+}  // namespace orbat
@@ -0,0 +1,873 @@
+#pragma once
+
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief RAII guard for a stream's number format.
+ *
+ * Switches the stream to fixed notation with the given precision and
+ * restores the caller's flags and precision when it goes out of scope, so
+ * writers that format numbers never leak their settings into the stream.
+ * Result sinks hold one while writing each record.
+ */
+class FormatScope {
+public:
+    /**
+     * @brief Save the stream's format and switch it to fixed notation.
+     * @param out Stream to format (must outlive the guard)
+     * @param precision Digits after the decimal point (default: 8)
+     */
+    explicit FormatScope(std::ostream& out, int precision = 8)
+        : out_(out), flags_(out.flags()), precision_(out.precision()) {
+        out_ << std::fixed << std::setprecision(precision);
+    }
+
+    ~FormatScope() {
+        out_.flags(flags_);
+        out_.precision(precision_);
+    }
+
+    FormatScope(const FormatScope&) = delete;
+    FormatScope& operator=(const FormatScope&) = delete;
+
+private:
+    std::ostream& out_;
+    std::ios::fmtflags flags_;
+    std::streamsize precision_;
+};
+
+/**
+ * @brief Serialization formats supported by result sinks.
+ */
+enum class OutputFormat {
+    JSON,    // Single JSON document (streamed array of result objects)
+    NDJSON,  // Newline-delimited JSON, one compact result object per line
+    CSV,     // Header row followed by one row per result
+    BINARY   // Little-endian binary records preceded by a schema header
+};
+
+/**
+ * @brief Parse an output format name.
+ *
+ * Accepted names (case-sensitive): "json", "ndjson", "csv", "binary".
+ *
+ * @param name Format name
+ * @return Corresponding OutputFormat
+ * @throws std::invalid_argument if the name is not recognized
+ */
+inline OutputFormat parseOutputFormat(const std::string& name) {
+    if (name == "json") {
+        return OutputFormat::JSON;
+    }
+    if (name == "ndjson") {
+        return OutputFormat::NDJSON;
+    }
+    if (name == "csv") {
+        return OutputFormat::CSV;
+    }
+    if (name == "binary") {
+        return OutputFormat::BINARY;
+    }
+    throw std::invalid_argument("Unknown output format: " + name +
+                                " (expected json, ndjson, csv or binary)");
+}
+
+/**
+ * @brief Get the canonical name of an output format.
+ * @param format Output format
+ * @return Format name as accepted by parseOutputFormat()
+ */
+inline std::string outputFormatName(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::JSON:
+            return "json";
+        case OutputFormat::NDJSON:
+            return "ndjson";
+        case OutputFormat::CSV:
+            return "csv";
+        case OutputFormat::BINARY:
+            return "binary";
+    }
+    return "json";
+}
+
+/**
+ * @brief Escape a string for inclusion in a JSON document.
+ * @param value Raw string
+ * @return Escaped string (without surrounding quotes)
+ */
+inline std::string escapeJSON(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    std::ostringstream oss;
+                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(c);
+                    escaped += oss.str();
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief Write a number as a JSON value.
+ *
+ * JSON has no NaN or infinity, so non-finite values are written as null.
+ *
+ * @param out Destination stream
+ * @param value Value to write
+ */
+inline void writeJSONNumber(std::ostream& out, double value) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+/**
+ * @brief Write a result as a single-line JSON object.
+ *
+ * Numbers use the stream's current formatting; non-finite numbers are written
+ * as null. The "id" member is omitted when id is empty.
+ *
+ * @param out Destination stream
+ * @param result Result to write
+ * @param id Optional record id
+ */
+inline void writeCompactJSON(std::ostream& out, const MarkowitzResult& result,
+                             const std::string& id = "") {
+    out << "{";
+    if (!id.empty()) {
+        out << "\"id\":\"" << escapeJSON(id) << "\",";
+    }
+    out << "\"converged\":" << (result.converged ? "true" : "false") << ",";
+    out << "\"message\":\"" << escapeJSON(result.message) << "\",";
+    out << "\"expectedReturn\":";
+    writeJSONNumber(out, result.expectedReturn);
+    out << ",\"risk\":";
+    writeJSONNumber(out, result.risk);
+    out << ",\"sharpeRatio\":";
+    writeJSONNumber(out, result.sharpeRatio);
+    out << ",\"weights\":[";
+    for (size_t i = 0; i < result.weights.size(); ++i) {
+        if (i > 0) {
+            out << ",";
+        }
+        writeJSONNumber(out, result.weights[i]);
+    }
+    out << "]}";
+}
+
+/**
+ * @brief Options shared by all result sinks.
+ */
+struct SinkOptions {
+    std::vector<std::string> assetLabels;  // Optional asset labels (CSV header, schema header)
+    bool includeIds = false;               // Emit an "id" column in CSV output
+    bool flushEachRecord = false;          // Flush the stream after every record
+};
+
+/**
+ * @brief Abstract destination for a stream of optimization results.
+ *
+ * A sink receives results one at a time and serializes each record as soon as
+ * it is written, so producers never need to hold a full batch or frontier in
+ * memory. Call finish() once after the last record to close any enclosing
+ * document structure and flush the underlying stream.
+ *
+ * Text sinks write numbers in fixed notation with 8 decimals. The stream's
+ * own formatting is set only for the duration of write() and finish() and is
+ * restored afterwards, so sinks can share std::cout with other output.
+ *
+ * Sinks are not thread-safe; producers running on several threads must
+ * serialize calls to write().
+ *
+ * Example:
+ *   std::ofstream out("results.ndjson");
+ *   auto sink = makeResultSink(OutputFormat::NDJSON, out);
+ *   sink->write(optimizer.minimumVariance(), "job-1");
+ *   sink->finish();
+ */
+class ResultSink {
+public:
+    /**
+     * @brief Construct a sink writing to a stream.
+     * @param out Destination stream (must outlive the sink)
+     * @param options Sink options
+     */
+    explicit ResultSink(std::ostream& out, SinkOptions options = {})
+        : out_(out), options_(std::move(options)), count_(0), finished_(false) {}
+
+    /**
+     * @brief Virtual destructor for proper cleanup of derived classes.
+     */
+    virtual ~ResultSink() = default;
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    /**
+     * @brief Serialize one result.
+     * @param result Optimization result
+     * @param id Optional record identifier (job id, frontier index, ...)
+     * @throws std::logic_error if called after finish()
+     * @throws std::runtime_error if the underlying stream fails
+     */
+    void write(const MarkowitzResult& result, const std::string& id = "") {
+        if (finished_) {
+            throw std::logic_error("Cannot write to a finished result sink");
+        }
+        ORBAT_TRACE_SPAN("ResultSink::write", "serialize");
+        {
+            FormatScope scope(out_);
+            writeRecord(result, id);
+        }
+        ++count_;
+        if (options_.flushEachRecord) {
+            out_.flush();
+        }
+        if (!out_) {
+            throw std::runtime_error("Failed to write result record");
+        }
+    }
+
+    /**
+     * @brief Close the output document and flush the stream.
+     *
+     * Calling finish() more than once has no further effect.
+     */
+    void finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        {
+            FormatScope scope(out_);
+            writeTrailer();
+        }
+        out_.flush();
+    }
+
+    /**
+     * @brief Get the number of records written so far.
+     * @return Record count
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Get the serialization format of this sink.
+     * @return Output format
+     */
+    virtual OutputFormat format() const = 0;
+
+protected:
+    std::ostream& out_;
+    SinkOptions options_;
+
+    /**
+     * @brief Serialize a single record to out_.
+     */
+    virtual void writeRecord(const MarkowitzResult& result, const std::string& id) = 0;
+
+    /**
+     * @brief Write any closing structure after the last record.
+     */
+    virtual void writeTrailer() {}
+
+    /**
+     * @brief Write a result as a single-line JSON object.
+     */
+    void writeCompactJSON(const MarkowitzResult& result, const std::string& id) {
+        optimizer::writeCompactJSON(out_, result, id);
+    }
+
+private:
+    size_t count_;
+    bool finished_;
+};
+
+/**
+ * @brief Newline-delimited JSON sink.
+ *
+ * Each record is a compact JSON object terminated by '\n', suitable for
+ * line-oriented streaming consumers (jq, Kafka producers, log shippers).
+ *
+ * Example output:
+ *   {"id":"job-1","converged":true,"message":"...","expectedReturn":0.1,...}
+ *   {"id":"job-2","converged":true,"message":"...","expectedReturn":0.2,...}
+ */
+class NdjsonResultSink : public ResultSink {
+public:
+    explicit NdjsonResultSink(std::ostream& out, SinkOptions options = {})
+        : ResultSink(out, std::move(options)) {}
+
+    OutputFormat format() const override { return OutputFormat::NDJSON; }
+
+protected:
+    void writeRecord(const MarkowitzResult& result, const std::string& id) override {
+        writeCompactJSON(result, id);
+        out_ << "\n";
+    }
+};
+
+/**
+ * @brief Streaming JSON document sink.
+ *
+ * Produces a single JSON object whose results array is written incrementally:
+ * {
+ *   "assets": ["A", "B"],
+ *   "results": [
+ *     {"converged":true,...},
+ *     {"converged":true,...}
+ *   ]
+ * }
+ *
+ * The "assets" key is present only when asset labels are supplied. The name of
+ * the results array can be changed (the frontier exporter uses "frontier").
+ */
+class JsonResultSink : public ResultSink {
+public:
+    explicit JsonResultSink(std::ostream& out, SinkOptions options = {},
+                            std::string arrayKey = "results")
+        : ResultSink(out, std::move(options)), arrayKey_(std::move(arrayKey)), headerDone_(false) {}
+
+    OutputFormat format() const override { return OutputFormat::JSON; }
+
+protected:
+    void writeRecord(const MarkowitzResult& result, const std::string& id) override {
+        if (!headerDone_) {
+            writeHeader();
+        } else {
+            out_ << ",\n";
+        }
+        out_ << "    ";
+        writeCompactJSON(result, id);
+    }
+
+    void writeTrailer() override {
+        if (!headerDone_) {
+            writeHeader();
+            out_ << "]\n}\n";
+            return;
+        }
+        out_ << "\n  ]\n}\n";
+    }
+
+private:
+    std::string arrayKey_;
+    bool headerDone_;
+
+    void writeHeader() {
+        headerDone_ = true;
+        out_ << "{\n";
+        if (!options_.assetLabels.empty()) {
+            out_ << "  \"assets\": [";
+            for (size_t i = 0; i < options_.assetLabels.size(); ++i) {
+                if (i > 0) {
+                    out_ << ", ";
+                }
+                out_ << "\"" << escapeJSON(options_.assetLabels[i]) << "\"";
+            }
+            out_ << "],\n";
+        }
+        out_ << "  \"" << escapeJSON(arrayKey_) << "\": [";
+        if (count() == 0) {
+            out_ << "\n";
+        }
+    }
+};
+
+/**
+ * @brief CSV sink.
+ *
+ * The header row is written with the first record and uses that record's
+ * number of weights. Columns follow MarkowitzResult::toCSV():
+ *   [id,]converged,message,expectedReturn,risk,sharpeRatio,weight_0,...
+ *
+ * Weight columns are named after the asset labels when they are provided.
+ */
+class CsvResultSink : public ResultSink {
+public:
+    explicit CsvResultSink(std::ostream& out, SinkOptions options = {})
+        : ResultSink(out, std::move(options)), headerDone_(false) {}
+
+    OutputFormat format() const override { return OutputFormat::CSV; }
+
+protected:
+    void writeRecord(const MarkowitzResult& result, const std::string& id) override {
+        if (!headerDone_) {
+            writeHeader(result.weights.size());
+        }
+        if (options_.includeIds) {
+            out_ << quote(id) << ",";
+        }
+        out_ << (result.converged ? "true" : "false") << ",";
+        out_ << quote(result.message) << ",";
+        out_ << result.expectedReturn << "," << result.risk << "," << result.sharpeRatio;
+        for (size_t i = 0; i < result.weights.size(); ++i) {
+            out_ << "," << result.weights[i];
+        }
+        out_ << "\n";
+    }
+
+private:
+    bool headerDone_;
+
+    void writeHeader(size_t numAssets) {
+        headerDone_ = true;
+        if (options_.includeIds) {
+            out_ << "id,";
+        }
+        out_ << "converged,message,expectedReturn,risk,sharpeRatio";
+        for (size_t i = 0; i < numAssets; ++i) {
+            out_ << ",";
+            if (i < options_.assetLabels.size() && !options_.assetLabels[i].empty()) {
+                out_ << quote(options_.assetLabels[i]);
+            } else {
+                out_ << "weight_" << i;
+            }
+        }
+        out_ << "\n";
+    }
+
+    static std::string quote(const std::string& value) {
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') {
+                quoted += '"';
+            }
+            quoted += c;
+        }
+        quoted += "\"";
+        return quoted;
+    }
+};
+
+/**
+ * @brief Field type codes used in the binary schema header.
+ */
+enum class BinaryFieldType : uint8_t {
+    BOOL = 1,          // 1 byte, 0 or 1
+    FLOAT64 = 2,       // IEEE-754 double, little-endian
+    STRING = 3,        // uint16 byte length + UTF-8 bytes
+    FLOAT64_ARRAY = 4  // uint32 element count + doubles, little-endian
+};
+
+/**
+ * @brief Constants describing the binary result format.
+ *
+ * Layout (all integers and doubles little-endian):
+ *
+ *   Header:
+ *     char[4]  magic "ORBR"
+ *     uint16   format version (currently 1)
+ *     uint16   field count F
+ *     F x { uint8 type, uint16 name length, name bytes }
+ *     uint32   label count L
+ *     L x { uint16 length, bytes }
+ *
+ *   Record (repeated until end of stream):
+ *     uint32   payload length in bytes (allows readers to skip records)
+ *     fields in schema order:
+ *       id (STRING), converged (BOOL), expectedReturn (FLOAT64), risk (FLOAT64),
+ *       sharpeRatio (FLOAT64), weights (FLOAT64_ARRAY), message (STRING)
+ */
+struct BinaryResultFormat {
+    static constexpr char MAGIC[4] = {'O', 'R', 'B', 'R'};
+    static constexpr uint16_t VERSION = 1;
+
+    /**
+     * @brief Get the schema fields written by this version of the format.
+     * @return Field name and type pairs in record order
+     */
+    static std::vector<std::pair<std::string, BinaryFieldType>> fields() {
+        return {{"id", BinaryFieldType::STRING},
+                {"converged", BinaryFieldType::BOOL},
+                {"expectedReturn", BinaryFieldType::FLOAT64},
+                {"risk", BinaryFieldType::FLOAT64},
+                {"sharpeRatio", BinaryFieldType::FLOAT64},
+                {"weights", BinaryFieldType::FLOAT64_ARRAY},
+                {"message", BinaryFieldType::STRING}};
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Append an unsigned integer to a byte buffer in little-endian order.
+ */
+inline void appendLE(std::string& buffer, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Append a double to a byte buffer in little-endian order.
+ */
+inline void appendDoubleLE(std::string& buffer, double value) {
+    appendLE(buffer, std::bit_cast<uint64_t>(value), 8);
+}
+
+/**
+ * @brief Append a length-prefixed (uint16) string to a byte buffer.
+ * @throws std::invalid_argument if the string exceeds 65535 bytes
+ */
+inline void appendString(std::string& buffer, const std::string& value) {
+    if (value.size() > 0xFFFF) {
+        throw std::invalid_argument("String too long for binary result format");
+    }
+    appendLE(buffer, value.size(), 2);
+    buffer += value;
+}
+
+/**
+ * @brief Decode a little-endian unsigned integer from raw bytes.
+ */
+inline uint64_t decodeLE(const char* bytes, size_t count) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Compact little-endian binary sink.
+ *
+ * Writes a self-describing schema header followed by length-prefixed records
+ * (see BinaryResultFormat). Doubles are stored bit-exactly, so no precision is
+ * lost and downstream readers avoid text parsing entirely. Use
+ * BinaryResultReader to decode the stream.
+ */
+class BinaryResultSink : public ResultSink {
+public:
+    explicit BinaryResultSink(std::ostream& out, SinkOptions options = {})
+        : ResultSink(out, std::move(options)) {
+        writeHeader();
+    }
+
+    OutputFormat format() const override { return OutputFormat::BINARY; }
+
+protected:
+    void writeRecord(const MarkowitzResult& result, const std::string& id) override {
+        // Reuse the record buffer to avoid an allocation per record
+        record_.clear();
+        detail::appendLE(record_, 0, 4);  // Payload length placeholder
+        detail::appendString(record_, id);
+        detail::appendLE(record_, result.converged ? 1 : 0, 1);
+        detail::appendDoubleLE(record_, result.expectedReturn);
+        detail::appendDoubleLE(record_, result.risk);
+        detail::appendDoubleLE(record_, result.sharpeRatio);
+        detail::appendLE(record_, result.weights.size(), 4);
+        for (size_t i = 0; i < result.weights.size(); ++i) {
+            detail::appendDoubleLE(record_, result.weights[i]);
+        }
+        detail::appendString(record_, result.message);
+
+        uint64_t payload = record_.size() - 4;
+        for (size_t i = 0; i < 4; ++i) {
+            record_[i] = static_cast<char>((payload >> (8 * i)) & 0xFF);
+        }
+        out_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+    }
+
+private:
+    std::string record_;
+
+    void writeHeader() {
+        std::string header(BinaryResultFormat::MAGIC, 4);
+        detail::appendLE(header, BinaryResultFormat::VERSION, 2);
+        auto fields = BinaryResultFormat::fields();
+        detail::appendLE(header, fields.size(), 2);
+        for (const auto& [name, type] : fields) {
+            detail::appendLE(header, static_cast<uint8_t>(type), 1);
+            detail::appendString(header, name);
+        }
+        detail::appendLE(header, options_.assetLabels.size(), 4);
+        for (const auto& label : options_.assetLabels) {
+            detail::appendString(header, label);
+        }
+        out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+};
+
+/**
+ * @brief A record decoded from the binary result format.
+ */
+struct BinaryResultRecord {
+    std::string id;          // Record identifier (may be empty)
+    MarkowitzResult result;  // Decoded optimization result
+};
+
+/**
+ * @brief Reader for streams produced by BinaryResultSink.
+ *
+ * Example:
+ *   std::ifstream in("results.bin", std::ios::binary);
+ *   BinaryResultReader reader(in);
+ *   BinaryResultRecord record;
+ *   while (reader.next(record)) {
+ *       std::cout << record.id << ": " << record.result.risk << std::endl;
+ *   }
+ */
+class BinaryResultReader {
+public:
+    /**
+     * @brief Construct a reader and parse the schema header.
+     * @param in Input stream positioned at the start of the header
+     * @throws std::runtime_error if the header is missing, malformed or of an
+     *         unsupported version/schema
+     */
+    explicit BinaryResultReader(std::istream& in) : in_(in) { readHeader(); }
+
+    /**
+     * @brief Get asset labels stored in the header.
+     * @return Asset labels (empty if none were written)
+     */
+    const std::vector<std::string>& assetLabels() const { return labels_; }
+
+    /**
+     * @brief Read the next record.
+     * @param record Destination record
+     * @return true if a record was read, false at end of stream
+     * @throws std::runtime_error if a record is truncated or malformed
+     */
+    bool next(BinaryResultRecord& record) {
+        char lengthBytes[4];
+        in_.read(lengthBytes, 4);
+        if (in_.gcount() == 0) {
+            return false;
+        }
+        if (in_.gcount() != 4) {
+            throw std::runtime_error("Truncated binary result record");
+        }
+        // Grow the buffer as bytes arrive, so a corrupt length cannot
+        // allocate more than the stream holds
+        size_t length = detail::decodeLE(lengthBytes, 4);
+        buffer_.clear();
+        while (buffer_.size() < length) {
+            size_t offset = buffer_.size();
+            size_t chunk = std::min(length - offset, READ_CHUNK_BYTES);
+            buffer_.resize(offset + chunk);
+            in_.read(buffer_.data() + offset, static_cast<std::streamsize>(chunk));
+            if (static_cast<size_t>(in_.gcount()) != chunk) {
+                throw std::runtime_error("Truncated binary result record");
+            }
+        }
+
+        size_t pos = 0;
+        record.id = readString(pos);
+        record.result.converged = take(pos, 1)[0] != 0;
+        record.result.expectedReturn = readDouble(pos);
+        record.result.risk = readDouble(pos);
+        record.result.sharpeRatio = readDouble(pos);
+        size_t numWeights = detail::decodeLE(take(pos, 4), 4);
+        if (numWeights > (buffer_.size() - pos) / 8) {
+            throw std::runtime_error("Malformed binary result record");
+        }
+        std::vector<double> weights(numWeights);
+        for (size_t i = 0; i < numWeights; ++i) {
+            weights[i] = readDouble(pos);
+        }
+        record.result.weights = core::Vector(std::move(weights));
+        record.result.message = readString(pos);
+        return true;
+    }
+
+private:
+    static constexpr size_t READ_CHUNK_BYTES = 64 * 1024;
+
+    std::istream& in_;
+    std::vector<std::string> labels_;
+    std::vector<char> buffer_;
+
+    const char* take(size_t& pos, size_t bytes) {
+        if (pos + bytes > buffer_.size()) {
+            throw std::runtime_error("Malformed binary result record");
+        }
+        const char* data = buffer_.data() + pos;
+        pos += bytes;
+        return data;
+    }
+
+    double readDouble(size_t& pos) {
+        return std::bit_cast<double>(detail::decodeLE(take(pos, 8), 8));
+    }
+
+    std::string readString(size_t& pos) {
+        size_t length = detail::decodeLE(take(pos, 2), 2);
+        return std::string(take(pos, length), length);
+    }
+
+    uint64_t readStreamLE(size_t bytes) {
+        char raw[8];
+        in_.read(raw, static_cast<std::streamsize>(bytes));
+        if (static_cast<size_t>(in_.gcount()) != bytes) {
+            throw std::runtime_error("Truncated binary result header");
+        }
+        return detail::decodeLE(raw, bytes);
+    }
+
+    std::string readStreamString() {
+        size_t length = readStreamLE(2);
+        std::string value(length, '\0');
+        in_.read(value.data(), static_cast<std::streamsize>(length));
+        if (static_cast<size_t>(in_.gcount()) != length) {
+            throw std::runtime_error("Truncated binary result header");
+        }
+        return value;
+    }
+
+    void readHeader() {
+        char magic[4];
+        in_.read(magic, 4);
+        if (in_.gcount() != 4 || std::memcmp(magic, BinaryResultFormat::MAGIC, 4) != 0) {
+            throw std::runtime_error("Not an orbat binary result stream (bad magic)");
+        }
+        if (readStreamLE(2) != BinaryResultFormat::VERSION) {
+            throw std::runtime_error("Unsupported binary result format version");
+        }
+
+        auto expected = BinaryResultFormat::fields();
+        size_t numFields = readStreamLE(2);
+        if (numFields != expected.size()) {
+            throw std::runtime_error("Unexpected binary result schema");
+        }
+        for (size_t i = 0; i < numFields; ++i) {
+            auto type = static_cast<BinaryFieldType>(readStreamLE(1));
+            std::string name = readStreamString();
+            if (name != expected[i].first || type != expected[i].second) {
+                throw std::runtime_error("Unexpected binary result schema field: " + name);
+            }
+        }
+
+        // Grown as labels are read: the count is not trusted to size an allocation
+        size_t numLabels = readStreamLE(4);
+        for (size_t i = 0; i < numLabels; ++i) {
+            labels_.push_back(readStreamString());
+        }
+    }
+};
+
+/**
+ * @brief Create a result sink for the given format.
+ *
+ * @param format Output format
+ * @param out Destination stream (must outlive the sink; open binary streams
+ *        with std::ios::binary)
+ * @param options Sink options
+ * @return Owning pointer to the sink
+ */
+inline std::unique_ptr<ResultSink> makeResultSink(OutputFormat format, std::ostream& out,
+                                                  SinkOptions options = {}) {
+    switch (format) {
+        case OutputFormat::NDJSON:
+            return std::make_unique<NdjsonResultSink>(out, std::move(options));
+        case OutputFormat::CSV:
+            return std::make_unique<CsvResultSink>(out, std::move(options));
+        case OutputFormat::BINARY:
+            return std::make_unique<BinaryResultSink>(out, std::move(options));
+        case OutputFormat::JSON:
+            break;
+    }
+    return std::make_unique<JsonResultSink>(out, std::move(options));
+}
+
+/**
+ * @brief Destination for serialized output: a named file or stdout.
+ *
+ * The path "-" selects stdout, which allows piping results directly into
+ * downstream tools. Files are opened in binary mode so that binary output is
+ * written byte-exactly on every platform.
+ *
+ * Example:
+ *   OutputTarget target("-");  // stdout
+ *   auto sink = makeResultSink(OutputFormat::NDJSON, target.stream());
+ */
+class OutputTarget {
+public:
+    /**
+     * @brief Open an output target.
+     * @param path File path, or "-" for stdout
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit OutputTarget(const std::string& path) : path_(path), useStdout_(path == "-") {
+        if (!useStdout_) {
+            file_.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!file_.is_open()) {
+                throw std::runtime_error("Cannot open output file: " + path);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the stream to write to.
+     * @return Output stream
+     */
+    std::ostream& stream() { return useStdout_ ? std::cout : file_; }
+
+    /**
+     * @brief Check whether this target writes to stdout.
+     * @return true for stdout
+     */
+    bool isStdout() const { return useStdout_; }
+
+    /**
+     * @brief Get the path this target was opened with.
+     * @return Path ("-" for stdout)
+     */
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    bool useStdout_;
+    std::ofstream file_;
+};
+
+}  // namespace optimizer
+}  // namespace orbat
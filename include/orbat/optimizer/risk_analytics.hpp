@@ -0,0 +1,378 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/constants.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/sobol.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/monte_carlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Value at Risk and Expected Shortfall at one confidence level.
+ *
+ * Both are losses, reported as positive numbers in return units: a VaR of
+ * 0.03 at 99% means returns below -3% happen in 1% of periods.
+ */
+struct RiskEstimate {
+    double confidence;         // Confidence level α, e.g. 0.99
+    double valueAtRisk;        // VaR: loss exceeded with probability 1 - α
+    double expectedShortfall;  // ES (CVaR): average loss in the worst 1 - α of outcomes
+};
+
+/**
+ * @brief Risk of one portfolio at each requested confidence level.
+ */
+struct PortfolioRisk {
+    double mean = 0.0;        // Mean return
+    double volatility = 0.0;  // Standard deviation of the return
+    size_t observations = 0;  // Scenarios or periods used (0 for parametric estimates)
+    std::vector<RiskEstimate> estimates;  // One per confidence level, in the options' order
+
+    /**
+     * @brief Get the VaR at a confidence level.
+     * @throws std::out_of_range if the level was not requested
+     */
+    double valueAtRisk(double confidence) const { return at(confidence).valueAtRisk; }
+
+    /**
+     * @brief Get the Expected Shortfall at a confidence level.
+     * @throws std::out_of_range if the level was not requested
+     */
+    double expectedShortfall(double confidence) const {
+        return at(confidence).expectedShortfall;
+    }
+
+private:
+    const RiskEstimate& at(double confidence) const {
+        for (const RiskEstimate& estimate : estimates) {
+            if (std::abs(estimate.confidence - confidence) < core::EPSILON) {
+                return estimate;
+            }
+        }
+        throw std::out_of_range("Confidence level was not computed");
+    }
+};
+
+/**
+ * @brief Options for risk analytics.
+ */
+struct RiskOptions {
+    std::vector<double> confidenceLevels = {0.95, 0.99};  // Each in (0, 1)
+    size_t blockSize = 4096;  // Historical periods per matrix product
+};
+
+/**
+ * @brief Value at Risk and Expected Shortfall of many portfolios at once.
+ *
+ * Three estimators, all taking portfolios as the rows of a weight matrix W
+ * (portfolios × assets):
+ *
+ * - parametric(): normal returns with mean W μ and variances diag(W Σ W'),
+ *   from one product W Σ. VaR = σ z_α - μ and ES = σ φ(z_α) / (1 - α) - μ.
+ * - historical(): the empirical distribution of past returns. A block of
+ *   periods H (periods × assets) gives the P&L of every portfolio as one
+ *   product H W'.
+ * - monteCarlo(): the empirical distribution of MonteCarloEngine scenarios,
+ *   whose P&L blocks come from MonteCarloEngine::evaluate().
+ *
+ * The empirical estimators use the k = ⌈N (1 - α)⌉ worst of N outcomes:
+ * VaR is minus the k-th smallest P&L and ES minus the mean of the k
+ * smallest. Outcomes stream through a per-portfolio buffer that keeps only
+ * the worst ⌈N (1 - min α)⌉ seen so far, using std::nth_element when it
+ * fills and a threshold test for everything else, so no P&L vector is
+ * stored or sorted. Memory is O(portfolios · N · (1 - min α)).
+ *
+ * Example:
+ *   RiskAnalytics risk;  // 95% and 99%
+ *   auto parametric = risk.parametric(returns, covariance, portfolios);
+ *   auto historical = risk.historical(pastReturns, portfolios);
+ *   auto simulated = risk.monteCarlo(engine, portfolios, simulationOptions);
+ *   double es99 = historical[0].expectedShortfall(0.99);
+ */
+class RiskAnalytics {
+public:
+    /**
+     * @brief Construct with options.
+     * @param options Confidence levels and block size
+     * @throws std::invalid_argument if a confidence level is not in (0, 1) or blockSize is 0
+     */
+    explicit RiskAnalytics(RiskOptions options = RiskOptions()) : options_(std::move(options)) {
+        if (options_.confidenceLevels.empty()) {
+            throw std::invalid_argument("At least one confidence level is required");
+        }
+        for (double confidence : options_.confidenceLevels) {
+            if (!(confidence > 0.0 && confidence < 1.0)) {
+                throw std::invalid_argument("Confidence levels must be in (0, 1)");
+            }
+        }
+        if (options_.blockSize == 0) {
+            throw std::invalid_argument("Block size must be at least 1");
+        }
+    }
+
+    /**
+     * @brief Parametric (normal) VaR and ES.
+     * @param returns Expected returns μ
+     * @param covariance Covariance matrix Σ
+     * @param portfolios Portfolios × assets matrix of weights
+     * @return Risk per portfolio
+     * @throws std::invalid_argument if the dimensions do not match
+     */
+    std::vector<PortfolioRisk> parametric(const ExpectedReturns& returns,
+                                          const CovarianceMatrix& covariance,
+                                          const core::Matrix& portfolios) const {
+        ORBAT_ALLOCATION_SCOPE("RiskAnalytics::parametric");
+        ORBAT_TRACE_SPAN("RiskAnalytics::parametric", "risk");
+        ORBAT_LATENCY_TIMER("RiskAnalytics::parametric");
+        if (returns.size() != covariance.size()) {
+            throw std::invalid_argument(
+                "Expected returns and covariance matrix dimensions must match");
+        }
+        checkPortfolios(portfolios, covariance.size());
+        const size_t n = covariance.size();
+        const core::Vector means = portfolios * returns.data();
+        core::Matrix weighted;  // W Σ: row i is (Σ w_i)'
+        portfolios.multiplyInto(covariance.data(), weighted);
+
+        std::vector<double> z;
+        std::vector<double> density;  // Standard normal density φ(z_α)
+        for (double confidence : options_.confidenceLevels) {
+            z.push_back(core::inverseNormalCdf(confidence));
+            density.push_back(std::exp(-0.5 * z.back() * z.back()) /
+                              std::sqrt(2.0 * std::numbers::pi));
+        }
+        std::vector<PortfolioRisk> risks(portfolios.rows());
+        for (size_t i = 0; i < portfolios.rows(); ++i) {
+            const double* w = portfolios.data().data() + i * n;
+            const double* sw = weighted.data().data() + i * n;
+            double variance = std::inner_product(w, w + n, sw, 0.0);
+            PortfolioRisk& risk = risks[i];
+            risk.mean = means[i];
+            risk.volatility = std::sqrt(std::max(variance, 0.0));
+            for (size_t l = 0; l < z.size(); ++l) {
+                const double alpha = options_.confidenceLevels[l];
+                risk.estimates.push_back(
+                    {alpha, risk.volatility * z[l] - risk.mean,
+                     risk.volatility * density[l] / (1.0 - alpha) - risk.mean});
+            }
+        }
+        return risks;
+    }
+
+    /**
+     * @brief Parametric (normal) VaR and ES of one portfolio.
+     */
+    PortfolioRisk parametric(const ExpectedReturns& returns, const CovarianceMatrix& covariance,
+                             const core::Vector& weights) const {
+        return parametric(returns, covariance, asMatrix(weights)).front();
+    }
+
+    /**
+     * @brief Historical VaR and ES.
+     * @param history Periods × assets matrix of past returns
+     * @param portfolios Portfolios × assets matrix of weights
+     * @return Risk per portfolio
+     * @throws std::invalid_argument if history is empty, the dimensions do not match or
+     *         a portfolio's P&L is not finite
+     */
+    std::vector<PortfolioRisk> historical(const core::Matrix& history,
+                                          const core::Matrix& portfolios) const {
+        ORBAT_ALLOCATION_SCOPE("RiskAnalytics::historical");
+        ORBAT_TRACE_SPAN("RiskAnalytics::historical", "risk");
+        ORBAT_LATENCY_TIMER("RiskAnalytics::historical");
+        if (history.rows() == 0) {
+            throw std::invalid_argument("Return history must have at least one period");
+        }
+        checkPortfolios(portfolios, history.cols());
+        const size_t n = history.cols();
+        const size_t periods = history.rows();
+        const core::Matrix weightsT = portfolios.transpose();
+        Accumulator accumulator(options_.confidenceLevels, periods, portfolios.rows());
+        core::Matrix block;
+        core::Matrix pnl;
+        if (periods <= options_.blockSize) {
+            history.multiplyInto(weightsT, pnl);  // One block: no copy
+            accumulator.add(pnl);
+            return accumulator.finish();
+        }
+        for (size_t first = 0; first < periods; first += options_.blockSize) {
+            const size_t rows = std::min(options_.blockSize, periods - first);
+            block.resize(rows, n);
+            std::copy_n(history.data().begin() + static_cast<std::ptrdiff_t>(first * n),
+                        rows * n, block.data().begin());
+            block.multiplyInto(weightsT, pnl);  // H W'
+            accumulator.add(pnl);
+        }
+        return accumulator.finish();
+    }
+
+    /**
+     * @brief Historical VaR and ES of one portfolio.
+     */
+    PortfolioRisk historical(const core::Matrix& history, const core::Vector& weights) const {
+        return historical(history, asMatrix(weights)).front();
+    }
+
+    /**
+     * @brief Monte Carlo VaR and ES over simulated scenarios.
+     * @param engine Scenario engine
+     * @param portfolios Portfolios × assets matrix of weights
+     * @param simulation Simulation options (scenario count, distribution, sampling, threads)
+     * @return Risk per portfolio
+     * @throws std::invalid_argument if the options or dimensions are invalid or a
+     *         portfolio's P&L is not finite
+     */
+    std::vector<PortfolioRisk> monteCarlo(const MonteCarloEngine& engine,
+                                          const core::Matrix& portfolios,
+                                          const SimulationOptions& simulation) const {
+        ORBAT_ALLOCATION_SCOPE("RiskAnalytics::monteCarlo");
+        ORBAT_TRACE_SPAN("RiskAnalytics::monteCarlo", "risk");
+        ORBAT_LATENCY_TIMER("RiskAnalytics::monteCarlo");
+        checkPortfolios(portfolios, engine.size());
+        Accumulator accumulator(options_.confidenceLevels, simulation.scenarios,
+                                portfolios.rows());
+        engine.evaluate(portfolios, simulation,
+                        [&accumulator](size_t, const core::Matrix& pnl) { accumulator.add(pnl); });
+        return accumulator.finish();
+    }
+
+    /**
+     * @brief Monte Carlo VaR and ES of one portfolio.
+     */
+    PortfolioRisk monteCarlo(const MonteCarloEngine& engine, const core::Vector& weights,
+                             const SimulationOptions& simulation) const {
+        return monteCarlo(engine, asMatrix(weights), simulation).front();
+    }
+
+    /**
+     * @brief Get the options.
+     */
+    const RiskOptions& options() const { return options_; }
+
+private:
+    RiskOptions options_;
+
+    /**
+     * @brief Streams blocks of P&L (outcomes × portfolios) into per-portfolio
+     * summaries and worst-outcome buffers.
+     */
+    class Accumulator {
+    public:
+        Accumulator(const std::vector<double>& levels, size_t outcomes, size_t portfolios)
+            : levels_(levels), stats_(portfolios), tails_(portfolios),
+              thresholds_(portfolios, std::numeric_limits<double>::infinity()) {
+            for (double confidence : levels_) {
+                counts_.push_back(tailCount(confidence, outcomes));
+                keep_ = std::max(keep_, counts_.back());
+            }
+            for (auto& tail : tails_) {
+                tail.reserve(2 * keep_);
+            }
+        }
+
+        void add(const core::Matrix& pnl) {
+            const size_t p = stats_.size();
+            const double* row = pnl.data().data();
+            for (size_t s = 0; s < pnl.rows(); ++s, row += p) {
+                for (size_t j = 0; j < p; ++j) {
+                    // NaN never enters the tail, which would leave it short of k
+                    if (!std::isfinite(row[j])) {
+                        throw std::invalid_argument("Portfolio P&L outcomes must be finite");
+                    }
+                    stats_[j].add(row[j]);
+                    if (row[j] < thresholds_[j]) {
+                        tails_[j].push_back(row[j]);
+                        if (tails_[j].size() == 2 * keep_) {
+                            compact(j);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<PortfolioRisk> finish() {
+            // Largest tail first, so each selection only searches the previous tail
+            std::vector<size_t> order(levels_.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(),
+                      [&](size_t a, size_t b) { return counts_[a] > counts_[b]; });
+
+            std::vector<PortfolioRisk> risks(stats_.size());
+            for (size_t j = 0; j < stats_.size(); ++j) {
+                PortfolioRisk& risk = risks[j];
+                risk.mean = stats_[j].mean();
+                risk.volatility = stats_[j].stddev();
+                risk.observations = stats_[j].count();
+                risk.estimates.resize(levels_.size());
+                std::vector<double>& tail = tails_[j];
+                auto end = tail.end();
+                for (size_t l : order) {
+                    const size_t k = counts_[l];
+                    auto kth = tail.begin() + static_cast<std::ptrdiff_t>(k - 1);
+                    std::nth_element(tail.begin(), kth, end);
+                    end = tail.begin() + static_cast<std::ptrdiff_t>(k);
+                    double sum = std::accumulate(tail.begin(), end, 0.0);
+                    risk.estimates[l] = {levels_[l], -tail[k - 1],
+                                         -sum / static_cast<double>(k)};
+                }
+            }
+            return risks;
+        }
+
+    private:
+        const std::vector<double>& levels_;
+        std::vector<size_t> counts_;  // Tail size k per level
+        size_t keep_ = 1;             // Largest k
+        std::vector<PnLStatistics> stats_;
+        std::vector<std::vector<double>> tails_;  // Worst outcomes so far, unordered
+        std::vector<double> thresholds_;  // Outcomes at or above this cannot enter the tail
+
+        // Keep the keep_ smallest; anything not below the largest of them is out
+        void compact(size_t j) {
+            std::vector<double>& tail = tails_[j];
+            auto kth = tail.begin() + static_cast<std::ptrdiff_t>(keep_ - 1);
+            std::nth_element(tail.begin(), kth, tail.end());
+            thresholds_[j] = *kth;
+            tail.resize(keep_);
+        }
+
+        // k = ⌈N (1 - α)⌉, at least 1; the tolerance keeps e.g. 0.05 · 1000 at 50
+        static size_t tailCount(double confidence, size_t outcomes) {
+            double tail = (1.0 - confidence) * static_cast<double>(outcomes);
+            size_t k = static_cast<size_t>(std::ceil(tail * (1.0 - 1e-12)));
+            return std::max<size_t>(1, std::min(k, outcomes));
+        }
+    };
+
+    static void checkPortfolios(const core::Matrix& portfolios, size_t assets) {
+        if (portfolios.rows() == 0 || portfolios.cols() != assets) {
+            throw std::invalid_argument("Portfolio weights must have one column per asset");
+        }
+    }
+
+    static core::Matrix asMatrix(const core::Vector& weights) {
+        core::Matrix portfolios(1, weights.size());
+        portfolios.setRow(0, weights);
+        return portfolios;
+    }
+};
+
+}  // namespace optimizer
+}  // namespace orbat
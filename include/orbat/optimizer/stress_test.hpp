@@ -0,0 +1,420 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Options for stress tests.
+ */
+struct StressTestOptions {
+    size_t threads = 0;      // Worker threads (0 = hardware concurrency, 1 = caller's thread)
+    size_t blockSize = 256;  // Portfolios per parallel task
+};
+
+/**
+ * @brief Returns of many portfolios under every scenario.
+ */
+struct StressTestResult {
+    std::vector<std::string> scenarios{};  // Scenario names, in the order they were added
+    core::Matrix returns{};                // Portfolios × scenarios matrix of returns w's
+
+    /**
+     * @brief Get the number of portfolios.
+     */
+    size_t portfolios() const { return returns.rows(); }
+
+    /**
+     * @brief Get the scenario with the lowest return for a portfolio.
+     * @throws std::out_of_range if the portfolio does not exist
+     */
+    size_t worstScenario(size_t portfolio) const {
+        if (portfolio >= returns.rows() || returns.cols() == 0) {
+            throw std::out_of_range("Portfolio index out of range");
+        }
+        const double* row = returns.data().data() + portfolio * returns.cols();
+        return static_cast<size_t>(std::min_element(row, row + returns.cols()) - row);
+    }
+
+    /**
+     * @brief Get the largest loss of a portfolio over all scenarios.
+     *
+     * Reported as a positive number in return units, like VaR.
+     *
+     * @throws std::out_of_range if the portfolio does not exist
+     */
+    double worstLoss(size_t portfolio) const {
+        return -returns(portfolio, worstScenario(portfolio));
+    }
+};
+
+/**
+ * @brief Historical and hypothetical stress tests of many portfolios.
+ *
+ * A scenario is a vector s of simultaneous asset returns, and a portfolio
+ * w returns w's under it. Scenarios come from three sources:
+ *
+ * - addScenario(): a vector given outright, such as a desk's hypothetical shock;
+ * - addHistoricalScenario(): the compounded returns of a period of history,
+ *   Π(1 + r_t) - 1 per asset, such as the autumn of 2008;
+ * - addFactorScenario(): shocks to a few variables only, such as a rate
+ *   proxy falling 2%. The other variables move by their conditional
+ *   expectation given the shocks under a joint normal model,
+ *
+ *     s_u = Σ_us Σ_ss⁻¹ s_s,
+ *
+ *   where s indexes the shocked variables and u the rest.
+ *
+ * Factors are variables of the covariance matrix. A factor that is not an
+ * asset of the portfolios, such as a rate, can be added to Σ as an extra
+ * variable that every portfolio holds with weight zero.
+ *
+ * The regression matrix Σ_us Σ_ss⁻¹ depends only on which variables are
+ * shocked. It is cached for each set of shocked variables, so a family of
+ * scenarios that shock the same factors by different amounts costs one
+ * O(nk² + k³) partition and one O(nk) product per scenario.
+ *
+ * evaluate() computes all returns as one product W S' of the portfolios ×
+ * assets weight matrix and the scenarios × assets shock matrix. The product
+ * is blocked so that a tile of S' stays in cache while four portfolios at a
+ * time stream through it. Blocks of portfolios run on a thread pool. Each
+ * return still sums its products in asset order, so results match a plain
+ * product and do not depend on the thread count or block size.
+ *
+ * Example:
+ *   StressTestEngine engine(covariance);
+ *   engine.addHistoricalScenario("2008", dailyReturns, lehmanStart, lehmanEnd);
+ *   engine.addFactorScenario("rates +200bp", {bondIndex}, core::Vector({-0.12}));
+ *   StressTestResult result = engine.evaluate(books);  // Books × assets
+ *   double loss = result.worstLoss(0);
+ */
+class StressTestEngine {
+public:
+    /**
+     * @brief Construct an engine without scenarios.
+     * @param covariance Covariance matrix Σ of the variables, used by factor scenarios
+     */
+    explicit StressTestEngine(const CovarianceMatrix& covariance) : covariance_(covariance) {}
+
+    /**
+     * @brief Get the number of variables.
+     */
+    size_t size() const { return covariance_.size(); }
+
+    /**
+     * @brief Get the number of scenarios.
+     */
+    size_t scenarioCount() const { return names_.size(); }
+
+    /**
+     * @brief Get a scenario's name.
+     * @throws std::out_of_range if the scenario does not exist
+     */
+    const std::string& scenarioName(size_t scenario) const { return names_.at(scenario); }
+
+    /**
+     * @brief Get a scenario's return for every variable.
+     * @throws std::out_of_range if the scenario does not exist
+     */
+    const core::Vector& scenarioShocks(size_t scenario) const { return shocks_.at(scenario); }
+
+    /**
+     * @brief Add a scenario given as a return for every variable.
+     * @param name Scenario name
+     * @param shocks Return of each variable
+     * @return Index of the scenario
+     * @throws std::invalid_argument if the vector does not match the covariance matrix
+     */
+    size_t addScenario(const std::string& name, const core::Vector& shocks) {
+        if (shocks.size() != size()) {
+            throw std::invalid_argument("Scenario must have one shock per variable");
+        }
+        for (double shock : shocks.data()) {
+            if (!std::isfinite(shock)) {
+                throw std::invalid_argument("Scenario shocks must be finite");
+            }
+        }
+        names_.push_back(name);
+        shocks_.push_back(shocks);
+        return names_.size() - 1;
+    }
+
+    /**
+     * @brief Add the compounded returns of a period of history as a scenario.
+     * @param name Scenario name
+     * @param history Periods × variables matrix of simple returns, oldest first
+     * @param first First period of the scenario
+     * @param last One past the last period of the scenario
+     * @return Index of the scenario
+     * @throws std::invalid_argument if the history or period is invalid
+     */
+    size_t addHistoricalScenario(const std::string& name, const core::Matrix& history,
+                                 size_t first, size_t last) {
+        if (history.cols() != size()) {
+            throw std::invalid_argument("Return history must have one column per variable");
+        }
+        if (first >= last || last > history.rows()) {
+            throw std::invalid_argument("Scenario period must be a non-empty range of history");
+        }
+        core::Vector growth(size(), 1.0);
+        for (size_t t = first; t < last; ++t) {
+            for (size_t i = 0; i < size(); ++i) {
+                growth[i] *= 1.0 + history(t, i);
+            }
+        }
+        for (size_t i = 0; i < size(); ++i) {
+            growth[i] -= 1.0;
+        }
+        return addScenario(name, growth);
+    }
+
+    /**
+     * @brief Add a scenario that shocks some variables and propagates through Σ.
+     *
+     * The shocked variables take the given returns, and every other variable
+     * its conditional expectation Σ_us Σ_ss⁻¹ s_s.
+     *
+     * @param name Scenario name
+     * @param factors Indices of the shocked variables (distinct)
+     * @param shocks Return of each shocked variable
+     * @return Index of the scenario
+     * @throws std::invalid_argument if the factors or shocks are invalid
+     * @throws std::runtime_error if the factors' covariance is not positive-definite
+     */
+    size_t addFactorScenario(const std::string& name, const std::vector<size_t>& factors,
+                             const core::Vector& shocks) {
+        if (factors.empty() || factors.size() != shocks.size()) {
+            throw std::invalid_argument("Factor scenario needs one shock per factor");
+        }
+        const core::Matrix& beta = partition(factors);
+        const size_t n = size();
+        const size_t k = factors.size();
+        core::Vector full(n);
+        for (size_t i = 0; i < n; ++i) {
+            const double* row = beta.data().data() + i * k;
+            double value = 0.0;
+            for (size_t f = 0; f < k; ++f) {
+                value += row[f] * shocks[f];
+            }
+            full[i] = value;
+        }
+        for (size_t f = 0; f < k; ++f) {
+            full[factors[f]] = shocks[f];  // Exact, not up to rounding
+        }
+        return addScenario(name, full);
+    }
+
+    /**
+     * @brief Get the number of cached covariance partitions.
+     */
+    size_t cachedPartitions() const { return partitions_.size(); }
+
+    /**
+     * @brief Compute the return of every portfolio under every scenario.
+     * @param portfolios Portfolios × variables matrix of weights (one portfolio per row)
+     * @param options Stress test options
+     * @return Returns, one row per portfolio and one column per scenario
+     * @throws std::invalid_argument if the dimensions or options are invalid
+     */
+    StressTestResult evaluate(const core::Matrix& portfolios,
+                              const StressTestOptions& options = {}) const {
+        ORBAT_ALLOCATION_SCOPE("StressTestEngine::evaluate");
+        ORBAT_TRACE_SPAN("StressTestEngine::evaluate", "risk");
+        ORBAT_LATENCY_TIMER("StressTestEngine::evaluate");
+        if (portfolios.rows() == 0 || portfolios.cols() != size()) {
+            throw std::invalid_argument("Portfolio weights must have one column per variable");
+        }
+        if (options.blockSize == 0) {
+            throw std::invalid_argument("Block size must be positive");
+        }
+        const size_t p = portfolios.rows();
+        const size_t n = size();
+        const size_t m = scenarioCount();
+        StressTestResult result{names_, core::Matrix(p, m)};
+        if (m == 0) {
+            return result;
+        }
+
+        // S' is variables × scenarios, so the kernel streams contiguous rows of it
+        core::Matrix shocksT(n, m);
+        for (size_t s = 0; s < m; ++s) {
+            for (size_t i = 0; i < n; ++i) {
+                shocksT(i, s) = shocks_[s][i];
+            }
+        }
+        const size_t numBlocks = (p + options.blockSize - 1) / options.blockSize;
+        auto task = [&](size_t b) {
+            const size_t first = b * options.blockSize;
+            const size_t rows = std::min(options.blockSize, p - first);
+            multiplyBlocked(portfolios.data().data() + first * n, rows, n,
+                            shocksT.data().data(), m, result.returns.data().data() + first * m);
+        };
+
+        size_t threads = options.threads == 0 ? core::ThreadPool::defaultThreadCount()
+                                              : options.threads;
+        if (threads == 1 || numBlocks == 1 || core::ThreadPool::inWorkerThread()) {
+            for (size_t b = 0; b < numBlocks; ++b) {
+                task(b);
+            }
+            return result;
+        }
+        // Blocks write disjoint rows, so only the number in flight is bounded
+        core::ThreadPool pool(std::min(threads, numBlocks));
+        const size_t maxInFlight = 4 * pool.size();
+        std::deque<std::future<void>> inFlight;
+        size_t next = 0;
+        while (next < numBlocks || !inFlight.empty()) {
+            while (next < numBlocks && inFlight.size() < maxInFlight) {
+                size_t b = next++;
+                inFlight.push_back(pool.submit([&task, b] { task(b); }));
+            }
+            // On an exception the pool destructor drains the remaining blocks
+            inFlight.front().get();
+            inFlight.pop_front();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Compute the return of one portfolio under every scenario.
+     * @throws std::invalid_argument if the weights do not match the covariance matrix
+     */
+    core::Vector evaluate(const core::Vector& weights) const {
+        if (weights.size() != size()) {
+            throw std::invalid_argument("Portfolio weights must have one entry per variable");
+        }
+        core::Vector returns(scenarioCount());
+        for (size_t s = 0; s < scenarioCount(); ++s) {
+            returns[s] = weights.dot(shocks_[s]);
+        }
+        return returns;
+    }
+
+private:
+    static constexpr size_t ROW_BLOCK = 4;       // Portfolios sharing each load of S'
+    static constexpr size_t ASSET_BLOCK = 128;   // Rows of S' per tile
+    static constexpr size_t COLUMN_BLOCK = 256;  // Scenarios per tile (256 KB tiles)
+
+    // Regression matrix Σ_·s Σ_ss⁻¹ (variables × factors) for a set of
+    // factors, computed once per set
+    const core::Matrix& partition(const std::vector<size_t>& factors) {
+        auto cached = partitions_.find(factors);
+        if (cached != partitions_.end()) {
+            return cached->second;
+        }
+        const size_t n = size();
+        const size_t k = factors.size();
+        for (size_t f = 0; f < k; ++f) {
+            if (factors[f] >= n) {
+                throw std::invalid_argument("Factor index out of range");
+            }
+            if (std::find(factors.begin(), factors.begin() + f, factors[f]) !=
+                factors.begin() + f) {
+                throw std::invalid_argument("Factors must be distinct");
+            }
+        }
+        core::Matrix factorCovariance(k, k);
+        for (size_t a = 0; a < k; ++a) {
+            for (size_t b = 0; b < k; ++b) {
+                factorCovariance(a, b) = covariance_(factors[a], factors[b]);
+            }
+        }
+        const core::Matrix lower = factorCovariance.cholesky();
+
+        // Row i solves Σ_ss x = Σ_si, by forward then backward substitution
+        core::Matrix beta(n, k);
+        for (size_t i = 0; i < n; ++i) {
+            double* x = beta.data().data() + i * k;
+            for (size_t a = 0; a < k; ++a) {
+                double sum = covariance_(factors[a], i);
+                for (size_t b = 0; b < a; ++b) {
+                    sum -= lower(a, b) * x[b];
+                }
+                x[a] = sum / lower(a, a);
+            }
+            for (size_t a = k; a-- > 0;) {
+                double sum = x[a];
+                for (size_t b = a + 1; b < k; ++b) {
+                    sum -= lower(b, a) * x[b];
+                }
+                x[a] = sum / lower(a, a);
+            }
+        }
+        return partitions_.emplace(factors, std::move(beta)).first->second;
+    }
+
+    // out (rows × m) = w (rows × n) times shocksT (n × m), all row-major. Tiles
+    // of shocksT are reused by every group of ROW_BLOCK portfolios, and each
+    // output still accumulates its products in asset order.
+    static void multiplyBlocked(const double* w, size_t rows, size_t n, const double* shocksT,
+                                size_t m, double* out) {
+        std::fill(out, out + rows * m, 0.0);
+        for (size_t j0 = 0; j0 < m; j0 += COLUMN_BLOCK) {
+            const size_t width = std::min(COLUMN_BLOCK, m - j0);
+            for (size_t k0 = 0; k0 < n; k0 += ASSET_BLOCK) {
+                const size_t k1 = std::min(n, k0 + ASSET_BLOCK);
+                size_t i = 0;
+                for (; i + ROW_BLOCK <= rows; i += ROW_BLOCK) {
+                    const double* w0 = w + i * n;
+                    const double* w1 = w0 + n;
+                    const double* w2 = w1 + n;
+                    const double* w3 = w2 + n;
+                    double* out0 = out + i * m + j0;
+                    double* out1 = out0 + m;
+                    double* out2 = out1 + m;
+                    double* out3 = out2 + m;
+                    for (size_t k = k0; k < k1; ++k) {
+                        const double a0 = w0[k];
+                        const double a1 = w1[k];
+                        const double a2 = w2[k];
+                        const double a3 = w3[k];
+                        const double* row = shocksT + k * m + j0;
+                        for (size_t j = 0; j < width; ++j) {
+                            const double shock = row[j];
+                            out0[j] += a0 * shock;
+                            out1[j] += a1 * shock;
+                            out2[j] += a2 * shock;
+                            out3[j] += a3 * shock;
+                        }
+                    }
+                }
+                for (; i < rows; ++i) {
+                    const double* wi = w + i * n;
+                    double* outI = out + i * m + j0;
+                    for (size_t k = k0; k < k1; ++k) {
+                        const double a = wi[k];
+                        const double* row = shocksT + k * m + j0;
+                        for (size_t j = 0; j < width; ++j) {
+                            outI[j] += a * row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    CovarianceMatrix covariance_;
+    std::vector<std::string> names_;
+    std::vector<core::Vector> shocks_;
+    std::map<std::vector<size_t>, core::Matrix> partitions_;  // Keyed by factor indices, in order
+};
+
+}  // namespace optimizer
+}  // namespace orbat
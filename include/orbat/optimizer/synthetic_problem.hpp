@@ -0,0 +1,270 @@
+#pragma once
+
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/random.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace orbat {
+namespace optimizer {
+
+/**
+ * @brief Parameters of a synthetic optimization problem.
+ */
+struct SyntheticOptions {
+    size_t assets = 100;             // Number of assets
+    size_t factors = 5;              // Risk factors (0 = uncorrelated assets)
+    double conditionNumber = 1e3;    // λmax / λmin of the covariance matrix (> 1)
+    double marketVolatility = 0.16;  // Volatility of the first (market) factor
+    double riskFreeRate = 0.02;      // Return of a riskless asset
+    double sharpeRatio = 0.4;        // Expected excess return per unit of factor risk
+    double alphaVolatility = 0.01;   // Asset-specific noise in expected returns
+    uint64_t seed = 42;              // Random seed (same seed = same problem)
+};
+
+/**
+ * @brief Random but realistic optimization inputs for tests and benchmarks.
+ *
+ * With factors > 0 the covariance matrix has a factor structure,
+ *
+ *   Σ = B F B' + d I
+ *
+ * where B holds the assets' loadings on a market factor (betas around 1)
+ * and factors - 1 style factors, and F is diagonal with decreasing factor
+ * variances. The idiosyncratic variance d is chosen so that the condition
+ * number of Σ is exactly conditionNumber: the smallest eigenvalue of Σ is d
+ * and the largest is d plus the largest eigenvalue of B F B'. Because the
+ * largest eigenvalue grows with the number of assets, a low condition
+ * number on a large universe means a large idiosyncratic risk.
+ *
+ * With factors = 0 the assets are uncorrelated and their variances are
+ * spread geometrically over [σ²/conditionNumber, σ²], σ = marketVolatility.
+ *
+ * Expected returns match the risk model: each asset earns the risk-free
+ * rate plus sharpeRatio times its factor exposures (or its volatility when
+ * there are no factors), plus alphaVolatility noise. Market weights for
+ * Black-Litterman are log-normal and sum to 1.
+ *
+ * Generation costs O(n² k) plus the O(n³) positive-definiteness check done
+ * by CovarianceMatrix. Random draws come from core::CounterRng, so the same
+ * options give the same problem with any standard library.
+ *
+ * Example:
+ *   SyntheticOptions options;
+ *   options.assets = 500;
+ *   options.conditionNumber = 1e4;
+ *   SyntheticProblem problem = SyntheticProblem::generate(options);
+ *   MarkowitzOptimizer optimizer(problem.returns(), problem.covariance());
+ */
+class SyntheticProblem {
+public:
+    /**
+     * @brief Generate a problem.
+     * @param options Problem parameters
+     * @return Generated problem
+     * @throws std::invalid_argument if the options are invalid
+     */
+    static SyntheticProblem generate(const SyntheticOptions& options = SyntheticOptions()) {
+        validate(options);
+        SyntheticProblem problem;
+        problem.options_ = options;
+        core::CounterRng rng(options.seed);
+        const size_t n = options.assets;
+
+        core::Matrix matrix(n, n);
+        std::vector<double> premium(n, 0.0);
+        if (options.factors == 0) {
+            std::vector<double> variances(n);
+            double variance = options.marketVolatility * options.marketVolatility;
+            for (size_t i = 0; i < n; ++i) {
+                double spread = n == 1 ? 0.0 : static_cast<double>(i) / static_cast<double>(n - 1);
+                variances[i] = variance * std::pow(options.conditionNumber, -spread);
+            }
+            rng.shuffle(variances.begin(), variances.end());
+            for (size_t i = 0; i < n; ++i) {
+                matrix(i, i) = variances[i];
+                premium[i] = options.sharpeRatio * std::sqrt(variances[i]);
+            }
+        } else {
+            // Scaled loadings C = B F^1/2, so that B F B' = C C'
+            const size_t k = options.factors;
+            core::Matrix loadings(n, k);
+            for (size_t j = 0; j < k; ++j) {
+                double volatility = options.marketVolatility * std::pow(0.6, j);
+                for (size_t i = 0; i < n; ++i) {
+                    double beta = j == 0 ? 1.0 + 0.3 * rng.normal() : rng.normal();
+                    loadings(i, j) = beta * volatility;
+                    premium[i] += options.sharpeRatio * loadings(i, j);
+                }
+            }
+
+            double idiosyncratic = largestEigenvalue(loadings) / (options.conditionNumber - 1.0);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = i; j < n; ++j) {
+                    double sum = 0.0;
+                    for (size_t f = 0; f < k; ++f) {
+                        sum += loadings(i, f) * loadings(j, f);
+                    }
+                    matrix(i, j) = sum;
+                    matrix(j, i) = sum;
+                }
+                matrix(i, i) += idiosyncratic;
+            }
+        }
+
+        std::vector<std::string> labels(n);
+        std::vector<double> returns(n);
+        std::vector<double> caps(n);
+        double totalCap = 0.0;
+        const size_t width = std::to_string(n).size();
+        for (size_t i = 0; i < n; ++i) {
+            std::string index = std::to_string(i + 1);
+            labels[i] = std::string("A").append(width - index.size(), '0').append(index);
+            returns[i] =
+                options.riskFreeRate + premium[i] + options.alphaVolatility * rng.normal();
+            caps[i] = std::exp(rng.normal());
+            totalCap += caps[i];
+        }
+        for (double& cap : caps) {
+            cap /= totalCap;
+        }
+
+        problem.covariance_ = CovarianceMatrix(std::move(matrix), labels);
+        problem.returns_ = ExpectedReturns(core::Vector(std::move(returns)), labels);
+        problem.marketWeights_ = core::Vector(std::move(caps));
+        return problem;
+    }
+
+    /**
+     * @brief Get the options the problem was generated from.
+     */
+    const SyntheticOptions& options() const { return options_; }
+
+    /**
+     * @brief Get the number of assets.
+     */
+    size_t size() const { return returns_.size(); }
+
+    /**
+     * @brief Get the expected returns (labelled A001, A002, ... for 100+ assets).
+     */
+    const ExpectedReturns& returns() const { return returns_; }
+
+    /**
+     * @brief Get the covariance matrix.
+     */
+    const CovarianceMatrix& covariance() const { return covariance_; }
+
+    /**
+     * @brief Get market capitalization weights for Black-Litterman.
+     */
+    const core::Vector& marketWeights() const { return marketWeights_; }
+
+    /**
+     * @brief Generate Black-Litterman views.
+     *
+     * Each view says one random asset will outperform another by roughly
+     * their difference in expected returns (or, with a single asset, gives
+     * an absolute return), with confidence between 0.2 and 0.8.
+     *
+     * @param count Number of views
+     * @return Views, the same for the same problem and count
+     */
+    std::vector<View> views(size_t count) const {
+        core::CounterRng rng(options_.seed, 1);
+        std::vector<View> result;
+        result.reserve(count);
+        for (size_t v = 0; v < count; ++v) {
+            core::Vector assets(size(), 0.0);
+            size_t a = rng.below(size());
+            assets[a] = 1.0;
+            double expected = returns_[a];
+            if (size() > 1) {
+                size_t b = rng.below(size());
+                while (b == a) {
+                    b = rng.below(size());
+                }
+                assets[b] = -1.0;
+                expected -= returns_[b];
+            }
+            double noise = 0.02 * rng.normal();
+            double confidence = 0.2 + 0.6 * rng.uniform();
+            result.emplace_back(assets, expected + noise, confidence);
+        }
+        return result;
+    }
+
+private:
+    SyntheticOptions options_;
+    ExpectedReturns returns_;
+    CovarianceMatrix covariance_;
+    core::Vector marketWeights_;
+
+    static void validate(const SyntheticOptions& options) {
+        if (options.assets == 0) {
+            throw std::invalid_argument("Synthetic problem needs at least one asset");
+        }
+        if (options.factors > 0 && options.factors >= options.assets) {
+            throw std::invalid_argument("Number of factors must be smaller than number of assets");
+        }
+        if (!(options.conditionNumber > 1.0) || !std::isfinite(options.conditionNumber)) {
+            throw std::invalid_argument("Condition number must be finite and greater than 1");
+        }
+        if (!(options.marketVolatility > 0.0) || !std::isfinite(options.marketVolatility)) {
+            throw std::invalid_argument("Market volatility must be positive");
+        }
+        if (!std::isfinite(options.riskFreeRate) || !std::isfinite(options.sharpeRatio)) {
+            throw std::invalid_argument("Risk-free rate and Sharpe ratio must be finite");
+        }
+        if (!(options.alphaVolatility >= 0.0) || !std::isfinite(options.alphaVolatility)) {
+            throw std::invalid_argument("Alpha volatility must be finite and non-negative");
+        }
+    }
+
+    // Largest eigenvalue of C C', computed from the small k x k matrix C'C
+    static double largestEigenvalue(const core::Matrix& loadings) {
+        const size_t k = loadings.cols();
+        core::Matrix gram(k, k);
+        for (size_t a = 0; a < k; ++a) {
+            for (size_t b = 0; b < k; ++b) {
+                double sum = 0.0;
+                for (size_t i = 0; i < loadings.rows(); ++i) {
+                    sum += loadings(i, a) * loadings(i, b);
+                }
+                gram(a, b) = sum;
+            }
+        }
+
+        // Power iteration; C'C is positive semi-definite and tiny
+        core::Vector x(k, 1.0);
+        double eigenvalue = 0.0;
+        for (int iteration = 0; iteration < 10000; ++iteration) {
+            core::Vector y = gram * x;
+            double norm = std::sqrt(y.dot(y));
+            if (norm == 0.0) {
+                break;
+            }
+            for (size_t i = 0; i < k; ++i) {
+                x[i] = y[i] / norm;
+            }
+            bool converged = std::abs(norm - eigenvalue) <= 1e-15 * norm;
+            eigenvalue = norm;
+            if (converged) {
+                break;
+            }
+        }
+        return eigenvalue;
+    }
+};
+
+}  // namespace optimizer
+}  // namespace orbat
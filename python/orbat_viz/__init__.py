@@ -0,0 +1,36 @@
+"""Python bindings for the orbat portfolio optimization library.
+
+NumPy arrays go in and out through the buffer protocol: inputs are read in
+place and copied once into the C++ objects, results are read-only views of
+their storage. Solves release the GIL, so optimizations in different Python
+threads run in parallel.
+
+Example:
+    import numpy as np
+    import orbat_viz as ov
+
+    cov = ov.CovarianceMatrix(np.array([[0.04, 0.006], [0.006, 0.09]]))
+    mu = ov.ExpectedReturns(np.array([0.08, 0.12]))
+    result = ov.MarkowitzOptimizer(mu, cov, long_only=True).minimum_variance()
+    result.weights  # array([...])
+"""
+
+from ._orbat import (
+    BlackLittermanOptimizer,
+    CovarianceMatrix,
+    ExpectedReturns,
+    MarkowitzOptimizer,
+    Result,
+    View,
+    efficient_frontier,
+)
+
+__all__ = [
+    "BlackLittermanOptimizer",
+    "CovarianceMatrix",
+    "ExpectedReturns",
+    "MarkowitzOptimizer",
+    "Result",
+    "View",
+    "efficient_frontier",
+]
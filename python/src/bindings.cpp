@@ -0,0 +1,268 @@
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::BlackLittermanOptimizer;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::FrontierEngine;
+using orbat::optimizer::FrontierOptions;
+using orbat::optimizer::LongOnlyConstraint;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MarkowitzResult;
+using orbat::optimizer::View;
+
+namespace {
+
+// float64, C-contiguous arrays pass through without conversion; anything
+// else (other dtypes, strided views, lists) is converted by NumPy first
+using InputArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// Solves release the GIL; inputs are owned by the C++ objects by then
+using ReleaseGil = py::call_guard<py::gil_scoped_release>;
+
+Vector toVector(const InputArray& array, const char* name) {
+    if (array.ndim() != 1) {
+        throw std::invalid_argument(std::string(name) + " must be a 1-D array");
+    }
+    const double* data = array.data();
+    return Vector(std::vector<double>(data, data + array.shape(0)));
+}
+
+Matrix toMatrix(const InputArray& array, const char* name) {
+    if (array.ndim() != 2) {
+        throw std::invalid_argument(std::string(name) + " must be a 2-D array");
+    }
+    Matrix matrix(static_cast<size_t>(array.shape(0)), static_cast<size_t>(array.shape(1)));
+    std::copy(array.data(), array.data() + array.size(), matrix.data().begin());
+    return matrix;
+}
+
+// Read-only array over storage owned by a Python object; the array keeps the
+// owner alive, so no copy is made
+py::array_t<double> view(const std::vector<double>& values, std::vector<py::ssize_t> shape,
+                         py::handle owner) {
+    py::array_t<double> array(std::move(shape), values.data(), owner);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+// Array that takes over a vector's buffer
+py::array_t<double> adopt(std::vector<double>&& values, std::vector<py::ssize_t> shape) {
+    auto* owned = new std::vector<double>(std::move(values));
+    py::capsule release(owned, [](void* p) { delete static_cast<std::vector<double>*>(p); });
+    return py::array_t<double>(std::move(shape), owned->data(), release);
+}
+
+py::ssize_t length(const std::vector<double>& values) {
+    return static_cast<py::ssize_t>(values.size());
+}
+
+ConstraintSet constraints(bool longOnly) {
+    ConstraintSet set;
+    if (longOnly) {
+        set.add(std::make_shared<LongOnlyConstraint>());
+    }
+    return set;
+}
+
+}  // namespace
+
+PYBIND11_MODULE(_orbat, m) {
+    m.doc() = "Portfolio optimization with the orbat C++ library.\n\n"
+              "Arrays are float64 NumPy arrays. Inputs are read through the buffer\n"
+              "protocol and copied once into the library; results and accessors are\n"
+              "read-only views of the library's storage. Solves release the GIL, so\n"
+              "Python threads can run optimizations in parallel. Do not add views or\n"
+              "constraints to an optimizer while another thread is solving with it.";
+
+    py::class_<CovarianceMatrix>(m, "CovarianceMatrix")
+        .def(py::init([](const InputArray& matrix, const std::vector<std::string>& labels) {
+                 CovarianceMatrix covariance(toMatrix(matrix, "covariance"));
+                 if (!labels.empty()) {
+                     covariance.setLabels(labels);
+                 }
+                 return covariance;
+             }),
+             py::arg("matrix"), py::arg("labels") = std::vector<std::string>(),
+             "Validate a symmetric positive-definite matrix (ValueError otherwise)")
+        .def_static("from_csv", &CovarianceMatrix::fromCSV, py::arg("path"))
+        .def_static("from_json", &CovarianceMatrix::fromJSON, py::arg("path"))
+        .def("__len__", &CovarianceMatrix::size)
+        .def_property_readonly("size", &CovarianceMatrix::size)
+        .def_property_readonly("labels", &CovarianceMatrix::labels)
+        .def_property_readonly(
+            "matrix",
+            [](py::object self) {
+                const Matrix& matrix = self.cast<const CovarianceMatrix&>().data();
+                return view(matrix.data(),
+                            {static_cast<py::ssize_t>(matrix.rows()),
+                             static_cast<py::ssize_t>(matrix.cols())},
+                            self);
+            },
+            "Read-only (n, n) view of the matrix");
+
+    py::class_<ExpectedReturns>(m, "ExpectedReturns")
+        .def(py::init([](const InputArray& returns, const std::vector<std::string>& labels) {
+                 ExpectedReturns expected(toVector(returns, "returns"));
+                 if (!labels.empty()) {
+                     expected.setLabels(labels);
+                 }
+                 return expected;
+             }),
+             py::arg("returns"), py::arg("labels") = std::vector<std::string>())
+        .def_static("from_csv", &ExpectedReturns::fromCSV, py::arg("path"))
+        .def_static("from_json", &ExpectedReturns::fromJSON, py::arg("path"))
+        .def("__len__", &ExpectedReturns::size)
+        .def_property_readonly("size", &ExpectedReturns::size)
+        .def_property_readonly("labels", &ExpectedReturns::labels)
+        .def_property_readonly(
+            "values",
+            [](py::object self) {
+                const Vector& values = self.cast<const ExpectedReturns&>().data();
+                return view(values.data(), {length(values.data())}, self);
+            },
+            "Read-only view of the returns");
+
+    py::class_<MarkowitzResult>(m, "Result")
+        .def_property_readonly(
+            "weights",
+            [](py::object self) {
+                const Vector& weights = self.cast<const MarkowitzResult&>().weights;
+                return view(weights.data(), {length(weights.data())}, self);
+            },
+            "Read-only view of the portfolio weights")
+        .def_readonly("expected_return", &MarkowitzResult::expectedReturn)
+        .def_readonly("risk", &MarkowitzResult::risk)
+        .def_readonly("sharpe_ratio", &MarkowitzResult::sharpeRatio)
+        .def_readonly("converged", &MarkowitzResult::converged)
+        .def_readonly("message", &MarkowitzResult::message)
+        .def("success", &MarkowitzResult::success)
+        .def("__repr__", [](const MarkowitzResult& r) {
+            std::ostringstream repr;
+            repr << "Result(expected_return=" << r.expectedReturn << ", risk=" << r.risk
+                 << ", converged=" << (r.converged ? "True" : "False") << ")";
+            return repr.str();
+        });
+
+    py::class_<MarkowitzOptimizer>(m, "MarkowitzOptimizer")
+        .def(py::init([](const ExpectedReturns& returns, const CovarianceMatrix& covariance,
+                         bool longOnly) {
+                 return std::make_unique<MarkowitzOptimizer>(returns, covariance,
+                                                             constraints(longOnly));
+             }),
+             py::arg("returns"), py::arg("covariance"), py::kw_only(),
+             py::arg("long_only") = false,
+             "The covariance matrix is factorized on the first solve")
+        .def("minimum_variance", &MarkowitzOptimizer::minimumVariance, ReleaseGil())
+        .def("optimize", &MarkowitzOptimizer::optimize, py::arg("risk_aversion"), ReleaseGil())
+        .def("target_return", &MarkowitzOptimizer::targetReturn, py::arg("target"),
+             ReleaseGil());
+
+    py::class_<View>(m, "View")
+        .def(py::init([](const InputArray& assets, double expectedReturn, double confidence) {
+                 return View(toVector(assets, "assets"), expectedReturn, confidence);
+             }),
+             py::arg("assets"), py::arg("expected_return"), py::arg("confidence") = 0.5)
+        .def_property_readonly("assets",
+                               [](py::object self) {
+                                   const Vector& assets = self.cast<const View&>().assets;
+                                   return view(assets.data(), {length(assets.data())}, self);
+                               })
+        .def_readonly("expected_return", &View::expectedReturn)
+        .def_readonly("confidence", &View::confidence);
+
+    py::class_<BlackLittermanOptimizer>(m, "BlackLittermanOptimizer")
+        .def(py::init([](const InputArray& weights, const CovarianceMatrix& covariance,
+                         double riskAversion, double tau) {
+                 return std::make_unique<BlackLittermanOptimizer>(
+                     toVector(weights, "market_weights"), covariance, riskAversion, tau);
+             }),
+             py::arg("market_weights"), py::arg("covariance"), py::arg("risk_aversion"),
+             py::arg("tau") = 0.025)
+        .def("add_view", &BlackLittermanOptimizer::addView, py::arg("view"))
+        .def(
+            "add_view",
+            [](BlackLittermanOptimizer& bl, const InputArray& assets, double expectedReturn,
+               double confidence) {
+                bl.addView(View(toVector(assets, "assets"), expectedReturn, confidence));
+            },
+            py::arg("assets"), py::arg("expected_return"), py::arg("confidence") = 0.5)
+        .def("clear_views", &BlackLittermanOptimizer::clearViews)
+        .def_property_readonly("num_views", &BlackLittermanOptimizer::numViews)
+        .def_property_readonly(
+            "equilibrium_returns",
+            [](py::object self) {
+                const Vector& pi = self.cast<const BlackLittermanOptimizer&>().equilibriumReturns();
+                return view(pi.data(), {length(pi.data())}, self);
+            },
+            "Read-only view of the implied equilibrium returns")
+        .def("compute_posterior_returns", &BlackLittermanOptimizer::computePosteriorReturns,
+             ReleaseGil())
+        .def("optimize", &BlackLittermanOptimizer::optimize, py::arg("risk_aversion") = -1.0,
+             ReleaseGil());
+
+    m.def(
+        "efficient_frontier",
+        [](const ExpectedReturns& returns, const CovarianceMatrix& covariance, size_t points,
+           double tolerance, size_t threads, bool longOnly) {
+            const size_t n = returns.size();
+            std::vector<double> expected;
+            std::vector<double> risk;
+            std::vector<double> weights;
+            {
+                py::gil_scoped_release release;
+                FrontierOptions options;
+                options.points = points;
+                options.tolerance = tolerance;
+                options.threads = threads;
+                FrontierEngine engine(returns, covariance, constraints(longOnly));
+                std::vector<MarkowitzResult> frontier = engine.compute(options);
+                expected.reserve(frontier.size());
+                risk.reserve(frontier.size());
+                weights.reserve(frontier.size() * n);
+                const double nan = std::numeric_limits<double>::quiet_NaN();
+                for (const MarkowitzResult& point : frontier) {
+                    // Failed points have no weights; keep their row so the shape holds
+                    if (!point.success() || point.weights.size() != n) {
+                        expected.push_back(nan);
+                        risk.push_back(nan);
+                        weights.insert(weights.end(), n, nan);
+                        continue;
+                    }
+                    expected.push_back(point.expectedReturn);
+                    risk.push_back(point.risk);
+                    weights.insert(weights.end(), point.weights.data().begin(),
+                                   point.weights.data().end());
+                }
+            }
+            py::ssize_t k = length(expected);
+            return py::make_tuple(adopt(std::move(expected), {k}), adopt(std::move(risk), {k}),
+                                  adopt(std::move(weights), {k, static_cast<py::ssize_t>(n)}));
+        },
+        py::arg("returns"), py::arg("covariance"), py::kw_only(), py::arg("points") = 50,
+        py::arg("tolerance") = 0.0, py::arg("threads") = 0, py::arg("long_only") = false,
+        "Compute the frontier (without holding the GIL); returns (expected_returns, risks, "
+        "weights) with weights of shape (points, n) and NaN rows for points that failed");
+}
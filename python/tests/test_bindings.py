@@ -0,0 +1,94 @@
+"""Tests for the orbat_viz extension module."""
+
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pytest
+
+import orbat_viz as ov
+
+COV = np.array([[0.04, 0.006, 0.002], [0.006, 0.09, 0.004], [0.002, 0.004, 0.0225]])
+MU = np.array([0.08, 0.12, 0.10])
+
+
+def test_minimum_variance_weights_sum_to_one() -> None:
+    optimizer = ov.MarkowitzOptimizer(ov.ExpectedReturns(MU), ov.CovarianceMatrix(COV))
+    result = optimizer.minimum_variance()
+    assert result.converged
+    assert result.weights.shape == (3,)
+    assert result.weights.sum() == pytest.approx(1.0)
+
+
+def test_results_and_accessors_are_read_only_views() -> None:
+    cov = ov.CovarianceMatrix(COV)
+    matrix = cov.matrix
+    assert not matrix.flags.owndata
+    assert not matrix.flags.writeable
+    np.testing.assert_array_equal(matrix, COV)
+
+    result = ov.MarkowitzOptimizer(ov.ExpectedReturns(MU), cov).optimize(2.0)
+    weights = result.weights
+    assert weights.base is not None
+    assert np.shares_memory(weights, result.weights)
+    with pytest.raises(ValueError):
+        weights[0] = 1.0
+
+
+def test_inputs_accept_other_layouts() -> None:
+    cov = ov.CovarianceMatrix(np.asfortranarray(COV))
+    np.testing.assert_array_equal(cov.matrix, COV)
+    returns = ov.ExpectedReturns([0.08, 0.12, 0.10])
+    assert len(returns) == 3
+    with pytest.raises(ValueError):
+        ov.CovarianceMatrix(np.array([[1.0, 2.0], [3.0, 4.0]]))
+    with pytest.raises(ValueError):
+        ov.ExpectedReturns(COV)
+
+
+def test_black_litterman_view_moves_posterior() -> None:
+    bl = ov.BlackLittermanOptimizer(np.array([0.5, 0.3, 0.2]), ov.CovarianceMatrix(COV), 2.5)
+    prior = bl.compute_posterior_returns().values.copy()
+    bl.add_view(np.array([1.0, 0.0, 0.0]), 0.15, 0.9)
+    assert bl.num_views == 1
+    assert bl.compute_posterior_returns().values[0] > prior[0]
+    assert bl.optimize().converged
+
+
+def test_efficient_frontier_arrays() -> None:
+    returns, risks, weights = ov.efficient_frontier(
+        ov.ExpectedReturns(MU), ov.CovarianceMatrix(COV), points=10
+    )
+    assert returns.shape == risks.shape == (10,)
+    assert weights.shape == (10, 3)
+    assert np.all(np.diff(returns) > 0)
+    np.testing.assert_allclose(weights.sum(axis=1), 1.0)
+
+
+def test_long_only_frontier_keeps_its_shape() -> None:
+    optimizer = ov.MarkowitzOptimizer(
+        ov.ExpectedReturns(MU), ov.CovarianceMatrix(COV), long_only=True
+    )
+    result = optimizer.target_return(0.115)
+    assert result.converged
+    assert result.weights.min() >= -1e-12
+    assert result.expected_return == pytest.approx(0.115)
+    assert optimizer.target_return(0.2).weights.shape == (0,)
+
+    returns, risks, weights = ov.efficient_frontier(
+        ov.ExpectedReturns(MU), ov.CovarianceMatrix(COV), points=12, long_only=True
+    )
+    assert returns.shape == risks.shape == (12,)
+    assert weights.shape == (12, 3)
+    solved = ~np.isnan(returns)
+    assert solved.any()
+    assert np.all(weights[solved] >= -1e-12)
+    np.testing.assert_allclose(weights[solved].sum(axis=1), 1.0)
+
+
+def test_solves_run_in_threads() -> None:
+    optimizer = ov.MarkowitzOptimizer(ov.ExpectedReturns(MU), ov.CovarianceMatrix(COV))
+    targets = np.linspace(0.09, 0.11, 16)
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        results = list(pool.map(optimizer.target_return, targets))
+    for target, result in zip(targets, results):
+        assert result.expected_return == pytest.approx(target)
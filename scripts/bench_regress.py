@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+"""Benchmark regression harness for orbat.
+
+Runs the Google Benchmark suites, stores the per-repetition timings as JSON
+tagged with the machine they ran on, and compares them against a baseline
+stored in benchmarks/baselines/. A benchmark counts as a regression when it
+is slower in the median by more than a threshold AND a one-sided
+Mann-Whitney U test over the repetitions says the slowdown is not noise.
+
+Commands:
+  run      Run the benchmarks and write a results file
+  compare  Compare two results files
+  check    Run, then compare against the stored baseline for this machine
+  update   Run, then overwrite the stored baseline for this machine
+
+Exit codes: 0 = no regression, 1 = regression found, 2 = usage or run error.
+
+Requires only the Python 3 standard library.
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import re
+import socket
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BASELINE_DIR = os.path.join(ROOT, "benchmarks", "baselines")
+SCHEMA = 1
+
+# Skips the 2000 and 5000 asset / dimension cases and the 100 MB and 1 GB
+# ingestion cases, which take minutes
+DEFAULT_FILTER = "-/((n:)?(2000|5000)|MB:(100|1000))(/|$)"
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+# ---------------------------------------------------------------------------
+# Machine tagging
+# ---------------------------------------------------------------------------
+
+def cpu_model():
+    """Return the CPU model name, or the platform's processor string."""
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    if platform.system() == "Darwin":
+        try:
+            return subprocess.check_output(
+                ["sysctl", "-n", "machdep.cpu.brand_string"], text=True).strip()
+        except (OSError, subprocess.CalledProcessError):
+            pass
+    return platform.processor() or platform.machine()
+
+
+def machine_info():
+    """Describe the machine; results are only comparable on the same tag."""
+    cpu = cpu_model()
+    cpus = os.cpu_count() or 1
+    slug = re.sub(r"[^a-z0-9]+", "-", cpu.lower()).strip("-")
+    return {
+        "tag": "%s-%s-%s-%dcpu" % (platform.system().lower(), platform.machine(), slug, cpus),
+        "hostname": socket.gethostname(),
+        "cpu": cpu,
+        "cpus": cpus,
+        "system": platform.platform(),
+    }
+
+
+def git_info():
+    """Return the commit the benchmarks were built from, if known."""
+    def git(*args):
+        return subprocess.check_output(["git", "-C", ROOT] + list(args), text=True,
+                                       stderr=subprocess.DEVNULL).strip()
+    try:
+        return {"commit": git("rev-parse", "HEAD"),
+                "dirty": bool(git("status", "--porcelain", "--untracked-files=no"))}
+    except (OSError, subprocess.CalledProcessError):
+        return {"commit": None, "dirty": None}
+
+
+def baseline_path(tag):
+    return os.path.join(BASELINE_DIR, tag + ".json")
+
+
+# ---------------------------------------------------------------------------
+# Running
+# ---------------------------------------------------------------------------
+
+def run_benchmarks(args):
+    """Run the benchmark executable and return a results document."""
+    executable = args.executable or os.path.join(args.build_dir, "benchmarks", "run_benchmarks")
+    if not os.path.isfile(executable):
+        raise RuntimeError("Benchmark executable not found: %s\n"
+                           "Build it with -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON "
+                           "and --target benchmarks, or pass --executable" % executable)
+
+    fd, raw_path = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+    command = [executable,
+               "--benchmark_filter=" + args.filter,
+               "--benchmark_repetitions=%d" % args.repetitions,
+               "--benchmark_min_time=%g" % args.min_time,
+               "--benchmark_out_format=json",
+               "--benchmark_out=" + raw_path]
+    print("Running: " + " ".join(command), file=sys.stderr)
+    try:
+        subprocess.run(command, check=True, stdout=sys.stderr)
+        with open(raw_path) as f:
+            raw = json.load(f)
+    except subprocess.CalledProcessError as e:
+        raise RuntimeError("Benchmark run failed with exit code %d" % e.returncode)
+    finally:
+        os.remove(raw_path)
+
+    benchmarks = {}
+    for entry in raw.get("benchmarks", []):
+        if entry.get("run_type") == "aggregate" or entry.get("error_occurred"):
+            continue
+        name = entry.get("run_name", entry["name"])
+        scale = TIME_UNITS[entry.get("time_unit", "ns")]
+        record = benchmarks.setdefault(name, {"real_time_ns": [], "cpu_time_ns": []})
+        record["real_time_ns"].append(float("%.6g" % (entry["real_time"] * scale)))
+        record["cpu_time_ns"].append(float("%.6g" % (entry["cpu_time"] * scale)))
+
+    context = raw.get("context", {})
+    return {
+        "schema": SCHEMA,
+        "created": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+        "machine": machine_info(),
+        "git": git_info(),
+        "build_type": context.get("library_build_type"),
+        "config": {"filter": args.filter, "repetitions": args.repetitions,
+                   "min_time": args.min_time},
+        "benchmarks": benchmarks,
+    }
+
+
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    if doc.get("schema") != SCHEMA or "benchmarks" not in doc:
+        raise RuntimeError("%s is not a benchmark results file (schema %d)" % (path, SCHEMA))
+    return doc
+
+
+def save(doc, path):
+    directory = os.path.dirname(os.path.abspath(path))
+    os.makedirs(directory, exist_ok=True)
+    with open(path, "w") as f:
+        json.dump(doc, f, indent=2, sort_keys=True)
+        f.write("\n")
+    print("Wrote " + path, file=sys.stderr)
+
+
+# ---------------------------------------------------------------------------
+# Statistics
+# ---------------------------------------------------------------------------
+
+def median(values):
+    s = sorted(values)
+    mid = len(s) // 2
+    return s[mid] if len(s) % 2 else 0.5 * (s[mid - 1] + s[mid])
+
+
+def mann_whitney_greater(x, y):
+    """One-sided Mann-Whitney U test that x tends to be larger than y.
+
+    Returns the p-value. Exact when there are no ties and the samples are
+    small, otherwise the normal approximation with tie and continuity
+    corrections.
+    """
+    m, n = len(x), len(y)
+    if m == 0 or n == 0:
+        return 1.0
+    pooled = sorted([(v, 0) for v in x] + [(v, 1) for v in y])
+    ranks = [0.0] * len(pooled)
+    ties = []
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = 0.5 * (i + j) + 1.0
+        if j > i:
+            ties.append(j - i + 1)
+        i = j + 1
+    rank_x = sum(r for r, (_, group) in zip(ranks, pooled) if group == 0)
+    u = rank_x - m * (m + 1) / 2.0  # Pairs (xi, yj) with xi > yj, ties count half
+
+    if not ties and m * n <= 400:
+        # Distribution of U by the recurrence f(m, n, u) = f(m-1, n, u-n) + f(m, n-1, u)
+        counts = [[[1] if a == 0 or b == 0 else None for b in range(n + 1)]
+                  for a in range(m + 1)]
+        for a in range(1, m + 1):
+            for b in range(1, n + 1):
+                left, right = counts[a - 1][b], counts[a][b - 1]
+                dist = [0] * (a * b + 1)
+                for k, c in enumerate(left):
+                    dist[k + b] += c
+                for k, c in enumerate(right):
+                    dist[k] += c
+                counts[a][b] = dist
+        dist = counts[m][n]
+        return sum(dist[int(round(u)):]) / float(sum(dist))
+
+    total = m + n
+    tie_term = sum(t ** 3 - t for t in ties) / float(total * (total - 1))
+    variance = m * n / 12.0 * ((total + 1) - tie_term)
+    if variance <= 0.0:
+        return 1.0
+    z = (u - m * n / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+# ---------------------------------------------------------------------------
+# Comparison
+# ---------------------------------------------------------------------------
+
+def compare(baseline, current, args):
+    """Print a comparison table and return the number of regressions."""
+    if baseline["machine"]["tag"] != current["machine"]["tag"]:
+        print("Warning: comparing results from different machines (%s vs %s)"
+              % (baseline["machine"]["tag"], current["machine"]["tag"]), file=sys.stderr)
+
+    metric = args.metric + "_ns"
+    names = sorted(set(baseline["benchmarks"]) & set(current["benchmarks"]))
+    missing = sorted(set(baseline["benchmarks"]) - set(current["benchmarks"]))
+    regressions = improvements = 0
+
+    width = max([len(n) for n in names] + [9])
+    print("%-*s %12s %12s %8s %9s  %s" % (width, "Benchmark", "Baseline", "Current",
+                                          "Change", "p-value", "Verdict"))
+    for name in names:
+        before = baseline["benchmarks"][name][metric]
+        after = current["benchmarks"][name][metric]
+        ratio = median(after) / median(before) if median(before) > 0 else 1.0
+        slower = mann_whitney_greater(after, before)
+        faster = mann_whitney_greater(before, after)
+        verdict = ""
+        p = slower if ratio >= 1.0 else faster
+        if ratio > 1.0 + args.threshold and slower < args.alpha:
+            verdict = "REGRESSION"
+            regressions += 1
+        elif ratio < 1.0 - args.threshold and faster < args.alpha:
+            verdict = "improved"
+            improvements += 1
+        if verdict or args.verbose:
+            print("%-*s %12s %12s %+7.1f%% %9.4f  %s" % (
+                width, name, format_time(median(before)), format_time(median(after)),
+                100.0 * (ratio - 1.0), p, verdict))
+
+    print("\n%d compared, %d regressions, %d improvements (threshold %.0f%%, alpha %g)"
+          % (len(names), regressions, improvements, 100.0 * args.threshold, args.alpha))
+    if missing:
+        print("%d baseline benchmarks not in current results%s" % (
+            len(missing), ": " + ", ".join(missing) if args.verbose else " (-v lists them)"))
+    return regressions
+
+
+def format_time(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.3f %s" % (ns / scale, unit)
+    return "%.1f ns" % ns
+
+
+# ---------------------------------------------------------------------------
+# Command line
+# ---------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def run_options(p):
+        p.add_argument("--build-dir", default=os.path.join(ROOT, "build"),
+                       help="Release build directory (default: build/)")
+        p.add_argument("--executable", help="Benchmark executable (default: run_benchmarks)")
+        p.add_argument("--filter", default=DEFAULT_FILTER,
+                       help="--benchmark_filter regex (default skips n >= 2000, >= 100 MB)")
+        p.add_argument("--repetitions", type=int, default=10,
+                       help="Repetitions per benchmark, the test's sample size (default: 10)")
+        p.add_argument("--min-time", type=float, default=0.1,
+                       help="Minimum seconds per repetition (default: 0.1)")
+        p.add_argument("--tag", help="Machine tag (default: derived from OS, CPU and cores)")
+
+    def compare_options(p):
+        p.add_argument("--threshold", type=float, default=0.10,
+                       help="Ignore median changes below this fraction (default: 0.10)")
+        p.add_argument("--alpha", type=float, default=0.01,
+                       help="Significance level of the Mann-Whitney test (default: 0.01)")
+        p.add_argument("--metric", choices=["real_time", "cpu_time"], default="real_time")
+        p.add_argument("-v", "--verbose", action="store_true", help="Show every benchmark")
+
+    p = sub.add_parser("run", help="Run the benchmarks and write a results file")
+    run_options(p)
+    p.add_argument("-o", "--output", required=True, help="Results file")
+
+    p = sub.add_parser("compare", help="Compare two results files")
+    p.add_argument("baseline")
+    p.add_argument("current")
+    compare_options(p)
+
+    p = sub.add_parser("check", help="Run and compare against the stored baseline")
+    run_options(p)
+    compare_options(p)
+    p.add_argument("--baseline", help="Baseline file (default: benchmarks/baselines/<tag>.json)")
+    p.add_argument("-o", "--output", help="Also write the new results here")
+
+    p = sub.add_parser("update", help="Run and store the result as this machine's baseline")
+    run_options(p)
+
+    args = parser.parse_args()
+    try:
+        if args.command == "compare":
+            return 1 if compare(load(args.baseline), load(args.current), args) else 0
+
+        tag = args.tag or machine_info()["tag"]
+        if args.command == "check":
+            path = args.baseline or baseline_path(tag)
+            if not os.path.isfile(path):
+                raise RuntimeError("No baseline for machine '%s' (%s); create one with "
+                                   "'bench_regress.py update'" % (tag, path))
+            baseline = load(path)
+
+        results = run_benchmarks(args)
+        results["machine"]["tag"] = tag
+        if args.command == "run":
+            save(results, args.output)
+        elif args.command == "update":
+            save(results, baseline_path(tag))
+        else:
+            if args.output:
+                save(results, args.output)
+            return 1 if compare(baseline, results, args) else 0
+        return 0
+    except (OSError, RuntimeError, ValueError, KeyError) as e:
+        print("Error: %s" % e, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -84,6 +85,26 @@ public:
         }
     }
 
+    /**
+     * @brief Get every value of a flag that may be repeated.
+     * @param flag Flag name (without -- or -)
+     * @return Values in command-line order (empty if the flag is absent)
+     * @throws std::runtime_error if an occurrence of the flag has no value
+     */
+    std::vector<std::string> getFlagValues(const std::string& flag) const {
+        std::string fullFlag = (flag.length() == 1 ? "-" : "--") + flag;
+        std::vector<std::string> values;
+        for (auto it = args_.begin(); it != args_.end(); ++it) {
+            if (*it == fullFlag) {
+                if (std::next(it) == args_.end()) {
+                    throw std::runtime_error("Flag " + fullFlag + " has no value");
+                }
+                values.push_back(*++it);
+            }
+        }
+        return values;
+    }
+
     /**
      * @brief Get all arguments as a vector.
      * @return Vector of all arguments
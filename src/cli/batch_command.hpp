@@ -0,0 +1,183 @@
+#pragma once
+
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arg_parser.hpp"
+#include "batch_runner.hpp"
+#include "error_codes.hpp"
+#include "metrics_output.hpp"
+#include "trace_output.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Batch command implementation.
+ *
+ * Implements the 'batch' command: runs every job in an NDJSON manifest on a
+ * thread pool inside one process. Each distinct input file is parsed once,
+ * and each covariance matrix is factorized once and shared by all jobs that
+ * reference it. Results stream to a result sink as jobs finish.
+ */
+class BatchCommand {
+public:
+    /**
+     * @brief Execute the batch command.
+     * @param parser Argument parser containing command-line arguments
+     * @return Exit code (0 if every job succeeded, 2 if any job failed)
+     */
+    static int execute(const ArgParser& parser) {
+        try {
+            if (parser.isHelp()) {
+                printHelp();
+                return static_cast<int>(ExitCode::SUCCESS);
+            }
+
+            if (!parser.hasFlag("manifest")) {
+                std::cerr << "Error: Missing required input - Job manifest not provided"
+                          << std::endl;
+                std::cerr << "Usage: Use --manifest <file> to specify an NDJSON job manifest"
+                          << std::endl;
+                std::cerr << "Run 'orbat batch --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            // Parse options before doing any work
+            std::string outputPath = parser.getFlagValue("output", "-");
+            optimizer::OutputFormat format = optimizer::OutputFormat::NDJSON;
+            BatchRunner::Order order = BatchRunner::Order::MANIFEST;
+            size_t threads = 0;
+            TraceOutput trace;
+            MetricsOutput metrics;
+            try {
+                format = optimizer::parseOutputFormat(parser.getFlagValue("format", "ndjson"));
+                order = BatchRunner::parseOrder(parser.getFlagValue("order", "manifest"));
+                if (parser.hasFlag("threads")) {
+                    threads = parseThreadCount(parser.getFlagValue("threads"));
+                }
+                trace = TraceOutput::fromParser(parser);
+                metrics = MetricsOutput::fromParser(parser, [] {
+                    std::ostringstream text;
+                    core::MetricsRegistry::global().writePrometheus(text);
+                    return text.str();
+                });
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid batch options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat batch --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            // Validate the whole manifest up front
+            std::string manifestFile = parser.getFlagValue("manifest");
+            std::vector<BatchJob> jobs;
+            try {
+                jobs = BatchManifest::load(manifestFile);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid manifest '" << manifestFile << "'" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Hint: Each line must be a JSON object with \"returns\" and "
+                             "\"covariance\" paths"
+                          << std::endl;
+                return static_cast<int>(ExitCode::VALIDATION_ERROR);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            BatchSummary summary;
+            BatchRunner runner(threads, order);
+            try {
+                optimizer::OutputTarget target(outputPath);
+                optimizer::SinkOptions sinkOptions;
+                sinkOptions.includeIds = true;
+                sinkOptions.flushEachRecord = target.isStdout();
+                auto sink = optimizer::makeResultSink(format, target.stream(), sinkOptions);
+                summary = runner.run(jobs, *sink);
+                sink->finish();
+                if (!target.stream()) {
+                    throw std::runtime_error("Failed to write output: " + outputPath);
+                }
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Error: Failed to write output to '" << outputPath << "'"
+                          << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::VALIDATION_ERROR);
+            }
+            double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cerr << "Batch complete: " << summary.jobs << " jobs, " << summary.succeeded
+                      << " succeeded, " << summary.failed << " failed ("
+                      << runner.cache().covarianceCount() << " covariance files, "
+                      << runner.threads() << " threads, " << seconds << "s)" << std::endl;
+
+            return static_cast<int>(summary.failed == 0 ? ExitCode::SUCCESS
+                                                        : ExitCode::COMPUTATION_ERROR);
+
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Unexpected error occurred" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Use 'orbat batch --help' for usage information." << std::endl;
+            return static_cast<int>(ExitCode::INTERNAL_ERROR);
+        }
+    }
+
+    /**
+     * @brief Print help message for batch command.
+     */
+    static void printHelp() {
+        std::cout
+            << "Usage: orbat batch --manifest <file> [OPTIONS]\n"
+            << "\n"
+            << "Run many optimization jobs from an NDJSON manifest in one process\n"
+            << "\n"
+            << "Required Options:\n"
+            << "  --manifest <file>      Job manifest, one JSON object per line\n"
+            << "\n"
+            << "Optional Flags:\n"
+            << "  --threads <n>          Worker threads (default: hardware concurrency)\n"
+            << "  --order <name>         Result order: manifest (default) or completion\n"
+            << "  --output <file|->      Write results to a file, or '-' for stdout (default)\n"
+            << "  --format <name>        Output format: ndjson (default), json, csv, binary\n"
+            << "  --trace <file>         Write a Chrome trace of the jobs' phases\n"
+            << "  --metrics <file>       Write job and solver metrics (Prometheus text format)\n"
+            << "  --metrics-interval <s> Also rewrite the metrics file every s seconds\n"
+            << "  --help, -h             Show this help message\n"
+            << "\n"
+            << "Manifest Fields:\n"
+            << "  id                     Record id (default: manifest line number)\n"
+            << "  method                 mpt (default) or bl\n"
+            << "  returns, covariance    Input CSV paths, relative to the manifest\n"
+            << "  objective              mpt: min-variance (default), mean-variance, "
+               "target-return\n"
+            << "  lambda, target         Parameters for mean-variance and target-return\n"
+            << "  longOnly               mpt long-only constraint (default: true)\n"
+            << "  riskAversion, tau      bl parameters (default: 2.5, 0.025)\n"
+            << "  rfRate                 Risk-free rate for the Sharpe ratio (default: 0.0)\n"
+            << "\n"
+            << "Examples:\n"
+            << "  orbat batch --manifest jobs.ndjson > results.ndjson\n"
+            << "  orbat batch --manifest jobs.ndjson --threads 8 --order completion "
+               "--format binary --output results.bin\n";
+    }
+
+private:
+    static size_t parseThreadCount(const std::string& value) {
+        size_t consumed = 0;
+        long long threads = std::stoll(value, &consumed);
+        if (consumed != value.size() || threads < 1 || threads > 1024) {
+            throw std::invalid_argument("Thread count must be an integer between 1 and 1024");
+        }
+        return static_cast<size_t>(threads);
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,565 @@
+#pragma once
+
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/thread_pool.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_parser.hpp"
+#include "json_reader.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief One optimization job from a batch manifest.
+ *
+ * Manifest lines are JSON objects:
+ *   {"id": "a", "returns": "mu.csv", "covariance": "cov.csv"}
+ *   {"id": "b", "method": "mpt", "objective": "mean-variance", "lambda": 0.5, ...}
+ *   {"id": "c", "method": "bl", "returns": "weights.csv", "riskAversion": 3.0, ...}
+ */
+struct BatchJob {
+    size_t line = 0;                         // 1-based manifest line number
+    std::string id;                          // Record id (defaults to the line number)
+    std::string method = "mpt";              // "mpt" or "bl"
+    std::string returnsPath;                 // Expected returns (mpt) or market weights (bl)
+    std::string covariancePath;              // Covariance matrix CSV
+    std::string objective = "min-variance";  // mpt: min-variance, mean-variance, target-return
+    double lambda = 0.0;                     // mean-variance risk aversion
+    double targetReturn = 0.0;               // target-return objective
+    double riskFreeRate = 0.0;               // Risk-free rate for the Sharpe ratio
+    double riskAversion = 2.5;               // bl market risk aversion
+    double tau = 0.025;                      // bl prior uncertainty
+    bool longOnly = true;                    // mpt long-only constraint
+};
+
+/**
+ * @brief Parser for newline-delimited JSON batch manifests.
+ *
+ * Blank lines and lines starting with '#' are skipped. Relative input paths
+ * are resolved against the manifest's directory. The whole manifest is
+ * validated before any job runs so that a typo on line 9000 is reported
+ * up front rather than after hours of work.
+ */
+class BatchManifest {
+public:
+    /**
+     * @brief Parse a manifest from a stream.
+     * @param in Input stream with one JSON object per line
+     * @param baseDir Directory used to resolve relative paths
+     * @return Jobs in manifest order
+     * @throws std::runtime_error with the line number if any line is invalid
+     */
+    static std::vector<BatchJob> parse(std::istream& in, const std::string& baseDir = "") {
+        std::vector<BatchJob> jobs;
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            size_t start = line.find_first_not_of(" \t\r\n");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            try {
+                jobs.push_back(parseJob(JsonValue::parse(line), lineNumber, baseDir));
+            } catch (const std::exception& e) {
+                throw std::runtime_error("Manifest line " + std::to_string(lineNumber) + ": " +
+                                         e.what());
+            }
+        }
+        if (jobs.empty()) {
+            throw std::runtime_error("Manifest contains no jobs");
+        }
+        return jobs;
+    }
+
+    /**
+     * @brief Load a manifest file.
+     * @param path Manifest path
+     * @return Jobs in manifest order
+     * @throws std::runtime_error if the file cannot be read or is invalid
+     */
+    static std::vector<BatchJob> load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open manifest file: " + path);
+        }
+        return parse(file, std::filesystem::path(path).parent_path().string());
+    }
+
+    /**
+     * @brief Build a job from a parsed JSON object.
+     * @param object Job description
+     * @param lineNumber Manifest line number (used as default id)
+     * @param baseDir Directory used to resolve relative paths
+     * @return Validated job
+     * @throws std::runtime_error if a field is missing or invalid
+     */
+    static BatchJob parseJob(const JsonValue& object, size_t lineNumber,
+                             const std::string& baseDir = "") {
+        if (!object.isObject()) {
+            throw std::runtime_error("Job must be a JSON object");
+        }
+
+        BatchJob job;
+        job.line = lineNumber;
+        if (object.has("id")) {
+            const JsonValue& id = object["id"];
+            if (id.isNumber()) {
+                std::ostringstream oss;
+                oss << id.asNumber();
+                job.id = oss.str();
+            } else {
+                job.id = id.asString();
+            }
+        } else {
+            job.id = std::to_string(lineNumber);
+        }
+
+        if (!object.has("returns") || !object.has("covariance")) {
+            throw std::runtime_error("Job requires \"returns\" and \"covariance\" paths");
+        }
+        job.returnsPath = resolvePath(object["returns"].asString(), baseDir);
+        job.covariancePath = resolvePath(object["covariance"].asString(), baseDir);
+        parseOptions(object, job);
+        return job;
+    }
+
+    /**
+     * @brief Read the method and solver parameters of a job description.
+     *
+     * Shared by manifest lines and serve requests; input paths are not read.
+     *
+     * @param object Job description (JSON object)
+     * @param job Job to update
+     * @throws std::runtime_error if a field is missing or invalid
+     */
+    static void parseOptions(const JsonValue& object, BatchJob& job) {
+        job.method = object.getString("method", job.method);
+        if (job.method != "mpt" && job.method != "bl") {
+            throw std::runtime_error("Unknown method '" + job.method + "' (expected mpt or bl)");
+        }
+        job.riskFreeRate = object.getNumber("rfRate", job.riskFreeRate);
+
+        if (job.method == "mpt") {
+            job.objective = object.getString("objective", job.objective);
+            job.longOnly = object.getBool("longOnly", job.longOnly);
+            if (job.objective == "mean-variance") {
+                job.lambda = object["lambda"].asNumber();
+                if (job.lambda < 0.0) {
+                    throw std::runtime_error("lambda must be non-negative");
+                }
+            } else if (job.objective == "target-return") {
+                job.targetReturn = object["target"].asNumber();
+            } else if (job.objective != "min-variance") {
+                throw std::runtime_error("Unknown objective '" + job.objective +
+                                         "' (expected min-variance, mean-variance or "
+                                         "target-return)");
+            }
+        } else {
+            job.riskAversion = object.getNumber("riskAversion", job.riskAversion);
+            job.tau = object.getNumber("tau", job.tau);
+            if (job.riskAversion <= 0.0 || job.tau <= 0.0) {
+                throw std::runtime_error("riskAversion and tau must be positive");
+            }
+        }
+    }
+
+private:
+    static std::string resolvePath(const std::string& path, const std::string& baseDir) {
+        if (path.empty()) {
+            throw std::runtime_error("Input path cannot be empty");
+        }
+        std::filesystem::path p(path);
+        if (p.is_relative() && !baseDir.empty()) {
+            p = std::filesystem::path(baseDir) / p;
+        }
+        return p.lexically_normal().string();
+    }
+};
+
+/**
+ * @brief Parsed and factorized covariance matrix shared between jobs.
+ */
+struct CachedCovariance {
+    optimizer::CovarianceMatrix covariance;
+    std::shared_ptr<const optimizer::CovarianceFactorization> factorization;
+};
+
+/**
+ * @brief Thread-safe load-once cache of input files.
+ *
+ * The first job that needs a file parses it (and, for covariance files,
+ * factorizes it); concurrent jobs needing the same file wait for that
+ * result instead of loading it again. Load errors are cached too, so every
+ * job referencing a bad file fails with the same message without re-reading
+ * it.
+ */
+class BatchInputCache {
+public:
+    /**
+     * @brief Get a parsed and factorized covariance matrix.
+     * @param path Covariance CSV path
+     * @return Shared cache entry
+     * @throws std::exception from parsing or factorization
+     */
+    std::shared_ptr<const CachedCovariance> covariance(const std::string& path) {
+        return getOrLoad(covariances_, path, [&path] {
+            auto entry = std::make_shared<CachedCovariance>();
+            entry->covariance = FileParser::parseCovariance(path);
+            entry->factorization = optimizer::CovarianceFactorization::create(entry->covariance);
+            return std::shared_ptr<const CachedCovariance>(std::move(entry));
+        });
+    }
+
+    /**
+     * @brief Get a parsed returns (or market weights) vector.
+     * @param path Returns CSV path
+     * @return Shared parsed returns
+     * @throws std::exception from parsing
+     */
+    std::shared_ptr<const optimizer::ExpectedReturns> returns(const std::string& path) {
+        return getOrLoad(returns_, path, [&path] {
+            return std::make_shared<const optimizer::ExpectedReturns>(
+                FileParser::parseReturns(path));
+        });
+    }
+
+    /**
+     * @brief Number of distinct covariance files loaded (or attempted).
+     */
+    size_t covarianceCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return covariances_.size();
+    }
+
+    /**
+     * @brief Number of distinct returns files loaded (or attempted).
+     */
+    size_t returnsCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return returns_.size();
+    }
+
+private:
+    template <typename T>
+    using Slot = std::shared_future<std::shared_ptr<const T>>;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Slot<CachedCovariance>> covariances_;
+    std::map<std::string, Slot<optimizer::ExpectedReturns>> returns_;
+
+    template <typename T, typename Loader>
+    std::shared_ptr<const T> getOrLoad(std::map<std::string, Slot<T>>& slots,
+                                       const std::string& path, Loader load) {
+        std::promise<std::shared_ptr<const T>> promise;
+        Slot<T> slot;
+        bool owner = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = slots.find(path);
+            if (it == slots.end()) {
+                slot = promise.get_future().share();
+                slots.emplace(path, slot);
+                owner = true;
+            } else {
+                slot = it->second;
+            }
+        }
+        // The owning thread loads outside the lock; others block in slot.get()
+        if (owner) {
+            try {
+                promise.set_value(load());
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+        return slot.get();
+    }
+};
+
+/**
+ * @brief Outcome counts for a batch run.
+ */
+struct BatchSummary {
+    size_t jobs = 0;
+    size_t succeeded = 0;
+    size_t failed = 0;
+};
+
+/**
+ * @brief Executes batch jobs on a thread pool and streams results to a sink.
+ *
+ * Results are written either in manifest order (a small reorder buffer holds
+ * results that finish early) or in completion order. The number of jobs in
+ * flight is bounded so that neither the task queue nor the reorder buffer
+ * grows with the size of the manifest.
+ *
+ * Job counts by status, the jobs in flight and a job latency histogram are
+ * recorded in core::MetricsRegistry::global() (orbat_batch_*).
+ *
+ * Example:
+ *   auto jobs = BatchManifest::load("jobs.ndjson");
+ *   optimizer::NdjsonResultSink sink(std::cout);
+ *   BatchRunner runner(8, BatchRunner::Order::MANIFEST);
+ *   BatchSummary summary = runner.run(jobs, sink);
+ */
+class BatchRunner {
+public:
+    enum class Order { MANIFEST, COMPLETION };
+
+    /**
+     * @brief Construct a runner.
+     * @param numThreads Worker threads (0 = hardware concurrency)
+     * @param order Result ordering
+     */
+    explicit BatchRunner(size_t numThreads = 0, Order order = Order::MANIFEST)
+        : order_(order), pool_(numThreads), metrics_(core::MetricsRegistry::global()) {}
+
+    /**
+     * @brief Parse an order name.
+     * @param name "manifest" or "completion"
+     * @return Order value
+     * @throws std::invalid_argument for unknown names
+     */
+    static Order parseOrder(const std::string& name) {
+        if (name == "manifest") {
+            return Order::MANIFEST;
+        }
+        if (name == "completion") {
+            return Order::COMPLETION;
+        }
+        throw std::invalid_argument("Unknown order '" + name +
+                                    "' (expected manifest or completion)");
+    }
+
+    /**
+     * @brief Get the number of worker threads.
+     */
+    size_t threads() const { return pool_.size(); }
+
+    /**
+     * @brief Get the input cache (shared across run() calls).
+     */
+    BatchInputCache& cache() { return cache_; }
+
+    /**
+     * @brief Run all jobs and write one record per job to the sink.
+     *
+     * Failed jobs produce a record with converged=false and the error in
+     * the message. The sink is not finished by this call.
+     *
+     * @param jobs Jobs to execute
+     * @param sink Destination for results (written from worker threads under a lock)
+     * @return Outcome counts
+     */
+    BatchSummary run(const std::vector<BatchJob>& jobs, optimizer::ResultSink& sink) {
+        const size_t maxInFlight = pool_.size() * IN_FLIGHT_PER_THREAD;
+        Emitter emitter(sink, order_);
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            emitter.waitForSlot(i, maxInFlight);
+            metrics_.inFlight.add(1.0);
+            pool_.submit([this, &jobs, &emitter, i] {
+                optimizer::MarkowitzResult result = [&] {
+                    core::LatencyTimer timer(metrics_.latency);
+                    return runJob(jobs[i], cache_);
+                }();
+                (result.success() ? metrics_.succeeded : metrics_.failed).add();
+                metrics_.inFlight.add(-1.0);
+                emitter.emit(i, jobs[i].id, std::move(result));
+            });
+        }
+        pool_.wait();
+        emitter.rethrowSinkError();
+
+        BatchSummary summary;
+        summary.jobs = jobs.size();
+        summary.failed = emitter.failed();
+        summary.succeeded = summary.jobs - summary.failed;
+        return summary;
+    }
+
+    /**
+     * @brief Execute one job.
+     * @param job Job description
+     * @param cache Input cache
+     * @return Optimization result; failures are reported with converged=false
+     */
+    static optimizer::MarkowitzResult runJob(const BatchJob& job, BatchInputCache& cache) {
+        ORBAT_TRACE_SPAN("BatchRunner::runJob", "job");
+        try {
+            auto returns = cache.returns(job.returnsPath);
+            auto cov = cache.covariance(job.covariancePath);
+            return solve(job, *returns, *cov);
+        } catch (const std::exception& e) {
+            return optimizer::MarkowitzResult{
+                {}, 0.0, 0.0, 0.0, false, std::string("Job failed: ") + e.what()};
+        }
+    }
+
+    /**
+     * @brief Solve one job against already loaded inputs.
+     * @param job Job parameters (input paths are ignored)
+     * @param returns Expected returns (mpt) or market weights (bl)
+     * @param cov Covariance matrix and its factorization
+     * @return Optimization result
+     * @throws std::invalid_argument if dimensions don't match or parameters are invalid
+     */
+    static optimizer::MarkowitzResult solve(const BatchJob& job,
+                                            const optimizer::ExpectedReturns& returns,
+                                            const CachedCovariance& cov) {
+        optimizer::MarkowitzResult result;
+        if (job.method == "bl") {
+            optimizer::BlackLittermanOptimizer bl(returns.data(), cov.covariance, job.riskAversion,
+                                                  job.tau);
+            bl.setCovarianceFactorization(cov.factorization);
+            result = bl.optimize();
+        } else {
+            optimizer::MarkowitzOptimizer markowitz(returns, cov.covariance,
+                                                    constraintsFor(job), cov.factorization);
+            if (job.objective == "mean-variance") {
+                result = markowitz.optimize(job.lambda);
+            } else if (job.objective == "target-return") {
+                result = markowitz.targetReturn(job.targetReturn);
+            } else {
+                result = markowitz.minimumVariance();
+            }
+        }
+
+        if (result.success() && job.riskFreeRate != 0.0) {
+            result.setRiskFreeRate(job.riskFreeRate);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Build the constraint set for an mpt job.
+     * @param job Job parameters
+     * @return Constraints (long-only unless disabled)
+     */
+    static optimizer::ConstraintSet constraintsFor(const BatchJob& job) {
+        optimizer::ConstraintSet constraints;
+        if (job.longOnly) {
+            constraints.add(std::make_shared<optimizer::LongOnlyConstraint>());
+        }
+        return constraints;
+    }
+
+private:
+    static constexpr size_t IN_FLIGHT_PER_THREAD = 16;
+
+    /**
+     * @brief Registered batch metrics, looked up once per runner.
+     */
+    struct JobMetrics {
+        core::MetricCounter& succeeded;
+        core::MetricCounter& failed;
+        core::MetricGauge& inFlight;
+        core::LatencyHistogram& latency;
+
+        explicit JobMetrics(core::MetricsRegistry& registry)
+            : succeeded(registry.counter("orbat_batch_jobs_total", "Batch jobs completed",
+                                         {{"status", "succeeded"}})),
+              failed(registry.counter("orbat_batch_jobs_total", "Batch jobs completed",
+                                      {{"status", "failed"}})),
+              inFlight(registry.gauge("orbat_batch_jobs_in_flight",
+                                      "Batch jobs submitted and not yet finished")),
+              latency(registry.histogram("orbat_batch_job_duration_seconds",
+                                         "Time to load inputs for and solve one batch job")) {}
+    };
+
+    /**
+     * @brief Serializes sink writes and restores manifest order when requested.
+     */
+    class Emitter {
+    public:
+        Emitter(optimizer::ResultSink& sink, Order order)
+            : sink_(sink), order_(order), written_(0), failed_(0) {}
+
+        void waitForSlot(size_t index, size_t maxInFlight) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slotFree_.wait(lock, [&] { return index < written_ + maxInFlight; });
+        }
+
+        void emit(size_t index, const std::string& id, optimizer::MarkowitzResult result) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!result.success()) {
+                ++failed_;
+            }
+            if (order_ == Order::COMPLETION) {
+                write(id, result);
+            } else {
+                pending_.emplace(index, std::make_pair(id, std::move(result)));
+                // Flush the contiguous run that starts at the next expected index
+                for (auto it = pending_.begin();
+                     it != pending_.end() && it->first == written_; it = pending_.begin()) {
+                    write(it->second.first, it->second.second);
+                    pending_.erase(it);
+                }
+            }
+            slotFree_.notify_all();
+        }
+
+        size_t failed() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return failed_;
+        }
+
+        void rethrowSinkError() const {
+            if (sinkError_) {
+                std::rethrow_exception(sinkError_);
+            }
+        }
+
+    private:
+        optimizer::ResultSink& sink_;
+        Order order_;
+        size_t written_;
+        size_t failed_;
+        std::map<size_t, std::pair<std::string, optimizer::MarkowitzResult>> pending_;
+        std::exception_ptr sinkError_;
+        mutable std::mutex mutex_;
+        std::condition_variable slotFree_;
+
+        void write(const std::string& id, const optimizer::MarkowitzResult& result) {
+            ++written_;
+            if (sinkError_) {
+                return;  // Keep draining so the producer is not blocked
+            }
+            try {
+                sink_.write(result, id);
+            } catch (...) {
+                sinkError_ = std::current_exception();
+            }
+        }
+    };
+
+    BatchInputCache cache_;  // Declared first so it outlives the workers
+    Order order_;
+    core::ThreadPool pool_;
+    JobMetrics metrics_;
+};
+
+}  // namespace cli
+}  // namespace orbat
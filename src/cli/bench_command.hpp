@@ -0,0 +1,590 @@
+#pragma once
+
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "arg_parser.hpp"
+#include "error_codes.hpp"
+
+#ifndef ORBAT_VERSION
+#define ORBAT_VERSION "unknown"
+#endif
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Settings for a benchmark run.
+ */
+struct BenchOptions {
+    std::vector<size_t> sizes = {10, 100, 500, 1000};  // Asset counts
+    std::vector<std::string> paths;                    // Paths to run (empty = all)
+    size_t repetitions = 0;   // Timed runs per case (0 = run for minSeconds)
+    double minSeconds = 0.5;  // Time budget per case when repetitions = 0
+    size_t warmup = 1;        // Untimed runs before timing
+    size_t threads = 0;       // Frontier engine threads (0 = hardware concurrency)
+    size_t views = 5;         // Black-Litterman views
+    optimizer::SyntheticOptions problem;  // Generator settings (assets is overridden)
+};
+
+/**
+ * @brief Latency statistics of one benchmark case (microseconds).
+ */
+struct LatencySummary {
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+
+    /**
+     * @brief Summarize run times with nearest-rank percentiles.
+     * @param micros Run times in microseconds (all zero if empty)
+     */
+    static LatencySummary fromSamples(std::vector<double> micros) {
+        LatencySummary summary;
+        if (micros.empty()) {
+            return summary;
+        }
+        std::sort(micros.begin(), micros.end());
+        double total = 0.0;
+        for (double sample : micros) {
+            total += sample;
+        }
+        auto percentile = [&micros](double q) {
+            size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(micros.size())));
+            return micros[std::min(micros.size() - 1, rank == 0 ? 0 : rank - 1)];
+        };
+        summary.meanUs = total / static_cast<double>(micros.size());
+        summary.p50Us = percentile(0.50);
+        summary.p90Us = percentile(0.90);
+        summary.p99Us = percentile(0.99);
+        summary.maxUs = micros.back();
+        return summary;
+    }
+};
+
+/**
+ * @brief Timing of one optimizer path at one problem size.
+ */
+struct BenchResult {
+    std::string path;
+    size_t assets = 0;
+    size_t repetitions = 0;
+    size_t failures = 0;   // Runs whose result was not successful
+    double seconds = 0.0;  // Total timed wall time
+    LatencySummary latency;
+
+    /**
+     * @brief Get completed runs per second.
+     */
+    double throughput() const {
+        return seconds > 0.0 ? static_cast<double>(repetitions) / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Benchmark command implementation.
+ *
+ * Implements the 'bench' command: generates synthetic problems of standard
+ * sizes with optimizer::SyntheticProblem, runs every optimizer path on them
+ * and reports throughput and latency percentiles as one JSON document, so
+ * hosts and releases can be compared. Each path reuses one covariance
+ * factorization per size (as batch and serve do), except "factorize", which
+ * measures the factorization itself.
+ */
+class BenchCommand {
+public:
+    /**
+     * @brief Get the names of the benchmarked optimizer paths.
+     */
+    static const std::vector<std::string>& pathNames() {
+        static const std::vector<std::string> names = {
+            "factorize",     "mpt-min-variance", "mpt-optimize",       "mpt-target-return",
+            "mpt-long-only", "mpt-packed",       "efficient-frontier", "frontier-engine",
+            "bl"};
+        return names;
+    }
+
+    /**
+     * @brief Execute the bench command.
+     * @param parser Argument parser containing command-line arguments
+     * @return Exit code (0 for success, non-zero for error)
+     */
+    static int execute(const ArgParser& parser) {
+        try {
+            if (parser.isHelp()) {
+                printHelp();
+                return static_cast<int>(ExitCode::SUCCESS);
+            }
+
+            BenchOptions options;
+            std::string outputPath = parser.getFlagValue("output", "-");
+            try {
+                options = parseOptions(parser);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid bench options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat bench --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            std::vector<BenchResult> results;
+            try {
+                results = run(options, &std::cerr);
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Error: Cannot generate benchmark problem" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::VALIDATION_ERROR);
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Error: Benchmark failed" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::COMPUTATION_ERROR);
+            }
+
+            optimizer::OutputTarget target(outputPath);
+            writeJSON(target.stream(), options, results);
+            if (!target.stream()) {
+                std::cerr << "Error: Failed to write output: " << outputPath << std::endl;
+                return static_cast<int>(ExitCode::COMPUTATION_ERROR);
+            }
+            return static_cast<int>(ExitCode::SUCCESS);
+
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Unexpected error occurred" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Use 'orbat bench --help' for usage information." << std::endl;
+            return static_cast<int>(ExitCode::INTERNAL_ERROR);
+        }
+    }
+
+    /**
+     * @brief Run the benchmarks.
+     *
+     * @param options Benchmark settings
+     * @param progress Stream for one progress line per case (nullptr = silent)
+     * @return One result per (size, path), sizes in the given order
+     * @throws std::invalid_argument if a problem cannot be generated
+     * @throws std::runtime_error if a path throws
+     */
+    static std::vector<BenchResult> run(const BenchOptions& options,
+                                        std::ostream* progress = nullptr) {
+        std::vector<BenchResult> results;
+        for (size_t n : options.sizes) {
+            optimizer::SyntheticOptions problemOptions = options.problem;
+            problemOptions.assets = n;
+            problemOptions.factors = std::min(problemOptions.factors, n - 1);
+            auto start = std::chrono::steady_clock::now();
+            optimizer::SyntheticProblem problem = optimizer::SyntheticProblem::generate(
+                problemOptions);
+            if (progress != nullptr) {
+                *progress << "bench: generated " << n << " assets in " << std::fixed
+                          << std::setprecision(3) << secondsSince(start) << " s"
+                          << std::defaultfloat << std::endl;
+            }
+
+            Fixture fixture(problem, options);
+            for (const std::string& path : pathNames()) {
+                if (!options.paths.empty() &&
+                    std::find(options.paths.begin(), options.paths.end(), path) ==
+                        options.paths.end()) {
+                    continue;
+                }
+                BenchResult result = measure(path, n, fixture.step(path), options);
+                if (progress != nullptr) {
+                    *progress << "bench: " << path << " n=" << n << " " << result.repetitions
+                              << " runs, p50 " << result.latency.p50Us << " us" << std::endl;
+                }
+                results.push_back(std::move(result));
+            }
+        }
+        return results;
+    }
+
+    /**
+     * @brief Write results as a JSON document.
+     *
+     * The document records the host, build and settings next to the
+     * results so that files from different machines and releases can be
+     * compared directly.
+     *
+     * @param out Output stream
+     * @param options Settings the results were produced with
+     * @param results Benchmark results
+     */
+    static void writeJSON(std::ostream& out, const BenchOptions& options,
+                          const std::vector<BenchResult>& results) {
+        const auto& p = options.problem;
+        out << "{\n"
+            << "  \"orbat\": \"" << optimizer::escapeJSON(ORBAT_VERSION) << "\",\n"
+            << "  \"timestamp\": \"" << timestamp() << "\",\n"
+            << "  \"host\": {\"name\": \"" << optimizer::escapeJSON(hostName())
+            << "\", \"cpus\": " << std::thread::hardware_concurrency() << ", \"compiler\": \""
+            << optimizer::escapeJSON(compiler()) << "\", \"build\": \""
+#ifdef NDEBUG
+            << "release"
+#else
+            << "debug"
+#endif
+            << "\"},\n"
+            << "  \"config\": {\"repetitions\": " << options.repetitions
+            << ", \"minSeconds\": " << options.minSeconds << ", \"warmup\": " << options.warmup
+            << ", \"threads\": " << options.threads << ", \"views\": " << options.views
+            << ", \"seed\": " << p.seed << ", \"factors\": " << p.factors
+            << ", \"conditionNumber\": " << p.conditionNumber << "},\n"
+            << "  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"path\": \"" << r.path
+                << "\", \"assets\": " << r.assets << ", \"repetitions\": " << r.repetitions
+                << ", \"failures\": " << r.failures << ", \"throughput\": " << r.throughput()
+                << ", \"latencyUs\": {\"mean\": " << r.latency.meanUs
+                << ", \"p50\": " << r.latency.p50Us << ", \"p90\": " << r.latency.p90Us
+                << ", \"p99\": " << r.latency.p99Us << ", \"max\": " << r.latency.maxUs << "}}";
+        }
+        out << (results.empty() ? "]\n" : "\n  ]\n") << "}" << std::endl;
+    }
+
+    /**
+     * @brief Print help message for bench command.
+     */
+    static void printHelp() {
+        std::cout
+            << "Usage: orbat bench [OPTIONS]\n"
+            << "\n"
+            << "Run every optimizer path on synthetic problems and report throughput and\n"
+            << "latency percentiles as JSON\n"
+            << "\n"
+            << "Optional Flags:\n"
+            << "  --sizes <n,...>        Asset counts (default: 10,100,500,1000)\n"
+            << "  --paths <name,...>     Paths to run (default: all):\n"
+            << "                         factorize, mpt-min-variance, mpt-optimize,\n"
+            << "                         mpt-target-return, mpt-long-only, mpt-packed,\n"
+            << "                         efficient-frontier, frontier-engine, bl\n"
+            << "  --repetitions <n>      Timed runs per case (default: as many as fit in\n"
+            << "                         --min-time)\n"
+            << "  --min-time <seconds>   Time budget per case (default: 0.5)\n"
+            << "  --warmup <n>           Untimed runs before timing (default: 1)\n"
+            << "  --threads <n>          Frontier engine threads (default: hardware "
+               "concurrency)\n"
+            << "  --views <n>            Black-Litterman views (default: 5)\n"
+            << "  --factors <n>          Covariance risk factors, 0 = uncorrelated "
+               "(default: 5)\n"
+            << "  --condition <value>    Covariance condition number (default: 1000)\n"
+            << "  --seed <n>             Random seed for the problems (default: 42)\n"
+            << "  --output <file|->      Write the JSON report to a file, or '-' for stdout\n"
+            << "                         (default)\n"
+            << "  --help, -h             Show this help message\n"
+            << "\n"
+            << "Examples:\n"
+            << "  orbat bench > bench.json\n"
+            << "  orbat bench --sizes 100,2000 --paths mpt-min-variance,bl --repetitions 50\n";
+    }
+
+private:
+    using Step = std::function<bool()>;
+
+    /**
+     * @brief Shared inputs for every path at one problem size.
+     */
+    class Fixture {
+    public:
+        Fixture(const optimizer::SyntheticProblem& problem, const BenchOptions& options)
+            : problem_(problem), options_(options),
+              factorization_(optimizer::CovarianceFactorization::create(problem.covariance())),
+              views_(problem.views(options.views)) {
+            const size_t n = problem.size();
+            longOnly_.add(std::make_shared<optimizer::LongOnlyConstraint>());
+
+            // At most 3 / n per asset, assets spread over up to five capped sectors
+            size_t sectors = std::min<size_t>(5, n);
+            auto limits = std::make_shared<optimizer::PackedConstraints>(
+                n, 0.0, std::min(1.0, 3.0 / static_cast<double>(n)));
+            for (size_t s = 0; s < sectors; ++s) {
+                limits->addSector(std::string("S") + std::to_string(s + 1), 0.0,
+                                  std::min(1.0, 2.0 / static_cast<double>(sectors)));
+            }
+            for (size_t i = 0; i < n; ++i) {
+                limits->setSector(i, i % sectors);
+            }
+            packed_.add(limits);
+
+            const core::Vector& mu = problem.returns().data();
+            target_ = mu.sum() / static_cast<double>(n);
+        }
+
+        Step step(const std::string& path) const {
+            const optimizer::SyntheticProblem& p = problem_;
+            auto f = factorization_;
+            if (path == "factorize") {
+                return [&p] {
+                    return optimizer::CovarianceFactorization::create(p.covariance()) != nullptr;
+                };
+            }
+            if (path == "mpt-min-variance") {
+                return [&p, f] { return markowitz(p, {}, f).minimumVariance().success(); };
+            }
+            if (path == "mpt-optimize") {
+                return [&p, f] { return markowitz(p, {}, f).optimize(1.0).success(); };
+            }
+            if (path == "mpt-target-return") {
+                return [&p, f, this] {
+                    return markowitz(p, {}, f).targetReturn(target_).success();
+                };
+            }
+            if (path == "mpt-long-only") {
+                return [&p, f, this] {
+                    return markowitz(p, longOnly_, f).minimumVariance().success();
+                };
+            }
+            if (path == "mpt-packed") {
+                return [&p, f, this] {
+                    return markowitz(p, packed_, f).minimumVariance().success();
+                };
+            }
+            if (path == "efficient-frontier") {
+                return [&p, f] {
+                    auto frontier = markowitz(p, {}, f).efficientFrontier(20);
+                    return !frontier.empty();
+                };
+            }
+            if (path == "frontier-engine") {
+                return [&p, f, this] {
+                    optimizer::FrontierEngine engine(p.returns(), p.covariance(), {}, f);
+                    optimizer::FrontierOptions frontierOptions;
+                    frontierOptions.points = 100;
+                    frontierOptions.threads = options_.threads;
+                    // Like efficientFrontier(), points below every asset's return are skipped
+                    return !engine.compute(frontierOptions).empty();
+                };
+            }
+            if (path == "bl") {
+                return [&p, f, this] {
+                    optimizer::BlackLittermanOptimizer bl(p.marketWeights(), p.covariance(), 2.5);
+                    bl.setCovarianceFactorization(f);
+                    for (const auto& view : views_) {
+                        bl.addView(view);
+                    }
+                    return bl.optimize().success();
+                };
+            }
+            throw std::invalid_argument("Unknown bench path: " + path);
+        }
+
+    private:
+        const optimizer::SyntheticProblem& problem_;
+        const BenchOptions& options_;
+        std::shared_ptr<const optimizer::CovarianceFactorization> factorization_;
+        std::vector<optimizer::View> views_;
+        optimizer::ConstraintSet longOnly_;
+        optimizer::ConstraintSet packed_;
+        double target_ = 0.0;
+
+        static optimizer::MarkowitzOptimizer markowitz(
+            const optimizer::SyntheticProblem& p, const optimizer::ConstraintSet& constraints,
+            std::shared_ptr<const optimizer::CovarianceFactorization> f) {
+            return optimizer::MarkowitzOptimizer(p.returns(), p.covariance(), constraints,
+                                                 std::move(f));
+        }
+    };
+
+    static constexpr size_t MAX_REPETITIONS = 1000000;
+
+    static BenchResult measure(const std::string& path, size_t assets, const Step& step,
+                               const BenchOptions& options) {
+        using Clock = std::chrono::steady_clock;
+        for (size_t i = 0; i < options.warmup; ++i) {
+            step();
+        }
+
+        BenchResult result;
+        result.path = path;
+        result.assets = assets;
+        std::vector<double> micros;
+        auto begin = Clock::now();
+        auto done = [&] {
+            if (options.repetitions > 0) {
+                return result.repetitions >= options.repetitions;
+            }
+            return result.repetitions >= MAX_REPETITIONS ||
+                   (result.repetitions >= 3 && secondsSince(begin) >= options.minSeconds);
+        };
+        while (!done()) {
+            auto start = Clock::now();
+            bool success = step();
+            micros.push_back(
+                std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            ++result.repetitions;
+            result.failures += success ? 0 : 1;
+        }
+        result.seconds = secondsSince(begin);
+
+        result.latency = LatencySummary::fromSamples(std::move(micros));
+        return result;
+    }
+
+    static BenchOptions parseOptions(const ArgParser& parser) {
+        BenchOptions options;
+        if (parser.hasFlag("sizes")) {
+            options.sizes.clear();
+            for (const auto& item : split(parser.getFlagValue("sizes"))) {
+                options.sizes.push_back(parseCount(item, "Size", 1, 100000));
+            }
+        }
+        if (parser.hasFlag("paths")) {
+            options.paths = split(parser.getFlagValue("paths"));
+            for (const auto& path : options.paths) {
+                const auto& names = pathNames();
+                if (std::find(names.begin(), names.end(), path) == names.end()) {
+                    throw std::invalid_argument("Unknown path '" + path + "'");
+                }
+            }
+        }
+        if (parser.hasFlag("repetitions")) {
+            options.repetitions =
+                parseCount(parser.getFlagValue("repetitions"), "Repetitions", 1, MAX_REPETITIONS);
+        }
+        if (parser.hasFlag("min-time")) {
+            options.minSeconds = parseNumber(parser.getFlagValue("min-time"), "Minimum time");
+            if (options.minSeconds < 0.0) {
+                throw std::invalid_argument("Minimum time cannot be negative");
+            }
+        }
+        if (parser.hasFlag("warmup")) {
+            options.warmup = parseCount(parser.getFlagValue("warmup"), "Warmup", 0, 1000);
+        }
+        if (parser.hasFlag("threads")) {
+            options.threads = parseCount(parser.getFlagValue("threads"), "Thread count", 1, 1024);
+        }
+        if (parser.hasFlag("views")) {
+            options.views = parseCount(parser.getFlagValue("views"), "View count", 0, 10000);
+        }
+        if (parser.hasFlag("factors")) {
+            options.problem.factors =
+                parseCount(parser.getFlagValue("factors"), "Factor count", 0, 1000);
+        }
+        if (parser.hasFlag("condition")) {
+            options.problem.conditionNumber =
+                parseNumber(parser.getFlagValue("condition"), "Condition number");
+        }
+        if (parser.hasFlag("seed")) {
+            options.problem.seed = parseCount(parser.getFlagValue("seed"), "Seed", 0,
+                                              std::numeric_limits<long long>::max());
+        }
+        return options;
+    }
+
+    static std::vector<std::string> split(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        if (items.empty()) {
+            throw std::invalid_argument("Expected a comma-separated list, got '" + list + "'");
+        }
+        return items;
+    }
+
+    static size_t parseCount(const std::string& value, const std::string& what, long long min,
+                             long long max) {
+        size_t consumed = 0;
+        long long count = 0;
+        try {
+            count = std::stoll(value, &consumed);
+        } catch (const std::exception&) {
+            consumed = 0;
+        }
+        if (consumed != value.size() || count < min || count > max) {
+            throw std::invalid_argument(what + " must be an integer between " +
+                                        std::to_string(min) + " and " + std::to_string(max));
+        }
+        return static_cast<size_t>(count);
+    }
+
+    static double parseNumber(const std::string& value, const std::string& what) {
+        size_t consumed = 0;
+        double number = 0.0;
+        try {
+            number = std::stod(value, &consumed);
+        } catch (const std::exception&) {
+            consumed = 0;
+        }
+        if (consumed != value.size() || !std::isfinite(number)) {
+            throw std::invalid_argument(what + " must be a finite number");
+        }
+        return number;
+    }
+
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::string hostName() {
+#if defined(__unix__) || defined(__APPLE__)
+        char name[256] = {};
+        if (::gethostname(name, sizeof(name) - 1) == 0) {
+            return name;
+        }
+#endif
+        return "unknown";
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    // Current UTC time as ISO 8601
+    static std::string timestamp() {
+        std::time_t now = std::time(nullptr);
+        std::tm utc{};
+#if defined(_WIN32)
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        return buffer;
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
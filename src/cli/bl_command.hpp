@@ -5,12 +5,17 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
 #include "arg_parser.hpp"
 #include "error_codes.hpp"
 #include "file_parser.hpp"
+#include "profiler.hpp"
+#include "result_output.hpp"
+#include "trace_output.hpp"
+#include "watch_session.hpp"
 
 namespace orbat {
 namespace cli {
@@ -55,6 +60,25 @@ public:
                 return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
             }
 
+            // Parse output options before doing any work
+            OutputOptions outputOptions;
+            Profiler profiler;
+            TraceOutput trace;
+            try {
+                outputOptions = OutputOptions::fromParser(parser);
+                profiler = Profiler::fromParser(parser);
+                trace = TraceOutput::fromParser(parser);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid output options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat bl --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            if (parser.hasFlag("watch")) {
+                return watch(parser, outputOptions);
+            }
+
             // Load input data
             // Note: For Black-Litterman, --returns actually contains market weights
             std::string marketWeightsFile = parser.getFlagValue("returns");
@@ -63,6 +87,7 @@ public:
             // Parse market weights with enhanced error handling
             optimizer::ExpectedReturns marketWeightsData;
             try {
+                auto scope = profiler.phase("parse returns");
                 marketWeightsData = FileParser::parseReturns(marketWeightsFile);
                 if (marketWeightsData.empty()) {
                     std::cerr << "Error: Empty market weights - File '" << marketWeightsFile
@@ -83,7 +108,13 @@ public:
             // Parse covariance with enhanced error handling
             optimizer::CovarianceMatrix covariance;
             try {
-                covariance = FileParser::parseCovariance(covarianceFile);
+                core::Matrix covarianceData;
+                {
+                    auto scope = profiler.phase("parse covariance");
+                    covarianceData = FileParser::parseCovarianceData(covarianceFile);
+                }
+                auto scope = profiler.phase("validate");
+                covariance = optimizer::CovarianceMatrix(std::move(covarianceData));
                 if (covariance.empty()) {
                     std::cerr << "Error: Empty covariance matrix - File '" << covarianceFile
                               << "' contains no valid data" << std::endl;
@@ -133,15 +164,29 @@ public:
                 // but could be used for Sharpe ratio calculation
             }
 
+            // Factorize once; the model and the final optimization share it
+            std::shared_ptr<const optimizer::CovarianceFactorization> factorization;
+            try {
+                auto scope = profiler.phase("factorize");
+                factorization = optimizer::CovarianceFactorization::create(covariance);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Optimization failed" << std::endl;
+                std::cerr << "Details: Optimization failed: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::COMPUTATION_ERROR);
+            }
+
             // Create Black-Litterman optimizer
+            auto optimizeScope = profiler.phase("optimize");
             optimizer::BlackLittermanOptimizer blOptimizer(marketWeights, covariance, riskAversion,
                                                            tau);
+            blOptimizer.setCovarianceFactorization(factorization);
 
             // Note: View specification is not yet implemented in CLI.
             // Planned feature: Support loading investor views from JSON/CSV files
             // to incorporate subjective beliefs about expected returns.
             // For now, the optimizer uses only the equilibrium returns derived from market weights.
             auto result = blOptimizer.optimize();
+            optimizeScope.stop();
 
             // Check if optimization succeeded
             if (!result.success()) {
@@ -149,27 +194,32 @@ public:
                 if (!result.message.empty()) {
                     std::cerr << "Details: " << result.message << std::endl;
                 }
+                profiler.report();
                 return static_cast<int>(ExitCode::COMPUTATION_ERROR);
             }
 
             // Output results
-            std::string outputFile = parser.getFlagValue("output", "");
-            if (outputFile.empty()) {
+            auto outputScope = profiler.phase("output");
+            if (outputOptions.humanReadable()) {
                 // Print to stdout
                 printResult(blOptimizer, result);
             } else {
-                // Write to file
+                // Serialize to file or stdout
                 try {
-                    writeResult(result, outputFile);
-                    std::cout << "Results written to: " << outputFile << std::endl;
+                    ResultOutput::write(result, outputOptions, marketWeightsData.labels());
+                    if (!outputOptions.toStdout()) {
+                        std::cout << "Results written to: " << outputOptions.path << std::endl;
+                    }
                 } catch (const std::runtime_error& e) {
-                    std::cerr << "Error: Failed to write output to '" << outputFile << "'"
+                    std::cerr << "Error: Failed to write output to '" << outputOptions.path << "'"
                               << std::endl;
                     std::cerr << "Details: " << e.what() << std::endl;
                     return static_cast<int>(ExitCode::VALIDATION_ERROR);
                 }
             }
+            outputScope.stop();
 
+            profiler.report();
             return static_cast<int>(ExitCode::SUCCESS);
 
         } catch (const std::exception& e) {
@@ -195,7 +245,14 @@ public:
                   << "Optional Flags:\n"
                   << "  --rf-rate <value>      Risk-free rate (for Sharpe ratio, default: 0.0)\n"
                   << "  --constraints <file>   Path to constraints file (not yet implemented)\n"
-                  << "  --output <file>        Output file (JSON format, default: stdout)\n"
+                  << "  --output <file|->      Write results to a file, or '-' for stdout\n"
+                  << "  --format <name>        Output format: json (default), ndjson, csv, binary\n"
+                  << "  --watch                Re-optimize whenever an input file changes\n"
+                  << "  --profile [table|json] Report time and memory per phase on stderr\n"
+                  << "  --profile-output <file>\n"
+                  << "                         Write the profile report to a file instead\n"
+                  << "  --profile-counters     Add CPU hardware counters to the profile (Linux)\n"
+                  << "  --trace <file>         Write a Chrome trace of the run's phases\n"
                   << "  --help, -h             Show this help message\n"
                   << "\n"
                   << "Note: The --returns file should contain market capitalization weights,\n"
@@ -205,10 +262,40 @@ public:
                   << "Examples:\n"
                   << "  orbat bl --returns market_weights.csv --covariance cov.csv\n"
                   << "  orbat bl --returns market_weights.csv --covariance cov.csv --output "
-                     "result.json\n";
+                     "result.json\n"
+                  << "  orbat bl --returns market_weights.csv --covariance cov.csv --watch\n";
     }
 
 private:
+    /**
+     * @brief Run in watch mode: re-optimize whenever an input file changes.
+     *
+     * Only changed files are re-parsed, and the covariance factorization is
+     * reused unless the covariance values changed (see IncrementalInputs).
+     *
+     * @param parser Argument parser
+     * @param outputOptions Where each result is written
+     * @return Exit code after the session is interrupted
+     */
+    static int watch(const ArgParser& parser, const OutputOptions& outputOptions) {
+        IncrementalInputs inputs(parser.getFlagValue("returns"),
+                                 parser.getFlagValue("covariance"));
+        return WatchSession::run(inputs, [&](const IncrementalInputs& current) {
+            optimizer::BlackLittermanOptimizer blOptimizer(current.returns().data(),
+                                                           current.covariance(), 2.5, 0.025);
+            blOptimizer.setCovarianceFactorization(current.factorization());
+            optimizer::MarkowitzResult result = blOptimizer.optimize();
+            if (!result.success()) {
+                throw std::runtime_error(result.message);
+            }
+            if (outputOptions.humanReadable()) {
+                printResult(blOptimizer, result);
+            } else {
+                ResultOutput::write(result, outputOptions, current.returns().labels());
+            }
+        });
+    }
+
     /**
      * @brief Print optimization result to stdout.
      */
@@ -240,18 +327,6 @@ private:
         }
         std::cout << std::endl;
     }
-
-    /**
-     * @brief Write optimization result to file in JSON format.
-     */
-    static void writeResult(const optimizer::MarkowitzResult& result, const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open output file: " + filename);
-        }
-        file << result.toJSON();
-        file.close();
-    }
 };
 
 }  // namespace cli
@@ -0,0 +1,331 @@
+#pragma once
+
+#include "orbat/optimizer/packed_constraints.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "json_reader.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Loads a constraints file (--constraints) into PackedConstraints.
+ *
+ * Constraints are keyed by asset label. Assets not listed in the file take
+ * the default bounds (long-only, at most 100% unless the file overrides the
+ * default). Files ending in ".json" are read as JSON, anything else as CSV:
+ *
+ *   {
+ *     "default": {"min": 0.0, "max": 0.05},
+ *     "sectors": {"Tech": {"min": 0.10, "max": 0.40}},
+ *     "assets": {"AAPL": {"max": 0.08, "sector": "Tech"}, ...}
+ *   }
+ *
+ *   kind,name,min,max,sector
+ *   default,,0.0,0.05,
+ *   sector,Tech,0.10,0.40,
+ *   asset,AAPL,,0.08,Tech
+ *
+ * Empty or omitted min/max fields fall back to the default. Entries are
+ * written straight into the packed arrays, so loading and validation take
+ * one pass over the file plus one pass over the assets.
+ *
+ * Example:
+ *   PackedConstraints limits = ConstraintsLoader::load("limits.csv", returns.labels());
+ *   constraints.add(std::make_shared<PackedConstraints>(std::move(limits)));
+ */
+class ConstraintsLoader {
+public:
+    /**
+     * @brief Load a constraints file.
+     *
+     * @param filename Path to a .json or CSV constraints file
+     * @param labels Asset labels, in optimizer order
+     * @return Validated packed constraints
+     * @throws std::runtime_error if the file cannot be read or is malformed
+     * @throws std::invalid_argument if the constraints are inconsistent or infeasible
+     */
+    static optimizer::PackedConstraints load(const std::string& filename,
+                                             const std::vector<std::string>& labels) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open constraints file: " + filename);
+        }
+        const std::string suffix = ".json";
+        bool json = filename.size() >= suffix.size() &&
+                    filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+        if (json) {
+            std::string text((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+            return parseJSON(text, labels);
+        }
+        return parseCSV(file, labels);
+    }
+
+    /**
+     * @brief Parse constraints in JSON format.
+     *
+     * @param text JSON document
+     * @param labels Asset labels, in optimizer order
+     * @return Validated packed constraints
+     * @throws std::runtime_error if the document is malformed
+     * @throws std::invalid_argument if the constraints are inconsistent or infeasible
+     */
+    static optimizer::PackedConstraints parseJSON(const std::string& text,
+                                                  const std::vector<std::string>& labels) {
+        JsonValue root = JsonValue::parse(text);
+        if (!root.isObject()) {
+            throw std::runtime_error("Constraints file must contain a JSON object");
+        }
+        Builder builder(labels);
+        for (const auto& [key, value] : root.asObject()) {
+            if (key == "default") {
+                builder.setDefault(number(value, "min"), number(value, "max"));
+            } else if (key == "sectors") {
+                for (const auto& [name, limits] : value.asObject()) {
+                    builder.defineSector(name, number(limits, "min"), number(limits, "max"));
+                }
+            } else if (key == "assets") {
+                for (const auto& [label, entry] : value.asObject()) {
+                    builder.setAsset(label, number(entry, "min"), number(entry, "max"),
+                                     entry.getString("sector", ""));
+                }
+            } else {
+                throw std::runtime_error("Unknown constraints key: " + key);
+            }
+        }
+        return builder.finish();
+    }
+
+    /**
+     * @brief Parse constraints in CSV format.
+     *
+     * Rows are "kind,name,min,max,sector" with kind one of default, sector
+     * or asset. A header row starting with "kind" and lines starting with
+     * '#' are skipped.
+     *
+     * @param in Input stream
+     * @param labels Asset labels, in optimizer order
+     * @return Validated packed constraints
+     * @throws std::runtime_error if a row is malformed
+     * @throws std::invalid_argument if the constraints are inconsistent or infeasible
+     */
+    static optimizer::PackedConstraints parseCSV(std::istream& in,
+                                                 const std::vector<std::string>& labels) {
+        Builder builder(labels);
+        std::string line;
+        size_t lineNumber = 0;
+        std::vector<std::string> fields;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            size_t start = line.find_first_not_of(" \t\r\n");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            split(line, fields);
+            if (fields[0] == "kind") {
+                continue;
+            }
+            try {
+                if (fields.size() > 5) {
+                    throw std::runtime_error("expected at most 5 fields");
+                }
+                fields.resize(5);
+                double min = parseBound(fields[2]);
+                double max = parseBound(fields[3]);
+                if (fields[0] == "default") {
+                    builder.setDefault(min, max);
+                } else if (fields[0] == "sector") {
+                    builder.defineSector(fields[1], min, max);
+                } else if (fields[0] == "asset") {
+                    builder.setAsset(fields[1], min, max, fields[4]);
+                } else {
+                    throw std::runtime_error("unknown row kind '" + fields[0] + "'");
+                }
+            } catch (const std::invalid_argument& e) {
+                throw std::invalid_argument("Constraints file line " +
+                                            std::to_string(lineNumber) + ": " + e.what());
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("Constraints file line " + std::to_string(lineNumber) +
+                                         ": " + e.what());
+            }
+        }
+        return builder.finish();
+    }
+
+private:
+    /// Marks a bound that was not given and takes the default.
+    static constexpr double UNSET = std::numeric_limits<double>::quiet_NaN();
+
+    /**
+     * @brief Accumulates entries directly into packed arrays.
+     */
+    class Builder {
+    public:
+        explicit Builder(const std::vector<std::string>& labels)
+            : lower_(labels.size(), UNSET), upper_(labels.size(), UNSET),
+              sectorOf_(labels.size(), optimizer::PackedConstraints::NO_SECTOR),
+              seen_(labels.size(), false) {
+            if (labels.empty()) {
+                throw std::invalid_argument(
+                    "Constraints are keyed by asset label, but the assets have no labels");
+            }
+            index_.reserve(labels.size());
+            for (size_t i = 0; i < labels.size(); ++i) {
+                if (!index_.emplace(labels[i], i).second) {
+                    throw std::invalid_argument("Duplicate asset label: " + labels[i]);
+                }
+            }
+        }
+
+        void setDefault(double min, double max) {
+            if (!std::isnan(min)) {
+                defaultLower_ = min;
+            }
+            if (!std::isnan(max)) {
+                defaultUpper_ = max;
+            }
+        }
+
+        void defineSector(const std::string& name, double min, double max) {
+            uint32_t sector = sectorIndex(name);
+            if (sectorDefined_[sector]) {
+                throw std::invalid_argument("Duplicate sector: " + name);
+            }
+            sectorDefined_[sector] = true;
+            sectorLower_[sector] = std::isnan(min) ? 0.0 : min;
+            sectorUpper_[sector] = std::isnan(max) ? 1.0 : max;
+        }
+
+        void setAsset(const std::string& label, double min, double max,
+                      const std::string& sector) {
+            auto it = index_.find(label);
+            if (it == index_.end()) {
+                throw std::invalid_argument("Unknown asset label: " + label);
+            }
+            size_t asset = it->second;
+            if (seen_[asset]) {
+                throw std::invalid_argument("Duplicate asset: " + label);
+            }
+            seen_[asset] = true;
+            lower_[asset] = min;
+            upper_[asset] = max;
+            if (!sector.empty()) {
+                sectorOf_[asset] = sectorIndex(sector);
+            }
+        }
+
+        optimizer::PackedConstraints finish() {
+            for (size_t s = 0; s < sectorNames_.size(); ++s) {
+                if (!sectorDefined_[s]) {
+                    throw std::invalid_argument("Sector '" + sectorNames_[s] +
+                                                "' is used by an asset but has no limits");
+                }
+            }
+            for (size_t i = 0; i < lower_.size(); ++i) {
+                if (std::isnan(lower_[i])) {
+                    lower_[i] = defaultLower_;
+                }
+                if (std::isnan(upper_[i])) {
+                    upper_[i] = defaultUpper_;
+                }
+            }
+            optimizer::PackedConstraints packed(std::move(lower_), std::move(upper_));
+            for (size_t s = 0; s < sectorNames_.size(); ++s) {
+                packed.addSector(sectorNames_[s], sectorLower_[s], sectorUpper_[s]);
+            }
+            for (size_t i = 0; i < sectorOf_.size(); ++i) {
+                if (sectorOf_[i] != optimizer::PackedConstraints::NO_SECTOR) {
+                    packed.setSector(i, sectorOf_[i]);
+                }
+            }
+            packed.validate();
+            return packed;
+        }
+
+    private:
+        std::unordered_map<std::string, size_t> index_;
+        std::vector<double> lower_;
+        std::vector<double> upper_;
+        std::vector<uint32_t> sectorOf_;
+        std::vector<bool> seen_;
+        double defaultLower_ = 0.0;
+        double defaultUpper_ = 1.0;
+        std::unordered_map<std::string, uint32_t> sectorIndex_;
+        std::vector<std::string> sectorNames_;
+        std::vector<double> sectorLower_;
+        std::vector<double> sectorUpper_;
+        std::vector<bool> sectorDefined_;
+
+        // Sectors may be referenced before they are defined
+        uint32_t sectorIndex(const std::string& name) {
+            if (name.empty()) {
+                throw std::invalid_argument("Sector name cannot be empty");
+            }
+            auto [it, inserted] =
+                sectorIndex_.emplace(name, static_cast<uint32_t>(sectorNames_.size()));
+            if (inserted) {
+                sectorNames_.push_back(name);
+                sectorLower_.push_back(0.0);
+                sectorUpper_.push_back(1.0);
+                sectorDefined_.push_back(false);
+            }
+            return it->second;
+        }
+    };
+
+    static double number(const JsonValue& object, const char* key) {
+        if (!object.isObject()) {
+            throw std::runtime_error("Constraint entries must be JSON objects");
+        }
+        return object.has(key) ? object[key].asNumber() : UNSET;
+    }
+
+    static double parseBound(const std::string& field) {
+        if (field.empty()) {
+            return UNSET;
+        }
+        size_t consumed = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(field, &consumed);
+        } catch (const std::exception&) {
+            consumed = 0;
+        }
+        if (consumed != field.size() || !std::isfinite(value)) {
+            throw std::runtime_error("invalid number '" + field + "'");
+        }
+        return value;
+    }
+
+    // Split on commas and trim each field; reuses the output vector's storage
+    static void split(const std::string& line, std::vector<std::string>& fields) {
+        fields.clear();
+        size_t begin = 0;
+        while (true) {
+            size_t end = line.find(',', begin);
+            std::string field = line.substr(begin, end == std::string::npos ? end : end - begin);
+            size_t first = field.find_first_not_of(" \t\r\n");
+            size_t last = field.find_last_not_of(" \t\r\n");
+            fields.push_back(first == std::string::npos ? ""
+                                                        : field.substr(first, last - first + 1));
+            if (end == std::string::npos) {
+                break;
+            }
+            begin = end + 1;
+        }
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
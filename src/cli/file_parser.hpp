@@ -1,6 +1,7 @@
 #pragma once
 
 #include "orbat/core/matrix.hpp"
+#include "orbat/core/trace.hpp"
 #include "orbat/core/vector.hpp"
 #include "orbat/optimizer/covariance_matrix.hpp"
 #include "orbat/optimizer/expected_returns.hpp"
@@ -25,6 +26,8 @@ public:
      * @brief Parse a returns vector from a CSV file.
      *
      * Expected format: single column of numbers or comma-separated values.
+     * Rows of the form "<return>,<label>" attach asset labels instead; then
+     * every row needs a label and a "return,label" header row is allowed.
      * Comments starting with # are ignored.
      *
      * @param filename Path to the CSV file
@@ -32,13 +35,16 @@ public:
      * @throws std::runtime_error if file cannot be read or format is invalid
      */
     static optimizer::ExpectedReturns parseReturns(const std::string& filename) {
+        ORBAT_TRACE_SPAN("FileParser::parseReturns", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open returns file: " + filename);
         }
 
         std::vector<double> returns;
+        std::vector<std::string> labels;
         std::string line;
+        bool firstRow = true;
 
         while (std::getline(file, line)) {
             // Skip empty lines and trim whitespace
@@ -54,12 +60,31 @@ public:
             // Parse comma-separated values
             std::istringstream iss(line);
             std::string token;
+            std::vector<std::string> tokens;
             while (std::getline(iss, token, ',')) {
-                try {
-                    returns.push_back(std::stod(token));
-                } catch (const std::exception&) {
-                    throw std::runtime_error("Invalid number in returns file: " + token);
+                tokens.push_back(token);
+            }
+
+            // "<return>,<label>" rows (and a "return,label" header)
+            if (tokens.size() == 2 && !isNumber(tokens[1])) {
+                bool header = firstRow && !isNumber(tokens[0]);
+                firstRow = false;
+                if (header) {
+                    continue;
                 }
+                if (labels.size() != returns.size()) {
+                    throw std::runtime_error("Returns file mixes labelled and unlabelled rows");
+                }
+                returns.push_back(parseNumber(tokens[0], "returns"));
+                labels.push_back(trim(tokens[1]));
+                continue;
+            }
+            firstRow = false;
+            if (!labels.empty()) {
+                throw std::runtime_error("Returns file mixes labelled and unlabelled rows");
+            }
+            for (const auto& value : tokens) {
+                returns.push_back(parseNumber(value, "returns"));
             }
         }
 
@@ -67,6 +92,9 @@ public:
             throw std::runtime_error("No valid returns data found in file: " + filename);
         }
 
+        if (!labels.empty()) {
+            return optimizer::ExpectedReturns(core::Vector(returns), labels);
+        }
         return optimizer::ExpectedReturns(core::Vector(returns));
     }
 
@@ -81,6 +109,23 @@ public:
      * @throws std::runtime_error if file cannot be read or format is invalid
      */
     static optimizer::CovarianceMatrix parseCovariance(const std::string& filename) {
+        return optimizer::CovarianceMatrix(parseCovarianceData(filename));
+    }
+
+    /**
+     * @brief Read a covariance matrix CSV file without validating it.
+     *
+     * Only the file format is checked (numeric, square). Symmetry and
+     * positive-definiteness are checked when the result is passed to the
+     * CovarianceMatrix constructor, which lets callers time the two steps
+     * separately.
+     *
+     * @param filename Path to the CSV file
+     * @return Raw square matrix
+     * @throws std::runtime_error if file cannot be read or format is invalid
+     */
+    static core::Matrix parseCovarianceData(const std::string& filename) {
+        ORBAT_TRACE_SPAN("FileParser::parseCovarianceData", "parse");
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open covariance file: " + filename);
@@ -137,7 +182,35 @@ public:
             }
         }
 
-        return optimizer::CovarianceMatrix(mat);
+        return mat;
+    }
+
+private:
+    static bool isNumber(const std::string& token) {
+        try {
+            size_t consumed = 0;
+            std::stod(token, &consumed);
+            return trim(token.substr(consumed)).empty();
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    static double parseNumber(const std::string& token, const std::string& what) {
+        try {
+            return std::stod(token);
+        } catch (const std::exception&) {
+            throw std::runtime_error("Invalid number in " + what + " file: " + token);
+        }
+    }
+
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
     }
 };
 
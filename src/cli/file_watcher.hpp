@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#define ORBAT_HAS_INOTIFY 1
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Waits for changes to a fixed set of input files (--watch).
+ *
+ * On Linux the watcher uses inotify on the files' parent directories, so it
+ * sees both in-place writes and editors that save by renaming a temporary
+ * file over the original. Other platforms poll modification times. Bursts
+ * of events (an editor writing a file in several steps) are merged: wait()
+ * returns once no further change has been seen for the debounce interval.
+ *
+ * Example:
+ *   FileWatcher watcher({"returns.csv", "cov.csv"});
+ *   while (!stop) {
+ *       std::vector<size_t> changed = watcher.wait(&stop);
+ *       // changed holds indices into the path list
+ *   }
+ */
+class FileWatcher {
+public:
+    /**
+     * @brief Start watching files.
+     * @param paths Files to watch (they must exist)
+     * @param debounce Quiet period that ends a burst of changes
+     * @throws std::runtime_error if a file does not exist or cannot be watched
+     */
+    explicit FileWatcher(std::vector<std::string> paths,
+                         std::chrono::milliseconds debounce = std::chrono::milliseconds(50))
+        : paths_(std::move(paths)), debounce_(debounce) {
+        if (paths_.empty()) {
+            throw std::invalid_argument("FileWatcher needs at least one file");
+        }
+        for (const auto& path : paths_) {
+            if (!std::filesystem::exists(path)) {
+                throw std::runtime_error("Cannot watch missing file: " + path);
+            }
+        }
+#ifdef ORBAT_HAS_INOTIFY
+        fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error(std::string("inotify_init1 failed: ") +
+                                     std::strerror(errno));
+        }
+        for (size_t i = 0; i < paths_.size(); ++i) {
+            std::filesystem::path path(paths_[i]);
+            std::string dir = path.has_parent_path() ? path.parent_path().string() : ".";
+            int wd = ::inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0) {
+                int error = errno;
+                ::close(fd_);
+                throw std::runtime_error("Cannot watch directory '" + dir +
+                                         "': " + std::strerror(error));
+            }
+            watches_[wd].emplace_back(path.filename().string(), i);
+        }
+#else
+        for (const auto& path : paths_) {
+            stamps_.push_back(stamp(path));
+        }
+#endif
+    }
+
+    ~FileWatcher() {
+#ifdef ORBAT_HAS_INOTIFY
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Get the watched paths.
+     */
+    const std::vector<std::string>& paths() const { return paths_; }
+
+    /**
+     * @brief Check whether changes are detected with inotify (rather than polling).
+     */
+    static bool usesInotify() {
+#ifdef ORBAT_HAS_INOTIFY
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Block until watched files change.
+     *
+     * @param stop Optional flag; when it becomes true wait() returns early
+     * @param timeout Give up after this long (negative = wait indefinitely)
+     * @return Sorted indices of the changed files (empty on stop or timeout)
+     */
+    std::vector<size_t> wait(const std::atomic<bool>* stop = nullptr,
+                             std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) {
+        using Clock = std::chrono::steady_clock;
+        const auto deadline = Clock::now() + timeout;
+        std::vector<bool> changed(paths_.size(), false);
+        bool any = false;
+
+        while (true) {
+            if (stop != nullptr && stop->load()) {
+                return {};
+            }
+            // Before the first change, wake up regularly to check stop and the
+            // timeout; after it, wait one debounce interval for the burst to end
+            auto slice = any ? debounce_ : std::chrono::milliseconds(100);
+            if (!any && timeout.count() >= 0) {
+                auto left =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+                if (left.count() <= 0) {
+                    return {};
+                }
+                slice = std::min(slice, left);
+            }
+            bool seen = poll(slice, changed);
+            any = any || seen;
+            if (any && !seen) {
+                break;
+            }
+        }
+
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i]) {
+                indices.push_back(i);
+            }
+        }
+        return indices;
+    }
+
+private:
+    std::vector<std::string> paths_;
+    std::chrono::milliseconds debounce_;
+
+#ifdef ORBAT_HAS_INOTIFY
+    int fd_ = -1;
+    // Watch descriptor -> (file name, path index) of the files in that directory
+    std::map<int, std::vector<std::pair<std::string, size_t>>> watches_;
+
+    // Wait up to `slice` for events; mark matching files; return true if any matched
+    bool poll(std::chrono::milliseconds slice, std::vector<bool>& changed) {
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, static_cast<int>(slice.count()));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                return false;
+            }
+            throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+        }
+        if (ready == 0) {
+            return false;
+        }
+
+        bool matched = false;
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = ::read(fd_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;  // EAGAIN: queue drained
+            }
+            for (char* p = buffer; p < buffer + length;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                auto it = watches_.find(event->wd);
+                if (it != watches_.end() && event->len > 0) {
+                    std::string name(event->name);
+                    for (const auto& [file, index] : it->second) {
+                        if (file == name) {
+                            changed[index] = true;
+                            matched = true;
+                        }
+                    }
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        return matched;
+    }
+#else
+    struct Stamp {
+        std::filesystem::file_time_type time{};
+        std::uintmax_t size = 0;
+        bool operator!=(const Stamp& other) const {
+            return time != other.time || size != other.size;
+        }
+    };
+    std::vector<Stamp> stamps_;
+
+    static Stamp stamp(const std::string& path) {
+        std::error_code ec;
+        Stamp s;
+        s.time = std::filesystem::last_write_time(path, ec);
+        s.size = std::filesystem::file_size(path, ec);
+        return s;
+    }
+
+    bool poll(std::chrono::milliseconds slice, std::vector<bool>& changed) {
+        std::this_thread::sleep_for(slice);
+        bool matched = false;
+        for (size_t i = 0; i < paths_.size(); ++i) {
+            Stamp now = stamp(paths_[i]);
+            if (now != stamps_[i]) {
+                stamps_[i] = now;
+                changed[i] = true;
+                matched = true;
+            }
+        }
+        return matched;
+    }
+#endif
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "arg_parser.hpp"
+#include "error_codes.hpp"
+#include "file_parser.hpp"
+#include "trace_output.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Efficient frontier command implementation.
+ *
+ * Implements the 'frontier' command: computes the efficient frontier with
+ * optimizer::FrontierEngine on a thread pool and streams each point to the
+ * output as soon as it and all points before it are ready, so the frontier
+ * is never held in memory.
+ */
+class FrontierCommand {
+public:
+    /**
+     * @brief Execute the frontier command.
+     * @param parser Argument parser containing command-line arguments
+     * @return Exit code (0 for success, non-zero for error)
+     */
+    static int execute(const ArgParser& parser) {
+        try {
+            if (parser.isHelp()) {
+                printHelp();
+                return static_cast<int>(ExitCode::SUCCESS);
+            }
+
+            if (!parser.hasFlag("returns") || !parser.hasFlag("covariance")) {
+                std::cerr << "Error: Missing required input - "
+                          << (parser.hasFlag("returns") ? "Covariance matrix"
+                                                        : "Expected returns data")
+                          << " not provided" << std::endl;
+                std::cerr << "Usage: Use --returns <file> and --covariance <file> to specify "
+                             "the input CSV files"
+                          << std::endl;
+                std::cerr << "Run 'orbat frontier --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            // Parse options before doing any work
+            std::string outputPath = parser.getFlagValue("output", "-");
+            optimizer::OutputFormat format = optimizer::OutputFormat::CSV;
+            optimizer::FrontierOptions options;
+            double riskFreeRate = 0.0;
+            TraceOutput trace;
+            try {
+                format = optimizer::parseOutputFormat(parser.getFlagValue("format", "csv"));
+                if (parser.hasFlag("points")) {
+                    options.points = parseCount(parser.getFlagValue("points"), "Point count", 2,
+                                                1000000000);
+                }
+                if (parser.hasFlag("tolerance")) {
+                    options.tolerance = parseNumber(parser.getFlagValue("tolerance"), "Tolerance");
+                    if (options.tolerance <= 0.0) {
+                        throw std::invalid_argument("Tolerance must be positive");
+                    }
+                    if (!parser.hasFlag("points")) {
+                        options.points = 8;  // Initial grid; refinement adds the rest
+                    }
+                }
+                if (parser.hasFlag("threads")) {
+                    options.threads =
+                        parseCount(parser.getFlagValue("threads"), "Thread count", 1, 1024);
+                }
+                if (parser.hasFlag("rf-rate")) {
+                    riskFreeRate = parseNumber(parser.getFlagValue("rf-rate"), "Risk-free rate");
+                }
+                trace = TraceOutput::fromParser(parser);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid frontier options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat frontier --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            std::string returnsFile = parser.getFlagValue("returns");
+            std::string covarianceFile = parser.getFlagValue("covariance");
+            std::unique_ptr<optimizer::FrontierEngine> engine;
+            optimizer::ExpectedReturns returns;
+            try {
+                returns = FileParser::parseReturns(returnsFile);
+                optimizer::CovarianceMatrix covariance =
+                    FileParser::parseCovariance(covarianceFile);
+                optimizer::ConstraintSet constraints;
+                if (parser.hasFlag("long-only")) {
+                    constraints.add(std::make_shared<optimizer::LongOnlyConstraint>());
+                }
+                engine = std::make_unique<optimizer::FrontierEngine>(returns, covariance,
+                                                                     constraints);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid frontier inputs" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Hint: --returns and --covariance must describe the same assets, "
+                             "and the covariance matrix must be positive-definite"
+                          << std::endl;
+                return static_cast<int>(ExitCode::VALIDATION_ERROR);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            size_t points = 0;
+            try {
+                optimizer::OutputTarget target(outputPath);
+                optimizer::SinkOptions sinkOptions;
+                sinkOptions.assetLabels = returns.labels();
+                sinkOptions.includeIds = true;
+                sinkOptions.flushEachRecord = target.isStdout();
+                std::unique_ptr<optimizer::ResultSink> sink;
+                if (format == optimizer::OutputFormat::JSON) {
+                    sink = std::make_unique<optimizer::JsonResultSink>(target.stream(),
+                                                                       sinkOptions, "frontier");
+                } else {
+                    sink = optimizer::makeResultSink(format, target.stream(), sinkOptions);
+                }
+                points = engine->compute(
+                    options, [&](size_t index, const optimizer::MarkowitzResult& result) {
+                        if (riskFreeRate == 0.0) {
+                            sink->write(result, std::to_string(index));
+                            return;
+                        }
+                        optimizer::MarkowitzResult adjusted = result;
+                        adjusted.setRiskFreeRate(riskFreeRate);
+                        sink->write(adjusted, std::to_string(index));
+                    });
+                sink->finish();
+                if (!target.stream()) {
+                    throw std::runtime_error("Failed to write output: " + outputPath);
+                }
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Error: Frontier computation failed" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::COMPUTATION_ERROR);
+            }
+            double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cerr << "Frontier complete: " << points << " points ("
+                      << (options.tolerance > 0.0 ? "adaptive" : "fixed grid") << ", "
+                      << seconds << "s)" << std::endl;
+
+            return static_cast<int>(points > 0 ? ExitCode::SUCCESS
+                                               : ExitCode::COMPUTATION_ERROR);
+
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Unexpected error occurred" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Use 'orbat frontier --help' for usage information." << std::endl;
+            return static_cast<int>(ExitCode::INTERNAL_ERROR);
+        }
+    }
+
+    /**
+     * @brief Print help message for frontier command.
+     */
+    static void printHelp() {
+        std::cout
+            << "Usage: orbat frontier --returns <file> --covariance <file> [OPTIONS]\n"
+            << "\n"
+            << "Compute the efficient frontier and stream its points to the output\n"
+            << "\n"
+            << "Required Options:\n"
+            << "  --returns <file>       Path to returns CSV file\n"
+            << "  --covariance <file>    Path to covariance matrix CSV file\n"
+            << "\n"
+            << "Optional Flags:\n"
+            << "  --points <n>           Evenly spaced frontier points (default: 50)\n"
+            << "  --tolerance <risk>     Refine adaptively until the risk between neighbouring\n"
+            << "                         points is within this tolerance of the frontier\n"
+            << "                         (--points then sets the initial grid, default: 8)\n"
+            << "  --threads <n>          Worker threads (default: hardware concurrency)\n"
+            << "  --long-only            Restrict portfolios to non-negative weights\n"
+            << "  --rf-rate <value>      Risk-free rate for Sharpe ratios (default: 0.0)\n"
+            << "  --output <file|->      Write points to a file, or '-' for stdout (default)\n"
+            << "  --format <name>        Output format: csv (default), json, ndjson, binary\n"
+            << "  --trace <file>         Write a Chrome trace of the run's phases\n"
+            << "  --help, -h             Show this help message\n"
+            << "\n"
+            << "Examples:\n"
+            << "  orbat frontier --returns returns.csv --covariance cov.csv > frontier.csv\n"
+            << "  orbat frontier --returns returns.csv --covariance cov.csv --points 1000000 "
+               "--threads 8 --format binary --output frontier.bin\n"
+            << "  orbat frontier --returns returns.csv --covariance cov.csv --tolerance 1e-4\n";
+    }
+
+private:
+    static size_t parseCount(const std::string& value, const std::string& what, long long min,
+                             long long max) {
+        size_t consumed = 0;
+        long long count = std::stoll(value, &consumed);
+        if (consumed != value.size() || count < min || count > max) {
+            throw std::invalid_argument(what + " must be an integer between " +
+                                        std::to_string(min) + " and " + std::to_string(max));
+        }
+        return static_cast<size_t>(count);
+    }
+
+    static double parseNumber(const std::string& value, const std::string& what) {
+        size_t consumed = 0;
+        double number = std::stod(value, &consumed);
+        if (consumed != value.size() || !std::isfinite(number)) {
+            throw std::invalid_argument(what + " must be a finite number");
+        }
+        return number;
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
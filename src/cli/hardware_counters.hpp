@@ -0,0 +1,297 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Hardware events counted by HardwareCounters.
+ */
+enum class HardwareEvent { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, FLOPS };
+
+constexpr size_t HARDWARE_EVENT_COUNT = 5;
+
+/**
+ * @brief Counter values, one per HardwareEvent; empty for events that are
+ * not counted on this machine.
+ */
+struct HardwareCounts {
+    std::array<std::optional<double>, HARDWARE_EVENT_COUNT> values;
+
+    std::optional<double> operator[](HardwareEvent event) const {
+        return values[static_cast<size_t>(event)];
+    }
+
+    /**
+     * @brief Counts between two readings (empty where either is empty).
+     */
+    HardwareCounts operator-(const HardwareCounts& start) const {
+        HardwareCounts delta;
+        for (size_t i = 0; i < HARDWARE_EVENT_COUNT; ++i) {
+            if (values[i] && start.values[i]) {
+                delta.values[i] = *values[i] - *start.values[i];
+            }
+        }
+        return delta;
+    }
+
+    /**
+     * @brief Instructions per cycle, if both are counted and cycles > 0.
+     */
+    std::optional<double> ipc() const {
+        auto cycles = (*this)[HardwareEvent::CYCLES];
+        auto instructions = (*this)[HardwareEvent::INSTRUCTIONS];
+        if (!cycles || !instructions || *cycles <= 0.0) {
+            return std::nullopt;
+        }
+        return *instructions / *cycles;
+    }
+};
+
+/**
+ * @brief CPU performance counters of the calling thread (Linux perf_event_open).
+ *
+ * Opens user-space counters for cycles, instructions, last-level cache
+ * misses, branch misses and double-precision floating-point operations when
+ * constructed; read() returns the totals since then. Threads the calling
+ * thread starts afterwards are included once they have exited (e.g. after
+ * FrontierEngine joins its workers).
+ *
+ * Counters are optional: on other platforms, when the kernel refuses them
+ * (/proc/sys/kernel/perf_event_paranoid above 2, seccomp filters in
+ * containers) or when the CPU exposes no PMU (most virtual machines), the
+ * missing events read as empty and status() says why. Nothing throws.
+ *
+ * FLOPS is only available on Intel processors from Broadwell on, using the
+ * FP_ARITH_INST_RETIRED events (FMA counts as two operations, a packed
+ * 256-bit instruction as four). When the PMU has fewer counters than events,
+ * the kernel time-shares them and the values are scaled estimates.
+ *
+ * Example:
+ *   HardwareCounters counters;
+ *   HardwareCounts start = counters.read();
+ *   matrix.cholesky();
+ *   HardwareCounts used = counters.read() - start;
+ *   if (auto ipc = used.ipc()) { std::cout << *ipc << " instructions/cycle\n"; }
+ */
+class HardwareCounters {
+public:
+    HardwareCounters() { open(); }
+
+    ~HardwareCounters() { close(); }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    HardwareCounters(HardwareCounters&& other) noexcept
+        : sources_(std::move(other.sources_)), status_(std::move(other.status_)) {
+        other.sources_.clear();
+    }
+
+    HardwareCounters& operator=(HardwareCounters&& other) noexcept {
+        if (this != &other) {
+            close();
+            sources_ = std::move(other.sources_);
+            status_ = std::move(other.status_);
+            other.sources_.clear();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Check whether at least one event is counted.
+     */
+    bool available() const {
+        for (size_t i = 0; i < HARDWARE_EVENT_COUNT; ++i) {
+            if (available(static_cast<HardwareEvent>(i))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Check whether one event is counted.
+     */
+    bool available(HardwareEvent event) const {
+        for (const Source& source : sources_) {
+            if (source.event == event) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Explain the events that are not counted ("" if all are).
+     */
+    const std::string& status() const { return status_; }
+
+    /**
+     * @brief Read the counts since construction.
+     */
+    HardwareCounts read() const {
+        HardwareCounts counts;
+#if defined(__linux__)
+        for (const Source& source : sources_) {
+            uint64_t raw[3] = {0, 0, 0};  // value, time enabled, time running
+            if (::read(source.fd, raw, sizeof(raw)) != static_cast<ssize_t>(sizeof(raw))) {
+                continue;
+            }
+            double value = static_cast<double>(raw[0]);
+            if (raw[2] > 0 && raw[2] < raw[1]) {
+                value *= static_cast<double>(raw[1]) / static_cast<double>(raw[2]);
+            }
+            auto& total = counts.values[static_cast<size_t>(source.event)];
+            total = total.value_or(0.0) + value * source.weight;
+        }
+#endif
+        return counts;
+    }
+
+    /**
+     * @brief Get the display name of an event.
+     */
+    static const char* eventName(HardwareEvent event) {
+        switch (event) {
+            case HardwareEvent::CYCLES:
+                return "cycles";
+            case HardwareEvent::INSTRUCTIONS:
+                return "instructions";
+            case HardwareEvent::CACHE_MISSES:
+                return "cache misses";
+            case HardwareEvent::BRANCH_MISSES:
+                return "branch misses";
+            case HardwareEvent::FLOPS:
+                return "FLOPs";
+        }
+        return "";
+    }
+
+private:
+    struct Source {
+        int fd;
+        HardwareEvent event;
+        double weight;  // FLOPs per count (FLOPS is the sum of several events)
+    };
+
+    std::vector<Source> sources_;
+    std::string status_;
+
+#if defined(__linux__)
+    void open() {
+        std::string missing;
+        int error = 0;
+        auto add = [&](HardwareEvent event, uint32_t type,
+                       const std::vector<std::pair<uint64_t, double>>& configs) {
+            std::vector<Source> opened;
+            for (const auto& [config, weight] : configs) {
+                int fd = openEvent(type, config);
+                if (fd < 0) {
+                    error = error != 0 ? error : errno;
+                    for (const Source& source : opened) {
+                        ::close(source.fd);
+                    }
+                    missing += (missing.empty() ? "" : ", ") + std::string(eventName(event));
+                    return;
+                }
+                opened.push_back({fd, event, weight});
+            }
+            sources_.insert(sources_.end(), opened.begin(), opened.end());
+        };
+
+        add(HardwareEvent::CYCLES, PERF_TYPE_HARDWARE, {{PERF_COUNT_HW_CPU_CYCLES, 1.0}});
+        add(HardwareEvent::INSTRUCTIONS, PERF_TYPE_HARDWARE, {{PERF_COUNT_HW_INSTRUCTIONS, 1.0}});
+        add(HardwareEvent::CACHE_MISSES, PERF_TYPE_HARDWARE, {{PERF_COUNT_HW_CACHE_MISSES, 1.0}});
+        add(HardwareEvent::BRANCH_MISSES, PERF_TYPE_HARDWARE,
+            {{PERF_COUNT_HW_BRANCH_MISSES, 1.0}});
+        if (intelCpu()) {
+            // FP_ARITH_INST_RETIRED (event 0xC7): scalar, 128-, 256- and 512-bit packed double
+            add(HardwareEvent::FLOPS, PERF_TYPE_RAW,
+                {{0x01C7, 1.0}, {0x04C7, 2.0}, {0x10C7, 4.0}, {0x40C7, 8.0}});
+        }
+
+        if (!missing.empty()) {
+            status_ = "Not counted: " + missing + " (" + reason(error) + ")";
+        }
+        if (!intelCpu()) {
+            status_ += std::string(status_.empty() ? "" : "; ") +
+                       "FLOPs are only counted on Intel processors";
+        }
+    }
+
+    void close() {
+        for (const Source& source : sources_) {
+            ::close(source.fd);
+        }
+        sources_.clear();
+    }
+
+    static int openEvent(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;  // Allowed up to perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        return static_cast<int>(fd);
+    }
+
+    static std::string reason(int error) {
+        switch (error) {
+            case EACCES:
+            case EPERM:
+                return "not permitted; see /proc/sys/kernel/perf_event_paranoid";
+            case ENOENT:
+            case ENODEV:
+            case EOPNOTSUPP:
+                return "not supported by this CPU or virtual machine";
+            case ENOSYS:
+                return "perf_event_open is not available";
+            default:
+                return std::strerror(error);
+        }
+    }
+
+    static bool intelCpu() {
+#if defined(__x86_64__) || defined(__i386__)
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("vendor_id", 0) == 0) {
+                return line.find("GenuineIntel") != std::string::npos;
+            }
+        }
+#endif
+        return false;
+    }
+#else
+    void open() { status_ = "Hardware counters require Linux (perf_event_open)"; }
+
+    void close() {}
+#endif
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Minimal JSON document model for CLI input files.
+ *
+ * Parses a complete JSON value (RFC 8259) into a small tree of JsonValue
+ * nodes. Objects keep their keys in document order; lookups are linear,
+ * which is fine for the small objects found in manifests, requests and
+ * constraint files.
+ *
+ * Example:
+ *   JsonValue job = JsonValue::parse(R"({"id": "a", "lambda": 0.5})");
+ *   std::string id = job.getString("id", "");
+ *   double lambda = job.getNumber("lambda", 0.0);
+ */
+class JsonValue {
+public:
+    enum class Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+    /**
+     * @brief Construct a null value.
+     */
+    JsonValue() = default;
+
+    /**
+     * @brief Parse a JSON document.
+     * @param text JSON text containing exactly one value
+     * @return Parsed value
+     * @throws std::runtime_error if the text is not valid JSON
+     */
+    static JsonValue parse(const std::string& text) {
+        Parser parser(text);
+        JsonValue value = parser.parseValue();
+        parser.skipWhitespace();
+        if (!parser.atEnd()) {
+            parser.fail("Unexpected trailing characters");
+        }
+        return value;
+    }
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::NUL; }
+    bool isBool() const { return type_ == Type::BOOL; }
+    bool isNumber() const { return type_ == Type::NUMBER; }
+    bool isString() const { return type_ == Type::STRING; }
+    bool isArray() const { return type_ == Type::ARRAY; }
+    bool isObject() const { return type_ == Type::OBJECT; }
+
+    /**
+     * @brief Get a boolean value.
+     * @throws std::runtime_error if the value is not a boolean
+     */
+    bool asBool() const {
+        expect(Type::BOOL, "boolean");
+        return bool_;
+    }
+
+    /**
+     * @brief Get a numeric value.
+     * @throws std::runtime_error if the value is not a number
+     */
+    double asNumber() const {
+        expect(Type::NUMBER, "number");
+        return number_;
+    }
+
+    /**
+     * @brief Get a string value.
+     * @throws std::runtime_error if the value is not a string
+     */
+    const std::string& asString() const {
+        expect(Type::STRING, "string");
+        return string_;
+    }
+
+    /**
+     * @brief Get the elements of an array.
+     * @throws std::runtime_error if the value is not an array
+     */
+    const std::vector<JsonValue>& asArray() const {
+        expect(Type::ARRAY, "array");
+        return array_;
+    }
+
+    /**
+     * @brief Get the members of an object in document order.
+     * @throws std::runtime_error if the value is not an object
+     */
+    const std::vector<std::pair<std::string, JsonValue>>& asObject() const {
+        expect(Type::OBJECT, "object");
+        return object_;
+    }
+
+    /**
+     * @brief Check whether an object has a member.
+     * @param key Member name
+     * @return true if this is an object containing key
+     */
+    bool has(const std::string& key) const { return find(key) != nullptr; }
+
+    /**
+     * @brief Get an object member.
+     * @param key Member name
+     * @return Member value
+     * @throws std::runtime_error if this is not an object or key is missing
+     */
+    const JsonValue& operator[](const std::string& key) const {
+        expect(Type::OBJECT, "object");
+        const JsonValue* value = find(key);
+        if (value == nullptr) {
+            throw std::runtime_error("Missing JSON key: " + key);
+        }
+        return *value;
+    }
+
+    /**
+     * @brief Get a string member, or a default when the key is absent.
+     * @throws std::runtime_error if the member exists but is not a string
+     */
+    std::string getString(const std::string& key, const std::string& defaultValue) const {
+        const JsonValue* value = find(key);
+        return value ? value->asString() : defaultValue;
+    }
+
+    /**
+     * @brief Get a numeric member, or a default when the key is absent.
+     * @throws std::runtime_error if the member exists but is not a number
+     */
+    double getNumber(const std::string& key, double defaultValue) const {
+        const JsonValue* value = find(key);
+        return value ? value->asNumber() : defaultValue;
+    }
+
+    /**
+     * @brief Get a boolean member, or a default when the key is absent.
+     * @throws std::runtime_error if the member exists but is not a boolean
+     */
+    bool getBool(const std::string& key, bool defaultValue) const {
+        const JsonValue* value = find(key);
+        return value ? value->asBool() : defaultValue;
+    }
+
+private:
+    Type type_ = Type::NUL;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::vector<std::pair<std::string, JsonValue>> object_;
+
+    const JsonValue* find(const std::string& key) const {
+        if (type_ != Type::OBJECT) {
+            return nullptr;
+        }
+        for (const auto& member : object_) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    void expect(Type type, const char* name) const {
+        if (type_ != type) {
+            throw std::runtime_error(std::string("JSON value is not a ") + name);
+        }
+    }
+
+    /**
+     * @brief Recursive-descent parser over a string.
+     */
+    class Parser {
+    public:
+        explicit Parser(const std::string& text) : text_(text), pos_(0) {}
+
+        bool atEnd() const { return pos_ >= text_.size(); }
+
+        void skipWhitespace() {
+            while (!atEnd() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                text_[pos_] == '\n' || text_[pos_] == '\r')) {
+                ++pos_;
+            }
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::runtime_error("Invalid JSON at offset " + std::to_string(pos_) + ": " +
+                                     message);
+        }
+
+        JsonValue parseValue(size_t depth = 0) {
+            if (depth > MAX_DEPTH) {
+                fail("Nesting too deep");
+            }
+            skipWhitespace();
+            if (atEnd()) {
+                fail("Unexpected end of input");
+            }
+
+            JsonValue value;
+            char c = text_[pos_];
+            if (c == '{') {
+                value.type_ = Type::OBJECT;
+                ++pos_;
+                skipWhitespace();
+                if (consume('}')) {
+                    return value;
+                }
+                do {
+                    skipWhitespace();
+                    if (atEnd() || text_[pos_] != '"') {
+                        fail("Expected object key");
+                    }
+                    std::string key = parseString();
+                    skipWhitespace();
+                    if (!consume(':')) {
+                        fail("Expected ':' after object key");
+                    }
+                    JsonValue member = parseValue(depth + 1);
+                    value.object_.emplace_back(std::move(key), std::move(member));
+                    skipWhitespace();
+                } while (consume(','));
+                if (!consume('}')) {
+                    fail("Expected ',' or '}' in object");
+                }
+            } else if (c == '[') {
+                value.type_ = Type::ARRAY;
+                ++pos_;
+                skipWhitespace();
+                if (consume(']')) {
+                    return value;
+                }
+                do {
+                    value.array_.push_back(parseValue(depth + 1));
+                    skipWhitespace();
+                } while (consume(','));
+                if (!consume(']')) {
+                    fail("Expected ',' or ']' in array");
+                }
+            } else if (c == '"') {
+                value.type_ = Type::STRING;
+                value.string_ = parseString();
+            } else if (matchLiteral("true")) {
+                value.type_ = Type::BOOL;
+                value.bool_ = true;
+            } else if (matchLiteral("false")) {
+                value.type_ = Type::BOOL;
+                value.bool_ = false;
+            } else if (matchLiteral("null")) {
+                value.type_ = Type::NUL;
+            } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+                value.type_ = Type::NUMBER;
+                value.number_ = parseNumber();
+            } else {
+                fail(std::string("Unexpected character '") + c + "'");
+            }
+            return value;
+        }
+
+    private:
+        static constexpr size_t MAX_DEPTH = 64;
+
+        const std::string& text_;
+        size_t pos_;
+
+        bool consume(char c) {
+            if (!atEnd() && text_[pos_] == c) {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+
+        bool matchLiteral(const char* literal) {
+            size_t len = std::char_traits<char>::length(literal);
+            if (text_.compare(pos_, len, literal) == 0) {
+                pos_ += len;
+                return true;
+            }
+            return false;
+        }
+
+        double parseNumber() {
+            size_t start = pos_;
+            consume('-');
+            if (!atEnd() && text_[pos_] == '0') {
+                ++pos_;
+            } else if (!skipDigits()) {
+                fail("Invalid number");
+            }
+            if (consume('.') && !skipDigits()) {
+                fail("Expected digits after decimal point");
+            }
+            if (!atEnd() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+                ++pos_;
+                if (!consume('+')) {
+                    consume('-');
+                }
+                if (!skipDigits()) {
+                    fail("Expected digits in exponent");
+                }
+            }
+            return std::strtod(text_.c_str() + start, nullptr);
+        }
+
+        bool skipDigits() {
+            size_t start = pos_;
+            while (!atEnd() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) {
+                ++pos_;
+            }
+            return pos_ > start;
+        }
+
+        std::string parseString() {
+            ++pos_;  // Opening quote
+            std::string result;
+            while (true) {
+                if (atEnd()) {
+                    fail("Unterminated string");
+                }
+                char c = text_[pos_++];
+                if (c == '"') {
+                    return result;
+                }
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fail("Control character in string");
+                }
+                if (c != '\\') {
+                    result += c;
+                    continue;
+                }
+                if (atEnd()) {
+                    fail("Unterminated escape sequence");
+                }
+                char escape = text_[pos_++];
+                switch (escape) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        result += escape;
+                        break;
+                    case 'b':
+                        result += '\b';
+                        break;
+                    case 'f':
+                        result += '\f';
+                        break;
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'u':
+                        appendUtf8(parseCodePoint(), result);
+                        break;
+                    default:
+                        fail(std::string("Invalid escape '\\") + escape + "'");
+                }
+            }
+        }
+
+        unsigned parseHex4() {
+            if (pos_ + 4 > text_.size()) {
+                fail("Truncated unicode escape");
+            }
+            unsigned value = 0;
+            for (int i = 0; i < 4; ++i) {
+                char c = text_[pos_++];
+                value <<= 4;
+                if (c >= '0' && c <= '9') {
+                    value |= static_cast<unsigned>(c - '0');
+                } else if (c >= 'a' && c <= 'f') {
+                    value |= static_cast<unsigned>(c - 'a' + 10);
+                } else if (c >= 'A' && c <= 'F') {
+                    value |= static_cast<unsigned>(c - 'A' + 10);
+                } else {
+                    fail("Invalid unicode escape");
+                }
+            }
+            return value;
+        }
+
+        unsigned parseCodePoint() {
+            unsigned code = parseHex4();
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                // High surrogate: must be followed by \uDC00-\uDFFF
+                if (!matchLiteral("\\u")) {
+                    fail("Unpaired surrogate in unicode escape");
+                }
+                unsigned low = parseHex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    fail("Invalid low surrogate in unicode escape");
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            return code;
+        }
+
+        static void appendUtf8(unsigned code, std::string& out) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+    };
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -1,12 +1,45 @@
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <string>
 
 #include "arg_parser.hpp"
+#include "batch_command.hpp"
+#include "bench_command.hpp"
 #include "bl_command.hpp"
+#include "frontier_command.hpp"
 #include "mpt_command.hpp"
+#include "profiler.hpp"
+#include "serve_command.hpp"
 
 using namespace orbat::cli;
 
+// Replacement global allocation functions feeding AllocationCounter for --profile.
+// The array and nothrow forms forward to these.
+void* operator new(std::size_t size) {
+    AllocationCounter::record(size);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC flags free() on memory from operator new once these are inlined; here they match
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 /**
  * @brief Print general help message for the CLI.
  */
@@ -18,6 +51,10 @@ void printHelp() {
               << "Available Commands:\n"
               << "  mpt        Modern Portfolio Theory (Mean-Variance) optimization\n"
               << "  bl         Black-Litterman portfolio optimization\n"
+              << "  frontier   Compute and stream the efficient frontier\n"
+              << "  batch      Run many optimization jobs from a manifest in parallel\n"
+              << "  serve      Answer optimization requests over a Unix domain socket\n"
+              << "  bench      Benchmark every optimizer path on synthetic problems\n"
               << "\n"
               << "Options:\n"
               << "  --help, -h Show help for the command\n"
@@ -27,11 +64,17 @@ void printHelp() {
               << "  orbat bl --help\n"
               << "  orbat mpt --returns returns.csv --covariance cov.csv\n"
               << "  orbat bl --returns market_weights.csv --covariance cov.csv\n"
+              << "  orbat frontier --returns returns.csv --covariance cov.csv --points 1000\n"
+              << "  orbat batch --manifest jobs.ndjson --threads 8\n"
+              << "  orbat serve --socket /tmp/orbat.sock --preload us=cov.csv\n"
+              << "  orbat bench --sizes 100,1000 > bench.json\n"
               << "\n"
               << "For more information, visit: https://github.com/rtrimble13/orbat\n";
 }
 
 int main(int argc, char* argv[]) {
+    AllocationCounter::markHooksInstalled();
+
     // Parse command line arguments
     ArgParser parser(argc, argv);
 
@@ -61,6 +104,14 @@ int main(int argc, char* argv[]) {
         return MptCommand::execute(parser);
     } else if (command == "bl") {
         return BlCommand::execute(parser);
+    } else if (command == "frontier") {
+        return FrontierCommand::execute(parser);
+    } else if (command == "batch") {
+        return BatchCommand::execute(parser);
+    } else if (command == "serve") {
+        return ServeCommand::execute(parser);
+    } else if (command == "bench") {
+        return BenchCommand::execute(parser);
     } else {
         std::cerr << "Error: Unknown command '" << command << "'" << std::endl;
         std::cerr << "Use 'orbat --help' for available commands." << std::endl;
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "orbat/core/metrics.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "arg_parser.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Prometheus metrics file of a CLI run (--metrics <file>).
+ *
+ * Writes a snapshot when it goes out of scope and, with
+ * --metrics-interval <seconds>, periodically from a background thread, so
+ * a node_exporter textfile collector can scrape a long batch or server.
+ * Each write replaces the file atomically. A file that cannot be written is
+ * reported on stderr; it does not change the command's exit code.
+ *
+ * Example:
+ *   MetricsOutput metrics = MetricsOutput::fromParser(parser, [] {
+ *       std::ostringstream text;
+ *       core::MetricsRegistry::global().writePrometheus(text);
+ *       return text.str();
+ *   });
+ */
+class MetricsOutput {
+public:
+    using Snapshot = std::function<std::string()>;
+
+    MetricsOutput() = default;
+
+    /**
+     * @brief Start writing metrics to a file.
+     * @param path Metrics file
+     * @param snapshot Produces the exposition text
+     * @param intervalSeconds Period of background writes (0 = only at the end)
+     */
+    MetricsOutput(std::string path, Snapshot snapshot, double intervalSeconds = 0.0)
+        : state_(std::make_unique<State>()) {
+        state_->path = std::move(path);
+        state_->snapshot = std::move(snapshot);
+        if (intervalSeconds > 0.0) {
+            auto interval = std::chrono::duration<double>(intervalSeconds);
+            State* state = state_.get();
+            state_->writer = std::thread([state, interval] {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                while (!state->wake.wait_for(lock, interval, [state] { return state->stop; })) {
+                    lock.unlock();
+                    state->write();
+                    lock.lock();
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief Start writing metrics if --metrics <file> is given.
+     * @param parser Argument parser
+     * @param snapshot Produces the exposition text
+     * @return Metrics output (inactive without --metrics)
+     * @throws std::invalid_argument if --metrics-interval is not a positive number
+     */
+    static MetricsOutput fromParser(const ArgParser& parser, Snapshot snapshot) {
+        if (!parser.hasFlag("metrics")) {
+            return MetricsOutput();
+        }
+        return MetricsOutput(parser.getFlagValue("metrics"), std::move(snapshot),
+                             intervalFromParser(parser));
+    }
+
+    /**
+     * @brief Read --metrics-interval <seconds>.
+     * @param parser Argument parser
+     * @return Interval in seconds (0 without the flag)
+     * @throws std::invalid_argument if the interval is not a positive number
+     */
+    static double intervalFromParser(const ArgParser& parser) {
+        if (!parser.hasFlag("metrics-interval")) {
+            return 0.0;
+        }
+        std::string value = parser.getFlagValue("metrics-interval");
+        size_t consumed = 0;
+        double seconds = std::stod(value, &consumed);
+        if (consumed != value.size() || !(seconds > 0.0)) {
+            throw std::invalid_argument("Metrics interval must be a positive number of seconds");
+        }
+        return seconds;
+    }
+
+    MetricsOutput(MetricsOutput&&) noexcept = default;
+
+    MetricsOutput& operator=(MetricsOutput&& other) noexcept {
+        if (this != &other) {
+            finish();
+            state_ = std::move(other.state_);
+        }
+        return *this;
+    }
+
+    MetricsOutput(const MetricsOutput&) = delete;
+    MetricsOutput& operator=(const MetricsOutput&) = delete;
+
+    ~MetricsOutput() { finish(); }
+
+    /**
+     * @brief Check whether metrics are being written.
+     */
+    bool active() const { return state_ != nullptr; }
+
+    /**
+     * @brief Stop periodic writes and write the final snapshot now (no-op
+     * when inactive).
+     */
+    void finish() noexcept {
+        if (!state_) {
+            return;
+        }
+        if (state_->writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                state_->stop = true;
+            }
+            state_->wake.notify_all();
+            state_->writer.join();
+        }
+        state_->write();
+        state_.reset();
+    }
+
+private:
+    struct State {
+        std::string path;
+        Snapshot snapshot;
+        std::thread writer;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stop = false;
+
+        void write() noexcept {
+            try {
+                core::MetricsRegistry::writeFile(path, snapshot());
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << e.what() << std::endl;
+            }
+        }
+    };
+
+    std::unique_ptr<State> state_;  // Stable address for the writer thread
+};
+
+}  // namespace cli
+}  // namespace orbat
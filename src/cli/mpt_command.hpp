@@ -2,7 +2,9 @@
 
 #include "orbat/optimizer/constraint.hpp"
 #include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
 
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -11,8 +13,13 @@
 #include <string>
 
 #include "arg_parser.hpp"
+#include "constraints_loader.hpp"
 #include "error_codes.hpp"
 #include "file_parser.hpp"
+#include "profiler.hpp"
+#include "result_output.hpp"
+#include "trace_output.hpp"
+#include "watch_session.hpp"
 
 namespace orbat {
 namespace cli {
@@ -56,6 +63,25 @@ public:
                 return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
             }
 
+            // Parse output options before doing any work
+            OutputOptions outputOptions;
+            Profiler profiler;
+            TraceOutput trace;
+            try {
+                outputOptions = OutputOptions::fromParser(parser);
+                profiler = Profiler::fromParser(parser);
+                trace = TraceOutput::fromParser(parser);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid output options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat mpt --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            if (parser.hasFlag("watch")) {
+                return watch(parser, outputOptions);
+            }
+
             // Load input data
             std::string returnsFile = parser.getFlagValue("returns");
             std::string covarianceFile = parser.getFlagValue("covariance");
@@ -63,6 +89,7 @@ public:
             // Parse returns with enhanced error handling
             optimizer::ExpectedReturns returns;
             try {
+                auto scope = profiler.phase("parse returns");
                 returns = FileParser::parseReturns(returnsFile);
                 if (returns.empty()) {
                     std::cerr << "Error: Empty returns data - File '" << returnsFile
@@ -84,7 +111,13 @@ public:
             // Parse covariance with enhanced error handling
             optimizer::CovarianceMatrix covariance;
             try {
-                covariance = FileParser::parseCovariance(covarianceFile);
+                core::Matrix covarianceData;
+                {
+                    auto scope = profiler.phase("parse covariance");
+                    covarianceData = FileParser::parseCovarianceData(covarianceFile);
+                }
+                auto scope = profiler.phase("validate");
+                covariance = optimizer::CovarianceMatrix(std::move(covarianceData));
                 if (covariance.empty()) {
                     std::cerr << "Error: Empty covariance matrix - File '" << covarianceFile
                               << "' contains no valid data" << std::endl;
@@ -124,40 +157,50 @@ public:
 
             // Parse optional risk-free rate
             double riskFreeRate = 0.0;
-            if (parser.hasFlag("rf-rate")) {
+            if (!parseRiskFreeRate(parser, riskFreeRate)) {
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            // Setup constraints: the --constraints file, or long-only by default
+            optimizer::ConstraintSet constraints;
+            if (parser.hasFlag("constraints")) {
+                std::string constraintsFile = parser.getFlagValue("constraints");
                 try {
-                    riskFreeRate = std::stod(parser.getFlagValue("rf-rate"));
-                    if (!std::isfinite(riskFreeRate)) {
-                        throw std::invalid_argument("Risk-free rate must be a finite number");
-                    }
+                    auto scope = profiler.phase("parse constraints");
+                    constraints.add(std::make_shared<optimizer::PackedConstraints>(
+                        ConstraintsLoader::load(constraintsFile, returns.labels())));
                 } catch (const std::exception& e) {
-                    std::cerr << "Error: Invalid risk-free rate value - '"
-                              << parser.getFlagValue("rf-rate") << "'" << std::endl;
+                    std::cerr << "Error: Invalid constraints file '" << constraintsFile << "'"
+                              << std::endl;
                     std::cerr << "Details: " << e.what() << std::endl;
-                    std::cerr << "Expected: A numeric value (e.g., 0.02 for 2%)" << std::endl;
-                    return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+                    std::cerr << "Hint: Constraints are keyed by the asset labels in the returns "
+                                 "file (rows of the form '<return>,<label>')"
+                              << std::endl;
+                    return static_cast<int>(ExitCode::VALIDATION_ERROR);
                 }
+            } else {
+                constraints.add(std::make_shared<optimizer::LongOnlyConstraint>());
             }
 
-            // Setup constraints (default: long-only)
-            optimizer::ConstraintSet constraints;
-            constraints.add(std::make_shared<optimizer::LongOnlyConstraint>());
-
-            // Parse additional constraints if provided
-            // Note: Custom constraints file parsing is not yet implemented.
-            // Planned feature: Support loading constraint definitions from JSON/CSV files
-            // to specify box constraints, sector constraints, and other custom limitations.
-            if (parser.hasFlag("constraints")) {
-                std::cerr << "Warning: --constraints flag is not yet implemented. Using default "
-                             "long-only constraint."
-                          << std::endl;
+            // Factorize once and hand the factorization to the optimizer
+            std::shared_ptr<const optimizer::CovarianceFactorization> factorization;
+            try {
+                auto scope = profiler.phase("factorize");
+                factorization = optimizer::CovarianceFactorization::create(covariance);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Optimization failed" << std::endl;
+                std::cerr << "Details: Optimization failed: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::COMPUTATION_ERROR);
             }
 
-            // Create optimizer
-            optimizer::MarkowitzOptimizer optimizer(returns, covariance, constraints);
-
             // Run minimum variance optimization
-            auto result = optimizer.minimumVariance();
+            optimizer::MarkowitzResult result;
+            {
+                auto scope = profiler.phase("optimize");
+                optimizer::MarkowitzOptimizer optimizer(returns, covariance, constraints,
+                                                        factorization);
+                result = optimizer.minimumVariance();
+            }
 
             // Check if optimization succeeded
             if (!result.success()) {
@@ -165,6 +208,7 @@ public:
                 if (!result.message.empty()) {
                     std::cerr << "Details: " << result.message << std::endl;
                 }
+                profiler.report();
                 return static_cast<int>(ExitCode::COMPUTATION_ERROR);
             }
 
@@ -174,23 +218,27 @@ public:
             }
 
             // Output results
-            std::string outputFile = parser.getFlagValue("output", "");
-            if (outputFile.empty()) {
+            auto outputScope = profiler.phase("output");
+            if (outputOptions.humanReadable()) {
                 // Print to stdout
                 printResult(result, riskFreeRate);
             } else {
-                // Write to file
+                // Serialize to file or stdout
                 try {
-                    writeResult(result, outputFile);
-                    std::cout << "Results written to: " << outputFile << std::endl;
+                    ResultOutput::write(result, outputOptions, returns.labels());
+                    if (!outputOptions.toStdout()) {
+                        std::cout << "Results written to: " << outputOptions.path << std::endl;
+                    }
                 } catch (const std::runtime_error& e) {
-                    std::cerr << "Error: Failed to write output to '" << outputFile << "'"
+                    std::cerr << "Error: Failed to write output to '" << outputOptions.path << "'"
                               << std::endl;
                     std::cerr << "Details: " << e.what() << std::endl;
                     return static_cast<int>(ExitCode::VALIDATION_ERROR);
                 }
             }
+            outputScope.stop();
 
+            profiler.report();
             return static_cast<int>(ExitCode::SUCCESS);
 
         } catch (const std::exception& e) {
@@ -215,17 +263,90 @@ public:
                   << "\n"
                   << "Optional Flags:\n"
                   << "  --rf-rate <value>      Risk-free rate (default: 0.0)\n"
-                  << "  --constraints <file>   Path to constraints file (not yet implemented)\n"
-                  << "  --output <file>        Output file (JSON format, default: stdout)\n"
+                  << "  --constraints <file>   Per-asset bounds and sector limits (JSON or CSV,\n"
+                  << "                         keyed by asset label; default: long-only)\n"
+                  << "  --output <file|->      Write results to a file, or '-' for stdout\n"
+                  << "  --format <name>        Output format: json (default), ndjson, csv, binary\n"
+                  << "  --watch                Re-optimize whenever an input file changes\n"
+                  << "  --profile [table|json] Report time and memory per phase on stderr\n"
+                  << "  --profile-output <file>\n"
+                  << "                         Write the profile report to a file instead\n"
+                  << "  --profile-counters     Add CPU hardware counters to the profile (Linux)\n"
+                  << "  --trace <file>         Write a Chrome trace of the run's phases\n"
                   << "  --help, -h             Show this help message\n"
                   << "\n"
                   << "Examples:\n"
                   << "  orbat mpt --returns returns.csv --covariance cov.csv\n"
                   << "  orbat mpt --returns returns.csv --covariance cov.csv --rf-rate 0.02 "
-                     "--output result.json\n";
+                     "--output result.json\n"
+                  << "  orbat mpt --returns returns.csv --covariance cov.csv "
+                     "--constraints limits.json\n"
+                  << "  orbat mpt --returns returns.csv --covariance cov.csv --watch\n";
     }
 
 private:
+    /**
+     * @brief Parse --rf-rate, reporting invalid values on stderr.
+     * @param parser Argument parser
+     * @param rate Receives the rate (unchanged when the flag is absent)
+     * @return false if the value is invalid
+     */
+    static bool parseRiskFreeRate(const ArgParser& parser, double& rate) {
+        if (!parser.hasFlag("rf-rate")) {
+            return true;
+        }
+        try {
+            rate = std::stod(parser.getFlagValue("rf-rate"));
+            if (!std::isfinite(rate)) {
+                throw std::invalid_argument("Risk-free rate must be a finite number");
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid risk-free rate value - '"
+                      << parser.getFlagValue("rf-rate") << "'" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Expected: A numeric value (e.g., 0.02 for 2%)" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run in watch mode: re-optimize whenever an input file changes.
+     *
+     * Only changed files are re-parsed, and the covariance factorization is
+     * reused unless the covariance values changed (see IncrementalInputs).
+     *
+     * @param parser Argument parser
+     * @param outputOptions Where each result is written
+     * @return Exit code after the session is interrupted
+     */
+    static int watch(const ArgParser& parser, const OutputOptions& outputOptions) {
+        double riskFreeRate = 0.0;
+        if (!parseRiskFreeRate(parser, riskFreeRate)) {
+            return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+        }
+        IncrementalInputs inputs(parser.getFlagValue("returns"),
+                                 parser.getFlagValue("covariance"),
+                                 parser.getFlagValue("constraints", ""));
+        return WatchSession::run(inputs, [&](const IncrementalInputs& current) {
+            optimizer::MarkowitzOptimizer optimizer(current.returns(), current.covariance(),
+                                                    current.constraints(),
+                                                    current.factorization());
+            optimizer::MarkowitzResult result = optimizer.minimumVariance();
+            if (!result.success()) {
+                throw std::runtime_error(result.message);
+            }
+            if (riskFreeRate != 0.0) {
+                result.setRiskFreeRate(riskFreeRate);
+            }
+            if (outputOptions.humanReadable()) {
+                printResult(result, riskFreeRate);
+            } else {
+                ResultOutput::write(result, outputOptions, current.returns().labels());
+            }
+        });
+    }
+
     /**
      * @brief Print optimization result to stdout.
      */
@@ -251,18 +372,6 @@ private:
         }
         std::cout << std::endl;
     }
-
-    /**
-     * @brief Write optimization result to file in JSON format.
-     */
-    static void writeResult(const optimizer::MarkowitzResult& result, const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open output file: " + filename);
-        }
-        file << result.toJSON();
-        file.close();
-    }
 };
 
 }  // namespace cli
@@ -0,0 +1,503 @@
+#pragma once
+
+#include "orbat/core/metrics.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch_runner.hpp"
+#include "file_parser.hpp"
+#include "json_reader.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Named covariance snapshots kept resident with their factorizations.
+ *
+ * Lookups take a shared lock and return a shared_ptr, so a snapshot that is
+ * replaced or dropped stays alive until in-flight requests using it finish.
+ * Parsing and factorization happen outside the lock.
+ */
+class SnapshotStore {
+public:
+    /**
+     * @brief Look up a snapshot.
+     * @param name Snapshot name
+     * @return Snapshot
+     * @throws std::runtime_error if no snapshot has this name
+     */
+    std::shared_ptr<const CachedCovariance> get(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = snapshots_.find(name);
+        if (it == snapshots_.end()) {
+            throw std::runtime_error("Unknown snapshot: " + name);
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Factorize a covariance matrix and store it under a name.
+     *
+     * An existing snapshot with the same name is replaced atomically.
+     *
+     * @param name Snapshot name
+     * @param covariance Covariance matrix
+     * @return Number of assets
+     * @throws std::runtime_error if the matrix cannot be factorized
+     */
+    size_t put(const std::string& name, optimizer::CovarianceMatrix covariance) {
+        if (name.empty()) {
+            throw std::invalid_argument("Snapshot name cannot be empty");
+        }
+        auto entry = std::make_shared<CachedCovariance>();
+        entry->covariance = std::move(covariance);
+        entry->factorization = optimizer::CovarianceFactorization::create(entry->covariance);
+        size_t n = entry->covariance.size();
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        snapshots_[name] = std::move(entry);
+        return n;
+    }
+
+    /**
+     * @brief Remove a snapshot.
+     * @param name Snapshot name
+     * @return true if a snapshot was removed
+     */
+    bool drop(const std::string& name) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return snapshots_.erase(name) > 0;
+    }
+
+    /**
+     * @brief List snapshot names and sizes.
+     * @return (name, number of assets) pairs sorted by name
+     */
+    std::vector<std::pair<std::string, size_t>> list() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<std::pair<std::string, size_t>> result;
+        result.reserve(snapshots_.size());
+        for (const auto& [name, entry] : snapshots_) {
+            result.emplace_back(name, entry->covariance.size());
+        }
+        return result;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, std::shared_ptr<const CachedCovariance>> snapshots_;
+};
+
+/**
+ * @brief JSON request handler behind 'orbat serve'.
+ *
+ * Requests and responses are JSON objects. Every request has an "op" member
+ * and may carry an "id" (string or number) that is echoed in the response.
+ *
+ *   {"op": "load", "snapshot": "us", "covariance": "cov.csv"}
+ *   {"op": "load", "snapshot": "us", "matrix": [[0.04, 0.01], [0.01, 0.09]]}
+ *   {"op": "mpt", "snapshot": "us", "returns": [0.08, 0.12], "objective": "min-variance"}
+ *   {"op": "bl", "snapshot": "us", "weights": [0.6, 0.4], "riskAversion": 2.5}
+ *   {"op": "frontier", "snapshot": "us", "returns": [0.08, 0.12], "points": 20}
+ *   {"op": "trace", "action": "start" | "stop" | "clear" | "dump", "path": "trace.json"}
+ *   {"op": "metrics", "path": "orbat.prom"}
+ *   {"op": "drop" | "snapshots" | "stats" | "ping" | "shutdown", ...}
+ *
+ * Responses have "ok": true plus op-specific members, or "ok": false and an
+ * "error" message. handle() never throws and is safe to call concurrently.
+ *
+ * File paths in requests (load "covariance", trace and metrics "path") are
+ * resolved against the data directory given at construction, and rejected
+ * if they lead outside it. Without a data directory they are rejected, and
+ * only inline matrices and inline trace and metrics replies are available.
+ *
+ * Each request updates a per-op counter, error counter and latency histogram
+ * in the service's metrics registry without taking a lock. The metrics op
+ * and metricsText() export them, together with the optimizer entry point
+ * histograms of core::MetricsRegistry::global(), in Prometheus text format.
+ */
+class OptimizationService {
+public:
+    static constexpr size_t MAX_FRONTIER_POINTS = 10000;
+
+    /**
+     * @brief Construct a service.
+     * @param dataDirectory Directory that request file paths are confined to,
+     *        or empty to reject file paths
+     * @throws std::invalid_argument if dataDirectory is not an existing directory
+     */
+    explicit OptimizationService(const std::string& dataDirectory = "")
+        : started_(std::chrono::steady_clock::now()), shutdown_(false) {
+        if (!dataDirectory.empty()) {
+            if (!std::filesystem::is_directory(dataDirectory)) {
+                throw std::invalid_argument("Data directory does not exist: " + dataDirectory);
+            }
+            dataDirectory_ = std::filesystem::canonical(dataDirectory);
+        }
+        for (const char* op : OPS) {
+            ops_.try_emplace(op, metrics_, op);
+        }
+        ops_.try_emplace("invalid", metrics_, "invalid");
+    }
+
+    /**
+     * @brief Handle one request.
+     * @param payload Request JSON text
+     * @return Response JSON text (single line)
+     */
+    std::string handle(const std::string& payload) {
+        auto start = std::chrono::steady_clock::now();
+        std::string op = "invalid";
+        std::string idMember;
+        bool failed = false;
+        std::ostringstream out;
+        out.precision(std::numeric_limits<double>::max_digits10);
+        try {
+            JsonValue request = JsonValue::parse(payload);
+            if (!request.isObject()) {
+                throw std::runtime_error("Request must be a JSON object");
+            }
+            idMember = idJson(request);
+            std::string name = request["op"].asString();
+            op = knownOp(name) != nullptr ? name : "invalid";
+            out << "{\"ok\":true" << idMember;
+            dispatch(name, request, out);
+            out << "}";
+        } catch (const std::exception& e) {
+            failed = true;
+            out.str("");
+            out << "{\"ok\":false" << idMember << ",\"error\":\""
+                << optimizer::escapeJSON(e.what()) << "\"}";
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        const OpMetrics& metrics = ops_.at(op);
+        metrics.requests.add();
+        if (failed) {
+            metrics.errors.add();
+        }
+        metrics.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        return out.str();
+    }
+
+    /**
+     * @brief Check whether a client requested shutdown.
+     */
+    bool shutdownRequested() const { return shutdown_.load(); }
+
+    /**
+     * @brief Access the snapshot store (e.g. to preload snapshots at startup).
+     */
+    SnapshotStore& snapshots() { return snapshots_; }
+
+    /**
+     * @brief Access the service's request metrics.
+     */
+    core::MetricsRegistry& metrics() { return metrics_; }
+
+    /**
+     * @brief Get a Prometheus text snapshot of the service and entry point metrics.
+     */
+    std::string metricsText() {
+        snapshotsGauge_.set(static_cast<double>(snapshots_.list().size()));
+        uptimeGauge_.set(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count());
+        std::ostringstream text;
+        metrics_.writePrometheus(text);
+        core::MetricsRegistry::global().writePrometheus(text);
+        return text.str();
+    }
+
+private:
+    static constexpr const char* OPS[] = {"load",  "drop",     "snapshots", "mpt",
+                                          "bl",    "frontier", "stats",     "ping",
+                                          "trace", "metrics",  "shutdown"};
+
+    /**
+     * @brief Metrics of one op, registered up front so requests never lock.
+     */
+    struct OpMetrics {
+        core::MetricCounter& requests;
+        core::MetricCounter& errors;
+        core::LatencyHistogram& latency;
+
+        OpMetrics(core::MetricsRegistry& registry, const std::string& op)
+            : requests(registry.counter("orbat_requests_total", "Requests handled",
+                                        {{"op", op}})),
+              errors(registry.counter("orbat_request_errors_total",
+                                      "Requests answered with an error", {{"op", op}})),
+              latency(registry.histogram("orbat_request_duration_seconds",
+                                         "Request handling time", {{"op", op}})) {}
+    };
+
+    SnapshotStore snapshots_;
+    core::MetricsRegistry metrics_;
+    std::map<std::string, OpMetrics> ops_;  // Fixed after construction
+    core::MetricGauge& snapshotsGauge_ =
+        metrics_.gauge("orbat_snapshots", "Covariance snapshots resident");
+    core::MetricGauge& uptimeGauge_ =
+        metrics_.gauge("orbat_uptime_seconds", "Time since the service started");
+    std::chrono::steady_clock::time_point started_;
+    std::atomic<bool> shutdown_;
+    std::filesystem::path dataDirectory_;  // Canonical; empty if file paths are rejected
+
+    // The op's name as a static string (usable as a trace span name), or nullptr
+    static const char* knownOp(const std::string& op) {
+        for (const char* known : OPS) {
+            if (op == known) {
+                return known;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Resolve a file path from a request inside the data directory.
+     *
+     * Relative paths are taken from the data directory. The result is
+     * resolved through ".." and symbolic links before it is checked, so
+     * neither can lead outside the directory.
+     *
+     * @param path Path from the request
+     * @return Resolved path
+     * @throws std::runtime_error if file paths are disabled or the path leads
+     *         outside the data directory
+     */
+    std::string resolvePath(const std::string& path) const {
+        if (dataDirectory_.empty()) {
+            throw std::runtime_error(
+                "File paths are disabled; start 'orbat serve' with --data-dir to allow them");
+        }
+        std::filesystem::path resolved =
+            std::filesystem::weakly_canonical(dataDirectory_ / std::filesystem::path(path));
+        auto [inside, rest] = std::mismatch(dataDirectory_.begin(), dataDirectory_.end(),
+                                            resolved.begin(), resolved.end());
+        if (inside != dataDirectory_.end() || rest == resolved.end()) {
+            throw std::runtime_error("Path is outside the data directory: " + path);
+        }
+        return resolved.string();
+    }
+
+    /**
+     * @brief Format the request id as a response member (empty if absent).
+     */
+    static std::string idJson(const JsonValue& request) {
+        if (!request.has("id")) {
+            return "";
+        }
+        const JsonValue& id = request["id"];
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<double>::max_digits10);
+        if (id.isNumber()) {
+            oss << ",\"id\":" << id.asNumber();
+        } else if (id.isString()) {
+            oss << ",\"id\":\"" << optimizer::escapeJSON(id.asString()) << "\"";
+        }
+        return oss.str();
+    }
+
+    void dispatch(const std::string& op, const JsonValue& request, std::ostream& out) {
+        ORBAT_TRACE_SPAN(knownOp(op) != nullptr ? knownOp(op) : "invalid", "request");
+        if (op == "mpt" || op == "bl") {
+            // The op doubles as the method; parseOptions() falls back to job.method
+            if (request.has("method") && request["method"].asString() != op) {
+                throw std::runtime_error("\"method\" does not match \"op\"");
+            }
+            BatchJob job;
+            job.method = op;
+            BatchManifest::parseOptions(request, job);
+            auto snapshot = snapshots_.get(request["snapshot"].asString());
+            optimizer::ExpectedReturns inputs(
+                toVector(request[op == "bl" ? "weights" : "returns"]));
+            optimizer::MarkowitzResult result = BatchRunner::solve(job, inputs, *snapshot);
+            ORBAT_TRACE_SPAN("OptimizationService::writeResult", "serialize");
+            out << ",\"result\":";
+            optimizer::writeCompactJSON(out, result);
+        } else if (op == "frontier") {
+            handleFrontier(request, out);
+        } else if (op == "load") {
+            handleLoad(request, out);
+        } else if (op == "drop") {
+            std::string name = request["snapshot"].asString();
+            out << ",\"dropped\":" << (snapshots_.drop(name) ? "true" : "false");
+        } else if (op == "snapshots") {
+            out << ",\"snapshots\":[";
+            bool first = true;
+            for (const auto& [name, size] : snapshots_.list()) {
+                out << (first ? "" : ",") << "{\"name\":\"" << optimizer::escapeJSON(name)
+                    << "\",\"assets\":" << size << "}";
+                first = false;
+            }
+            out << "]";
+        } else if (op == "stats") {
+            handleStats(out);
+        } else if (op == "trace") {
+            handleTrace(request, out);
+        } else if (op == "metrics") {
+            handleMetrics(request, out);
+        } else if (op == "ping") {
+            out << ",\"pong\":true";
+        } else if (op == "shutdown") {
+            shutdown_.store(true);
+        } else {
+            throw std::runtime_error("Unknown op: " + op);
+        }
+    }
+
+    void handleLoad(const JsonValue& request, std::ostream& out) {
+        std::string name = request["snapshot"].asString();
+        optimizer::CovarianceMatrix covariance;
+        if (request.has("matrix")) {
+            const auto& rows = request["matrix"].asArray();
+            core::Matrix matrix(rows.size(), rows.size());
+            for (size_t i = 0; i < rows.size(); ++i) {
+                const auto& row = rows[i].asArray();
+                if (row.size() != rows.size()) {
+                    throw std::runtime_error("Covariance matrix must be square");
+                }
+                for (size_t j = 0; j < row.size(); ++j) {
+                    matrix(i, j) = row[j].asNumber();
+                }
+            }
+            covariance = optimizer::CovarianceMatrix(matrix);
+        } else {
+            covariance =
+                FileParser::parseCovariance(resolvePath(request["covariance"].asString()));
+        }
+        size_t n = snapshots_.put(name, std::move(covariance));
+        out << ",\"snapshot\":\"" << optimizer::escapeJSON(name) << "\",\"assets\":" << n;
+    }
+
+    void handleFrontier(const JsonValue& request, std::ostream& out) {
+        auto snapshot = snapshots_.get(request["snapshot"].asString());
+        optimizer::ExpectedReturns returns(toVector(request["returns"]));
+        double points = request.getNumber("points", 20.0);
+        if (points < 2.0 || points > static_cast<double>(MAX_FRONTIER_POINTS)) {
+            throw std::runtime_error("points must be between 2 and " +
+                                     std::to_string(MAX_FRONTIER_POINTS));
+        }
+        BatchJob job;
+        job.longOnly = request.getBool("longOnly", job.longOnly);
+        optimizer::FrontierEngine engine(returns, snapshot->covariance,
+                                         BatchRunner::constraintsFor(job), snapshot->factorization);
+        optimizer::FrontierOptions options;
+        options.points = static_cast<size_t>(points);
+        options.tolerance = request.getNumber("tolerance", 0.0);
+        options.threads = 1;  // Already running on a server worker
+        std::ostringstream frontier;
+        frontier.precision(out.precision());
+        // Adaptive refinement can add points; keep responses bounded
+        engine.compute(options, [&](size_t i, const optimizer::MarkowitzResult& r) {
+            if (i >= MAX_FRONTIER_POINTS) {
+                throw std::runtime_error("Frontier exceeds " +
+                                         std::to_string(MAX_FRONTIER_POINTS) + " points");
+            }
+            frontier << (i > 0 ? "," : "");
+            optimizer::writeCompactJSON(frontier, r);
+        });
+        out << ",\"frontier\":[" << frontier.str() << "]";
+    }
+
+    void handleStats(std::ostream& out) const {
+        double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_)
+                            .count();
+        out << ",\"uptimeSeconds\":" << uptime << ",\"snapshots\":" << snapshots_.list().size()
+            << ",\"ops\":{";
+        bool first = true;
+        for (const auto& [op, metrics] : ops_) {
+            const core::LatencyHistogram& h = metrics.latency;
+            uint64_t count = h.count();
+            if (count == 0) {
+                continue;
+            }
+            double meanUs = static_cast<double>(h.sum()) * 1e-3 / static_cast<double>(count);
+            out << (first ? "" : ",") << "\"" << op << "\":{\"count\":" << count
+                << ",\"meanUs\":" << meanUs
+                << ",\"p50Us\":" << h.quantile(0.50) * 1e-3
+                << ",\"p90Us\":" << h.quantile(0.90) * 1e-3
+                << ",\"p99Us\":" << h.quantile(0.99) * 1e-3
+                << ",\"maxUs\":" << static_cast<double>(h.max()) * 1e-3 << "}";
+            first = false;
+        }
+        out << "}";
+    }
+
+    // Prometheus text snapshot, written atomically to "path" or returned
+    // inline as "metrics" when no path is given
+    void handleMetrics(const JsonValue& request, std::ostream& out) {
+        std::string text = metricsText();
+        if (request.has("path")) {
+            std::string path = request["path"].asString();
+            core::MetricsRegistry::writeFile(resolvePath(path), text);
+            out << ",\"path\":\"" << optimizer::escapeJSON(path) << "\"";
+        } else {
+            out << ",\"metrics\":\"" << optimizer::escapeJSON(text) << "\"";
+        }
+    }
+
+    // Spans (core::Tracer) are dumped in Chrome trace format to "path", or
+    // inline as "trace" when no path is given
+    void handleTrace(const JsonValue& request, std::ostream& out) const {
+        using core::Tracer;
+        std::string action = request.getString("action", "dump");
+        if (action == "start") {
+            Tracer::enable();
+        } else if (action == "stop") {
+            Tracer::disable();
+        } else if (action == "clear") {
+            Tracer::clear();
+        } else if (action == "dump") {
+            out << ",\"events\":" << Tracer::events().size()
+                << ",\"dropped\":" << Tracer::dropped();
+            if (request.has("path")) {
+                std::string path = request["path"].asString();
+                Tracer::writeChromeTrace(resolvePath(path));
+                out << ",\"path\":\"" << optimizer::escapeJSON(path) << "\"";
+            } else {
+                std::ostringstream trace;
+                Tracer::writeChromeTrace(trace);
+                std::string text = trace.str();
+                text.erase(std::remove(text.begin(), text.end(), '\n'), text.end());
+                out << ",\"trace\":" << text;
+            }
+        } else {
+            throw std::runtime_error("Unknown trace action '" + action +
+                                     "' (expected start, stop, clear or dump)");
+        }
+        out << ",\"tracing\":" << (Tracer::enabled() ? "true" : "false");
+    }
+
+    static core::Vector toVector(const JsonValue& array) {
+        const auto& items = array.asArray();
+        std::vector<double> values;
+        values.reserve(items.size());
+        for (const auto& item : items) {
+            values.push_back(item.asNumber());
+        }
+        return core::Vector(values);
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,528 @@
+#pragma once
+
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arg_parser.hpp"
+#include "hardware_counters.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Process-wide heap allocation counters.
+ *
+ * The counters are fed by the replacement global operator new in the CLI's
+ * main.cpp. Programs that do not install those hooks (e.g. unit tests) report
+ * allocations as unavailable rather than as zero.
+ */
+class AllocationCounter {
+public:
+    /**
+     * @brief Record one allocation. Called from the operator new hook.
+     * @param bytes Requested size
+     */
+    static void record(size_t bytes) noexcept {
+        count_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Mark the allocation hooks as installed.
+     */
+    static void markHooksInstalled() noexcept { installed_.store(true); }
+
+    /**
+     * @brief Check whether allocations are being counted.
+     */
+    static bool hooksInstalled() noexcept { return installed_.load(); }
+
+    /**
+     * @brief Get the number of allocations so far.
+     */
+    static uint64_t count() noexcept { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of bytes requested so far.
+     */
+    static uint64_t bytes() noexcept { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+    static inline std::atomic<uint64_t> count_{0};
+    static inline std::atomic<uint64_t> bytes_{0};
+    static inline std::atomic<bool> installed_{false};
+};
+
+/**
+ * @brief Per-phase timing and memory profile of a CLI run (--profile).
+ *
+ * Each phase records wall time, CPU time (user + system), the process's peak
+ * resident set size at the end of the phase and how much the phase raised
+ * it, and the number and total size of heap allocations made during it.
+ * With hardware counters enabled (--profile-counters), each phase also
+ * records CPU counters (see HardwareCounters) where the machine allows it.
+ * When profiling is disabled, phase() is a no-op.
+ *
+ * Example:
+ *   Profiler profiler = Profiler::fromParser(parser);
+ *   {
+ *       auto scope = profiler.phase("parse returns");
+ *       returns = FileParser::parseReturns(file);
+ *   }
+ *   profiler.report();
+ */
+class Profiler {
+public:
+    /**
+     * @brief Measurements for one phase.
+     */
+    struct Phase {
+        std::string name;
+        double wallSeconds = 0.0;
+        double cpuSeconds = 0.0;
+        uint64_t peakRssBytes = 0;    // Process peak RSS at the end of the phase
+        uint64_t rssGrowthBytes = 0;  // Increase of the peak RSS during the phase
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        HardwareCounts counters;  // Empty unless hardware counters are enabled
+    };
+
+    /**
+     * @brief Report format.
+     */
+    enum class Format { TABLE, JSON };
+
+    /**
+     * @brief RAII guard measuring one phase.
+     */
+    class Scope {
+    public:
+        Scope(Profiler* profiler, std::string name) : profiler_(profiler) {
+            if (profiler_ != nullptr) {
+                phase_.name = std::move(name);
+                start_ = Sample::now(profiler_->counters_.get());
+            }
+        }
+
+        ~Scope() { stop(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief End the phase before the scope is destroyed.
+         */
+        void stop() {
+            if (profiler_ != nullptr) {
+                Sample end = Sample::now(profiler_->counters_.get());
+                phase_.wallSeconds = end.wallSeconds - start_.wallSeconds;
+                phase_.cpuSeconds = end.cpuSeconds - start_.cpuSeconds;
+                phase_.peakRssBytes = end.peakRssBytes;
+                phase_.rssGrowthBytes = end.peakRssBytes - start_.peakRssBytes;
+                phase_.allocations = end.allocations - start_.allocations;
+                phase_.allocatedBytes = end.allocatedBytes - start_.allocatedBytes;
+                phase_.counters = end.counters - start_.counters;
+                profiler_->phases_.push_back(std::move(phase_));
+                profiler_ = nullptr;
+            }
+        }
+
+    private:
+        struct Sample {
+            double wallSeconds = 0.0;
+            double cpuSeconds = 0.0;
+            uint64_t peakRssBytes = 0;
+            uint64_t allocations = 0;
+            uint64_t allocatedBytes = 0;
+            HardwareCounts counters;
+
+            static Sample now(const HardwareCounters* counters) {
+                Sample sample;
+                if (counters != nullptr) {
+                    sample.counters = counters->read();
+                }
+                sample.wallSeconds = std::chrono::duration<double>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count();
+                sample.allocations = AllocationCounter::count();
+                sample.allocatedBytes = AllocationCounter::bytes();
+#if defined(__unix__) || defined(__APPLE__)
+                rusage usage{};
+                getrusage(RUSAGE_SELF, &usage);
+                sample.cpuSeconds = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#if defined(__APPLE__)
+                sample.peakRssBytes = static_cast<uint64_t>(usage.ru_maxrss);  // bytes
+#else
+                sample.peakRssBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // KiB
+#endif
+#else
+                sample.cpuSeconds = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+                return sample;
+            }
+
+#if defined(__unix__) || defined(__APPLE__)
+            static double seconds(const timeval& tv) {
+                return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) * 1e-6;
+            }
+#endif
+        };
+
+        Profiler* profiler_;
+        Phase phase_;
+        Sample start_;
+    };
+
+    /**
+     * @brief Construct a profiler.
+     * @param enabled Whether phases are measured
+     * @param format Report format
+     * @param outputPath Report destination ("" or "-" = stderr)
+     * @param hardwareCounters Whether phases also record CPU counters
+     */
+    explicit Profiler(bool enabled = false, Format format = Format::TABLE,
+                      std::string outputPath = "", bool hardwareCounters = false)
+        : enabled_(enabled), format_(format), outputPath_(std::move(outputPath)) {
+        if (enabled_ && hardwareCounters) {
+            counters_ = std::make_unique<HardwareCounters>();
+        }
+    }
+
+    /**
+     * @brief Build a profiler from command-line flags.
+     *
+     * Flags:
+     *   --profile [table|json]   Enable profiling (default format: table)
+     *   --profile-output <file>  Write the report to a file instead of stderr
+     *   --profile-counters       Add hardware counters per phase (implies --profile)
+     *
+     * @param parser Argument parser
+     * @return Profiler (disabled unless --profile or --profile-counters is given)
+     * @throws std::invalid_argument if --profile names an unknown format
+     */
+    static Profiler fromParser(const ArgParser& parser) {
+        bool counters = parser.hasFlag("profile-counters");
+        if (!parser.hasFlag("profile") && !counters) {
+            return Profiler();
+        }
+        // A bare --profile is followed by the next flag, or nothing
+        std::string value = parser.getFlagValue("profile", "");
+        Format format = Format::TABLE;
+        if (value == "json") {
+            format = Format::JSON;
+        } else if (value != "table" && !value.empty() && value[0] != '-') {
+            throw std::invalid_argument("Unknown profile format '" + value +
+                                        "' (expected table or json)");
+        }
+        return Profiler(true, format, parser.getFlagValue("profile-output", ""), counters);
+    }
+
+    /**
+     * @brief Check whether profiling is enabled.
+     */
+    bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Get the hardware counters, or nullptr if they were not requested.
+     */
+    const HardwareCounters* hardwareCounters() const { return counters_.get(); }
+
+    /**
+     * @brief Start measuring a phase; the phase ends when the scope is destroyed.
+     * @param name Phase name
+     * @return Scope guard
+     */
+    Scope phase(const std::string& name) { return Scope(enabled_ ? this : nullptr, name); }
+
+    /**
+     * @brief Get the phases measured so far.
+     */
+    const std::vector<Phase>& phases() const { return phases_; }
+
+    /**
+     * @brief Write the report to the configured destination (no-op when disabled).
+     * @throws std::runtime_error if the report file cannot be written
+     */
+    void report() const {
+        if (!enabled_) {
+            return;
+        }
+        if (outputPath_.empty() || outputPath_ == "-") {
+            write(std::cerr);
+            return;
+        }
+        std::ofstream file(outputPath_);
+        write(file);
+        if (!file) {
+            throw std::runtime_error("Cannot write profile report: " + outputPath_);
+        }
+    }
+
+    /**
+     * @brief Write the report in the configured format.
+     * @param out Destination stream
+     */
+    void write(std::ostream& out) const {
+        if (format_ == Format::JSON) {
+            writeJSON(out);
+        } else {
+            writeTable(out);
+        }
+    }
+
+    /**
+     * @brief Write the report as an aligned text table with a total row.
+     * @param out Destination stream
+     */
+    void writeTable(std::ostream& out) const {
+        const bool allocs = AllocationCounter::hooksInstalled();
+        optimizer::FormatScope format(out, 3);
+        out << "\n=== Profile ===\n"
+            << std::left << std::setw(18) << "Phase" << std::right << std::setw(12) << "Wall (ms)"
+            << std::setw(12) << "CPU (ms)" << std::setw(14) << "Peak RSS (MB)" << std::setw(12)
+            << "+RSS (MB)" << std::setw(12) << "Allocs" << std::setw(14) << "Alloc (MB)" << "\n";
+        Phase total = totals();
+        for (const Phase* phase : withTotal(total)) {
+            out << std::left << std::setw(18) << phase->name << std::right << std::fixed
+                << std::setprecision(3) << std::setw(12) << phase->wallSeconds * 1e3
+                << std::setw(12) << phase->cpuSeconds * 1e3 << std::setprecision(1)
+                << std::setw(14) << megabytes(phase->peakRssBytes) << std::setw(12)
+                << megabytes(phase->rssGrowthBytes);
+            if (allocs) {
+                out << std::setw(12) << phase->allocations << std::setw(14)
+                    << megabytes(phase->allocatedBytes);
+            } else {
+                out << std::setw(12) << "n/a" << std::setw(14) << "n/a";
+            }
+            out << "\n";
+        }
+        if (counters_) {
+            writeCountersTable(out, total);
+        }
+        if (core::AllocationTracker::enabled()) {
+            writeTrackedTable(out);
+        }
+        out.flush();
+    }
+
+    /**
+     * @brief Write the report as a single JSON object.
+     *
+     * Example:
+     *   {"phases":[{"name":"parse covariance","wallMs":12.5,"cpuMs":12.4,
+     *     "peakRssBytes":10485760,"rssGrowthBytes":2097152,"allocations":1204,
+     *     "allocatedBytes":98304},...],"total":{...}}
+     *
+     * Allocation fields are null when allocation counting is unavailable.
+     * With hardware counters, each phase has a "counters" object (cycles,
+     * instructions, cacheMisses, branchMisses, flops; null for events that
+     * are not counted) and "countersStatus" explains missing events;
+     * otherwise both are null.
+     * "tracked" holds the core::Vector / core::Matrix storage counters by
+     * container and by entry point (see core::AllocationTracker), or null
+     * when the library was built without ORBAT_ALLOCATION_TRACKING.
+     *
+     * @param out Destination stream
+     */
+    void writeJSON(std::ostream& out) const {
+        optimizer::FormatScope format(out, 3);
+        out << "{\"phases\":[";
+        for (size_t i = 0; i < phases_.size(); ++i) {
+            out << (i > 0 ? "," : "");
+            writePhaseJSON(out, phases_[i]);
+        }
+        out << "],\"total\":";
+        writePhaseJSON(out, totals());
+        out << ",\"countersStatus\":";
+        if (counters_) {
+            out << "\"" << counters_->status() << "\"";
+        } else {
+            out << "null";
+        }
+        out << ",\"tracked\":";
+        writeTrackedJSON(out);
+        out << "}\n";
+        out.flush();
+    }
+
+private:
+    bool enabled_;
+    Format format_;
+    std::string outputPath_;
+    std::vector<Phase> phases_;
+    std::unique_ptr<HardwareCounters> counters_;
+
+    Phase totals() const {
+        Phase total;
+        total.name = "total";
+        for (const auto& phase : phases_) {
+            total.wallSeconds += phase.wallSeconds;
+            total.cpuSeconds += phase.cpuSeconds;
+            total.peakRssBytes = std::max(total.peakRssBytes, phase.peakRssBytes);
+            total.rssGrowthBytes += phase.rssGrowthBytes;
+            total.allocations += phase.allocations;
+            total.allocatedBytes += phase.allocatedBytes;
+            for (size_t i = 0; i < HARDWARE_EVENT_COUNT; ++i) {
+                if (phase.counters.values[i]) {
+                    auto& sum = total.counters.values[i];
+                    sum = sum.value_or(0.0) + *phase.counters.values[i];
+                }
+            }
+        }
+        return total;
+    }
+
+    std::vector<const Phase*> withTotal(const Phase& total) const {
+        std::vector<const Phase*> rows;
+        for (const auto& phase : phases_) {
+            rows.push_back(&phase);
+        }
+        rows.push_back(&total);
+        return rows;
+    }
+
+    static double megabytes(uint64_t bytes) { return static_cast<double>(bytes) / 1048576.0; }
+
+    // Counts in millions (misses in thousands) per phase, n/a where not counted
+    void writeCountersTable(std::ostream& out, const Phase& total) const {
+        out << "\n=== Hardware counters ===\n"
+            << std::left << std::setw(18) << "Phase" << std::right << std::setw(12) << "Cycles (M)"
+            << std::setw(12) << "Instr (M)" << std::setw(8) << "IPC" << std::setw(16)
+            << "Cache miss (K)" << std::setw(17) << "Branch miss (K)" << std::setw(12)
+            << "FLOPs (M)" << "\n";
+        auto cell = [&out](int width, std::optional<double> value, double scale) {
+            out << std::setw(width);
+            if (value) {
+                out << *value / scale;
+            } else {
+                out << "n/a";
+            }
+        };
+        for (const Phase* phase : withTotal(total)) {
+            const HardwareCounts& c = phase->counters;
+            out << std::left << std::setw(18) << phase->name << std::right << std::fixed
+                << std::setprecision(3);
+            cell(12, c[HardwareEvent::CYCLES], 1e6);
+            cell(12, c[HardwareEvent::INSTRUCTIONS], 1e6);
+            out << std::setprecision(2);
+            cell(8, c.ipc(), 1.0);
+            out << std::setprecision(1);
+            cell(16, c[HardwareEvent::CACHE_MISSES], 1e3);
+            cell(17, c[HardwareEvent::BRANCH_MISSES], 1e3);
+            out << std::setprecision(3);
+            cell(12, c[HardwareEvent::FLOPS], 1e6);
+            out << "\n";
+        }
+        if (!counters_->status().empty()) {
+            out << counters_->status() << "\n";
+        }
+    }
+
+    // Container storage counters since startup, then one row per entry point
+    static void writeTrackedTable(std::ostream& out) {
+        using core::AllocationSite;
+        using core::AllocationTracker;
+        out << "\n=== Tracked allocations (core::Vector / core::Matrix storage) ===\n"
+            << std::left << std::setw(44) << "Container / entry point" << std::right
+            << std::setw(10) << "Calls" << std::setw(12) << "Allocs" << std::setw(14)
+            << "Alloc (MB)" << std::setw(14) << "Peak (MB)" << "\n";
+        auto row = [&out](const std::string& name, const core::AllocationStats& stats,
+                          bool entryPoint) {
+            out << std::left << std::setw(44) << name << std::right << std::setw(10);
+            if (entryPoint) {
+                out << stats.calls;
+            } else {
+                out << "-";
+            }
+            out << std::setw(12) << stats.allocations << std::fixed << std::setprecision(3)
+                << std::setw(14) << megabytes(stats.bytes) << std::setw(14)
+                << megabytes(stats.peakBytes) << "\n";
+        };
+        for (AllocationSite site : {AllocationSite::VECTOR, AllocationSite::MATRIX}) {
+            row(AllocationTracker::siteName(site), AllocationTracker::site(site), false);
+        }
+        for (const auto& [name, stats] : AllocationTracker::entryPoints()) {
+            row(name, stats, true);
+        }
+    }
+
+    static void writeTrackedJSON(std::ostream& out) {
+        using core::AllocationSite;
+        using core::AllocationTracker;
+        if (!AllocationTracker::enabled()) {
+            out << "null";
+            return;
+        }
+        auto stats = [&out](const core::AllocationStats& s) {
+            out << "{\"calls\":" << s.calls << ",\"allocations\":" << s.allocations
+                << ",\"bytes\":" << s.bytes << ",\"liveBytes\":" << s.liveBytes
+                << ",\"peakBytes\":" << s.peakBytes << "}";
+        };
+        out << "{\"containers\":{\"vector\":";
+        stats(AllocationTracker::site(AllocationSite::VECTOR));
+        out << ",\"matrix\":";
+        stats(AllocationTracker::site(AllocationSite::MATRIX));
+        out << "},\"entryPoints\":{";
+        bool first = true;
+        for (const auto& [name, s] : AllocationTracker::entryPoints()) {
+            out << (first ? "" : ",") << "\"" << name << "\":";
+            stats(s);
+            first = false;
+        }
+        out << "}}";
+    }
+
+    void writeCountersJSON(std::ostream& out, const Phase& phase) const {
+        if (!counters_) {
+            out << "null";
+            return;
+        }
+        const char* keys[HARDWARE_EVENT_COUNT] = {"cycles", "instructions", "cacheMisses",
+                                                  "branchMisses", "flops"};
+        out << std::setprecision(0);
+        for (size_t i = 0; i < HARDWARE_EVENT_COUNT; ++i) {
+            out << (i == 0 ? "{\"" : ",\"") << keys[i] << "\":";
+            if (phase.counters.values[i]) {
+                out << *phase.counters.values[i];
+            } else {
+                out << "null";
+            }
+        }
+        out << "}" << std::setprecision(3);
+    }
+
+    void writePhaseJSON(std::ostream& out, const Phase& phase) const {
+        out << "{\"name\":\"" << phase.name << "\",\"wallMs\":" << phase.wallSeconds * 1e3
+            << ",\"cpuMs\":" << phase.cpuSeconds * 1e3 << ",\"peakRssBytes\":" << phase.peakRssBytes
+            << ",\"rssGrowthBytes\":" << phase.rssGrowthBytes << ",\"allocations\":";
+        if (AllocationCounter::hooksInstalled()) {
+            out << phase.allocations << ",\"allocatedBytes\":" << phase.allocatedBytes;
+        } else {
+            out << "null,\"allocatedBytes\":null";
+        }
+        out << ",\"counters\":";
+        writeCountersJSON(out, phase);
+        out << "}";
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
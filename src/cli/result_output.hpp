@@ -0,0 +1,102 @@
+#pragma once
+
+#include "orbat/core/trace.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arg_parser.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Output destination and format selected on the command line.
+ *
+ * Flags:
+ *   --output <file|->   Write results to a file, or to stdout with "-"
+ *   --format <name>     json (default), ndjson, csv or binary
+ *
+ * Without either flag, commands print a human-readable report. Giving only
+ * --format streams machine-readable output to stdout.
+ */
+struct OutputOptions {
+    std::string path;  // "" = console report, "-" = stdout, otherwise a file path
+    optimizer::OutputFormat format = optimizer::OutputFormat::JSON;
+
+    /**
+     * @brief Check whether the human-readable console report was requested.
+     * @return true if no machine-readable output was requested
+     */
+    bool humanReadable() const { return path.empty(); }
+
+    /**
+     * @brief Check whether machine-readable output goes to stdout.
+     * @return true if writing to stdout
+     */
+    bool toStdout() const { return path == "-"; }
+
+    /**
+     * @brief Build output options from command-line flags.
+     * @param parser Argument parser
+     * @return Output options
+     * @throws std::invalid_argument if --format names an unknown format
+     */
+    static OutputOptions fromParser(const ArgParser& parser) {
+        OutputOptions options;
+        options.path = parser.getFlagValue("output", "");
+        if (parser.hasFlag("format")) {
+            options.format = optimizer::parseOutputFormat(parser.getFlagValue("format"));
+            if (options.path.empty()) {
+                options.path = "-";
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * @brief Serialization of single optimization results for CLI commands.
+ */
+class ResultOutput {
+public:
+    /**
+     * @brief Write one result to the configured destination.
+     *
+     * JSON output of a single result keeps the document layout produced by
+     * MarkowitzResult::toJSON(); other formats go through a result sink.
+     *
+     * @param result Optimization result
+     * @param options Output options (must not be humanReadable())
+     * @param assetLabels Optional asset labels for CSV headers and binary schema
+     * @throws std::runtime_error if the output cannot be written
+     */
+    static void write(const optimizer::MarkowitzResult& result, const OutputOptions& options,
+                      const std::vector<std::string>& assetLabels = {}) {
+        ORBAT_TRACE_SPAN("ResultOutput::write", "serialize");
+        optimizer::OutputTarget target(options.path);
+        if (options.format == optimizer::OutputFormat::JSON) {
+            target.stream() << result.toJSON();
+            if (target.isStdout()) {
+                target.stream() << "\n";
+            }
+            target.stream().flush();
+        } else {
+            optimizer::SinkOptions sinkOptions;
+            sinkOptions.assetLabels = assetLabels;
+            auto sink = optimizer::makeResultSink(options.format, target.stream(), sinkOptions);
+            sink->write(result);
+            sink->finish();
+        }
+        if (!target.stream()) {
+            throw std::runtime_error("Failed to write output: " + options.path);
+        }
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arg_parser.hpp"
+#include "error_codes.hpp"
+#include "file_parser.hpp"
+#include "metrics_output.hpp"
+#include "optimization_service.hpp"
+#include "trace_output.hpp"
+#include "unix_socket_server.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Serve command implementation.
+ *
+ * Implements the 'serve' command: a long-lived process that keeps named
+ * covariance snapshots and their factorizations resident and answers mpt,
+ * bl and frontier requests over a Unix domain socket. See
+ * OptimizationService for the request format and FrameProtocol for the
+ * framing.
+ */
+class ServeCommand {
+public:
+    /**
+     * @brief Execute the serve command.
+     * @param parser Argument parser containing command-line arguments
+     * @return Exit code (0 after a clean shutdown)
+     */
+    static int execute(const ArgParser& parser) {
+        try {
+            if (parser.isHelp()) {
+                printHelp();
+                return static_cast<int>(ExitCode::SUCCESS);
+            }
+
+#ifndef ORBAT_HAS_UNIX_SOCKETS
+            std::cerr << "Error: 'orbat serve' requires Unix domain sockets, which are not "
+                         "available on this platform"
+                      << std::endl;
+            return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+#else
+            if (!parser.hasFlag("socket")) {
+                std::cerr << "Error: Missing required input - Socket path not provided"
+                          << std::endl;
+                std::cerr << "Usage: Use --socket <path> to choose where the server listens"
+                          << std::endl;
+                std::cerr << "Run 'orbat serve --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            std::string socketPath = parser.getFlagValue("socket");
+            size_t threads = 0;
+            std::vector<std::pair<std::string, std::string>> preloads;
+            TraceOutput trace;
+            double metricsInterval = 0.0;
+            std::string dataDirectory;
+            try {
+                if (parser.hasFlag("threads")) {
+                    threads = parseThreadCount(parser.getFlagValue("threads"));
+                }
+                for (const auto& spec : parser.getFlagValues("preload")) {
+                    preloads.push_back(parsePreload(spec));
+                }
+                trace = TraceOutput::fromParser(parser);
+                metricsInterval = MetricsOutput::intervalFromParser(parser);
+                if (parser.hasFlag("data-dir")) {
+                    dataDirectory = parser.getFlagValue("data-dir");
+                    if (!std::filesystem::is_directory(dataDirectory)) {
+                        throw std::invalid_argument("Data directory does not exist: " +
+                                                    dataDirectory);
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid serve options" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                std::cerr << "Run 'orbat serve --help' for more information." << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            OptimizationService service(dataDirectory);
+            for (const auto& [name, file] : preloads) {
+                try {
+                    size_t n = service.snapshots().put(name, FileParser::parseCovariance(file));
+                    std::cerr << "Loaded snapshot '" << name << "' (" << n << " assets) from "
+                              << file << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Failed to load snapshot '" << name << "' from '" << file
+                              << "'" << std::endl;
+                    std::cerr << "Details: " << e.what() << std::endl;
+                    return static_cast<int>(ExitCode::VALIDATION_ERROR);
+                }
+            }
+
+            MetricsOutput metrics;
+            if (parser.hasFlag("metrics")) {
+                metrics = MetricsOutput(parser.getFlagValue("metrics"),
+                                        [&service] { return service.metricsText(); },
+                                        metricsInterval);
+            }
+
+            UnixSocketServer server(socketPath, service, threads);
+            try {
+                server.start();
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Cannot start server on '" << socketPath << "'" << std::endl;
+                std::cerr << "Details: " << e.what() << std::endl;
+                return static_cast<int>(ExitCode::INVALID_ARGUMENTS);
+            }
+
+            installSignalHandlers();
+            std::cerr << "orbat serve listening on " << socketPath << std::endl;
+            server.run(&stopFlag());
+            std::cerr << "orbat serve stopped" << std::endl;
+            return static_cast<int>(ExitCode::SUCCESS);
+#endif
+
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Unexpected error occurred" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Use 'orbat serve --help' for usage information." << std::endl;
+            return static_cast<int>(ExitCode::INTERNAL_ERROR);
+        }
+    }
+
+    /**
+     * @brief Print help message for serve command.
+     */
+    static void printHelp() {
+        std::cout
+            << "Usage: orbat serve --socket <path> [OPTIONS]\n"
+            << "\n"
+            << "Long-lived optimization server on a Unix domain socket\n"
+            << "\n"
+            << "Required Options:\n"
+            << "  --socket <path>        Socket path to listen on\n"
+            << "\n"
+            << "Optional Flags:\n"
+            << "  --threads <n>          Worker threads (default: hardware concurrency)\n"
+            << "  --preload <name=file>  Load a covariance snapshot at startup (repeatable)\n"
+            << "  --data-dir <dir>       Directory that file paths in requests must lie in\n"
+            << "                         (default: none; requests cannot name files)\n"
+            << "  --trace <file>         Record spans from startup; written at shutdown\n"
+            << "                         (the trace request also starts and dumps them)\n"
+            << "  --metrics <file>       Write request and solver metrics (Prometheus text\n"
+            << "                         format) at shutdown\n"
+            << "  --metrics-interval <s> Also rewrite the metrics file every s seconds\n"
+            << "  --help, -h             Show this help message\n"
+            << "\n"
+            << "Protocol:\n"
+            << "  Each message is a 4-byte little-endian length followed by a JSON object.\n"
+            << "  Requests: load, drop, snapshots, mpt, bl, frontier, stats, trace, metrics,\n"
+            << "            ping, shutdown\n"
+            << "\n"
+            << "Examples:\n"
+            << "  orbat serve --socket /tmp/orbat.sock --preload us=us_cov.csv\n"
+            << "  request: {\"op\": \"mpt\", \"snapshot\": \"us\", \"returns\": [0.08, 0.12]}\n";
+    }
+
+private:
+    static std::atomic<bool>& stopFlag() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static void installSignalHandlers() {
+        stopFlag().store(false);
+        std::signal(SIGINT, [](int) { stopFlag().store(true); });
+        std::signal(SIGTERM, [](int) { stopFlag().store(true); });
+    }
+
+    static std::pair<std::string, std::string> parsePreload(const std::string& spec) {
+        size_t eq = spec.find('=');
+        if (eq == std::string::npos || eq == 0 || eq + 1 == spec.size()) {
+            throw std::invalid_argument("Preload must be <name>=<file>: " + spec);
+        }
+        return {spec.substr(0, eq), spec.substr(eq + 1)};
+    }
+
+    static size_t parseThreadCount(const std::string& value) {
+        size_t consumed = 0;
+        long long threads = std::stoll(value, &consumed);
+        if (consumed != value.size() || threads < 1 || threads > 1024) {
+            throw std::invalid_argument("Thread count must be an integer between 1 and 1024");
+        }
+        return static_cast<size_t>(threads);
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "orbat/core/trace.hpp"
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "arg_parser.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Timeline of a CLI run (--trace <file>).
+ *
+ * Enables core::Tracer for the lifetime of the command and writes the
+ * recorded spans (parse, validate, factorize, solve, serialize, ...) as a
+ * Chrome trace file when it goes out of scope, on every exit path. A trace
+ * that cannot be written is reported on stderr; it does not change the
+ * command's exit code.
+ *
+ * Example:
+ *   TraceOutput trace = TraceOutput::fromParser(parser);
+ *   ... run the command ...
+ *   // trace.json is written here; open it in https://ui.perfetto.dev
+ */
+class TraceOutput {
+public:
+    TraceOutput() = default;
+
+    /**
+     * @brief Start tracing to a file.
+     * @param path Trace file written at the end of the run
+     */
+    explicit TraceOutput(std::string path) : path_(std::move(path)) {
+        core::Tracer::clear();
+        core::Tracer::setThreadName("main");
+        core::Tracer::enable();
+    }
+
+    /**
+     * @brief Start tracing if --trace <file> is given.
+     * @param parser Argument parser
+     * @return Trace output (inactive without --trace)
+     * @throws std::runtime_error if --trace has no file name
+     */
+    static TraceOutput fromParser(const ArgParser& parser) {
+        if (!parser.hasFlag("trace")) {
+            return TraceOutput();
+        }
+        return TraceOutput(parser.getFlagValue("trace"));
+    }
+
+    TraceOutput(TraceOutput&& other) noexcept : path_(std::exchange(other.path_, "")) {}
+
+    TraceOutput& operator=(TraceOutput&& other) noexcept {
+        if (this != &other) {
+            finish();
+            path_ = std::exchange(other.path_, "");
+        }
+        return *this;
+    }
+
+    TraceOutput(const TraceOutput&) = delete;
+    TraceOutput& operator=(const TraceOutput&) = delete;
+
+    ~TraceOutput() { finish(); }
+
+    /**
+     * @brief Check whether this run is being traced.
+     */
+    bool active() const { return !path_.empty(); }
+
+    /**
+     * @brief Stop tracing and write the file now (no-op when inactive).
+     */
+    void finish() noexcept {
+        if (path_.empty()) {
+            return;
+        }
+        core::Tracer::disable();
+        try {
+            core::Tracer::writeChromeTrace(path_);
+            if (!core::Tracer::compiledIn()) {
+                std::cerr << "Warning: tracing was disabled at build time (ORBAT_TRACING=OFF); "
+                          << path_ << " has no spans" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+        path_.clear();
+    }
+
+private:
+    std::string path_;
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,435 @@
+#pragma once
+
+#include "orbat/core/thread_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "optimization_service.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ORBAT_HAS_UNIX_SOCKETS 1
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Length-prefixed framing used by 'orbat serve'.
+ *
+ * Every message in either direction is a 4-byte unsigned little-endian
+ * payload length followed by that many bytes of UTF-8 JSON.
+ *
+ *   +----------------+---------------------------+
+ *   | length: uint32 | payload: length bytes     |
+ *   +----------------+---------------------------+
+ */
+struct FrameProtocol {
+    static constexpr size_t HEADER_SIZE = 4;
+    static constexpr uint32_t MAX_FRAME_SIZE = 16u * 1024u * 1024u;  // 16 MiB
+
+    /**
+     * @brief Encode a frame header.
+     * @param size Payload size
+     * @return 4-byte little-endian header
+     */
+    static std::string encodeHeader(uint32_t size) {
+        std::string header(HEADER_SIZE, '\0');
+        for (size_t i = 0; i < HEADER_SIZE; ++i) {
+            header[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+        }
+        return header;
+    }
+
+    /**
+     * @brief Decode a frame header.
+     * @param bytes Pointer to 4 header bytes
+     * @return Payload size
+     */
+    static uint32_t decodeHeader(const char* bytes) {
+        uint32_t size = 0;
+        for (size_t i = 0; i < HEADER_SIZE; ++i) {
+            size |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+        }
+        return size;
+    }
+};
+
+#ifdef ORBAT_HAS_UNIX_SOCKETS
+
+namespace detail {
+
+/**
+ * @brief Read exactly n bytes.
+ * @return false on clean end-of-stream before the first byte
+ * @throws std::runtime_error on I/O error or end-of-stream mid-read
+ */
+inline bool readFully(int fd, char* buffer, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t got = ::recv(fd, buffer + done, n - done, 0);
+        if (got == 0) {
+            if (done == 0) {
+                return false;
+            }
+            throw std::runtime_error("Connection closed mid-frame");
+        }
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("recv failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+/**
+ * @brief Write exactly n bytes (without raising SIGPIPE where supported).
+ * @throws std::runtime_error on I/O error
+ */
+inline void writeFully(int fd, const char* buffer, size_t n) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    size_t done = 0;
+    while (done < n) {
+        ssize_t sent = ::send(fd, buffer + done, n - done, flags);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(sent);
+    }
+}
+
+/**
+ * @brief Read one frame.
+ * @return false on clean end-of-stream
+ * @throws std::runtime_error on I/O error or oversized frame
+ */
+inline bool readFrame(int fd, std::string& payload) {
+    char header[FrameProtocol::HEADER_SIZE];
+    if (!readFully(fd, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t size = FrameProtocol::decodeHeader(header);
+    if (size > FrameProtocol::MAX_FRAME_SIZE) {
+        throw std::runtime_error("Frame exceeds maximum size");
+    }
+    payload.resize(size);
+    if (size > 0 && !readFully(fd, payload.data(), size)) {
+        throw std::runtime_error("Connection closed mid-frame");
+    }
+    return true;
+}
+
+/**
+ * @brief Write one frame.
+ * @throws std::runtime_error on I/O error or oversized payload
+ */
+inline void writeFrame(int fd, const std::string& payload) {
+    if (payload.size() > FrameProtocol::MAX_FRAME_SIZE) {
+        throw std::runtime_error("Frame exceeds maximum size");
+    }
+    std::string frame = FrameProtocol::encodeHeader(static_cast<uint32_t>(payload.size()));
+    frame += payload;
+    writeFully(fd, frame.data(), frame.size());
+}
+
+/**
+ * @brief Fill a sockaddr_un for a filesystem path.
+ * @throws std::invalid_argument if the path is empty or too long
+ */
+inline sockaddr_un makeAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path must be 1-" +
+                                    std::to_string(sizeof(address.sun_path) - 1) +
+                                    " characters: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Unix domain socket front end for an OptimizationService.
+ *
+ * One lightweight thread per connection reads frames; the optimization work
+ * runs on a shared worker pool, so the number of concurrent solves is bounded
+ * by the pool size regardless of the number of clients. Requests on one
+ * connection are answered in order.
+ *
+ * Example:
+ *   OptimizationService service;
+ *   UnixSocketServer server("/tmp/orbat.sock", service, 8);
+ *   server.start();
+ *   server.run();  // Until stop(), a shutdown request, or *externalStop
+ */
+class UnixSocketServer {
+public:
+    static constexpr size_t MAX_CONNECTIONS = 256;
+    static constexpr int POLL_INTERVAL_MS = 100;
+    static constexpr int IO_TIMEOUT_SECONDS = 10;
+
+    /**
+     * @brief Construct a server (does not bind yet).
+     * @param path Socket path
+     * @param service Request handler (must outlive the server)
+     * @param numThreads Worker threads (0 = hardware concurrency)
+     */
+    UnixSocketServer(std::string path, OptimizationService& service, size_t numThreads = 0)
+        : path_(std::move(path)), service_(service), pool_(numThreads), listenFd_(-1),
+          stopping_(false) {}
+
+    ~UnixSocketServer() {
+        stop();
+        joinConnections(true);
+        closeListener();
+    }
+
+    UnixSocketServer(const UnixSocketServer&) = delete;
+    UnixSocketServer& operator=(const UnixSocketServer&) = delete;
+
+    /**
+     * @brief Bind and listen on the socket path.
+     *
+     * A stale socket file left by a crashed server is removed; a path that
+     * another live server is listening on is an error.
+     *
+     * @throws std::runtime_error if the socket cannot be created or bound
+     */
+    void start() {
+        sockaddr_un address = detail::makeAddress(path_);
+        struct stat info {};
+        if (::lstat(path_.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                throw std::runtime_error("Path exists and is not a socket: " + path_);
+            }
+            if (isLive(address)) {
+                throw std::runtime_error("Another server is already listening on " + path_);
+            }
+            ::unlink(path_.c_str());  // Stale socket from a previous run
+        }
+
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd_ < 0) {
+            throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+        }
+        const auto* addr = reinterpret_cast<const sockaddr*>(&address);
+        bool listening = ::bind(listenFd_, addr, sizeof(address)) == 0 &&
+                         ::listen(listenFd_, SOMAXCONN) == 0;
+        if (!listening) {
+            std::string error = std::strerror(errno);
+            closeListener();
+            throw std::runtime_error("Cannot listen on " + path_ + ": " + error);
+        }
+    }
+
+    /**
+     * @brief Accept and serve connections until stopped.
+     * @param externalStop Optional flag (e.g. set by a signal handler) that stops the server
+     */
+    void run(const std::atomic<bool>* externalStop = nullptr) {
+        if (listenFd_ < 0) {
+            throw std::logic_error("UnixSocketServer::run() called before start()");
+        }
+        while (!shouldStop(externalStop)) {
+            pollfd pfd{listenFd_, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+            joinConnections(false);
+            if (ready <= 0 || !(pfd.revents & POLLIN)) {
+                continue;
+            }
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            // A client that stalls mid-frame must not pin its thread forever
+            timeval timeout{IO_TIMEOUT_SECONDS, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            if (connections_.size() >= MAX_CONNECTIONS) {
+                ::close(fd);
+                continue;
+            }
+            auto done = std::make_shared<std::atomic<bool>>(false);
+            connections_.push_back(
+                {std::thread([this, fd, done, externalStop] {
+                     serveConnection(fd, externalStop);
+                     done->store(true);
+                 }),
+                 done});
+        }
+        stop();
+        joinConnections(true);
+        closeListener();
+    }
+
+    /**
+     * @brief Ask the server to stop. Safe to call from any thread.
+     */
+    void stop() { stopping_.store(true); }
+
+    /**
+     * @brief Get the socket path.
+     */
+    const std::string& path() const { return path_; }
+
+private:
+    struct Connection {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    std::string path_;
+    OptimizationService& service_;
+    core::ThreadPool pool_;
+    int listenFd_;
+    std::atomic<bool> stopping_;
+    std::mutex connectionsMutex_;
+    std::vector<Connection> connections_;
+
+    bool shouldStop(const std::atomic<bool>* externalStop) const {
+        return stopping_.load() || service_.shutdownRequested() ||
+               (externalStop != nullptr && externalStop->load());
+    }
+
+    static bool isLive(const sockaddr_un& address) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        bool live =
+            ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        ::close(fd);
+        return live;
+    }
+
+    void serveConnection(int fd, const std::atomic<bool>* externalStop) {
+        try {
+            std::string request;
+            while (!shouldStop(externalStop)) {
+                pollfd pfd{fd, POLLIN, 0};
+                int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+                if (ready == 0) {
+                    continue;
+                }
+                if (ready < 0 || !detail::readFrame(fd, request)) {
+                    break;
+                }
+                std::string response =
+                    pool_.submit([this, &request] { return service_.handle(request); }).get();
+                detail::writeFrame(fd, response);
+            }
+        } catch (const std::exception&) {
+            // Protocol or I/O error: drop this connection, keep serving others
+        }
+        ::close(fd);
+    }
+
+    void joinConnections(bool all) {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (all || it->done->load()) {
+                it->thread.join();
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void closeListener() {
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+            ::unlink(path_.c_str());
+        }
+    }
+};
+
+/**
+ * @brief Blocking client for 'orbat serve'.
+ *
+ * Example:
+ *   UnixSocketClient client("/tmp/orbat.sock");
+ *   std::string reply = client.request(R"({"op": "ping"})");
+ */
+class UnixSocketClient {
+public:
+    /**
+     * @brief Connect to a server.
+     * @param path Socket path
+     * @throws std::runtime_error if the connection fails
+     */
+    explicit UnixSocketClient(const std::string& path) : fd_(-1) {
+        sockaddr_un address = detail::makeAddress(path);
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0 ||
+            ::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            std::string error = std::strerror(errno);
+            close();
+            throw std::runtime_error("Cannot connect to " + path + ": " + error);
+        }
+    }
+
+    ~UnixSocketClient() { close(); }
+
+    UnixSocketClient(const UnixSocketClient&) = delete;
+    UnixSocketClient& operator=(const UnixSocketClient&) = delete;
+
+    /**
+     * @brief Send a request and wait for its response.
+     * @param payload Request JSON
+     * @return Response JSON
+     * @throws std::runtime_error on I/O error or if the server closes the connection
+     */
+    std::string request(const std::string& payload) {
+        detail::writeFrame(fd_, payload);
+        std::string response;
+        if (!detail::readFrame(fd_, response)) {
+            throw std::runtime_error("Server closed the connection");
+        }
+        return response;
+    }
+
+private:
+    int fd_;
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+};
+
+#endif  // ORBAT_HAS_UNIX_SOCKETS
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,300 @@
+#pragma once
+
+#include "orbat/core/matrix.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "constraints_loader.hpp"
+#include "error_codes.hpp"
+#include "file_parser.hpp"
+#include "file_watcher.hpp"
+
+namespace orbat {
+namespace cli {
+
+/**
+ * @brief Parsed mpt/bl inputs that are reloaded file by file.
+ *
+ * refresh() re-parses only the files it is told have changed and keeps
+ * everything else, including the covariance factorization: the matrix is
+ * refactorized only when the covariance file's values actually changed, so
+ * edits to returns or constraints cost a re-parse of that file plus an
+ * O(n^2) solve. A file that fails to parse leaves the previous state in
+ * place.
+ *
+ * Example:
+ *   IncrementalInputs inputs("returns.csv", "cov.csv", "limits.json");
+ *   inputs.refresh();                                   // Load everything
+ *   auto status = inputs.refresh({"returns.csv"});      // Reuses the factorization
+ */
+class IncrementalInputs {
+public:
+    /**
+     * @brief What the last refresh() reloaded.
+     */
+    struct Refresh {
+        bool returns = false;       // Returns file re-parsed
+        bool covariance = false;    // Covariance file re-parsed
+        bool constraints = false;   // Constraints file re-parsed
+        bool refactorized = false;  // Covariance matrix factorized again
+
+        /**
+         * @brief Describe the refresh for progress messages.
+         */
+        std::string describe() const {
+            std::string files;
+            for (auto [flag, name] : {std::pair{returns, "returns"},
+                                      std::pair{covariance, "covariance"},
+                                      std::pair{constraints, "constraints"}}) {
+                if (flag) {
+                    files += (files.empty() ? "" : ", ") + std::string(name);
+                }
+            }
+            return "reloaded " + (files.empty() ? std::string("nothing") : files) + "; " +
+                   (refactorized ? "refactorized covariance" : "reused factorization");
+        }
+    };
+
+    /**
+     * @brief Describe the input files.
+     * @param returnsFile Returns (or market weights) CSV file
+     * @param covarianceFile Covariance matrix CSV file
+     * @param constraintsFile Constraints file ("" = long-only)
+     */
+    IncrementalInputs(std::string returnsFile, std::string covarianceFile,
+                      std::string constraintsFile = "")
+        : returnsFile_(std::move(returnsFile)), covarianceFile_(std::move(covarianceFile)),
+          constraintsFile_(std::move(constraintsFile)) {}
+
+    /**
+     * @brief Get the files to watch.
+     */
+    std::vector<std::string> files() const {
+        std::vector<std::string> result = {returnsFile_, covarianceFile_};
+        if (!constraintsFile_.empty()) {
+            result.push_back(constraintsFile_);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Load every input file.
+     * @return What was reloaded
+     * @throws std::exception if a file cannot be parsed or the inputs are inconsistent
+     */
+    Refresh refresh() { return refresh(files()); }
+
+    /**
+     * @brief Reload the given files.
+     *
+     * Files are committed one at a time, so when the asset universe changes
+     * across several files the inputs become consistent again once the last
+     * of them has been saved.
+     *
+     * @param changed Paths of the changed files
+     * @return What was reloaded
+     * @throws std::exception if a file cannot be parsed or the inputs are inconsistent
+     */
+    Refresh refresh(const std::vector<std::string>& changed) {
+        Refresh status;
+        auto has = [&](const std::string& path) {
+            for (const auto& file : changed) {
+                if (file == path) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        if (has(returnsFile_) || !returnsLoaded_) {
+            returns_ = FileParser::parseReturns(returnsFile_);
+            returnsLoaded_ = true;
+            status.returns = true;
+        }
+        if (has(covarianceFile_) || !factorization_) {
+            core::Matrix data = FileParser::parseCovarianceData(covarianceFile_);
+            status.covariance = true;
+            if (!factorization_ || !sameValues(data, covariance_.data())) {
+                optimizer::CovarianceMatrix covariance(std::move(data));
+                factorization_ = optimizer::CovarianceFactorization::create(covariance);
+                covariance_ = std::move(covariance);
+                status.refactorized = true;
+            }
+        }
+        // Constraints are keyed by the returns labels, so they follow returns changes
+        if (!constraintsFile_.empty() &&
+            (has(constraintsFile_) || status.returns || !constraintsLoaded_)) {
+            constraintsLoaded_ = false;  // Retried on every refresh until it loads
+            constraints_ = std::make_shared<optimizer::PackedConstraints>(
+                ConstraintsLoader::load(constraintsFile_, returns_.labels()));
+            constraintsLoaded_ = true;
+            status.constraints = true;
+        }
+
+        if (returns_.size() != covariance_.size()) {
+            throw std::invalid_argument("Returns have " + std::to_string(returns_.size()) +
+                                        " assets but the covariance matrix is " +
+                                        std::to_string(covariance_.size()) + "x" +
+                                        std::to_string(covariance_.size()));
+        }
+        return status;
+    }
+
+    /**
+     * @brief Get the returns (or market weights).
+     */
+    const optimizer::ExpectedReturns& returns() const { return returns_; }
+
+    /**
+     * @brief Get the covariance matrix.
+     */
+    const optimizer::CovarianceMatrix& covariance() const { return covariance_; }
+
+    /**
+     * @brief Get the cached covariance factorization.
+     */
+    std::shared_ptr<const optimizer::CovarianceFactorization> factorization() const {
+        return factorization_;
+    }
+
+    /**
+     * @brief Get the constraint set: the constraints file, or long-only.
+     */
+    optimizer::ConstraintSet constraints() const {
+        optimizer::ConstraintSet set;
+        if (constraints_) {
+            set.add(constraints_);
+        } else {
+            set.add(std::make_shared<optimizer::LongOnlyConstraint>());
+        }
+        return set;
+    }
+
+private:
+    std::string returnsFile_;
+    std::string covarianceFile_;
+    std::string constraintsFile_;
+    optimizer::ExpectedReturns returns_;
+    bool returnsLoaded_ = false;
+    optimizer::CovarianceMatrix covariance_;
+    std::shared_ptr<const optimizer::CovarianceFactorization> factorization_;
+    std::shared_ptr<optimizer::PackedConstraints> constraints_;
+    bool constraintsLoaded_ = false;
+
+    static bool sameValues(const core::Matrix& a, const core::Matrix& b) {
+        if (a.rows() != b.rows() || a.cols() != b.cols()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t j = 0; j < a.cols(); ++j) {
+                if (a(i, j) != b(i, j)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Runs a command again whenever its input files change (--watch).
+ *
+ * The first run loads every file; later runs reload only the changed
+ * files through IncrementalInputs. Errors are reported and the session
+ * keeps waiting for the next change. SIGINT/SIGTERM end the session.
+ */
+class WatchSession {
+public:
+    /**
+     * @brief Computes and prints one result from the current inputs.
+     */
+    using Step = std::function<void(const IncrementalInputs&)>;
+
+    /**
+     * @brief Run the watch loop until interrupted.
+     *
+     * @param inputs Inputs to watch and reload
+     * @param step Called after every successful refresh
+     * @param stop Optional external stop flag (signals are used otherwise)
+     * @return Exit code (0 after an interrupt)
+     */
+    static int run(IncrementalInputs& inputs, const Step& step,
+                   const std::atomic<bool>* stop = nullptr) {
+        if (stop == nullptr) {
+            installSignalHandlers();
+            stop = &stopFlag();
+        }
+
+        std::unique_ptr<FileWatcher> watcher;
+        try {
+            watcher = std::make_unique<FileWatcher>(inputs.files());
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Cannot watch input files" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            return static_cast<int>(ExitCode::VALIDATION_ERROR);
+        }
+
+        update(inputs, step, watcher->paths());
+        std::cerr << "Watching " << watcher->paths().size() << " files ("
+                  << (FileWatcher::usesInotify() ? "inotify" : "polling")
+                  << "); press Ctrl+C to stop" << std::endl;
+        while (!stop->load()) {
+            std::vector<size_t> changed = watcher->wait(stop);
+            if (changed.empty()) {
+                continue;
+            }
+            std::vector<std::string> paths;
+            for (size_t index : changed) {
+                paths.push_back(watcher->paths()[index]);
+            }
+            update(inputs, step, paths);
+        }
+        return static_cast<int>(ExitCode::SUCCESS);
+    }
+
+private:
+    static void update(IncrementalInputs& inputs, const Step& step,
+                       const std::vector<std::string>& changed) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            IncrementalInputs::Refresh status = inputs.refresh(changed);
+            step(inputs);
+            double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+            std::cerr << "Updated in " << ms << " ms (" << status.describe() << ")"
+                      << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Update failed" << std::endl;
+            std::cerr << "Details: " << e.what() << std::endl;
+            std::cerr << "Waiting for the next change..." << std::endl;
+        }
+    }
+
+    static std::atomic<bool>& stopFlag() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static void installSignalHandlers() {
+        stopFlag().store(false);
+        std::signal(SIGINT, [](int) { stopFlag().store(true); });
+        std::signal(SIGTERM, [](int) { stopFlag().store(true); });
+    }
+};
+
+}  // namespace cli
+}  // namespace orbat
@@ -0,0 +1,217 @@
+#include "cli/profiler.hpp"
+#include "orbat/core/allocation_tracker.hpp"
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// This test is built with ORBAT_ALLOCATION_TRACKING defined (see tests/CMakeLists.txt)
+
+using namespace orbat::core;
+using namespace orbat::optimizer;
+
+namespace {
+
+SyntheticProblem problem(size_t assets) {
+    SyntheticOptions options;
+    options.assets = assets;
+    return SyntheticProblem::generate(options);
+}
+
+AllocationStats vectors() {
+    return AllocationTracker::site(AllocationSite::VECTOR);
+}
+
+AllocationStats matrices() {
+    return AllocationTracker::site(AllocationSite::MATRIX);
+}
+
+// Allocations per call of an entry point since the last reset
+double perCall(const std::string& name) {
+    AllocationStats stats = AllocationTracker::entryPoint(name);
+    return stats.calls == 0 ? 0.0
+                            : static_cast<double>(stats.allocations) /
+                                  static_cast<double>(stats.calls);
+}
+
+}  // namespace
+
+// Test that container storage is counted once per heap block and released
+TEST(AllocationTrackerTest, CountsContainerStorage) {
+    ASSERT_TRUE(AllocationTracker::enabled());
+    AllocationTracker::reset();
+    const uint64_t live = vectors().liveBytes;
+    {
+        Vector v(10);
+        EXPECT_EQ(vectors().allocations, 1u);
+        EXPECT_EQ(vectors().bytes, 80u);
+        EXPECT_EQ(vectors().liveBytes, live + 80);
+
+        Vector copy = v;
+        Vector moved = std::move(copy);  // Moves transfer the block
+        moved = v;                       // Fits the existing block
+        EXPECT_EQ(vectors().allocations, 2u);
+        EXPECT_EQ(vectors().liveBytes, live + 160);
+    }
+    EXPECT_EQ(vectors().liveBytes, live);
+    EXPECT_EQ(vectors().peakBytes, live + 160);
+    EXPECT_EQ(vectors().allocations, 2u);
+}
+
+// Test that reallocating operations and adopted storage are counted per container kind
+TEST(AllocationTrackerTest, CountsResizeAndAdoption) {
+    AllocationTracker::reset();
+    Matrix m{{1.0, 2.0}, {3.0, 4.0}};
+    EXPECT_EQ(matrices().allocations, 1u);
+    m.resize(4, 4);
+    EXPECT_EQ(matrices().allocations, 2u);
+    EXPECT_EQ(matrices().bytes, 32u + 128u);
+
+    Vector adopted(std::vector<double>(5, 1.0));
+    Vector resized(2);
+    resized.resize(1);  // Shrinking keeps the block
+    EXPECT_EQ(vectors().allocations, 2u);
+    EXPECT_EQ(vectors().bytes, 40u + 16u);
+
+    AllocationTracker::reset();
+    EXPECT_EQ(matrices().allocations, 0u);
+    EXPECT_EQ(matrices().peakBytes, matrices().liveBytes);
+}
+
+// Test that a product written into an empty matrix is counted, and reuse is free
+TEST(AllocationTrackerTest, CountsMultiplyInto) {
+    Matrix a(100, 100, 1.0);
+    Matrix b(100, 100, 2.0);
+    Matrix result;
+    AllocationTracker::reset();
+    a.multiplyInto(b, result);
+    EXPECT_EQ(matrices().allocations, 1u);
+    EXPECT_EQ(matrices().bytes, 100u * 100u * sizeof(double));
+
+    a.multiplyInto(b, result);
+    EXPECT_EQ(matrices().allocations, 1u);
+    EXPECT_DOUBLE_EQ(result(0, 0), 200.0);
+}
+
+// Test that scopes are inclusive when nested and only see their own thread
+TEST(AllocationTrackerTest, ScopesNestAndStayOnThread) {
+    AllocationTracker::reset();
+    {
+        AllocationScope outer("outer");
+        Vector a(4);
+        {
+            AllocationScope inner("inner");
+            Vector b(8);
+        }
+        std::thread([] { Vector c(100); }).join();
+        Vector d(2);
+    }
+    AllocationStats outer = AllocationTracker::entryPoint("outer");
+    AllocationStats inner = AllocationTracker::entryPoint("inner");
+    EXPECT_EQ(outer.calls, 1u);
+    EXPECT_EQ(outer.allocations, 3u);
+    EXPECT_EQ(outer.bytes, 32u + 64u + 16u);
+    EXPECT_EQ(outer.peakBytes, 32u + 64u);
+    EXPECT_EQ(inner.allocations, 1u);
+    EXPECT_EQ(inner.peakBytes, 64u);
+    EXPECT_EQ(AllocationTracker::entryPoint("missing").calls, 0u);
+    EXPECT_EQ(AllocationTracker::entryPoints().size(), 2u);
+}
+
+// Allocation budgets of the hot paths. The per-call counts of the solves do
+// not grow with the number of assets; their peak is a few n-vectors.
+TEST(AllocationTrackerTest, MarkowitzBudgets) {
+    for (size_t n : {10u, 100u}) {
+        SyntheticProblem p = problem(n);
+        MarkowitzOptimizer optimizer(p.returns(), p.covariance());
+        optimizer.covarianceFactorization();  // Factorized on first use; budgets are per solve
+        const uint64_t vectorBytes = n * sizeof(double);
+        AllocationTracker::reset();
+
+        optimizer.minimumVariance();
+        optimizer.optimize(1.0);
+        optimizer.targetReturn(p.returns().data().sum() / static_cast<double>(n));
+        EXPECT_LE(perCall("MarkowitzOptimizer::minimumVariance"), 4) << n;
+        EXPECT_LE(perCall("MarkowitzOptimizer::optimize"), 7) << n;
+        EXPECT_LE(perCall("MarkowitzOptimizer::targetReturn"), 7) << n;
+        EXPECT_LE(AllocationTracker::entryPoint("MarkowitzOptimizer::minimumVariance").peakBytes,
+                  3 * vectorBytes);
+        EXPECT_LE(AllocationTracker::entryPoint("MarkowitzOptimizer::optimize").peakBytes,
+                  5 * vectorBytes);
+
+        AllocationTracker::reset();
+        optimizer.efficientFrontier(20);
+        EXPECT_LE(perCall("MarkowitzOptimizer::efficientFrontier"), 10 + 20 * 8) << n;
+        EXPECT_EQ(matrices().allocations, 0u) << n;  // The factorization is reused
+    }
+}
+
+TEST(AllocationTrackerTest, FrontierEngineBudgets) {
+    for (size_t n : {10u, 100u}) {
+        SyntheticProblem p = problem(n);
+        FrontierEngine engine(p.returns(), p.covariance());
+        FrontierOptions options;
+        options.points = 50;
+        options.threads = 1;
+        AllocationTracker::reset();
+
+        engine.compute(options);
+        engine.point(0.08);
+        EXPECT_LE(perCall("FrontierEngine::compute"), 6 * 50) << n;
+        EXPECT_LE(perCall("FrontierEngine::point"), 4) << n;
+        EXPECT_LE(AllocationTracker::entryPoint("FrontierEngine::point").peakBytes,
+                  3 * n * sizeof(double));
+    }
+}
+
+// Factorization and Black-Litterman allocate O(n) blocks (column-wise solves)
+TEST(AllocationTrackerTest, FactorizationAndBlackLittermanBudgets) {
+    for (size_t n : {10u, 100u}) {
+        SyntheticProblem p = problem(n);
+        AllocationTracker::reset();
+        CovarianceFactorization factorization(p.covariance());
+        AllocationStats stats = AllocationTracker::entryPoint("CovarianceFactorization");
+        EXPECT_LE(stats.allocations, 3 * n + 8) << n;
+        EXPECT_LE(stats.peakBytes, 4 * n * n * sizeof(double)) << n;
+
+        BlackLittermanOptimizer bl(p.marketWeights(), p.covariance(), 2.5);
+        for (const View& view : p.views(3)) {
+            bl.addView(view);
+        }
+        AllocationTracker::reset();
+        bl.optimize();
+        EXPECT_LE(perCall("BlackLittermanOptimizer::optimize"), 10 * n + 60) << n;
+        EXPECT_EQ(AllocationTracker::entryPoint("BlackLittermanOptimizer::computePosteriorReturns")
+                      .calls,
+                  1u);
+    }
+}
+
+// Test that --profile reports the tracked counters
+TEST(AllocationTrackerTest, ProfilerReportsTrackedCounters) {
+    SyntheticProblem p = problem(10);
+    AllocationTracker::reset();
+    MarkowitzOptimizer(p.returns(), p.covariance()).minimumVariance();
+
+    orbat::cli::Profiler profiler(true, orbat::cli::Profiler::Format::JSON);
+    std::ostringstream json;
+    profiler.write(json);
+    EXPECT_NE(json.str().find("\"tracked\":{\"containers\":{\"vector\":{\"calls\":0"),
+              std::string::npos);
+    EXPECT_NE(json.str().find("\"MarkowitzOptimizer::minimumVariance\":{\"calls\":1"),
+              std::string::npos);
+
+    std::ostringstream table;
+    profiler.writeTable(table);
+    EXPECT_NE(table.str().find("Tracked allocations"), std::string::npos);
+    EXPECT_NE(table.str().find("CovarianceFactorization"), std::string::npos);
+}
@@ -0,0 +1,323 @@
+#include "orbat/optimizer/backtest.hpp"
+
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::BacktestEngine;
+using orbat::optimizer::BacktestOptions;
+using orbat::optimizer::BacktestParameters;
+using orbat::optimizer::BacktestReport;
+using orbat::optimizer::BacktestStrategy;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MarkowitzResult;
+using orbat::optimizer::MonteCarloEngine;
+using orbat::optimizer::RollingEstimator;
+using orbat::optimizer::SimulationOptions;
+using orbat::test::testCovariance;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Daily returns of four correlated assets
+Matrix testHistory(size_t periods) {
+    ExpectedReturns mean(Vector({0.0003, 0.0005, 0.0004, 0.0002}));
+    CovarianceMatrix covariance(testCovariance().data() * (1.0 / 252.0));
+    SimulationOptions options;
+    options.scenarios = periods;
+    options.seed = 9;
+    options.threads = 1;
+    return MonteCarloEngine(mean, covariance).simulate(options);
+}
+
+// Two-pass sample mean and covariance of rows [begin, end)
+void directEstimate(const Matrix& history, size_t begin, size_t end, Vector& mean,
+                    Matrix& covariance) {
+    const size_t n = history.cols();
+    const double count = static_cast<double>(end - begin);
+    mean = Vector(n);
+    covariance = Matrix(n, n);
+    for (size_t r = begin; r < end; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            mean[i] += history(r, i) / count;
+        }
+    }
+    for (size_t r = begin; r < end; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                covariance(i, j) +=
+                    (history(r, i) - mean[i]) * (history(r, j) - mean[j]) / (count - 1.0);
+            }
+        }
+    }
+}
+
+void expectSameReports(const BacktestReport& a, const BacktestReport& b, double tolerance) {
+    EXPECT_EQ(a.name, b.name);
+    EXPECT_EQ(a.firstPeriod, b.firstPeriod);
+    ASSERT_EQ(a.returns.size(), b.returns.size());
+    for (size_t t = 0; t < a.returns.size(); ++t) {
+        EXPECT_NEAR(a.returns[t], b.returns[t], tolerance) << t;
+    }
+    ASSERT_EQ(a.rebalances.size(), b.rebalances.size());
+    for (size_t k = 0; k < a.rebalances.size(); ++k) {
+        EXPECT_EQ(a.rebalances[k].period, b.rebalances[k].period);
+        EXPECT_EQ(a.rebalances[k].traded, b.rebalances[k].traded);
+        EXPECT_NEAR(a.rebalances[k].turnover, b.rebalances[k].turnover, tolerance);
+        for (size_t i = 0; i < a.rebalances[k].weights.size(); ++i) {
+            EXPECT_NEAR(a.rebalances[k].weights[i], b.rebalances[k].weights[i], tolerance);
+        }
+    }
+    EXPECT_NEAR(a.totalTurnover, b.totalTurnover, tolerance);
+    EXPECT_NEAR(a.totalCost, b.totalCost, tolerance);
+    EXPECT_EQ(a.failedRebalances, b.failedRebalances);
+}
+
+std::vector<BacktestParameters> testParameterSets() {
+    std::vector<BacktestParameters> sets(4);
+    sets[0].name = "min-variance";
+    sets[0].window = 40;
+    sets[0].rebalanceInterval = 20;
+    sets[1].name = "mean-variance";
+    sets[1].window = 40;
+    sets[1].rebalanceInterval = 20;
+    sets[1].strategy = BacktestStrategy::MEAN_VARIANCE;
+    sets[1].riskAversion = 0.5;
+    sets[1].transactionCost = 0.001;
+    sets[2].name = "target";
+    sets[2].window = 60;
+    sets[2].rebalanceInterval = 10;
+    sets[2].strategy = BacktestStrategy::TARGET_RETURN;
+    sets[2].targetReturn = 0.0004;
+    sets[3].name = "shrunk, no-trade band";
+    sets[3].window = 40;
+    sets[3].rebalanceInterval = 20;
+    sets[3].shrinkage = 0.5;
+    sets[3].rebalanceThreshold = 10.0;
+    return sets;
+}
+
+}  // namespace
+
+// Test incremental windows against direct estimates, including resyncs and jumps
+TEST(BacktestTest, RollingEstimatorMatchesDirect) {
+    Matrix history = testHistory(600);
+    RollingEstimator estimator(history, 50);
+    EXPECT_THROW(estimator.mean(), std::logic_error);
+    EXPECT_THROW(estimator.advance(49), std::out_of_range);
+    EXPECT_THROW(estimator.advance(601), std::out_of_range);
+
+    std::vector<size_t> ends = {50, 51, 58, 100, 99, 180};
+    for (size_t end = 187; end <= 600; end += 7) {
+        ends.push_back(end);  // Slides past RESYNC_WINDOWS windows
+    }
+    for (size_t end : ends) {
+        estimator.advance(end);
+        EXPECT_EQ(estimator.end(), end);
+        Vector mean;
+        Matrix covariance;
+        directEstimate(history, end - 50, end, mean, covariance);
+        Vector estimatedMean = estimator.mean().data();
+        Matrix estimated = estimator.covariance().data();
+        Matrix shrunk = estimator.covariance(0.25).data();
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_NEAR(estimatedMean[i], mean[i], 1e-16) << end;
+            for (size_t j = 0; j < 4; ++j) {
+                EXPECT_NEAR(estimated(i, j), covariance(i, j), 1e-17) << end;
+                double factor = i == j ? 1.0 : 0.75;
+                EXPECT_NEAR(shrunk(i, j), factor * covariance(i, j), 1e-17) << end;
+            }
+        }
+    }
+    EXPECT_THROW(estimator.covariance(1.5), std::invalid_argument);
+}
+
+// Test the engine against a direct loop over the rebalances and periods
+TEST(BacktestTest, MatchesReferenceLoop) {
+    const size_t periods = 130;
+    Matrix history = testHistory(periods);
+    BacktestParameters parameters;
+    parameters.window = 40;
+    parameters.rebalanceInterval = 20;
+    parameters.transactionCost = 0.001;
+    BacktestReport report = BacktestEngine(history).run(parameters);
+
+    Vector holdings(4);
+    std::vector<double> returns;
+    double turnover = 0.0;
+    double cost = 0.0;
+    size_t rebalances = 0;
+    for (size_t t = 40; t < periods; ++t) {
+        double pendingCost = 0.0;
+        if ((t - 40) % 20 == 0) {
+            Vector mean;
+            Matrix covariance;
+            directEstimate(history, t - 40, t, mean, covariance);
+            MarkowitzResult target = MarkowitzOptimizer(ExpectedReturns(mean),
+                                                        CovarianceMatrix(covariance))
+                                         .minimumVariance();
+            ASSERT_TRUE(target.success());
+            double change = 0.0;
+            for (size_t i = 0; i < 4; ++i) {
+                change += std::abs(target.weights[i] - holdings[i]);
+            }
+            holdings = target.weights;
+            pendingCost = 0.001 * change;
+            turnover += change;
+            cost += pendingCost;
+            ++rebalances;
+        }
+        double gross = 0.0;
+        for (size_t i = 0; i < 4; ++i) {
+            gross += holdings[i] * history(t, i);
+        }
+        returns.push_back(gross - pendingCost);
+        for (size_t i = 0; i < 4; ++i) {
+            holdings[i] *= (1.0 + history(t, i)) / (1.0 + gross);
+        }
+    }
+
+    EXPECT_EQ(report.firstPeriod, 40u);
+    ASSERT_EQ(report.returns.size(), returns.size());
+    for (size_t t = 0; t < returns.size(); ++t) {
+        EXPECT_NEAR(report.returns[t], returns[t], 1e-12) << t;
+    }
+    ASSERT_EQ(report.rebalances.size(), rebalances);
+    EXPECT_EQ(report.rebalances[1].period, 60u);
+    EXPECT_TRUE(report.rebalances[1].traded);
+    EXPECT_NEAR(report.totalTurnover, turnover, 1e-10);
+    EXPECT_NEAR(report.totalCost, cost, 1e-13);
+    EXPECT_EQ(report.failedRebalances, 0u);
+
+    double wealth = 1.0;
+    for (double value : returns) {
+        wealth *= 1.0 + value;
+    }
+    EXPECT_NEAR(report.cumulativeReturn(), wealth - 1.0, 1e-12);
+    EXPECT_NEAR(report.averageTurnover(), turnover / static_cast<double>(rebalances), 1e-10);
+    EXPECT_GE(report.maxDrawdown(), 0.0);
+    EXPECT_EQ(report.statistics().count(), returns.size());
+}
+
+// Test that grouped, parallel runs match separate sequential ones
+TEST(BacktestTest, ParallelParameterSets) {
+    BacktestEngine engine(testHistory(300));
+    std::vector<BacktestParameters> sets = testParameterSets();
+    BacktestOptions sequential;
+    sequential.threads = 1;
+    BacktestOptions parallel;
+    parallel.threads = 4;
+    std::vector<BacktestReport> reports = engine.run(sets, parallel);
+    std::vector<BacktestReport> expected = engine.run(sets, sequential);
+    ASSERT_EQ(reports.size(), 4u);
+    for (size_t s = 0; s < sets.size(); ++s) {
+        expectSameReports(reports[s], expected[s], 0.0);
+        expectSameReports(reports[s], engine.run(sets[s], sequential), 0.0);
+    }
+    EXPECT_EQ(reports[2].firstPeriod, 60u);
+    // Windows whose mean returns cannot reach the target fail and keep the holdings
+    EXPECT_EQ(reports[2].rebalances.size() + reports[2].failedRebalances, 24u);
+    EXPECT_GT(reports[2].failedRebalances, 0u);
+    EXPECT_GT(reports[1].totalCost, 0.0);
+
+    // Only the first allocation is outside the no-trade band
+    const BacktestReport& banded = reports[3];
+    ASSERT_EQ(banded.rebalances.size(), 13u);
+    EXPECT_TRUE(banded.rebalances[0].traded);
+    EXPECT_NEAR(banded.totalTurnover, banded.rebalances[0].turnover, 1e-15);
+    for (size_t k = 1; k < banded.rebalances.size(); ++k) {
+        EXPECT_FALSE(banded.rebalances[k].traded) << k;
+        EXPECT_EQ(banded.rebalances[k].turnover, 0.0);
+    }
+}
+
+// Test resuming from checkpoints, extending the history, and mismatch detection
+TEST(BacktestTest, CheckpointResume) {
+    const std::string path =
+        (fs::temp_directory_path() / ("orbat_backtest_" + std::to_string(::getpid()) + ".ckpt"))
+            .string();
+    fs::remove(path);
+    Matrix history = testHistory(300);
+    std::vector<BacktestParameters> sets = testParameterSets();
+    std::vector<BacktestReport> expected = BacktestEngine(history).run(sets);
+
+    Matrix partial(170, 4);
+    for (size_t t = 0; t < 170; ++t) {
+        partial.setRow(t, history.getRow(t));
+    }
+    BacktestOptions options;
+    options.checkpointPath = path;
+    options.checkpointInterval = 2;
+    BacktestEngine(partial).run(sets, options);
+    ASSERT_TRUE(fs::exists(path));
+
+    std::vector<BacktestReport> resumed = BacktestEngine(history).run(sets, options);
+    for (size_t s = 0; s < sets.size(); ++s) {
+        expectSameReports(resumed[s], expected[s], 1e-12);
+    }
+
+    // Finished runs resume at the end
+    std::vector<BacktestReport> again = BacktestEngine(history).run(sets, options);
+    expectSameReports(again[1], resumed[1], 0.0);
+
+    std::vector<BacktestParameters> changed = sets;
+    changed[1].transactionCost = 0.002;
+    EXPECT_THROW(BacktestEngine(history).run(changed, options), std::runtime_error);
+    EXPECT_THROW(BacktestEngine(history).run(sets[0], options), std::runtime_error);
+    Matrix revised = history;
+    revised(5, 2) += 0.01;
+    EXPECT_THROW(BacktestEngine(revised).run(sets, options), std::runtime_error);
+
+    fs::resize_file(path, fs::file_size(path) - 3);
+    EXPECT_THROW(BacktestEngine(history).run(sets, options), std::runtime_error);
+    fs::remove(path);
+}
+
+// Test failed estimates and argument validation
+TEST(BacktestTest, FailuresAndValidation) {
+    Matrix history = testHistory(100);
+    for (size_t t = 0; t < 100; ++t) {
+        history(t, 3) = 0.0;  // No variance: Σ is not positive-definite
+    }
+    BacktestEngine engine(history);
+    BacktestParameters parameters;
+    parameters.window = 10;
+    parameters.rebalanceInterval = 9;
+    BacktestReport report = engine.run(parameters);
+    EXPECT_EQ(report.failedRebalances, 10u);
+    EXPECT_TRUE(report.rebalances.empty());
+    EXPECT_EQ(report.cumulativeReturn(), 0.0);
+    EXPECT_EQ(report.averageTurnover(), 0.0);
+
+    auto invalid = [&engine](auto change) {
+        BacktestParameters p;
+        p.window = 20;
+        change(p);
+        EXPECT_THROW(engine.run(p), std::invalid_argument);
+    };
+    invalid([](BacktestParameters& p) { p.window = 1; });
+    invalid([](BacktestParameters& p) { p.window = 100; });
+    invalid([](BacktestParameters& p) { p.rebalanceInterval = 0; });
+    invalid([](BacktestParameters& p) { p.shrinkage = 1.5; });
+    invalid([](BacktestParameters& p) { p.transactionCost = -0.001; });
+    EXPECT_THROW(engine.run(std::vector<BacktestParameters>{}), std::invalid_argument);
+    BacktestOptions options;
+    options.checkpointPath = "unused.ckpt";
+    options.checkpointInterval = 0;
+    parameters.window = 20;
+    EXPECT_THROW(engine.run(parameters, options), std::invalid_argument);
+    EXPECT_THROW(BacktestEngine{Matrix()}, std::invalid_argument);
+}
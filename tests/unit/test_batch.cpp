@@ -0,0 +1,246 @@
+#include "cli/arg_parser.hpp"
+#include "cli/batch_command.hpp"
+#include "cli/batch_runner.hpp"
+#include "cli/json_reader.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+using namespace orbat::cli;
+using orbat::optimizer::NdjsonResultSink;
+
+namespace {
+
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+std::string manifestLine(const std::string& id,
+                         const std::string& returns = "expected_returns.csv") {
+    return "{\"id\": \"" + id + "\", \"returns\": \"" + returns +
+           "\", \"covariance\": \"covariance.csv\"}\n";
+}
+
+}  // namespace
+
+// Test JSON values of every type
+TEST(JsonValueTest, ParsesAllTypes) {
+    JsonValue v = JsonValue::parse(R"({"s": "a\"b\u00e9", "n": -1.5e2, "t": true, "f": false,)"
+                                   R"( "z": null, "a": [1, [2]], "o": {}})");
+    ASSERT_TRUE(v.isObject());
+    EXPECT_EQ(v["s"].asString(), "a\"b\xC3\xA9");
+    EXPECT_DOUBLE_EQ(v["n"].asNumber(), -150.0);
+    EXPECT_TRUE(v["t"].asBool());
+    EXPECT_FALSE(v["f"].asBool());
+    EXPECT_TRUE(v["z"].isNull());
+    ASSERT_EQ(v["a"].asArray().size(), 2);
+    EXPECT_DOUBLE_EQ(v["a"].asArray()[1].asArray()[0].asNumber(), 2.0);
+    EXPECT_TRUE(v["o"].asObject().empty());
+    EXPECT_EQ(v.asObject().front().first, "s");  // Document order is kept
+}
+
+// Test defaults and type errors on member access
+TEST(JsonValueTest, MemberAccess) {
+    JsonValue v = JsonValue::parse(R"({"x": 1})");
+    EXPECT_TRUE(v.has("x"));
+    EXPECT_FALSE(v.has("y"));
+    EXPECT_DOUBLE_EQ(v.getNumber("y", 7.0), 7.0);
+    EXPECT_EQ(v.getString("y", "dflt"), "dflt");
+    EXPECT_THROW(v["y"], std::runtime_error);
+    EXPECT_THROW(v.getString("x", ""), std::runtime_error);
+}
+
+// Test malformed documents are rejected
+TEST(JsonValueTest, RejectsMalformed) {
+    for (const char* text : {"", "{", "[1,]", "{\"a\" 1}", "tru", "01", "1.", "\"abc", "{} x",
+                             "\"\\q\"", "{\"a\": 1,}"}) {
+        EXPECT_THROW(JsonValue::parse(text), std::runtime_error) << text;
+    }
+}
+
+// Test manifest parsing, defaults and path resolution
+TEST(BatchManifestTest, ParsesJobs) {
+    std::istringstream in("# comment\n"
+                          "\n" +
+                          manifestLine("a") +
+                          R"({"method": "bl", "returns": "/abs/w.csv", "covariance": "c.csv",)"
+                          R"( "tau": 0.05})"
+                          "\n");
+    auto jobs = BatchManifest::parse(in, "base");
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[0].id, "a");
+    EXPECT_EQ(jobs[0].line, 3);
+    EXPECT_EQ(jobs[0].method, "mpt");
+    EXPECT_EQ(jobs[0].objective, "min-variance");
+    EXPECT_EQ(jobs[0].returnsPath, "base/expected_returns.csv");
+    EXPECT_EQ(jobs[1].id, "4");  // Defaults to the line number
+    EXPECT_EQ(jobs[1].returnsPath, "/abs/w.csv");
+    EXPECT_DOUBLE_EQ(jobs[1].tau, 0.05);
+    EXPECT_DOUBLE_EQ(jobs[1].riskAversion, 2.5);
+}
+
+// Test manifest errors report the line number
+TEST(BatchManifestTest, ReportsLineNumber) {
+    std::istringstream bad(manifestLine("a") + R"({"returns": "r.csv"})" + "\n");
+    try {
+        BatchManifest::parse(bad);
+        FAIL() << "Expected std::runtime_error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 2"), std::string::npos);
+    }
+
+    std::istringstream unknownObjective(
+        R"({"returns": "r.csv", "covariance": "c.csv", "objective": "max-fun"})");
+    EXPECT_THROW(BatchManifest::parse(unknownObjective), std::runtime_error);
+
+    std::istringstream missingLambda(
+        R"({"returns": "r.csv", "covariance": "c.csv", "objective": "mean-variance"})");
+    EXPECT_THROW(BatchManifest::parse(missingLambda), std::runtime_error);
+
+    std::istringstream empty("# nothing\n");
+    EXPECT_THROW(BatchManifest::parse(empty), std::runtime_error);
+}
+
+// Test the cache loads each file once and shares the factorization
+TEST(BatchInputCacheTest, LoadsOnce) {
+    BatchInputCache cache;
+    auto a = cache.covariance("data/covariance.csv");
+    auto b = cache.covariance("data/covariance.csv");
+    EXPECT_EQ(a, b);
+    ASSERT_NE(a->factorization, nullptr);
+    EXPECT_EQ(a->factorization->size(), 3);
+    EXPECT_EQ(cache.covarianceCount(), 1);
+
+    EXPECT_THROW(cache.returns("data/no_such_file.csv"), std::runtime_error);
+    EXPECT_THROW(cache.returns("data/no_such_file.csv"), std::runtime_error);  // Cached error
+    EXPECT_EQ(cache.returnsCount(), 1);
+}
+
+// Test manifest order is preserved with many threads
+TEST(BatchRunnerTest, ManifestOrder) {
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += manifestLine("job-" + std::to_string(i));
+    }
+    std::istringstream in(text);
+    auto jobs = BatchManifest::parse(in, "data");
+
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    BatchRunner runner(4, BatchRunner::Order::MANIFEST);
+    BatchSummary summary = runner.run(jobs, sink);
+    sink.finish();
+
+    EXPECT_EQ(summary.jobs, 200);
+    EXPECT_EQ(summary.succeeded, 200);
+    EXPECT_EQ(summary.failed, 0);
+    EXPECT_EQ(runner.cache().covarianceCount(), 1);
+
+    auto lines = splitLines(out.str());
+    ASSERT_EQ(lines.size(), 200);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_NE(lines[i].find("\"id\":\"job-" + std::to_string(i) + "\""), std::string::npos);
+    }
+}
+
+// Test completion order emits every job once, and failures become records
+TEST(BatchRunnerTest, CompletionOrderAndFailures) {
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        std::string returns = i % 10 == 0 ? "missing.csv" : "expected_returns.csv";
+        text += manifestLine(std::to_string(i), returns);
+    }
+    std::istringstream in(text);
+    auto jobs = BatchManifest::parse(in, "data");
+
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    BatchRunner runner(3, BatchRunner::Order::COMPLETION);
+    BatchSummary summary = runner.run(jobs, sink);
+    sink.finish();
+
+    EXPECT_EQ(summary.failed, 5);
+    EXPECT_EQ(summary.succeeded, 45);
+    auto lines = splitLines(out.str());
+    ASSERT_EQ(lines.size(), 50);
+    size_t failures = 0;
+    for (const auto& line : lines) {
+        if (line.find("\"converged\":false") != std::string::npos) {
+            EXPECT_NE(line.find("Job failed: Cannot open returns file"), std::string::npos);
+            ++failures;
+        }
+    }
+    EXPECT_EQ(failures, 5);
+}
+
+// Test job results match the single-run optimizers
+TEST(BatchRunnerTest, RunJobMatchesDirectOptimization) {
+    BatchInputCache cache;
+    BatchJob job;
+    job.returnsPath = "data/expected_returns.csv";
+    job.covariancePath = "data/covariance.csv";
+    job.objective = "mean-variance";
+    job.lambda = 0.5;
+    job.longOnly = false;
+
+    auto batch = BatchRunner::runJob(job, cache);
+    orbat::optimizer::MarkowitzOptimizer direct(
+        FileParser::parseReturns(job.returnsPath), FileParser::parseCovariance(job.covariancePath));
+    auto expected = direct.optimize(0.5);
+    ASSERT_TRUE(batch.success());
+    for (size_t i = 0; i < expected.weights.size(); ++i) {
+        EXPECT_DOUBLE_EQ(batch.weights[i], expected.weights[i]);
+    }
+}
+
+// Test the batch command end to end
+TEST(BatchCommandTest, RunsManifestToFile) {
+    std::string outputFile = "/tmp/test_batch_output.ndjson";
+    char* argv[] = {
+        const_cast<char*>("orbat"),      const_cast<char*>("batch"),
+        const_cast<char*>("--manifest"), const_cast<char*>("data/batch_manifest.ndjson"),
+        const_cast<char*>("--threads"),  const_cast<char*>("2"),
+        const_cast<char*>("--output"),   const_cast<char*>(outputFile.c_str())};
+    ArgParser parser(8, argv);
+    ASSERT_EQ(BatchCommand::execute(parser), 0);
+
+    std::ifstream file(outputFile);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto lines = splitLines(content);
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_NE(lines[0].find("\"id\":\"minvar\""), std::string::npos);
+    EXPECT_NE(lines[3].find("\"id\":\"bl\""), std::string::npos);
+    std::remove(outputFile.c_str());
+}
+
+// Test argument validation exit codes
+TEST(BatchCommandTest, ArgumentErrors) {
+    char* noManifest[] = {const_cast<char*>("orbat"), const_cast<char*>("batch")};
+    EXPECT_EQ(BatchCommand::execute(ArgParser(2, noManifest)), 3);
+
+    char* badThreads[] = {const_cast<char*>("orbat"), const_cast<char*>("batch"),
+                          const_cast<char*>("--manifest"),
+                          const_cast<char*>("data/batch_manifest.ndjson"),
+                          const_cast<char*>("--threads"), const_cast<char*>("zero")};
+    EXPECT_EQ(BatchCommand::execute(ArgParser(6, badThreads)), 3);
+
+    char* badOrder[] = {const_cast<char*>("orbat"), const_cast<char*>("batch"),
+                        const_cast<char*>("--manifest"),
+                        const_cast<char*>("data/batch_manifest.ndjson"),
+                        const_cast<char*>("--order"), const_cast<char*>("random")};
+    EXPECT_EQ(BatchCommand::execute(ArgParser(6, badOrder)), 3);
+
+    char* missingManifest[] = {const_cast<char*>("orbat"), const_cast<char*>("batch"),
+                               const_cast<char*>("--manifest"),
+                               const_cast<char*>("data/no_such_manifest.ndjson")};
+    EXPECT_EQ(BatchCommand::execute(ArgParser(4, missingManifest)), 1);
+}
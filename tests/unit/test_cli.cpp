@@ -1,6 +1,18 @@
 #include "cli/arg_parser.hpp"
+#include "cli/bench_command.hpp"
 #include "cli/bl_command.hpp"
+#include "cli/constraints_loader.hpp"
+#include "cli/frontier_command.hpp"
+#include "cli/json_reader.hpp"
 #include "cli/mpt_command.hpp"
+#include "cli/profiler.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 using namespace orbat::cli;
@@ -236,3 +248,368 @@ TEST(BlCommandTest, DimensionMismatchExitCode) {
     int result = BlCommand::execute(parser);
     EXPECT_EQ(result, 1);
 }
+
+// Test output format selection
+TEST(MptCommandTest, InvalidOutputFormatExitCode) {
+    char* argv[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("mpt"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--format"),     const_cast<char*>("xml")};
+    ArgParser parser(8, argv);
+
+    // Should return INVALID_ARGUMENTS (3) for an unknown format
+    int result = MptCommand::execute(parser);
+    EXPECT_EQ(result, 3);
+}
+
+TEST(MptCommandTest, NdjsonOutputFile) {
+    std::string outputFile = "/tmp/test_cli_mpt_output.ndjson";
+    char* argv[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("mpt"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--output"),     const_cast<char*>(outputFile.c_str()),
+        const_cast<char*>("--format"),     const_cast<char*>("ndjson")};
+    ArgParser parser(10, argv);
+
+    ASSERT_EQ(MptCommand::execute(parser), 0);
+
+    std::ifstream file(outputFile);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_EQ(line.front(), '{');
+    EXPECT_NE(line.find("\"converged\":true"), std::string::npos);
+    EXPECT_FALSE(std::getline(file, line));  // Exactly one record
+    std::remove(outputFile.c_str());
+}
+
+TEST(BlCommandTest, BinaryOutputFile) {
+    std::string outputFile = "/tmp/test_cli_bl_output.bin";
+    char* argv[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("bl"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/market_weights.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--output"),     const_cast<char*>(outputFile.c_str()),
+        const_cast<char*>("--format"),     const_cast<char*>("binary")};
+    ArgParser parser(10, argv);
+
+    ASSERT_EQ(BlCommand::execute(parser), 0);
+
+    std::ifstream file(outputFile, std::ios::binary);
+    orbat::optimizer::BinaryResultReader reader(file);
+    orbat::optimizer::BinaryResultRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_TRUE(record.result.converged);
+    EXPECT_EQ(record.result.weights.size(), 3);
+    EXPECT_FALSE(reader.next(record));
+    std::remove(outputFile.c_str());
+}
+
+TEST(FrontierCommandTest, StreamsCsvToFile) {
+    std::string outputFile = "/tmp/test_cli_frontier_output.csv";
+    char* argv[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("frontier"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--points"),     const_cast<char*>("40"),
+        const_cast<char*>("--threads"),    const_cast<char*>("2"),
+        const_cast<char*>("--output"),     const_cast<char*>(outputFile.c_str())};
+    ArgParser parser(12, argv);
+
+    ASSERT_EQ(FrontierCommand::execute(parser), 0);
+
+    std::ifstream file(outputFile);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(file, line)) {
+        ++lines;
+    }
+    EXPECT_EQ(lines, 41);  // Header plus one row per point
+    std::remove(outputFile.c_str());
+}
+
+TEST(FrontierCommandTest, ArgumentErrors) {
+    char* missing[] = {const_cast<char*>("orbat"), const_cast<char*>("frontier"),
+                       const_cast<char*>("--returns"),
+                       const_cast<char*>("data/expected_returns.csv")};
+    EXPECT_EQ(FrontierCommand::execute(ArgParser(4, missing)), 3);
+
+    char* badPoints[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("frontier"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--points"),     const_cast<char*>("1")};
+    EXPECT_EQ(FrontierCommand::execute(ArgParser(8, badPoints)), 3);
+
+    char* badCovariance[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("frontier"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/invalid_non_pd_cov.csv")};
+    EXPECT_EQ(FrontierCommand::execute(ArgParser(6, badCovariance)), 1);
+}
+
+TEST(ProfilerTest, DisabledByDefault) {
+    char* argv[] = {const_cast<char*>("orbat"), const_cast<char*>("mpt")};
+    Profiler profiler = Profiler::fromParser(ArgParser(2, argv));
+    EXPECT_FALSE(profiler.enabled());
+    {
+        auto scope = profiler.phase("parse");
+    }
+    EXPECT_TRUE(profiler.phases().empty());
+}
+
+TEST(ProfilerTest, RecordsPhasesInOrder) {
+    Profiler profiler(true, Profiler::Format::JSON);
+    {
+        auto scope = profiler.phase("first");
+        std::vector<double> work(1000, 1.0);
+        EXPECT_EQ(work.size(), 1000);
+    }
+    auto scope = profiler.phase("second");
+    scope.stop();
+    scope.stop();  // Stopping twice records once
+
+    ASSERT_EQ(profiler.phases().size(), 2);
+    EXPECT_EQ(profiler.phases()[0].name, "first");
+    EXPECT_EQ(profiler.phases()[1].name, "second");
+    EXPECT_GE(profiler.phases()[0].wallSeconds, 0.0);
+    EXPECT_GT(profiler.phases()[0].peakRssBytes, 0u);
+
+    std::ostringstream json;
+    profiler.write(json);
+    EXPECT_EQ(json.str().rfind("{\"phases\":[{\"name\":\"first\"", 0), 0);
+    EXPECT_NE(json.str().find("\"total\":{\"name\":\"total\""), std::string::npos);
+    if (!orbat::core::AllocationTracker::enabled()) {
+        EXPECT_NE(json.str().find("\"tracked\":null}"), std::string::npos);
+    }
+
+    std::ostringstream table;
+    table << std::setprecision(4);
+    profiler.writeTable(table);
+    EXPECT_NE(table.str().find("second"), std::string::npos);
+    EXPECT_NE(table.str().find("total"), std::string::npos);
+    EXPECT_EQ(table.precision(), 4);  // The caller's format is restored
+    EXPECT_FALSE(table.flags() & std::ios::fixed);
+}
+
+TEST(ProfilerTest, ParsesFlags) {
+    char* argv[] = {const_cast<char*>("orbat"),    const_cast<char*>("mpt"),
+                    const_cast<char*>("--profile"), const_cast<char*>("json"),
+                    const_cast<char*>("--profile-output"),
+                    const_cast<char*>("/tmp/test_cli_profile.json")};
+    Profiler profiler = Profiler::fromParser(ArgParser(6, argv));
+    EXPECT_TRUE(profiler.enabled());
+    profiler.report();
+
+    std::ifstream file("/tmp/test_cli_profile.json");
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content.rfind("{\"phases\":[]", 0), 0);
+    std::remove("/tmp/test_cli_profile.json");
+}
+
+TEST(ProfilerTest, RejectsUnknownFormat) {
+    char* bare[] = {const_cast<char*>("orbat"), const_cast<char*>("mpt"),
+                    const_cast<char*>("--profile"), const_cast<char*>("--returns"),
+                    const_cast<char*>("r.csv")};
+    EXPECT_TRUE(Profiler::fromParser(ArgParser(5, bare)).enabled());
+
+    char* unknown[] = {const_cast<char*>("orbat"), const_cast<char*>("mpt"),
+                       const_cast<char*>("--profile"), const_cast<char*>("xml")};
+    EXPECT_THROW(Profiler::fromParser(ArgParser(4, unknown)), std::invalid_argument);
+
+    char* command[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("mpt"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--profile"),    const_cast<char*>("xml")};
+    EXPECT_EQ(MptCommand::execute(ArgParser(8, command)),
+              static_cast<int>(ExitCode::INVALID_ARGUMENTS));
+}
+
+TEST(MptCommandTest, ProfileReportsEveryPhase) {
+    std::string profileFile = "/tmp/test_cli_mpt_profile.json";
+    std::string outputFile = "/tmp/test_cli_mpt_profiled.json";
+    char* argv[] = {
+        const_cast<char*>("orbat"),        const_cast<char*>("mpt"),
+        const_cast<char*>("--returns"),    const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"), const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--output"),     const_cast<char*>(outputFile.c_str()),
+        const_cast<char*>("--profile"),    const_cast<char*>("json"),
+        const_cast<char*>("--profile-output"), const_cast<char*>(profileFile.c_str())};
+    ASSERT_EQ(MptCommand::execute(ArgParser(12, argv)), 0);
+
+    std::ifstream file(profileFile);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    for (const char* phase : {"parse returns", "parse covariance", "validate", "factorize",
+                              "optimize", "output"}) {
+        EXPECT_NE(content.find(std::string("\"") + phase + "\""), std::string::npos) << phase;
+    }
+    EXPECT_NE(content.find("\"allocations\":null"), std::string::npos);  // No hooks in tests
+    std::remove(profileFile.c_str());
+    std::remove(outputFile.c_str());
+}
+
+// Test that labelled returns files keep their labels
+TEST(FileParserTest, LabelledReturns) {
+    auto returns = FileParser::parseReturns("data/expected_returns_with_labels.csv");
+    ASSERT_EQ(returns.size(), 3u);
+    ASSERT_EQ(returns.labels().size(), 3u);
+    EXPECT_EQ(returns.labels()[2], "Stock C");
+    EXPECT_DOUBLE_EQ(returns[1], 0.12);
+    EXPECT_TRUE(FileParser::parseReturns("data/expected_returns.csv").labels().empty());
+}
+
+// Test that the JSON and CSV formats load the same packed constraints
+TEST(ConstraintsLoaderTest, JsonAndCsvAgree) {
+    std::vector<std::string> labels = {"Stock A", "Stock B", "Stock C"};
+    auto json = ConstraintsLoader::load("data/constraints.json", labels);
+    auto csv = ConstraintsLoader::load("data/constraints.csv", labels);
+
+    EXPECT_EQ(json.lowerBounds(), std::vector<double>({0.1, 0.0, 0.0}));
+    EXPECT_EQ(json.upperBounds(), std::vector<double>({0.6, 0.6, 0.4}));
+    ASSERT_EQ(json.sectorCount(), 1u);
+    EXPECT_DOUBLE_EQ(json.sectorUpper(0), 0.65);
+    EXPECT_EQ(json.sectors()[1], 0u);
+    EXPECT_EQ(json.sectors()[2], orbat::optimizer::PackedConstraints::NO_SECTOR);
+
+    EXPECT_EQ(csv.lowerBounds(), json.lowerBounds());
+    EXPECT_EQ(csv.upperBounds(), json.upperBounds());
+    EXPECT_EQ(csv.sectors(), json.sectors());
+    EXPECT_DOUBLE_EQ(csv.sectorUpper(0), json.sectorUpper(0));
+}
+
+// Test loader errors
+TEST(ConstraintsLoaderTest, Errors) {
+    std::vector<std::string> labels = {"A", "B"};
+    auto csv = [&](const std::string& text) {
+        std::istringstream in(text);
+        return ConstraintsLoader::parseCSV(in, labels);
+    };
+    EXPECT_NO_THROW(csv("asset,A,,0.5,\n"));
+    EXPECT_THROW(csv("asset,C,,0.5,\n"), std::invalid_argument);                  // Unknown label
+    EXPECT_THROW(csv("asset,A,,0.5,\nasset,A,,0.5,\n"), std::invalid_argument);  // Duplicate
+    EXPECT_THROW(csv("asset,A,,0.5,Tech\n"), std::invalid_argument);  // Undefined sector
+    EXPECT_THROW(csv("asset,A,0.6,0.5,\n"), std::invalid_argument);   // Inverted bounds
+    EXPECT_THROW(csv("default,,0.0,0.4,\n"), std::invalid_argument);  // Cannot sum to 1
+    EXPECT_THROW(csv("asset,A,x,0.5,\n"), std::runtime_error);        // Bad number
+    EXPECT_THROW(csv("limit,A,0.0,0.5,\n"), std::runtime_error);      // Bad kind
+    EXPECT_THROW(ConstraintsLoader::parseJSON(R"({"bounds": {}})", labels), std::runtime_error);
+    EXPECT_THROW(ConstraintsLoader::parseJSON("{}", {}), std::invalid_argument);  // No labels
+    EXPECT_THROW(ConstraintsLoader::load("data/missing.json", labels), std::runtime_error);
+}
+
+// Test mpt with a constraints file
+TEST(MptCommandTest, ConstraintsFile) {
+    std::string outputFile = "/tmp/test_cli_mpt_constrained.json";
+    const char* returnsFile = "data/expected_returns_with_labels.csv";
+    for (const char* constraintsFile : {"data/constraints.json", "data/constraints.csv"}) {
+        char* argv[] = {
+            const_cast<char*>("orbat"),         const_cast<char*>("mpt"),
+            const_cast<char*>("--returns"),     const_cast<char*>(returnsFile),
+            const_cast<char*>("--covariance"),  const_cast<char*>("data/covariance.csv"),
+            const_cast<char*>("--constraints"), const_cast<char*>(constraintsFile),
+            const_cast<char*>("--output"),      const_cast<char*>(outputFile.c_str())};
+        ASSERT_EQ(MptCommand::execute(ArgParser(10, argv)), 0) << constraintsFile;
+
+        std::ifstream file(outputFile);
+        std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+        JsonValue result = JsonValue::parse(content);
+        const auto& weights = result["weights"].asArray();
+        ASSERT_EQ(weights.size(), 3u);
+        double a = weights[0].asNumber();
+        double b = weights[1].asNumber();
+        double c = weights[2].asNumber();
+        EXPECT_GE(a, 0.1 - 1e-8);
+        EXPECT_LE(c, 0.4 + 1e-8);
+        EXPECT_LE(a + b, 0.65 + 1e-8);
+        EXPECT_NEAR(a + b + c, 1.0, 1e-8);
+    }
+    std::remove(outputFile.c_str());
+
+    // Unlabelled returns cannot be matched against the file
+    char* argv[] = {
+        const_cast<char*>("orbat"),         const_cast<char*>("mpt"),
+        const_cast<char*>("--returns"),     const_cast<char*>("data/expected_returns.csv"),
+        const_cast<char*>("--covariance"),  const_cast<char*>("data/covariance.csv"),
+        const_cast<char*>("--constraints"), const_cast<char*>("data/constraints.json")};
+    EXPECT_EQ(MptCommand::execute(ArgParser(8, argv)), 1);
+}
+
+TEST(BenchCommandTest, RunsEveryPath) {
+    BenchOptions options;
+    options.sizes = {8};
+    options.repetitions = 3;
+    options.warmup = 0;
+    options.threads = 1;
+    options.problem.factors = 20;  // Clamped below the problem size
+    auto results = BenchCommand::run(options);
+
+    ASSERT_EQ(results.size(), BenchCommand::pathNames().size());
+    for (const auto& result : results) {
+        EXPECT_EQ(result.assets, 8u);
+        EXPECT_EQ(result.repetitions, 3u);
+        EXPECT_EQ(result.failures, 0u) << result.path;
+        EXPECT_LE(result.latency.p50Us, result.latency.maxUs);
+        EXPECT_LE(result.latency.meanUs, result.latency.maxUs);
+        EXPECT_GT(result.throughput(), 0.0);
+    }
+
+    std::ostringstream out;
+    BenchCommand::writeJSON(out, options, results);
+    JsonValue report = JsonValue::parse(out.str());
+    EXPECT_EQ(report["results"].asArray().size(), results.size());
+    EXPECT_EQ(report["results"].asArray()[0]["path"].asString(), "factorize");
+    EXPECT_EQ(report["host"]["cpus"].asNumber(), std::thread::hardware_concurrency());
+}
+
+TEST(BenchCommandTest, LatencySummary) {
+    std::vector<double> micros;
+    for (int i = 100; i >= 1; --i) {
+        micros.push_back(static_cast<double>(i));
+    }
+    LatencySummary summary = LatencySummary::fromSamples(micros);
+    EXPECT_DOUBLE_EQ(summary.meanUs, 50.5);
+    EXPECT_DOUBLE_EQ(summary.p50Us, 50.0);
+    EXPECT_DOUBLE_EQ(summary.p90Us, 90.0);
+    EXPECT_DOUBLE_EQ(summary.p99Us, 99.0);
+    EXPECT_DOUBLE_EQ(summary.maxUs, 100.0);
+
+    LatencySummary single = LatencySummary::fromSamples({7.0});
+    EXPECT_DOUBLE_EQ(single.p50Us, 7.0);
+    EXPECT_DOUBLE_EQ(single.p99Us, 7.0);
+    EXPECT_DOUBLE_EQ(LatencySummary::fromSamples({}).maxUs, 0.0);
+}
+
+TEST(BenchCommandTest, OptionsAndErrors) {
+    std::string outputFile = "/tmp/test_cli_bench_output.json";
+    char* argv[] = {
+        const_cast<char*>("orbat"),         const_cast<char*>("bench"),
+        const_cast<char*>("--sizes"),       const_cast<char*>("4,6"),
+        const_cast<char*>("--paths"),       const_cast<char*>("mpt-min-variance,bl"),
+        const_cast<char*>("--repetitions"), const_cast<char*>("2"),
+        const_cast<char*>("--output"),      const_cast<char*>(outputFile.c_str())};
+    ASSERT_EQ(BenchCommand::execute(ArgParser(10, argv)), 0);
+    std::ifstream file(outputFile);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    JsonValue report = JsonValue::parse(buffer.str());
+    ASSERT_EQ(report["results"].asArray().size(), 4u);
+    EXPECT_EQ(report["results"].asArray()[3]["path"].asString(), "bl");
+    EXPECT_EQ(report["results"].asArray()[3]["assets"].asNumber(), 6.0);
+    std::remove(outputFile.c_str());
+
+    char* badPath[] = {const_cast<char*>("orbat"), const_cast<char*>("bench"),
+                       const_cast<char*>("--paths"), const_cast<char*>("simplex")};
+    EXPECT_EQ(BenchCommand::execute(ArgParser(4, badPath)), 3);
+
+    char* badSize[] = {const_cast<char*>("orbat"), const_cast<char*>("bench"),
+                       const_cast<char*>("--sizes"), const_cast<char*>("10,x")};
+    EXPECT_EQ(BenchCommand::execute(ArgParser(4, badSize)), 3);
+
+    char* badCondition[] = {const_cast<char*>("orbat"), const_cast<char*>("bench"),
+                            const_cast<char*>("--sizes"), const_cast<char*>("4"),
+                            const_cast<char*>("--condition"), const_cast<char*>("0.5")};
+    EXPECT_EQ(BenchCommand::execute(ArgParser(6, badCondition)), 1);
+}
@@ -0,0 +1,133 @@
+#include "orbat/optimizer/black_litterman.hpp"
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::BlackLittermanOptimizer;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::CovarianceFactorization;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::MarkowitzOptimizer;
+
+namespace {
+
+CovarianceMatrix sampleCovariance() {
+    return CovarianceMatrix({{0.04, 0.01, 0.005}, {0.01, 0.0225, 0.008}, {0.005, 0.008, 0.01}});
+}
+
+}  // namespace
+
+// Test the factors match the direct computations
+TEST(CovarianceFactorizationTest, MatchesDirectComputation) {
+    CovarianceMatrix cov = sampleCovariance();
+    CovarianceFactorization factor(cov);
+
+    EXPECT_EQ(factor.size(), 3);
+
+    Matrix L = factor.cholesky();
+    Matrix LLt = L * L.transpose();
+    Matrix inv = cov.data().inverse();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(LLt(i, j), cov(i, j), 1e-12);
+            EXPECT_DOUBLE_EQ(factor.inverse()(i, j), inv(i, j));
+        }
+    }
+
+    Vector expectedOnes = inv * Vector(3, 1.0);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_DOUBLE_EQ(factor.inverseOnes()[i], expectedOnes[i]);
+    }
+}
+
+// Test solve() returns x with Σx = b
+TEST(CovarianceFactorizationTest, Solve) {
+    CovarianceMatrix cov = sampleCovariance();
+    CovarianceFactorization factor(cov);
+    Vector b({0.08, 0.12, 0.10});
+
+    Vector x = factor.solve(b);
+    Vector Sx = cov.data() * x;
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(Sx[i], b[i], 1e-12);
+    }
+    EXPECT_THROW(factor.solve(Vector({1.0, 2.0})), std::invalid_argument);
+}
+
+// Test an empty covariance matrix is rejected
+TEST(CovarianceFactorizationTest, EmptyThrows) {
+    EXPECT_THROW(CovarianceFactorization factor{CovarianceMatrix()}, std::invalid_argument);
+}
+
+// Test optimizers sharing a factorization give the same results as private ones
+TEST(CovarianceFactorizationTest, SharedFactorizationMatchesOptimizer) {
+    CovarianceMatrix cov = sampleCovariance();
+    ExpectedReturns returns({0.08, 0.12, 0.10});
+    auto factor = CovarianceFactorization::create(cov);
+
+    MarkowitzOptimizer shared(returns, cov, ConstraintSet(), factor);
+    MarkowitzOptimizer own(returns, cov);
+    EXPECT_EQ(shared.covarianceFactorization(), factor);
+    ASSERT_NE(own.covarianceFactorization(), nullptr);
+
+    auto a = shared.optimize(0.5);
+    auto b = own.optimize(0.5);
+    ASSERT_TRUE(a.success());
+    ASSERT_TRUE(b.success());
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_DOUBLE_EQ(a.weights[i], b.weights[i]);
+    }
+    EXPECT_DOUBLE_EQ(shared.targetReturn(0.1).risk, own.targetReturn(0.1).risk);
+}
+
+// Test the factorization is deferred to the first solve and a failure is kept
+TEST(CovarianceFactorizationTest, OptimizerFactorizesOnFirstUse) {
+    CovarianceMatrix cov = sampleCovariance();
+    cov.data()(2, 2) = -0.01;  // Edited after validation: no longer positive-definite
+    MarkowitzOptimizer optimizer(ExpectedReturns({0.08, 0.12, 0.10}), cov);
+
+    auto first = optimizer.minimumVariance();
+    auto second = optimizer.optimize(0.5);
+    EXPECT_FALSE(first.success());
+    EXPECT_FALSE(second.success());
+    EXPECT_NE(first.message.find("not positive-definite"), std::string::npos) << first.message;
+    EXPECT_EQ(second.message, first.message);
+    EXPECT_EQ(optimizer.covarianceFactorization(), nullptr);
+}
+
+// Test mismatched or missing factorizations are rejected
+TEST(CovarianceFactorizationTest, OptimizerRejectsMismatch) {
+    CovarianceMatrix cov = sampleCovariance();
+    ExpectedReturns returns({0.08, 0.12, 0.10});
+    auto small = CovarianceFactorization::create(CovarianceMatrix({{0.04, 0.01}, {0.01, 0.09}}));
+
+    EXPECT_THROW(MarkowitzOptimizer(returns, cov, ConstraintSet(), small), std::invalid_argument);
+    EXPECT_THROW(MarkowitzOptimizer(returns, cov, ConstraintSet(), nullptr),
+                 std::invalid_argument);
+
+    BlackLittermanOptimizer bl(Vector({0.5, 0.3, 0.2}), cov, 2.5);
+    EXPECT_THROW(bl.setCovarianceFactorization(small), std::invalid_argument);
+}
+
+// Test Black-Litterman results are unchanged by a shared factorization
+TEST(CovarianceFactorizationTest, BlackLittermanSharedFactorization) {
+    CovarianceMatrix cov = sampleCovariance();
+    Vector weights({0.5, 0.3, 0.2});
+
+    BlackLittermanOptimizer plain(weights, cov, 2.5);
+    BlackLittermanOptimizer shared(weights, cov, 2.5);
+    shared.setCovarianceFactorization(CovarianceFactorization::create(cov));
+
+    auto a = plain.optimize();
+    auto b = shared.optimize();
+    ASSERT_TRUE(b.success());
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(a.weights[i], b.weights[i], 1e-10);
+    }
+}
@@ -0,0 +1,154 @@
+#include "orbat/optimizer/frontier_engine.hpp"
+
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Vector;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::CovarianceFactorization;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::FrontierEngine;
+using orbat::optimizer::FrontierOptions;
+using orbat::optimizer::LongOnlyConstraint;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MarkowitzResult;
+using orbat::test::testCovariance;
+using orbat::test::testReturns;
+
+namespace {
+
+FrontierOptions fixedGrid(size_t points, size_t threads, size_t chunkSize = 256) {
+    FrontierOptions options;
+    options.points = points;
+    options.threads = threads;
+    options.chunkSize = chunkSize;
+    return options;
+}
+
+}  // namespace
+
+// Test that the closed-form frontier matches the optimizer's frontier
+TEST(FrontierEngineTest, MatchesEfficientFrontier) {
+    MarkowitzOptimizer optimizer(testReturns(), testCovariance());
+    FrontierEngine engine(testReturns(), testCovariance());
+
+    auto expected = optimizer.efficientFrontier(25);
+    auto actual = engine.compute(fixedGrid(25, 1));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual[i].expectedReturn, expected[i].expectedReturn, 1e-12);
+        EXPECT_NEAR(actual[i].risk, expected[i].risk, 1e-10);
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_NEAR(actual[i].weights[j], expected[i].weights[j], 1e-10);
+        }
+    }
+}
+
+// Test that parallel runs emit the same points, in order, as serial runs
+TEST(FrontierEngineTest, ParallelMatchesSerial) {
+    FrontierEngine engine(testReturns(), testCovariance());
+    auto serial = engine.compute(fixedGrid(1001, 1));
+    auto parallel = engine.compute(fixedGrid(1001, 4, 16));
+
+    ASSERT_EQ(parallel.size(), 1001u);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].expectedReturn, serial[i].expectedReturn);
+        EXPECT_EQ(parallel[i].risk, serial[i].risk);
+    }
+}
+
+// Test that points are streamed with consecutive indices
+TEST(FrontierEngineTest, StreamsIndicesInOrder) {
+    FrontierEngine engine(testReturns(), testCovariance());
+    size_t expectedIndex = 0;
+    double lastReturn = -1.0;
+    size_t count = engine.compute(fixedGrid(500, 3, 7),
+                                  [&](size_t index, const MarkowitzResult& result) {
+                                      EXPECT_EQ(index, expectedIndex++);
+                                      EXPECT_GT(result.expectedReturn, lastReturn);
+                                      lastReturn = result.expectedReturn;
+                                  });
+    EXPECT_EQ(count, 500u);
+}
+
+// Test streaming into a result sink
+TEST(FrontierEngineTest, WritesToSink) {
+    FrontierEngine engine(testReturns(), testCovariance());
+    std::ostringstream out;
+    orbat::optimizer::SinkOptions options;
+    options.includeIds = true;
+    auto sink = orbat::optimizer::makeResultSink(orbat::optimizer::OutputFormat::NDJSON, out,
+                                                 options);
+    EXPECT_EQ(engine.compute(fixedGrid(10, 2, 3), *sink), 10u);
+    sink->finish();
+
+    std::string text = out.str();
+    EXPECT_NE(text.find("\"id\":\"0\""), std::string::npos);
+    EXPECT_NE(text.find("\"id\":\"9\""), std::string::npos);
+}
+
+// Test that adaptive refinement meets the tolerance
+TEST(FrontierEngineTest, AdaptiveRefinement) {
+    FrontierEngine engine(testReturns(), testCovariance());
+    FrontierOptions options;
+    options.points = 3;
+    options.tolerance = 1e-5;
+    options.threads = 2;
+    auto frontier = engine.compute(options);
+
+    ASSERT_GT(frontier.size(), 3u);
+    auto [low, high] = engine.returnRange();
+    EXPECT_NEAR(frontier.front().expectedReturn, low, 1e-12);
+    EXPECT_NEAR(frontier.back().expectedReturn, high, 1e-12);
+    for (size_t i = 1; i < frontier.size(); ++i) {
+        ASSERT_GT(frontier[i].expectedReturn, frontier[i - 1].expectedReturn);
+        // The frontier midway between neighbours is within tolerance of the chord
+        double mid = 0.5 * (frontier[i].expectedReturn + frontier[i - 1].expectedReturn);
+        double chord = 0.5 * (frontier[i].risk + frontier[i - 1].risk);
+        EXPECT_LE(chord - engine.point(mid).risk, options.tolerance + 1e-12);
+    }
+
+    // A tighter tolerance needs more points
+    options.tolerance = 1e-7;
+    EXPECT_GT(engine.compute(options).size(), frontier.size());
+}
+
+// Test constrained points fall back to the optimizer
+TEST(FrontierEngineTest, LongOnlyMatchesOptimizer) {
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<LongOnlyConstraint>());
+    MarkowitzOptimizer optimizer(testReturns(), testCovariance(), constraints);
+    FrontierEngine engine(testReturns(), testCovariance(), constraints);
+
+    auto expected = optimizer.efficientFrontier(20);
+    auto actual = engine.compute(fixedGrid(20, 2, 4));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual[i].risk, expected[i].risk, 1e-10);
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_GE(actual[i].weights[j], -1e-12);
+        }
+    }
+}
+
+// Test sharing a factorization and validation errors
+TEST(FrontierEngineTest, SharedFactorizationAndValidation) {
+    auto factorization = CovarianceFactorization::create(testCovariance());
+    FrontierEngine engine(testReturns(), testCovariance(), ConstraintSet(), factorization);
+    EXPECT_EQ(engine.size(), 4u);
+
+    FrontierOptions onePoint;
+    onePoint.points = 1;
+    EXPECT_THROW(engine.compute(onePoint), std::invalid_argument);
+    FrontierOptions negative;
+    negative.tolerance = -1.0;
+    EXPECT_THROW(engine.compute(negative), std::invalid_argument);
+
+    ExpectedReturns twoAssets(Vector({0.1, 0.2}));
+    EXPECT_THROW(FrontierEngine(twoAssets, testCovariance()), std::invalid_argument);
+}
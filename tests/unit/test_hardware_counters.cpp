@@ -0,0 +1,129 @@
+#include "cli/hardware_counters.hpp"
+#include "cli/profiler.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace orbat::cli;
+
+// These tests pass whether or not the machine grants hardware counters; most
+// virtual machines and containers do not.
+
+namespace {
+
+double work(size_t n) {
+    std::vector<double> values(n, 1.5);
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v * v;
+    }
+    return sum;
+}
+
+}  // namespace
+
+// Test that every event is either counted or explained
+TEST(HardwareCountersTest, CountsOrExplains) {
+    HardwareCounters counters;
+    HardwareCounts start = counters.read();
+    EXPECT_GT(work(100000), 0.0);
+    HardwareCounts used = counters.read() - start;
+
+    bool allCounted = true;
+    for (size_t i = 0; i < HARDWARE_EVENT_COUNT; ++i) {
+        auto event = static_cast<HardwareEvent>(i);
+        EXPECT_EQ(counters.available(event), used[event].has_value())
+            << HardwareCounters::eventName(event);
+        if (used[event]) {
+            EXPECT_GE(*used[event], 0.0) << HardwareCounters::eventName(event);
+        }
+        allCounted = allCounted && counters.available(event);
+    }
+    EXPECT_EQ(allCounted, counters.status().empty()) << counters.status();
+    if (counters.available(HardwareEvent::INSTRUCTIONS)) {
+        EXPECT_GT(*used[HardwareEvent::INSTRUCTIONS], 100000.0);
+    }
+}
+
+// Test that counters survive a move and include joined threads
+TEST(HardwareCountersTest, MovesAndIncludesChildThreads) {
+    HardwareCounters original;
+    const bool available = original.available();
+    HardwareCounters counters = std::move(original);
+    EXPECT_FALSE(original.available());
+    EXPECT_EQ(counters.available(), available);
+
+    HardwareCounts start = counters.read();
+    std::thread([] { EXPECT_GT(work(200000), 0.0); }).join();
+    HardwareCounts used = counters.read() - start;
+    if (counters.available(HardwareEvent::INSTRUCTIONS)) {
+        EXPECT_GT(*used[HardwareEvent::INSTRUCTIONS], 200000.0);
+    }
+}
+
+TEST(HardwareCountersTest, DifferenceAndIpc) {
+    HardwareCounts start;
+    HardwareCounts end;
+    end.values[0] = 200.0;  // Cycles
+    end.values[1] = 500.0;  // Instructions
+    start.values[0] = 100.0;
+    HardwareCounts delta = end - start;
+    EXPECT_DOUBLE_EQ(*delta[HardwareEvent::CYCLES], 100.0);
+    EXPECT_FALSE(delta[HardwareEvent::INSTRUCTIONS].has_value());  // Missing at start
+    EXPECT_FALSE(delta.ipc().has_value());
+
+    start.values[1] = 100.0;
+    EXPECT_DOUBLE_EQ(*(end - start).ipc(), 4.0);
+}
+
+// Test that --profile-counters adds the counters to both report formats
+TEST(HardwareCountersTest, ProfilerReportsCounters) {
+    char* argv[] = {const_cast<char*>("orbat"), const_cast<char*>("mpt"),
+                    const_cast<char*>("--profile-counters")};
+    Profiler profiler = Profiler::fromParser(ArgParser(3, argv));
+    ASSERT_TRUE(profiler.enabled());
+    ASSERT_NE(profiler.hardwareCounters(), nullptr);
+    {
+        auto scope = profiler.phase("work");
+        EXPECT_GT(work(10000), 0.0);
+    }
+    ASSERT_EQ(profiler.phases().size(), 1u);
+    const HardwareCounters& counters = *profiler.hardwareCounters();
+    EXPECT_EQ(profiler.phases()[0].counters[HardwareEvent::CYCLES].has_value(),
+              counters.available(HardwareEvent::CYCLES));
+
+    std::ostringstream table;
+    profiler.writeTable(table);
+    EXPECT_NE(table.str().find("=== Hardware counters ==="), std::string::npos);
+    EXPECT_NE(table.str().find(counters.status()), std::string::npos);
+    if (!counters.available()) {
+        EXPECT_NE(table.str().find("n/a"), std::string::npos);
+    }
+
+    std::ostringstream json;
+    profiler.writeJSON(json);
+    EXPECT_NE(json.str().find("\"counters\":{\"cycles\":"), std::string::npos);
+    EXPECT_NE(json.str().find("\"countersStatus\":\"" + counters.status() + "\""),
+              std::string::npos);
+}
+
+TEST(HardwareCountersTest, ProfilerWithoutCounters) {
+    Profiler profiler(true, Profiler::Format::JSON);
+    EXPECT_EQ(profiler.hardwareCounters(), nullptr);
+    {
+        auto scope = profiler.phase("work");
+    }
+    EXPECT_FALSE(profiler.phases()[0].counters[HardwareEvent::CYCLES].has_value());
+    std::ostringstream json;
+    profiler.writeJSON(json);
+    EXPECT_NE(json.str().find("\"counters\":null"), std::string::npos);
+    EXPECT_NE(json.str().find("\"countersStatus\":null"), std::string::npos);
+
+    std::ostringstream table;
+    profiler.writeTable(table);
+    EXPECT_EQ(table.str().find("Hardware counters"), std::string::npos);
+}
@@ -203,6 +203,30 @@ TEST(MatrixTest, MatrixMultiplicationIncompatible) {
     EXPECT_THROW(A * B, std::invalid_argument);
 }
 
+// Test multiplication into a reused matrix of a different shape
+TEST(MatrixTest, MultiplyInto) {
+    Matrix A({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+    Matrix B({{7.0, 8.0}, {9.0, 10.0}, {11.0, 12.0}});
+    Matrix C(5, 5, 1.0);
+    A.multiplyInto(B, C);
+
+    EXPECT_EQ(C.rows(), 2);
+    EXPECT_EQ(C.cols(), 2);
+    EXPECT_DOUBLE_EQ(C(0, 0), 58.0);
+    EXPECT_DOUBLE_EQ(C(0, 1), 64.0);
+    EXPECT_DOUBLE_EQ(C(1, 0), 139.0);
+    EXPECT_DOUBLE_EQ(C(1, 1), 154.0);
+    EXPECT_THROW(B.multiplyInto(B, C), std::invalid_argument);
+
+    // The result is cleared before the operands are read, so aliasing is rejected
+    Matrix S({{1.0, 2.0}, {3.0, 4.0}});
+    Matrix T = S;
+    EXPECT_THROW(S.multiplyInto(T, S), std::invalid_argument);
+    EXPECT_THROW(T.multiplyInto(S, S), std::invalid_argument);
+    EXPECT_THROW(S.multiplyInto(S, S), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(S(1, 1), 4.0);
+}
+
 // Test matrix-vector multiplication
 TEST(MatrixTest, MatrixVectorMultiplication) {
     Matrix A({{1.0, 2.0}, {3.0, 4.0}});
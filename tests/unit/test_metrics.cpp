@@ -0,0 +1,159 @@
+#include "orbat/core/metrics.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::LatencyHistogram;
+using orbat::core::MetricsRegistry;
+
+namespace {
+
+std::string exposition(const MetricsRegistry& registry) {
+    std::ostringstream text;
+    registry.writePrometheus(text);
+    return text.str();
+}
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line) != std::string::npos;
+}
+
+}  // namespace
+
+// Test that every bucket's upper bound maps back to it and values stay within 1/32
+TEST(LatencyHistogramTest, BucketResolution) {
+    for (size_t i = 0; i + 1 < LatencyHistogram::BUCKETS; ++i) {
+        uint64_t upper = LatencyHistogram::bucketUpper(i);
+        EXPECT_EQ(LatencyHistogram::bucketIndex(upper), i);
+        EXPECT_EQ(LatencyHistogram::bucketIndex(upper + 1), i + 1);
+    }
+    for (uint64_t value : {uint64_t{0}, uint64_t{63}, uint64_t{64}, uint64_t{1000},
+                           uint64_t{123456789}, ~uint64_t{0}}) {
+        size_t index = LatencyHistogram::bucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::BUCKETS);
+        uint64_t upper = LatencyHistogram::bucketUpper(index);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(static_cast<double>(upper - value), static_cast<double>(value) / 32.0);
+    }
+}
+
+// Test quantiles, sum and max against a uniform sample
+TEST(LatencyHistogramTest, Quantiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.quantile(0.5), 0.0);
+    for (uint64_t micros = 1; micros <= 1000; ++micros) {
+        histogram.record(micros * 1000);
+    }
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.sum(), 500500u * 1000u);
+    EXPECT_EQ(histogram.max(), 1000000u);
+    EXPECT_NEAR(histogram.quantile(0.5), 500000.0, 500000.0 / 32.0);
+    EXPECT_NEAR(histogram.quantile(0.99), 990000.0, 990000.0 / 32.0);
+    EXPECT_EQ(histogram.quantile(1.0), 1000000.0);
+    // Only whole buckets count, so values within 1/32 below the limit may be left out
+    EXPECT_LE(histogram.countAtOrBelow(100000), 100u);
+    EXPECT_GE(histogram.countAtOrBelow(100000), 97u);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.max(), 0u);
+}
+
+// Test that concurrent recording loses no samples
+TEST(LatencyHistogramTest, ConcurrentRecording) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                histogram.record(i * (t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(histogram.count(), 40000u);
+    EXPECT_EQ(histogram.max(), 9999u * 4u);
+}
+
+// Test registration, label formatting and the exposition format
+TEST(MetricsRegistryTest, Exposition) {
+    MetricsRegistry registry;
+    auto& ok = registry.counter("jobs_total", "Jobs run", {{"status", "ok"}});
+    ok.add(3);
+    EXPECT_EQ(&registry.counter("jobs_total", "Jobs run", {{"status", "ok"}}), &ok);
+    registry.counter("jobs_total", "Jobs run", {{"status", "a\"b"}}).add();
+    registry.gauge("depth", "Queue depth").set(2.5);
+    auto& latency = registry.histogram("call_seconds", "Call time", {{"fn", "f"}});
+    latency.record(2000);      // 2 µs
+    latency.record(40000000);  // 40 ms
+
+    std::string text = exposition(registry);
+    EXPECT_TRUE(contains(text, "# HELP jobs_total Jobs run\n# TYPE jobs_total counter\n"));
+    EXPECT_TRUE(contains(text, "jobs_total{status=\"ok\"} 3\n"));
+    EXPECT_TRUE(contains(text, "jobs_total{status=\"a\\\"b\"} 1\n"));
+    EXPECT_TRUE(contains(text, "# TYPE depth gauge\ndepth 2.5\n"));
+    EXPECT_TRUE(contains(text, "# TYPE call_seconds histogram\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_bucket{fn=\"f\",le=\"1e-06\"} 0\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_bucket{fn=\"f\",le=\"2.5e-06\"} 1\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_bucket{fn=\"f\",le=\"0.05\"} 2\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_bucket{fn=\"f\",le=\"+Inf\"} 2\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_count{fn=\"f\"} 2\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_max{fn=\"f\"} 0.04\n"));
+    EXPECT_TRUE(contains(text, "call_seconds_quantile{fn=\"f\",quantile=\"0.999\"} 0.04\n"));
+
+    registry.reset();
+    EXPECT_EQ(ok.value(), 0u);
+    EXPECT_EQ(latency.count(), 0u);
+
+    EXPECT_THROW(registry.gauge("jobs_total", "Jobs run"), std::invalid_argument);
+    EXPECT_THROW(registry.counter("bad name", "x"), std::invalid_argument);
+    EXPECT_THROW(registry.counter("x", "x", {{"1label", "v"}}), std::invalid_argument);
+}
+
+// Test the atomic file export
+TEST(MetricsRegistryTest, WriteFile) {
+    MetricsRegistry registry;
+    registry.counter("written_total", "Writes").add();
+    std::string path = "/tmp/test_metrics.prom";
+    registry.writePrometheus(path);
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_EQ(contents.str(), exposition(registry));
+    std::remove(path.c_str());
+    EXPECT_THROW(registry.writePrometheus("/nonexistent-dir/metrics.prom"), std::runtime_error);
+}
+
+// Test that the optimizer entry points record into the global registry
+TEST(MetricsRegistryTest, EntryPointLatency) {
+#ifdef ORBAT_DISABLE_METRICS
+    GTEST_SKIP() << "Metrics compiled out (ORBAT_METRICS=OFF)";
+#endif
+    orbat::optimizer::SyntheticOptions options;
+    options.assets = 5;
+    options.factors = 2;
+    auto problem = orbat::optimizer::SyntheticProblem::generate(options);
+    orbat::optimizer::MarkowitzOptimizer optimizer(problem.returns(), problem.covariance());
+
+    auto& histogram = MetricsRegistry::global().histogram(
+        "orbat_entry_point_duration_seconds", "Time spent in optimizer entry points",
+        {{"entry_point", "MarkowitzOptimizer::minimumVariance"}});
+    uint64_t before = histogram.count();
+    optimizer.minimumVariance();
+    optimizer.minimumVariance();
+    EXPECT_EQ(histogram.count(), before + 2);
+    EXPECT_TRUE(contains(exposition(MetricsRegistry::global()),
+                         "orbat_entry_point_duration_seconds_count{entry_point="
+                         "\"MarkowitzOptimizer::minimumVariance\"}"));
+}
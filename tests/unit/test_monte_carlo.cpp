@@ -0,0 +1,210 @@
+#include "orbat/optimizer/monte_carlo.hpp"
+
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::CovarianceFactorization;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::MonteCarloEngine;
+using orbat::optimizer::PnLStatistics;
+using orbat::optimizer::ScenarioDistribution;
+using orbat::optimizer::ScenarioSampling;
+using orbat::optimizer::SimulationOptions;
+using orbat::test::testCovariance;
+using orbat::test::testReturns;
+
+namespace {
+
+SimulationOptions simulation(size_t scenarios, size_t threads,
+                             ScenarioDistribution distribution = ScenarioDistribution::NORMAL) {
+    SimulationOptions options;
+    options.scenarios = scenarios;
+    options.threads = threads;
+    options.distribution = distribution;
+    return options;
+}
+
+// Sample mean and covariance of scenarios (one per row)
+void expectMoments(const Matrix& scenarios, double meanTolerance, double covTolerance) {
+    const Vector mu = testReturns().data();
+    const Matrix sigma = testCovariance().data();
+    const size_t n = scenarios.cols();
+    const double count = static_cast<double>(scenarios.rows());
+    std::vector<double> mean(n, 0.0);
+    for (size_t s = 0; s < scenarios.rows(); ++s) {
+        for (size_t i = 0; i < n; ++i) {
+            mean[i] += scenarios(s, i) / count;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(mean[i], mu[i], meanTolerance);
+        for (size_t j = 0; j < n; ++j) {
+            double cov = 0.0;
+            for (size_t s = 0; s < scenarios.rows(); ++s) {
+                cov += (scenarios(s, i) - mean[i]) * (scenarios(s, j) - mean[j]);
+            }
+            EXPECT_NEAR(cov / (count - 1.0), sigma(i, j), covTolerance) << i << "," << j;
+        }
+    }
+}
+
+}  // namespace
+
+// Test that normal scenarios reproduce μ and Σ
+TEST(MonteCarloEngineTest, NormalMoments) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    Matrix scenarios = engine.simulate(simulation(200000, 1));
+    ASSERT_EQ(scenarios.rows(), 200000u);
+    ASSERT_EQ(scenarios.cols(), 4u);
+    expectMoments(scenarios, 0.003, 0.001);
+}
+
+// Test that Student-t scenarios are scaled to covariance Σ
+TEST(MonteCarloEngineTest, StudentTMoments) {
+    auto factor = CovarianceFactorization::create(testCovariance());
+    MonteCarloEngine engine(testReturns(), testCovariance(), factor);
+    SimulationOptions options = simulation(200000, 1, ScenarioDistribution::STUDENT_T);
+    options.degreesOfFreedom = 8.0;
+    expectMoments(engine.simulate(options), 0.003, 0.002);
+}
+
+// Test that scenarios and statistics do not depend on the thread count
+TEST(MonteCarloEngineTest, ReproducibleAcrossThreads) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    SimulationOptions options = simulation(1050, 1, ScenarioDistribution::STUDENT_T);
+    options.blockSize = 100;
+    Matrix sequential = engine.simulate(options);
+    options.threads = 3;
+    Matrix parallel = engine.simulate(options);
+    EXPECT_EQ(sequential.data(), parallel.data());
+
+    Vector weights({0.25, 0.25, 0.25, 0.25});
+    PnLStatistics a = engine.evaluate(weights, options);
+    options.threads = 1;
+    PnLStatistics b = engine.evaluate(weights, options);
+    EXPECT_EQ(a.count(), 1050u);
+    EXPECT_EQ(a.mean(), b.mean());
+    EXPECT_EQ(a.variance(), b.variance());
+
+    options.seed = 7;
+    EXPECT_NE(engine.simulate(options).data(), sequential.data());
+}
+
+// Test that Sobol scenarios converge faster and do not depend on how they are split
+TEST(MonteCarloEngineTest, SobolSampling) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    SimulationOptions options = simulation(16384, 1);
+    options.sampling = ScenarioSampling::SOBOL;
+    Matrix sequential = engine.simulate(options);
+    expectMoments(sequential, 1e-4, 2e-4);  // Pseudo-random: standard errors ~1e-3
+
+    options.blockSize = 1000;
+    options.threads = 3;
+    EXPECT_EQ(engine.simulate(options).data(), sequential.data());
+
+    Vector weights({0.4, 0.3, 0.2, 0.1});
+    PnLStatistics pnl = engine.evaluate(weights, options);
+    EXPECT_NEAR(pnl.mean(), testReturns().data().dot(weights), 1e-5);
+
+    options.seed = 7;
+    EXPECT_NE(engine.simulate(options).data(), sequential.data());
+}
+
+// Test that streamed P&L blocks equal simulated returns times the weights
+TEST(MonteCarloEngineTest, EvaluateMatchesSimulate) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    SimulationOptions options = simulation(2500, 2);
+    options.blockSize = 300;
+    Matrix portfolios({{0.25, 0.25, 0.25, 0.25}, {1.0, -0.5, 0.3, 0.2}});
+    Matrix expected = engine.simulate(options) * portfolios.transpose();
+
+    size_t next = 0;
+    size_t blocks = 0;
+    auto stats = engine.evaluate(portfolios, options, [&](size_t first, const Matrix& pnl) {
+        EXPECT_EQ(first, next);
+        EXPECT_EQ(pnl.cols(), 2u);
+        for (size_t s = 0; s < pnl.rows(); ++s) {
+            for (size_t j = 0; j < 2; ++j) {
+                EXPECT_NEAR(pnl(s, j), expected(first + s, j), 1e-12);
+            }
+        }
+        next += pnl.rows();
+        ++blocks;
+    });
+    EXPECT_EQ(next, 2500u);
+    EXPECT_EQ(blocks, 9u);
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[1].count(), 2500u);
+}
+
+// Test P&L moments and that Student-t tails are heavier than normal tails
+TEST(MonteCarloEngineTest, PnLDistribution) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    Vector weights({0.4, 0.3, 0.2, 0.1});
+    const double mean = testReturns().data().dot(weights);
+    const double stddev = std::sqrt(weights.dot(testCovariance().data() * weights));
+
+    auto tailCount = [&](ScenarioDistribution distribution) {
+        SimulationOptions options = simulation(200000, 2, distribution);
+        Matrix portfolios(1, 4);
+        portfolios.setRow(0, weights);
+        size_t tail = 0;
+        auto stats = engine.evaluate(portfolios, options, [&](size_t, const Matrix& pnl) {
+            for (double value : pnl.data()) {
+                tail += std::abs(value - mean) > 4.0 * stddev ? 1 : 0;
+            }
+        });
+        EXPECT_NEAR(stats[0].mean(), mean, 0.002);
+        EXPECT_NEAR(stats[0].stddev(), stddev, 0.003);
+        EXPECT_LT(stats[0].min(), mean - 3.0 * stddev);
+        EXPECT_GT(stats[0].max(), mean + 3.0 * stddev);
+        return tail;
+    };
+    size_t normalTail = tailCount(ScenarioDistribution::NORMAL);
+    size_t studentTail = tailCount(ScenarioDistribution::STUDENT_T);
+    EXPECT_LT(normalTail, 50u);  // P(|Z| > 4) ≈ 6e-5
+    EXPECT_GT(studentTail, 10 * normalTail);
+}
+
+// Test that merged partial statistics match one sequential pass
+TEST(MonteCarloEngineTest, StatisticsMerge) {
+    PnLStatistics all;
+    PnLStatistics first;
+    PnLStatistics second;
+    for (int i = 0; i < 100; ++i) {
+        double value = std::sin(static_cast<double>(i)) * 10.0 + 3.0;
+        all.add(value);
+        (i < 37 ? first : second).add(value);
+    }
+    PnLStatistics merged;
+    merged.merge(first);
+    merged.merge(second);
+    merged.merge(PnLStatistics());
+    EXPECT_EQ(merged.count(), all.count());
+    EXPECT_NEAR(merged.mean(), all.mean(), 1e-12);
+    EXPECT_NEAR(merged.variance(), all.variance(), 1e-10);
+    EXPECT_EQ(merged.min(), all.min());
+    EXPECT_EQ(merged.max(), all.max());
+}
+
+// Test validation of options and dimensions
+TEST(MonteCarloEngineTest, InvalidInputs) {
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    EXPECT_THROW(engine.simulate(simulation(0, 1)), std::invalid_argument);
+    SimulationOptions options = simulation(10, 1, ScenarioDistribution::STUDENT_T);
+    options.degreesOfFreedom = 2.0;
+    EXPECT_THROW(engine.simulate(options), std::invalid_argument);
+    options = simulation(10, 1);
+    options.blockSize = 0;
+    EXPECT_THROW(engine.simulate(options), std::invalid_argument);
+    EXPECT_THROW(engine.evaluate(Vector({0.5, 0.5}), simulation(10, 1)), std::invalid_argument);
+    EXPECT_THROW(MonteCarloEngine(ExpectedReturns(Vector({0.1, 0.2})), testCovariance()),
+                 std::invalid_argument);
+}
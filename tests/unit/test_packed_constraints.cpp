@@ -0,0 +1,297 @@
+#include "orbat/optimizer/packed_constraints.hpp"
+
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+#include "test_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::LongOnlyConstraint;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::PackedConstraints;
+using orbat::optimizer::SyntheticOptions;
+using orbat::optimizer::SyntheticProblem;
+using orbat::test::testCovariance;
+
+namespace {
+
+// Four assets; assets 0 and 1 form a sector capped at 50%
+PackedConstraints sectorLimits() {
+    PackedConstraints limits(4, 0.0, 0.6);
+    limits.setBounds(3, 0.05, 0.2);
+    size_t sector = limits.addSector("Growth", 0.1, 0.5);
+    limits.setSector(0, sector);
+    limits.setSector(1, sector);
+    return limits;
+}
+
+// Largest violation of the KKT conditions of minimize (1/2)w'Σw over long-only,
+// fully invested weights (with μ'w fixed if withReturn), relative to the gradient.
+// The gradient Σw must equal a + bμ on held assets and be at least that elsewhere.
+double kktViolation(const SyntheticProblem& problem, const Vector& weights, bool withReturn) {
+    const Vector& mu = problem.returns().data();
+    Vector gradient = problem.covariance().data() * weights;
+    double n = 0.0, sm = 0.0, smm = 0.0, sg = 0.0, smg = 0.0, scale = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        scale = std::max(scale, std::abs(gradient[i]));
+        if (weights[i] > 1e-9) {
+            n += 1.0;
+            sm += mu[i];
+            smm += mu[i] * mu[i];
+            sg += gradient[i];
+            smg += mu[i] * gradient[i];
+        }
+    }
+    double b = withReturn ? (n * smg - sm * sg) / (n * smm - sm * sm) : 0.0;
+    double a = (sg - b * sm) / n;
+    double violation = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        double residual = gradient[i] - a - b * mu[i];
+        violation = std::max(violation, weights[i] > 1e-9 ? std::abs(residual) : -residual);
+    }
+    return violation / scale;
+}
+
+}  // namespace
+
+// Test construction and accessors
+TEST(PackedConstraintsTest, Construction) {
+    PackedConstraints limits = sectorLimits();
+    EXPECT_EQ(limits.size(), 4u);
+    EXPECT_EQ(limits.sectorCount(), 1u);
+    EXPECT_EQ(limits.getName(), "PackedConstraints");
+    EXPECT_DOUBLE_EQ(limits.lowerBounds()[3], 0.05);
+    EXPECT_DOUBLE_EQ(limits.upperBounds()[0], 0.6);
+    EXPECT_EQ(limits.sectors()[1], 0u);
+    EXPECT_EQ(limits.sectors()[2], PackedConstraints::NO_SECTOR);
+    EXPECT_EQ(limits.sectorName(0), "Growth");
+    EXPECT_NO_THROW(limits.validate());
+
+    EXPECT_THROW(PackedConstraints(0), std::invalid_argument);
+    EXPECT_THROW(PackedConstraints({0.0}, {1.0, 1.0}), std::invalid_argument);
+    EXPECT_THROW(limits.setBounds(4, 0.0, 1.0), std::out_of_range);
+    EXPECT_THROW(limits.setSector(0, 1), std::out_of_range);
+}
+
+// Test validation of inconsistent and infeasible limits
+TEST(PackedConstraintsTest, Validation) {
+    PackedConstraints inverted(3);
+    inverted.setBounds(1, 0.5, 0.2);
+    EXPECT_THROW(inverted.validate(), std::invalid_argument);
+
+    EXPECT_THROW(PackedConstraints(3, 0.4, 1.0).validate(), std::invalid_argument);
+    EXPECT_THROW(PackedConstraints(3, 0.0, 0.3).validate(), std::invalid_argument);
+
+    PackedConstraints sectorTooSmall = sectorLimits();
+    sectorTooSmall.setBounds(0, 0.3, 0.6);
+    sectorTooSmall.setBounds(1, 0.3, 0.6);
+    EXPECT_THROW(sectorTooSmall.validate(), std::invalid_argument);
+
+    PackedConstraints sectorUnreachable(3, 0.0, 1.0);
+    size_t sector = sectorUnreachable.addSector("Cash", 0.0, 0.5);
+    sectorUnreachable.setSector(0, sector);
+    sectorUnreachable.setBounds(0, 0.0, 0.05);
+    EXPECT_NO_THROW(sectorUnreachable.validate());
+    sectorUnreachable.setSectorLimits(sector, 0.1, 0.5);
+    EXPECT_THROW(sectorUnreachable.validate(), std::invalid_argument);
+}
+
+// Test sectors that together cannot hold, or must exceed, the whole budget
+TEST(PackedConstraintsTest, SectorsMustReachBudget) {
+    PackedConstraints limits(3, 0.0, 1.0);
+    size_t first = limits.addSector("A", 0.0, 0.3);
+    size_t second = limits.addSector("B", 0.0, 0.3);
+    limits.setSector(0, first);
+    limits.setSector(1, first);
+    limits.setSector(2, second);
+    EXPECT_THROW(limits.validate(), std::invalid_argument);
+    Vector weights({0.2, 0.2, 0.6});
+    EXPECT_THROW(limits.project(weights), std::invalid_argument);
+
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<PackedConstraints>(limits));
+    EXPECT_THROW(MarkowitzOptimizer(ExpectedReturns(Vector({0.08, 0.12, 0.10})),
+                                    CovarianceMatrix(Matrix({{0.04, 0.01, 0.005},
+                                                             {0.01, 0.0225, 0.008},
+                                                             {0.005, 0.008, 0.01}})),
+                                    constraints),
+                 std::invalid_argument);
+
+    // An asset outside the sectors can take the rest
+    PackedConstraints withCash = limits;
+    withCash.setSector(2, PackedConstraints::NO_SECTOR);
+    EXPECT_NO_THROW(withCash.validate());
+
+    // Sector floors above the budget are rejected as well
+    limits.setSectorLimits(first, 0.6, 1.0);
+    limits.setSectorLimits(second, 0.6, 1.0);
+    EXPECT_THROW(limits.validate(), std::invalid_argument);
+    EXPECT_THROW(limits.project(weights), std::invalid_argument);
+}
+
+// Test feasibility of asset bounds and sector limits
+TEST(PackedConstraintsTest, IsFeasible) {
+    PackedConstraints limits = sectorLimits();
+    EXPECT_TRUE(limits.isFeasible(Vector({0.3, 0.2, 0.4, 0.1})));
+    EXPECT_FALSE(limits.isFeasible(Vector({0.3, 0.3, 0.3, 0.1})));   // Sector above 50%
+    EXPECT_FALSE(limits.isFeasible(Vector({0.05, 0.0, 0.6, 0.35})));  // Sector below 10%
+    EXPECT_FALSE(limits.isFeasible(Vector({0.2, 0.2, 0.6, 0.0})));   // Asset 3 below 5%
+    EXPECT_FALSE(limits.isFeasible(Vector({0.5, 0.5, 0.0})));         // Wrong size
+}
+
+// Test that repeated projection reaches a fully invested feasible portfolio
+TEST(PackedConstraintsTest, ProjectionReachesFeasibleSet) {
+    PackedConstraints limits = sectorLimits();
+    Vector weights({0.9, 0.4, -0.2, 0.3});
+    for (int i = 0; i < 100 && !limits.isFeasible(weights); ++i) {
+        limits.project(weights);
+    }
+    EXPECT_TRUE(limits.isFeasible(weights));
+    EXPECT_NEAR(weights.sum(), 1.0, 1e-8);
+
+    // Feasible weights are left unchanged
+    Vector feasible({0.3, 0.2, 0.4, 0.1});
+    Vector projected = feasible;
+    limits.project(projected);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(projected[i], feasible[i], 1e-12);
+    }
+
+    Vector wrongSize({1.0});
+    EXPECT_THROW(limits.project(wrongSize), std::invalid_argument);
+}
+
+// Test that one projection is the Euclidean projection onto the feasible set
+TEST(PackedConstraintsTest, ProjectionIsExact) {
+    PackedConstraints limits = sectorLimits();
+    Vector point({0.9, 0.4, -0.2, 0.3});
+    Vector projected = point;
+    limits.project(projected);
+    EXPECT_TRUE(limits.isFeasible(projected));
+    EXPECT_NEAR(projected.sum(), 1.0, 1e-12);
+
+    // p is the projection of v iff (v - p)'(q - p) <= 0 for every feasible q
+    for (int k = 0; k < 200; ++k) {
+        double x = static_cast<double>(k);
+        Vector q({std::sin(x), std::cos(1.3 * x), std::sin(0.7 * x), std::cos(2.1 * x)});
+        limits.project(q);
+        ASSERT_TRUE(limits.isFeasible(q));
+        double inner = 0.0;
+        for (size_t i = 0; i < 4; ++i) {
+            inner += (point[i] - projected[i]) * (q[i] - projected[i]);
+        }
+        EXPECT_LE(inner, 1e-12) << k;
+    }
+}
+
+// Test against optima solved by hand for the limits of tests/data/constraints.json
+TEST(PackedConstraintsTest, MarkowitzMatchesHandSolvedOptimum) {
+    ExpectedReturns returns(Vector({0.08, 0.12, 0.10}));
+    CovarianceMatrix covariance(
+        Matrix({{0.04, 0.01, 0.005}, {0.01, 0.0225, 0.008}, {0.005, 0.008, 0.01}}));
+    PackedConstraints limits(3, 0.0, 0.6);
+    size_t growth = limits.addSector("Growth", 0.0, 0.65);
+    limits.setSector(0, growth);
+    limits.setSector(1, growth);
+    limits.setBounds(0, 0.1, 0.6);
+    limits.setBounds(2, 0.0, 0.4);
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<PackedConstraints>(limits));
+    MarkowitzOptimizer optimizer(returns, covariance, constraints);
+
+    // C sits at its 40% cap, so B = 0.6 - A and dVar/dA = 0.17A - 0.0348 = 0
+    auto minimum = optimizer.minimumVariance();
+    ASSERT_TRUE(minimum.success()) << minimum.message;
+    double a = 0.0348 / 0.17;
+    EXPECT_NEAR(minimum.weights[0], a, 1e-6);
+    EXPECT_NEAR(minimum.weights[1], 0.6 - a, 1e-6);
+    EXPECT_NEAR(minimum.weights[2], 0.4, 1e-6);
+
+    // With C capped, a 10% return fixes A = B = 0.3; the multipliers confirm the cap binds
+    auto target = optimizer.targetReturn(0.10);
+    ASSERT_TRUE(target.success()) << target.message;
+    EXPECT_NEAR(target.expectedReturn, 0.10, 1e-8);
+    EXPECT_NEAR(target.weights[0], 0.3, 1e-6);
+    EXPECT_NEAR(target.weights[1], 0.3, 1e-6);
+    EXPECT_NEAR(target.weights[2], 0.4, 1e-6);
+
+    // No portfolio within the limits returns 13%
+    EXPECT_FALSE(optimizer.targetReturn(0.13).success());
+}
+
+// Test the optimizer honours packed constraints
+TEST(PackedConstraintsTest, MarkowitzUsesPackedConstraints) {
+    ExpectedReturns returns(Vector({0.08, 0.12, 0.10, 0.06}));
+    PackedConstraints limits(4, 0.0, 0.3);
+    size_t sector = limits.addSector("Low vol", 0.0, 0.45);
+    limits.setSector(2, sector);
+    limits.setSector(3, sector);
+
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<PackedConstraints>(limits));
+    ASSERT_NE(constraints.find<PackedConstraints>(), nullptr);
+    EXPECT_EQ(constraints.find<LongOnlyConstraint>(), nullptr);
+
+    MarkowitzOptimizer optimizer(returns, testCovariance(), constraints);
+    auto result = optimizer.minimumVariance();
+    ASSERT_TRUE(result.success());
+    EXPECT_TRUE(limits.isFeasible(result.weights));
+    EXPECT_NEAR(result.weights.sum(), 1.0, 1e-8);
+
+    // Constraints sized for a different universe are rejected
+    ConstraintSet mismatched;
+    mismatched.add(std::make_shared<PackedConstraints>(3));
+    EXPECT_THROW(MarkowitzOptimizer(returns, testCovariance(), mismatched),
+                 std::invalid_argument);
+}
+
+// Test long-only solves of a large, ill-conditioned problem reach the optimum
+TEST(PackedConstraintsTest, MarkowitzSolvesIllConditionedLongOnly) {
+    SyntheticOptions options;
+    options.assets = 300;
+    options.conditionNumber = 1e4;
+    SyntheticProblem problem = SyntheticProblem::generate(options);
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<LongOnlyConstraint>());
+    MarkowitzOptimizer optimizer(problem.returns(), problem.covariance(), constraints);
+
+    auto minimum = optimizer.minimumVariance();
+    ASSERT_TRUE(minimum.success()) << minimum.message;
+    const auto& minimumWeights = minimum.weights.data();
+    EXPECT_GE(*std::min_element(minimumWeights.begin(), minimumWeights.end()), -1e-10);
+    EXPECT_NEAR(minimum.weights.sum(), 1.0, 1e-8);
+    EXPECT_LT(kktViolation(problem, minimum.weights, false), 1e-6);
+
+    const auto& mu = problem.returns().data().data();
+    double target = 0.5 * (minimum.expectedReturn + *std::max_element(mu.begin(), mu.end()));
+    auto result = optimizer.targetReturn(target);
+    ASSERT_TRUE(result.success()) << result.message;
+    const auto& resultWeights = result.weights.data();
+    EXPECT_GE(*std::min_element(resultWeights.begin(), resultWeights.end()), -1e-10);
+    EXPECT_NEAR(result.weights.sum(), 1.0, 1e-8);
+    EXPECT_NEAR(result.expectedReturn, target, 1e-8);
+    EXPECT_LT(kktViolation(problem, result.weights, true), 1e-6);
+
+    // A sector cap sends the solve through projected gradient instead
+    PackedConstraints limits(options.assets);
+    size_t sector = limits.addSector("First half", 0.0, 0.3);
+    for (size_t i = 0; i < options.assets / 2; ++i) {
+        limits.setSector(i, sector);
+    }
+    ConstraintSet sectors;
+    sectors.add(std::make_shared<PackedConstraints>(limits));
+    MarkowitzOptimizer capped(problem.returns(), problem.covariance(), sectors);
+    auto cappedMinimum = capped.minimumVariance();
+    ASSERT_TRUE(cappedMinimum.success()) << cappedMinimum.message;
+    EXPECT_TRUE(limits.isFeasible(cappedMinimum.weights));
+    EXPECT_GE(cappedMinimum.risk, minimum.risk - 1e-12);
+}
@@ -0,0 +1,149 @@
+#include "orbat/core/random.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::CounterRng;
+using orbat::core::Matrix;
+using orbat::core::Vector;
+
+namespace {
+
+double mean(const std::vector<double>& values) {
+    return std::accumulate(values.begin(), values.end(), 0.0) /
+           static_cast<double>(values.size());
+}
+
+double variance(const std::vector<double>& values) {
+    double m = mean(values);
+    double sum = 0.0;
+    for (double value : values) {
+        sum += (value - m) * (value - m);
+    }
+    return sum / static_cast<double>(values.size() - 1);
+}
+
+}  // namespace
+
+// Test the Philox4x32-10 known-answer vectors from Random123
+TEST(CounterRngTest, PhiloxKnownAnswers) {
+    using Counter = CounterRng::Counter;
+    EXPECT_EQ(CounterRng::philox({0, 0, 0, 0}, {0, 0}),
+              (Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(CounterRng::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                 {0xffffffff, 0xffffffff}),
+              (Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(CounterRng::philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                                 {0xa4093822, 0x299f31d0}),
+              (Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+// Test that positions can be reached by skipping and streams are distinct
+TEST(CounterRngTest, SkipAheadAndStreams) {
+    CounterRng rng(42, 3);
+    std::vector<uint64_t> words(100);
+    for (auto& word : words) {
+        word = rng();
+    }
+    EXPECT_EQ(rng.position(), 100u);
+    for (uint64_t i : {0u, 1u, 2u, 37u, 99u}) {
+        CounterRng jump(42, 3);
+        jump.discard(i);
+        EXPECT_EQ(jump(), words[i]);
+    }
+    CounterRng other(42, 4);
+    CounterRng reseeded(43, 3);
+    EXPECT_NE(other(), words[0]);
+    EXPECT_NE(reseeded(), words[0]);
+}
+
+// Test that bulk fills match single draws however the calls are split
+TEST(CounterRngTest, FillsMatchSingleDraws) {
+    CounterRng single(7);
+    std::vector<double> uniforms(101);
+    std::vector<double> normals(257);
+    for (double& u : uniforms) {
+        u = single.uniform();
+    }
+    for (double& z : normals) {
+        z = single.normal();
+    }
+
+    CounterRng bulk(7);
+    std::vector<double> u(101);
+    std::vector<double> z(257);
+    bulk.fillUniform(u.data(), 1);
+    bulk.fillUniform(u.data() + 1, 100);
+    bulk.fillNormal(z.data(), 3);
+    bulk.fillNormal(z.data() + 3, 200);
+    bulk.fillNormal(z.data() + 203, 54);
+    EXPECT_EQ(u, uniforms);
+    EXPECT_EQ(z, normals);
+}
+
+// Test the moments of uniforms and normals
+TEST(CounterRngTest, Distributions) {
+    CounterRng rng(1);
+    Vector u(200000);
+    rng.fillUniform(u);
+    EXPECT_GT(*std::min_element(u.data().begin(), u.data().end()), 0.0);
+    EXPECT_LT(*std::max_element(u.data().begin(), u.data().end()), 1.0);
+    EXPECT_NEAR(mean(u.data()), 0.5, 0.003);
+    EXPECT_NEAR(variance(u.data()), 1.0 / 12.0, 0.001);
+
+    Matrix z(1000, 200);
+    rng.fillNormal(z);
+    EXPECT_NEAR(mean(z.data()), 0.0, 0.01);
+    EXPECT_NEAR(variance(z.data()), 1.0, 0.01);
+    double tail = static_cast<double>(std::count_if(z.data().begin(), z.data().end(),
+                                                    [](double x) { return std::abs(x) > 1.96; }));
+    EXPECT_NEAR(tail / 200000.0, 0.05, 0.003);
+}
+
+// Test the χ² moments (mean ν, variance 2ν), including ν < 2
+TEST(CounterRngTest, ChiSquared) {
+    CounterRng rng(5);
+    for (double dof : {0.8, 5.0, 30.0}) {
+        std::vector<double> values(100000);
+        for (double& value : values) {
+            value = rng.chiSquared(dof);
+        }
+        EXPECT_NEAR(mean(values), dof, 0.03 * dof) << dof;
+        EXPECT_NEAR(variance(values), 2.0 * dof, 0.1 * dof) << dof;
+    }
+    EXPECT_THROW(rng.chiSquared(0.0), std::invalid_argument);
+}
+
+// Test bounded integers, shuffling and use with <random>
+TEST(CounterRngTest, IntegersAndShuffle) {
+    CounterRng rng(9);
+    std::vector<int> counts(7, 0);
+    for (int i = 0; i < 70000; ++i) {
+        uint64_t value = rng.below(7);
+        ASSERT_LT(value, 7u);
+        ++counts[value];
+    }
+    for (int count : counts) {
+        EXPECT_NEAR(count, 10000, 500);
+    }
+    EXPECT_THROW(rng.below(0), std::invalid_argument);
+
+    std::vector<int> items(50);
+    std::iota(items.begin(), items.end(), 0);
+    std::vector<int> shuffled = items;
+    rng.shuffle(shuffled.begin(), shuffled.end());
+    EXPECT_NE(shuffled, items);
+    std::sort(shuffled.begin(), shuffled.end());
+    EXPECT_EQ(shuffled, items);
+
+    std::uniform_int_distribution<int> die(1, 6);
+    int roll = die(rng);
+    EXPECT_GE(roll, 1);
+    EXPECT_LE(roll, 6);
+}
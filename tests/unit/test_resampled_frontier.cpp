@@ -0,0 +1,232 @@
+#include "orbat/optimizer/resampled_frontier.hpp"
+
+#include "orbat/core/random.hpp"
+#include "orbat/optimizer/constraint.hpp"
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/packed_constraints.hpp"
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+using orbat::core::CounterRng;
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::ConstraintSet;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::FrontierEngine;
+using orbat::optimizer::FrontierOptions;
+using orbat::optimizer::LongOnlyConstraint;
+using orbat::optimizer::MarkowitzResult;
+using orbat::optimizer::PackedConstraints;
+using orbat::optimizer::ResampledFrontier;
+using orbat::optimizer::ResampledFrontierEngine;
+using orbat::optimizer::ResamplingMethod;
+using orbat::optimizer::ResamplingOptions;
+using orbat::test::testCovariance;
+using orbat::test::testReturns;
+
+namespace {
+
+ConstraintSet longOnly() {
+    ConstraintSet constraints;
+    constraints.add(std::make_shared<LongOnlyConstraint>());
+    return constraints;
+}
+
+// Correlated returns drawn from N(μ, Σ)
+Matrix testHistory(size_t periods) {
+    Matrix z(periods, 4);
+    CounterRng(3, 0).fillNormal(z);
+    Matrix lower = testCovariance().data().cholesky();
+    Matrix history(periods, 4);
+    for (size_t t = 0; t < periods; ++t) {
+        for (size_t i = 0; i < 4; ++i) {
+            double value = testReturns()[i];
+            for (size_t j = 0; j <= i; ++j) {
+                value += lower(i, j) * z(t, j);
+            }
+            history(t, i) = value;
+        }
+    }
+    return history;
+}
+
+// Sample mean and covariance of the rows of a matrix
+std::pair<ExpectedReturns, CovarianceMatrix> estimate(const Matrix& x) {
+    const size_t T = x.rows();
+    const size_t n = x.cols();
+    Vector mean(n, 0.0);
+    for (size_t t = 0; t < T; ++t) {
+        for (size_t i = 0; i < n; ++i) {
+            mean[i] += x(t, i) / static_cast<double>(T);
+        }
+    }
+    Matrix cov(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            double sum = 0.0;
+            for (size_t t = 0; t < T; ++t) {
+                sum += (x(t, i) - mean[i]) * (x(t, j) - mean[j]);
+            }
+            cov(i, j) = sum / static_cast<double>(T - 1);
+        }
+    }
+    return {ExpectedReturns(mean), CovarianceMatrix(cov)};
+}
+
+}  // namespace
+
+// Test that one parametric sample reproduces the frontier of its explicit estimates
+TEST(ResampledFrontierTest, SingleSampleMatchesFrontier) {
+    ResamplingOptions options;
+    options.samples = 1;
+    options.observations = 60;
+    options.points = 10;
+    options.seed = 11;
+    ResampledFrontierEngine engine(testReturns(), testCovariance());
+    EXPECT_EQ(engine.method(), ResamplingMethod::PARAMETRIC);
+    ResampledFrontier frontier = engine.compute(options);
+    ASSERT_EQ(frontier.samples, 1u);
+    ASSERT_EQ(frontier.points.size(), 10u);
+
+    // Sample 0 is μ + Lz for the normals of stream 0
+    Matrix z(60, 4);
+    CounterRng(11, 0).fillNormal(z);
+    Matrix lower = testCovariance().data().cholesky();
+    Matrix x(60, 4);
+    for (size_t t = 0; t < 60; ++t) {
+        for (size_t i = 0; i < 4; ++i) {
+            double value = testReturns()[i];
+            for (size_t j = 0; j <= i; ++j) {
+                value += lower(i, j) * z(t, j);
+            }
+            x(t, i) = value;
+        }
+    }
+    auto [mu, sigma] = estimate(x);
+    FrontierOptions frontierOptions;
+    frontierOptions.points = 10;
+    frontierOptions.threads = 1;
+    std::vector<MarkowitzResult> expected = FrontierEngine(mu, sigma).compute(frontierOptions);
+    ASSERT_EQ(expected.size(), 10u);
+
+    for (size_t k = 0; k < 10; ++k) {
+        const MarkowitzResult& point = frontier.points[k];
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_NEAR(point.weights[i], expected[k].weights[i], 1e-9) << k << " " << i;
+        }
+        // Reported under the original inputs
+        Vector w = point.weights;
+        EXPECT_NEAR(point.expectedReturn, testReturns().data().dot(w), 1e-14);
+        EXPECT_NEAR(point.risk, std::sqrt(w.dot(testCovariance().data() * w)), 1e-14);
+        EXPECT_TRUE(point.success());
+    }
+}
+
+// Test averaged portfolios: fully invested, inside the frontier, and independent of threads
+TEST(ResampledFrontierTest, DeterministicAcrossThreads) {
+    ResampledFrontierEngine engine(testReturns(), testCovariance());
+    ResamplingOptions options;
+    options.samples = 37;
+    options.observations = 48;
+    options.points = 8;
+    options.chunkSize = 3;
+    options.threads = 1;
+    ResampledFrontier serial = engine.compute(options);
+    options.threads = 4;
+    ResampledFrontier parallel = engine.compute(options);
+
+    EXPECT_EQ(serial.samples + serial.failedSamples, 37u);
+    EXPECT_EQ(parallel.samples, serial.samples);
+    ASSERT_EQ(parallel.points.size(), 8u);
+    FrontierEngine exact(testReturns(), testCovariance());
+    for (size_t k = 0; k < 8; ++k) {
+        const MarkowitzResult& point = serial.points[k];
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_EQ(parallel.points[k].weights[i], point.weights[i]);
+        }
+        EXPECT_NEAR(point.weights.sum(), 1.0, 1e-12);
+        // No portfolio beats the true frontier
+        MarkowitzResult best = exact.point(point.expectedReturn);
+        if (best.success()) {
+            EXPECT_GE(point.risk, best.risk - 1e-12) << k;
+        }
+    }
+    // Ranks are ordered by return
+    EXPECT_LT(serial.points.front().expectedReturn, serial.points.back().expectedReturn);
+
+    options.seed = 43;
+    EXPECT_NE(engine.compute(options).points[4].weights[0], serial.points[4].weights[0]);
+}
+
+// Test bootstrapping a history under a long-only constraint
+TEST(ResampledFrontierTest, BootstrapLongOnly) {
+    Matrix history = testHistory(120);
+    ResampledFrontierEngine engine(history, longOnly());
+    EXPECT_EQ(engine.method(), ResamplingMethod::BOOTSTRAP);
+    auto [mu, sigma] = estimate(history);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(engine.expectedReturns()[i], mu[i], 1e-14);
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_NEAR(engine.covariance()(i, j), sigma(i, j), 1e-14);
+        }
+    }
+
+    ResamplingOptions options;
+    options.samples = 64;
+    options.points = 12;
+    ResampledFrontier frontier = engine.compute(options);
+    EXPECT_EQ(frontier.samples, 64u);
+    ASSERT_EQ(frontier.points.size(), 12u);
+    for (const MarkowitzResult& point : frontier.points) {
+        EXPECT_NEAR(point.weights.sum(), 1.0, 1e-9);
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_GE(point.weights[i], -1e-12);
+        }
+    }
+    // Averaging keeps the top rank diversified instead of all in one asset
+    size_t held = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        held += frontier.points.back().weights[i] > 1e-6 ? 1 : 0;
+    }
+    EXPECT_GT(held, 1u);
+}
+
+// Test validation of inputs and options
+TEST(ResampledFrontierTest, Validation) {
+    ResampledFrontierEngine engine(testReturns(), testCovariance());
+    ResamplingOptions options;
+    EXPECT_THROW(engine.compute(options), std::invalid_argument);  // Observations required
+    options.observations = 4;
+    EXPECT_THROW(engine.compute(options), std::invalid_argument);
+    options.observations = 20;
+    options.points = 1;
+    EXPECT_THROW(engine.compute(options), std::invalid_argument);
+    options.points = 5;
+    options.samples = 0;
+    EXPECT_THROW(engine.compute(options), std::invalid_argument);
+    options.samples = 5;
+    options.chunkSize = 0;
+    EXPECT_THROW(engine.compute(options), std::invalid_argument);
+
+    EXPECT_THROW(ResampledFrontierEngine(testHistory(4), ConstraintSet()),
+                 std::invalid_argument);
+    EXPECT_THROW(ResampledFrontierEngine(ExpectedReturns(Vector({0.1, 0.2})), testCovariance()),
+                 std::invalid_argument);
+
+    // Constraints are checked as MarkowitzOptimizer checks them
+    ConstraintSet mismatched;
+    mismatched.add(std::make_shared<PackedConstraints>(3));
+    EXPECT_THROW(ResampledFrontierEngine(testReturns(), testCovariance(), mismatched),
+                 std::invalid_argument);
+    ConstraintSet infeasible;
+    infeasible.add(std::make_shared<PackedConstraints>(4, 0.0, 0.2));  // At most 80% invested
+    EXPECT_THROW(ResampledFrontierEngine(testReturns(), testCovariance(), infeasible),
+                 std::invalid_argument);
+}
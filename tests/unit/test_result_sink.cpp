@@ -0,0 +1,368 @@
+#include "orbat/optimizer/efficient_frontier.hpp"
+#include "orbat/optimizer/result_sink.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Vector;
+using orbat::optimizer::BinaryResultReader;
+using orbat::optimizer::BinaryResultRecord;
+using orbat::optimizer::BinaryResultSink;
+using orbat::optimizer::CovarianceMatrix;
+using orbat::optimizer::CsvResultSink;
+using orbat::optimizer::ExpectedReturns;
+using orbat::optimizer::JsonResultSink;
+using orbat::optimizer::makeResultSink;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MarkowitzResult;
+using orbat::optimizer::NdjsonResultSink;
+using orbat::optimizer::OutputFormat;
+using orbat::optimizer::outputFormatName;
+using orbat::optimizer::parseOutputFormat;
+using orbat::optimizer::SinkOptions;
+
+namespace {
+
+MarkowitzResult sampleResult(double scale = 1.0) {
+    return MarkowitzResult{
+        Vector({0.3 * scale, 0.5, 0.2}), 0.12 * scale, 0.15, 0.8, true, "Test message"};
+}
+
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+// Test format name parsing
+TEST(ResultSinkTest, ParseOutputFormat) {
+    EXPECT_EQ(parseOutputFormat("json"), OutputFormat::JSON);
+    EXPECT_EQ(parseOutputFormat("ndjson"), OutputFormat::NDJSON);
+    EXPECT_EQ(parseOutputFormat("csv"), OutputFormat::CSV);
+    EXPECT_EQ(parseOutputFormat("binary"), OutputFormat::BINARY);
+    EXPECT_THROW(parseOutputFormat("xml"), std::invalid_argument);
+
+    for (auto format :
+         {OutputFormat::JSON, OutputFormat::NDJSON, OutputFormat::CSV, OutputFormat::BINARY}) {
+        EXPECT_EQ(parseOutputFormat(outputFormatName(format)), format);
+    }
+}
+
+// Test NDJSON output: one compact object per line
+TEST(ResultSinkTest, NdjsonOneRecordPerLine) {
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    sink.write(sampleResult(), "job-1");
+    sink.write(sampleResult(2.0), "job-2");
+    sink.finish();
+
+    auto lines = splitLines(out.str());
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(sink.count(), 2);
+    EXPECT_EQ(lines[0].front(), '{');
+    EXPECT_EQ(lines[0].back(), '}');
+    EXPECT_NE(lines[0].find("\"id\":\"job-1\""), std::string::npos);
+    EXPECT_NE(lines[1].find("\"id\":\"job-2\""), std::string::npos);
+    EXPECT_NE(lines[1].find("\"expectedReturn\":0.24000000"), std::string::npos);
+
+    // Records round-trip through the existing JSON reader
+    auto parsed = MarkowitzResult::fromJSON(lines[0]);
+    EXPECT_TRUE(parsed.converged);
+    EXPECT_NEAR(parsed.expectedReturn, 0.12, 1e-8);
+    ASSERT_EQ(parsed.weights.size(), 3);
+    EXPECT_NEAR(parsed.weights[1], 0.5, 1e-8);
+}
+
+// Test that the record id is omitted when empty
+TEST(ResultSinkTest, NdjsonOmitsEmptyId) {
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    sink.write(sampleResult());
+    sink.finish();
+    EXPECT_EQ(out.str().find("\"id\""), std::string::npos);
+}
+
+// Test JSON strings are escaped
+TEST(ResultSinkTest, EscapesStrings) {
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    MarkowitzResult result = sampleResult();
+    result.message = "quote \" and\nnewline";
+    sink.write(result);
+    sink.finish();
+    EXPECT_NE(out.str().find("quote \\\" and\\nnewline"), std::string::npos);
+    EXPECT_EQ(splitLines(out.str()).size(), 1);
+}
+
+// Test non-finite numbers are written as JSON null and read back as NaN
+TEST(ResultSinkTest, NdjsonWritesNonFiniteAsNull) {
+    std::ostringstream out;
+    NdjsonResultSink sink(out);
+    MarkowitzResult result = sampleResult();
+    result.risk = std::numeric_limits<double>::quiet_NaN();
+    result.sharpeRatio = std::numeric_limits<double>::infinity();
+    result.weights[1] = -std::numeric_limits<double>::infinity();
+    sink.write(result);
+    sink.finish();
+
+    std::string line = out.str();
+    EXPECT_EQ(line.find("nan"), std::string::npos);
+    EXPECT_EQ(line.find("inf"), std::string::npos);
+    EXPECT_NE(line.find("\"risk\":null,\"sharpeRatio\":null"), std::string::npos);
+    EXPECT_NE(line.find("[0.30000000,null,0.20000000]"), std::string::npos);
+
+    auto parsed = MarkowitzResult::fromJSON(line);
+    EXPECT_NEAR(parsed.expectedReturn, 0.12, 1e-8);
+    EXPECT_TRUE(std::isnan(parsed.risk));
+    EXPECT_TRUE(std::isnan(parsed.weights[1]));
+}
+
+// Test sinks leave the caller's stream formatting as they found it
+TEST(ResultSinkTest, RestoresStreamFormatting) {
+    for (auto format : {OutputFormat::JSON, OutputFormat::NDJSON, OutputFormat::CSV}) {
+        std::ostringstream out;
+        out << std::scientific << std::setprecision(3);
+        auto sink = makeResultSink(format, out);
+        out << 0.5 << "\n";
+        sink->write(sampleResult());
+        out << 0.5 << "\n";
+        sink->finish();
+        out << 0.5;
+
+        EXPECT_EQ(out.precision(), 3) << outputFormatName(format);
+        EXPECT_TRUE(out.flags() & std::ios::scientific) << outputFormatName(format);
+        EXPECT_EQ(splitLines(out.str()).back(), "5.000e-01") << outputFormatName(format);
+        EXPECT_NE(out.str().find("0.12000000"), std::string::npos) << outputFormatName(format);
+    }
+}
+
+// Test streaming JSON document structure
+TEST(ResultSinkTest, JsonDocumentStructure) {
+    std::ostringstream out;
+    SinkOptions options;
+    options.assetLabels = {"A", "B", "C"};
+    JsonResultSink sink(out, options, "frontier");
+    sink.write(sampleResult(), "0");
+    sink.write(sampleResult(), "1");
+    sink.finish();
+
+    std::string json = out.str();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find("\"assets\": [\"A\", \"B\", \"C\"]"), std::string::npos);
+    EXPECT_NE(json.find("\"frontier\": ["), std::string::npos);
+    EXPECT_NE(json.find("},\n"), std::string::npos);
+    EXPECT_NE(json.find("\n  ]\n}\n"), std::string::npos);
+}
+
+// Test that an empty JSON document is still well-formed
+TEST(ResultSinkTest, JsonEmptyDocument) {
+    std::ostringstream out;
+    JsonResultSink sink(out);
+    sink.finish();
+    EXPECT_EQ(out.str(), "{\n  \"results\": [\n]\n}\n");
+}
+
+// Test CSV header and rows
+TEST(ResultSinkTest, CsvHeaderAndRows) {
+    std::ostringstream out;
+    SinkOptions options;
+    options.includeIds = true;
+    options.assetLabels = {"Bonds", "Stocks"};
+    CsvResultSink sink(out, options);
+    sink.write(sampleResult(), "a");
+    sink.write(sampleResult(), "b");
+    sink.finish();
+
+    auto lines = splitLines(out.str());
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0],
+              "id,converged,message,expectedReturn,risk,sharpeRatio,\"Bonds\",\"Stocks\",weight_2");
+    EXPECT_EQ(lines[1].rfind("\"a\",true,\"Test message\",0.12000000", 0), 0);
+}
+
+// Test binary round trip is bit-exact
+TEST(ResultSinkTest, BinaryRoundTrip) {
+    std::stringstream buffer(std::ios::in | std::ios::out | std::ios::binary);
+    SinkOptions options;
+    options.assetLabels = {"A", "B", "C"};
+
+    MarkowitzResult first = sampleResult();
+    first.expectedReturn = 0.1 + 0.2;  // Not representable in fixed text precision
+    MarkowitzResult second{Vector(), 0.0, 0.0, 0.0, false, "Singular covariance matrix"};
+
+    BinaryResultSink sink(buffer, options);
+    sink.write(first, "first");
+    sink.write(second, "");
+    sink.finish();
+
+    BinaryResultReader reader(buffer);
+    EXPECT_EQ(reader.assetLabels(), options.assetLabels);
+
+    BinaryResultRecord record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "first");
+    EXPECT_TRUE(record.result.converged);
+    EXPECT_EQ(record.result.expectedReturn, first.expectedReturn);
+    ASSERT_EQ(record.result.weights.size(), 3);
+    EXPECT_EQ(record.result.weights[0], first.weights[0]);
+    EXPECT_EQ(record.result.message, "Test message");
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(record.id, "");
+    EXPECT_FALSE(record.result.converged);
+    EXPECT_TRUE(record.result.weights.empty());
+    EXPECT_EQ(record.result.message, "Singular covariance matrix");
+
+    EXPECT_FALSE(reader.next(record));
+}
+
+// Test binary header layout is little-endian and starts with the magic bytes
+TEST(ResultSinkTest, BinaryHeaderLayout) {
+    std::ostringstream out(std::ios::binary);
+    BinaryResultSink sink(out);
+    sink.finish();
+
+    std::string bytes = out.str();
+    ASSERT_GE(bytes.size(), 8);
+    EXPECT_EQ(bytes.substr(0, 4), "ORBR");
+    EXPECT_EQ(static_cast<unsigned char>(bytes[4]), 1);  // version, low byte first
+    EXPECT_EQ(static_cast<unsigned char>(bytes[5]), 0);
+    EXPECT_EQ(static_cast<unsigned char>(bytes[6]), 7);  // field count
+}
+
+// Test reader rejects foreign data
+TEST(ResultSinkTest, BinaryReaderRejectsBadMagic) {
+    std::istringstream in("NOPE....");
+    EXPECT_THROW(BinaryResultReader reader(in), std::runtime_error);
+}
+
+// Test reader detects truncated records
+TEST(ResultSinkTest, BinaryReaderDetectsTruncation) {
+    std::ostringstream out(std::ios::binary);
+    BinaryResultSink sink(out);
+    sink.write(sampleResult(), "x");
+    sink.finish();
+
+    std::string bytes = out.str();
+    std::istringstream in(bytes.substr(0, bytes.size() - 5));
+    BinaryResultReader reader(in);
+    BinaryResultRecord record;
+    EXPECT_THROW(reader.next(record), std::runtime_error);
+}
+
+// Test a corrupt record length fails on the data present instead of allocating it
+TEST(ResultSinkTest, BinaryReaderBoundsRecordLength) {
+    std::ostringstream out(std::ios::binary);
+    BinaryResultSink sink(out);
+    sink.finish();
+    std::string header = out.str();
+
+    // Length 0xFFFFFFFF followed by a few bytes
+    std::istringstream huge(header + std::string(4, '\xFF') + "abcdef");
+    BinaryResultReader reader(huge);
+    BinaryResultRecord record;
+    EXPECT_THROW(reader.next(record), std::runtime_error);
+
+    // A weight count larger than the record
+    std::string payload;
+    payload += std::string("\0\0", 2);  // Empty id
+    payload += '\1';                    // Converged
+    payload += std::string(24, '\0');   // Return, risk, Sharpe ratio
+    payload += std::string(4, '\xFF');  // Weight count
+    payload += std::string("\0\0", 2);  // Empty message
+    std::string length = {static_cast<char>(payload.size()), '\0', '\0', '\0'};
+    std::istringstream overcount(header + length + payload);
+    BinaryResultReader overcountReader(overcount);
+    EXPECT_THROW(overcountReader.next(record), std::runtime_error);
+}
+
+// Test a huge label count in a truncated header fails as truncation
+TEST(ResultSinkTest, BinaryReaderBoundsLabelCount) {
+    std::ostringstream out(std::ios::binary);
+    BinaryResultSink sink(out);
+    sink.finish();
+    std::string header = out.str();
+
+    // The header ends with the label count, 0 here
+    header.replace(header.size() - 4, 4, std::string(4, '\xFF'));
+    std::istringstream huge(header + std::string("\1\0a", 3));
+    EXPECT_THROW(BinaryResultReader{huge}, std::runtime_error);
+}
+
+// Test writing after finish is rejected
+TEST(ResultSinkTest, WriteAfterFinishThrows) {
+    std::ostringstream out;
+    auto sink = makeResultSink(OutputFormat::NDJSON, out);
+    sink->finish();
+    EXPECT_THROW(sink->write(sampleResult()), std::logic_error);
+}
+
+// Test the factory selects the requested format
+TEST(ResultSinkTest, FactoryFormats) {
+    std::ostringstream out;
+    for (auto format :
+         {OutputFormat::JSON, OutputFormat::NDJSON, OutputFormat::CSV, OutputFormat::BINARY}) {
+        EXPECT_EQ(makeResultSink(format, out)->format(), format);
+    }
+}
+
+// Test frontier export through the sink interface
+TEST(ResultSinkTest, FrontierExportNdjson) {
+    ExpectedReturns returns({0.08, 0.12, 0.16});
+    CovarianceMatrix cov({{0.04, 0.01, 0.005}, {0.01, 0.0225, 0.008}, {0.005, 0.008, 0.01}});
+    MarkowitzOptimizer optimizer(returns, cov);
+    auto frontier = optimizer.efficientFrontier(10);
+    ASSERT_FALSE(frontier.empty());
+
+    std::string filename = "/tmp/test_frontier_sink.ndjson";
+    orbat::optimizer::exportFrontier(frontier, filename, OutputFormat::NDJSON);
+
+    std::ifstream file(filename);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto lines = splitLines(content);
+    EXPECT_EQ(lines.size(), frontier.size());
+    EXPECT_NE(lines[0].find("\"id\":\"0\""), std::string::npos);
+    std::remove(filename.c_str());
+}
+
+// Test frontier export in binary format
+TEST(ResultSinkTest, FrontierExportBinary) {
+    ExpectedReturns returns({0.08, 0.12, 0.16});
+    CovarianceMatrix cov({{0.04, 0.01, 0.005}, {0.01, 0.0225, 0.008}, {0.005, 0.008, 0.01}});
+    MarkowitzOptimizer optimizer(returns, cov);
+    auto frontier = optimizer.efficientFrontier(5);
+
+    std::string filename = "/tmp/test_frontier_sink.bin";
+    orbat::optimizer::exportFrontier(frontier, filename, OutputFormat::BINARY, {"A", "B", "C"});
+
+    std::ifstream file(filename, std::ios::binary);
+    BinaryResultReader reader(file);
+    EXPECT_EQ(reader.assetLabels().size(), 3);
+    size_t count = 0;
+    BinaryResultRecord record;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.result.expectedReturn, frontier[count].expectedReturn);
+        ++count;
+    }
+    EXPECT_EQ(count, frontier.size());
+    std::remove(filename.c_str());
+}
+
+// Test exporting an empty frontier is rejected
+TEST(ResultSinkTest, FrontierExportEmptyThrows) {
+    std::vector<MarkowitzResult> empty;
+    EXPECT_THROW(orbat::optimizer::exportFrontier(empty, "/tmp/unused.json", OutputFormat::JSON),
+                 std::invalid_argument);
+}
@@ -0,0 +1,154 @@
+#include "orbat/optimizer/risk_analytics.hpp"
+
+#include "test_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::CounterRng;
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::MonteCarloEngine;
+using orbat::optimizer::PortfolioRisk;
+using orbat::optimizer::RiskAnalytics;
+using orbat::optimizer::RiskOptions;
+using orbat::optimizer::SimulationOptions;
+using orbat::test::testCovariance;
+using orbat::test::testReturns;
+
+namespace {
+
+Matrix testPortfolios() {
+    return Matrix({{0.25, 0.25, 0.25, 0.25}, {0.4, 0.3, 0.2, 0.1}, {1.0, -0.5, 0.3, 0.2}});
+}
+
+}  // namespace
+
+// Test parametric VaR and ES against the normal closed forms
+TEST(RiskAnalyticsTest, Parametric) {
+    RiskAnalytics risk;
+    Matrix portfolios = testPortfolios();
+    std::vector<PortfolioRisk> all = risk.parametric(testReturns(), testCovariance(), portfolios);
+    ASSERT_EQ(all.size(), 3u);
+    for (size_t i = 0; i < 3; ++i) {
+        Vector w = portfolios.getRow(i);
+        double mean = testReturns().data().dot(w);
+        double sigma = std::sqrt(w.dot(testCovariance().data() * w));
+        EXPECT_NEAR(all[i].mean, mean, 1e-14);
+        EXPECT_NEAR(all[i].volatility, sigma, 1e-14);
+        EXPECT_EQ(all[i].observations, 0u);
+        EXPECT_NEAR(all[i].valueAtRisk(0.95), 1.6448536269514722 * sigma - mean, 1e-12);
+        EXPECT_NEAR(all[i].valueAtRisk(0.99), 2.3263478740408408 * sigma - mean, 1e-12);
+        EXPECT_NEAR(all[i].expectedShortfall(0.95), 2.0627128075074257 * sigma - mean, 1e-12);
+        EXPECT_NEAR(all[i].expectedShortfall(0.99), 2.6652142203457830 * sigma - mean, 1e-12);
+
+        PortfolioRisk single = risk.parametric(testReturns(), testCovariance(), w);
+        EXPECT_NEAR(single.valueAtRisk(0.99), all[i].valueAtRisk(0.99), 1e-14);
+    }
+    EXPECT_THROW(all[0].valueAtRisk(0.9), std::out_of_range);
+}
+
+// Test historical VaR and ES against sorting each portfolio's P&L
+TEST(RiskAnalyticsTest, HistoricalMatchesSort) {
+    const size_t periods = 1000;
+    Matrix history(periods, 4);
+    CounterRng rng(3);
+    rng.fillNormal(history);
+    history = history * 0.02;
+
+    RiskOptions options;
+    options.confidenceLevels = {0.9, 0.95, 0.99, 0.999};
+    options.blockSize = 77;
+    RiskAnalytics risk(options);
+    Matrix portfolios = testPortfolios();
+    std::vector<PortfolioRisk> all = risk.historical(history, portfolios);
+    ASSERT_EQ(all.size(), 3u);
+
+    for (size_t i = 0; i < 3; ++i) {
+        Vector pnl = history * portfolios.getRow(i);
+        std::vector<double> sorted = pnl.data();
+        std::sort(sorted.begin(), sorted.end());
+        double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / periods;
+        EXPECT_NEAR(all[i].mean, mean, 1e-14);
+        EXPECT_EQ(all[i].observations, periods);
+        for (auto [confidence, k] : std::vector<std::pair<double, size_t>>{
+                 {0.9, 100}, {0.95, 50}, {0.99, 10}, {0.999, 1}}) {
+            double tail = std::accumulate(sorted.begin(), sorted.begin() + k, 0.0) / k;
+            EXPECT_NEAR(all[i].valueAtRisk(confidence), -sorted[k - 1], 1e-15) << confidence;
+            EXPECT_NEAR(all[i].expectedShortfall(confidence), -tail, 1e-14) << confidence;
+        }
+        PortfolioRisk single = risk.historical(history, portfolios.getRow(i));
+        EXPECT_NEAR(single.valueAtRisk(0.99), all[i].valueAtRisk(0.99), 1e-15);
+    }
+}
+
+// Test that Monte Carlo estimates of normal scenarios approach the parametric ones
+TEST(RiskAnalyticsTest, MonteCarloMatchesParametric) {
+    RiskAnalytics risk;
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    SimulationOptions simulation;
+    simulation.scenarios = 200000;
+    simulation.threads = 2;
+    Matrix portfolios = testPortfolios();
+    std::vector<PortfolioRisk> simulated = risk.monteCarlo(engine, portfolios, simulation);
+    std::vector<PortfolioRisk> exact = risk.parametric(testReturns(), testCovariance(), portfolios);
+    ASSERT_EQ(simulated.size(), 3u);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(simulated[i].observations, 200000u);
+        for (double confidence : {0.95, 0.99}) {
+            double scale = exact[i].volatility;
+            EXPECT_NEAR(simulated[i].valueAtRisk(confidence), exact[i].valueAtRisk(confidence),
+                        0.02 * scale);
+            EXPECT_NEAR(simulated[i].expectedShortfall(confidence),
+                        exact[i].expectedShortfall(confidence), 0.03 * scale);
+        }
+    }
+    PortfolioRisk single = risk.monteCarlo(engine, portfolios.getRow(1), simulation);
+    EXPECT_EQ(single.valueAtRisk(0.95), simulated[1].valueAtRisk(0.95));
+}
+
+// Test validation of options and dimensions
+TEST(RiskAnalyticsTest, InvalidInputs) {
+    RiskOptions options;
+    options.confidenceLevels = {};
+    EXPECT_THROW(RiskAnalytics{options}, std::invalid_argument);
+    options.confidenceLevels = {0.95, 1.0};
+    EXPECT_THROW(RiskAnalytics{options}, std::invalid_argument);
+    options.confidenceLevels = {0.95};
+    options.blockSize = 0;
+    EXPECT_THROW(RiskAnalytics{options}, std::invalid_argument);
+
+    RiskAnalytics risk;
+    EXPECT_THROW(risk.parametric(testReturns(), testCovariance(), Matrix(2, 3)),
+                 std::invalid_argument);
+    EXPECT_THROW(risk.historical(Matrix(0, 4), testPortfolios()), std::invalid_argument);
+    EXPECT_THROW(risk.historical(Matrix(10, 3), testPortfolios()), std::invalid_argument);
+}
+
+// Test that non-finite P&L is rejected instead of leaving the tail short
+TEST(RiskAnalyticsTest, RejectsNonFiniteOutcomes) {
+    RiskOptions options;
+    options.blockSize = 8;
+    RiskAnalytics risk(options);
+    Matrix history(40, 4, 0.01);
+    history(3, 1) = std::nan("");
+    EXPECT_THROW(risk.historical(history, testPortfolios()), std::invalid_argument);
+    history(3, 1) = 0.01;
+    history(37, 2) = -std::numeric_limits<double>::infinity();  // In a later block
+    EXPECT_THROW(risk.historical(history, testPortfolios()), std::invalid_argument);
+
+    SimulationOptions simulation;
+    simulation.scenarios = 100;
+    simulation.threads = 2;
+    simulation.blockSize = 16;
+    MonteCarloEngine engine(testReturns(), testCovariance());
+    EXPECT_THROW(risk.monteCarlo(engine, Vector({0.5, std::nan(""), 0.25, 0.25}), simulation),
+                 std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+#include "orbat/optimizer/risk_attribution.hpp"
+
+#include "orbat/optimizer/frontier_engine.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::FrontierEngine;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::MarkowitzResult;
+using orbat::optimizer::RiskAttribution;
+using orbat::optimizer::RiskContributionMatrix;
+using orbat::optimizer::RiskContributions;
+using orbat::test::testCovariance;
+using orbat::test::testReturns;
+
+namespace {
+
+void expectSame(const RiskContributions& a, const RiskContributions& b, double tolerance) {
+    EXPECT_NEAR(a.volatility, b.volatility, tolerance);
+    ASSERT_EQ(a.marginal.size(), b.marginal.size());
+    for (size_t i = 0; i < a.marginal.size(); ++i) {
+        EXPECT_NEAR(a.marginal[i], b.marginal[i], tolerance) << i;
+        EXPECT_NEAR(a.component[i], b.component[i], tolerance) << i;
+        EXPECT_NEAR(a.percentage[i], b.percentage[i], tolerance) << i;
+    }
+}
+
+}  // namespace
+
+// Test the definitions and that components add up to the volatility
+TEST(RiskAttributionTest, SinglePortfolio) {
+    Vector w({0.4, 0.3, 0.2, 0.1});
+    Vector sw = testCovariance().data() * w;
+    double sigma = std::sqrt(w.dot(sw));
+
+    RiskContributions risk = RiskAttribution::compute(testCovariance(), w);
+    EXPECT_NEAR(risk.volatility, sigma, 1e-15);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(risk.marginal[i], sw[i] / sigma, 1e-15);
+        EXPECT_NEAR(risk.component[i], w[i] * sw[i] / sigma, 1e-15);
+        EXPECT_NEAR(risk.percentage[i], w[i] * sw[i] / (sigma * sigma), 1e-14);
+    }
+    EXPECT_NEAR(risk.component.sum(), sigma, 1e-15);
+    EXPECT_NEAR(risk.percentage.sum(), 1.0, 1e-14);
+    expectSame(RiskAttribution::fromCovarianceWeights(w, sw), risk, 0.0);
+}
+
+// Test that the batched decomposition matches portfolio-by-portfolio results
+TEST(RiskAttributionTest, BatchMatchesSingle) {
+    Matrix portfolios({{0.25, 0.25, 0.25, 0.25}, {0.4, 0.3, 0.2, 0.1}, {1.0, -0.5, 0.3, 0.2}});
+    RiskContributionMatrix all = RiskAttribution::compute(testCovariance(), portfolios);
+    ASSERT_EQ(all.size(), 3u);
+    ASSERT_EQ(all.marginal.rows(), 3u);
+    ASSERT_EQ(all.marginal.cols(), 4u);
+    for (size_t i = 0; i < 3; ++i) {
+        RiskContributions single = RiskAttribution::compute(testCovariance(), portfolios.getRow(i));
+        expectSame(all.portfolio(i), single, 1e-15);
+    }
+    EXPECT_THROW(all.portfolio(3), std::out_of_range);
+}
+
+// Test that optimizer results carry Σw for an O(n) decomposition
+TEST(RiskAttributionTest, MarkowitzResults) {
+    MarkowitzOptimizer optimizer(testReturns(), testCovariance());
+
+    // Only the budget constraint binds, so every asset has the same marginal risk
+    MarkowitzResult minVar = optimizer.minimumVariance();
+    RiskContributions risk = minVar.riskContributions();
+    EXPECT_NEAR(risk.volatility, minVar.risk, 1e-15);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(risk.marginal[i], minVar.risk, 1e-12) << i;
+    }
+    expectSame(risk, RiskAttribution::compute(testCovariance(), minVar.weights), 1e-15);
+
+    MarkowitzResult meanVariance = optimizer.optimize(0.5);
+    expectSame(meanVariance.riskContributions(),
+               RiskAttribution::compute(testCovariance(), meanVariance.weights), 1e-15);
+
+    FrontierEngine engine(testReturns(), testCovariance());
+    MarkowitzResult point = engine.point(0.09);
+    ASSERT_TRUE(point.success());
+    expectSame(point.riskContributions(),
+               RiskAttribution::compute(testCovariance(), point.weights), 1e-12);
+
+    MarkowitzResult parsed = MarkowitzResult::fromJSON(minVar.toJSON());
+    EXPECT_THROW(parsed.riskContributions(), std::logic_error);
+}
+
+// Test riskless portfolios and dimension checks
+TEST(RiskAttributionTest, EdgeCases) {
+    RiskContributions none = RiskAttribution::compute(testCovariance(), Vector(4, 0.0));
+    EXPECT_EQ(none.volatility, 0.0);
+    EXPECT_EQ(none.marginal.sum(), 0.0);
+    EXPECT_EQ(none.percentage.sum(), 0.0);
+
+    EXPECT_THROW(RiskAttribution::compute(testCovariance(), Vector(3, 0.1)),
+                 std::invalid_argument);
+    EXPECT_THROW(RiskAttribution::compute(testCovariance(), Matrix(2, 3)), std::invalid_argument);
+    EXPECT_THROW(RiskAttribution::fromCovarianceWeights(Vector(3), Vector(4)),
+                 std::invalid_argument);
+}
@@ -0,0 +1,260 @@
+#include "cli/json_reader.hpp"
+#include "cli/optimization_service.hpp"
+#include "cli/unix_socket_server.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace orbat::cli;
+
+namespace {
+
+// Services in these tests confine file paths to tests/data
+const char* DATA_DIR = "data";
+const char* LOAD_REQUEST = R"({"op": "load", "snapshot": "s", "covariance": "covariance.csv"})";
+const char* LOAD_MATRIX_REQUEST =
+    R"({"op": "load", "snapshot": "s", "matrix": [[0.04, 0.01], [0.01, 0.09]]})";
+
+JsonValue call(OptimizationService& service, const std::string& request) {
+    return JsonValue::parse(service.handle(request));
+}
+
+}  // namespace
+
+// Test frame header encoding round trip
+TEST(FrameProtocolTest, HeaderRoundTrip) {
+    std::string header = FrameProtocol::encodeHeader(0x01020304u);
+    ASSERT_EQ(header.size(), FrameProtocol::HEADER_SIZE);
+    EXPECT_EQ(static_cast<unsigned char>(header[0]), 0x04);
+    EXPECT_EQ(static_cast<unsigned char>(header[3]), 0x01);
+    EXPECT_EQ(FrameProtocol::decodeHeader(header.data()), 0x01020304u);
+}
+
+// Test snapshot load, list and drop
+TEST(OptimizationServiceTest, SnapshotLifecycle) {
+    OptimizationService service(DATA_DIR);
+    JsonValue loaded = call(service, LOAD_REQUEST);
+    ASSERT_TRUE(loaded["ok"].asBool());
+    EXPECT_EQ(loaded["assets"].asNumber(), 3.0);
+
+    call(service, R"({"op": "load", "snapshot": "m", "matrix": [[0.04, 0.0], [0.0, 0.09]]})");
+    JsonValue list = call(service, R"({"op": "snapshots"})");
+    ASSERT_EQ(list["snapshots"].asArray().size(), 2u);
+    EXPECT_EQ(list["snapshots"].asArray()[0]["name"].asString(), "m");
+
+    EXPECT_TRUE(call(service, R"({"op": "drop", "snapshot": "m"})")["dropped"].asBool());
+    EXPECT_FALSE(call(service, R"({"op": "drop", "snapshot": "m"})")["dropped"].asBool());
+}
+
+// Test that mpt requests match the library result and echo the id
+TEST(OptimizationServiceTest, MptMatchesOptimizer) {
+    OptimizationService service(DATA_DIR);
+    call(service, LOAD_REQUEST);
+    JsonValue response =
+        call(service, R"({"op": "mpt", "id": 7, "snapshot": "s", "returns": [0.08, 0.12, 0.10]})");
+    ASSERT_TRUE(response["ok"].asBool());
+    EXPECT_EQ(response["id"].asNumber(), 7.0);
+
+    orbat::optimizer::MarkowitzOptimizer optimizer(
+        orbat::optimizer::ExpectedReturns(orbat::core::Vector({0.08, 0.12, 0.10})),
+        FileParser::parseCovariance("data/covariance.csv"));
+    auto expected = optimizer.minimumVariance();
+    const auto& weights = response["result"]["weights"].asArray();
+    ASSERT_EQ(weights.size(), 3u);
+    for (size_t i = 0; i < weights.size(); ++i) {
+        EXPECT_NEAR(weights[i].asNumber(), expected.weights[i], 1e-12);
+    }
+}
+
+// Test Black-Litterman and frontier requests
+TEST(OptimizationServiceTest, BlAndFrontier) {
+    OptimizationService service(DATA_DIR);
+    call(service, LOAD_REQUEST);
+    JsonValue bl = call(service, R"({"op": "bl", "snapshot": "s", "weights": [0.5, 0.3, 0.2]})");
+    ASSERT_TRUE(bl["ok"].asBool());
+    EXPECT_EQ(bl["result"]["weights"].asArray().size(), 3u);
+
+    JsonValue frontier = call(service, R"({"op": "frontier", "snapshot": "s", "points": 5,)"
+                                       R"( "returns": [0.08, 0.12, 0.10]})");
+    ASSERT_TRUE(frontier["ok"].asBool());
+    const auto& points = frontier["frontier"].asArray();
+    ASSERT_EQ(points.size(), 5u);
+    EXPECT_LT(points[0]["expectedReturn"].asNumber(), points[4]["expectedReturn"].asNumber());
+}
+
+// Test frontier requests are long-only unless they opt out, like mpt requests
+TEST(OptimizationServiceTest, FrontierDefaultsToLongOnly) {
+    OptimizationService service(DATA_DIR);
+    call(service, LOAD_REQUEST);
+    auto mostNegativeWeight = [&service](const std::string& longOnly) {
+        std::string request = R"({"op": "frontier", "snapshot": "s", "points": 5,)"
+                              R"( "returns": [0.08, 0.12, 0.10])";
+        JsonValue frontier = call(service, request + longOnly + "}");
+        double lowest = 0.0;
+        for (const JsonValue& point : frontier["frontier"].asArray()) {
+            for (const JsonValue& weight : point["weights"].asArray()) {
+                lowest = std::min(lowest, weight.asNumber());
+            }
+        }
+        return lowest;
+    };
+    EXPECT_GE(mostNegativeWeight(""), -1e-10);
+    EXPECT_GE(mostNegativeWeight(R"(, "longOnly": true)"), -1e-10);
+    EXPECT_LT(mostNegativeWeight(R"(, "longOnly": false)"), -1e-3);
+}
+
+// Test error responses
+TEST(OptimizationServiceTest, Errors) {
+    OptimizationService service(DATA_DIR);
+    JsonValue unknown =
+        call(service, R"({"op": "mpt", "id": "a", "snapshot": "x", "returns": [1]})");
+    EXPECT_FALSE(unknown["ok"].asBool());
+    EXPECT_EQ(unknown["id"].asString(), "a");
+    EXPECT_NE(unknown["error"].asString().find("Unknown snapshot"), std::string::npos);
+
+    EXPECT_FALSE(call(service, "not json")["ok"].asBool());
+    EXPECT_FALSE(call(service, R"({"op": "nope"})")["ok"].asBool());
+
+    call(service, LOAD_REQUEST);
+    JsonValue mismatch = call(service, R"({"op": "mpt", "snapshot": "s", "returns": [0.1]})");
+    EXPECT_FALSE(mismatch["ok"].asBool());
+}
+
+// Test per-op statistics and shutdown
+TEST(OptimizationServiceTest, StatsAndShutdown) {
+    OptimizationService service;
+    call(service, R"({"op": "ping"})");
+    call(service, R"({"op": "ping"})");
+    call(service, R"({"op": "bogus"})");
+
+    JsonValue stats = call(service, R"({"op": "stats"})");
+    EXPECT_EQ(stats["ops"]["ping"]["count"].asNumber(), 2.0);
+    EXPECT_EQ(stats["ops"]["invalid"]["count"].asNumber(), 1.0);
+
+    EXPECT_FALSE(service.shutdownRequested());
+    call(service, R"({"op": "shutdown"})");
+    EXPECT_TRUE(service.shutdownRequested());
+}
+
+// Test starting, dumping and stopping tracing over the protocol
+TEST(OptimizationServiceTest, Trace) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    OptimizationService service(directory.string());
+    orbat::core::Tracer::clear();
+    EXPECT_TRUE(call(service, R"({"op": "trace", "action": "start"})")["tracing"].asBool());
+    call(service, LOAD_MATRIX_REQUEST);
+
+    JsonValue dump = call(service, R"({"op": "trace"})");
+    ASSERT_TRUE(dump["ok"].asBool());
+    bool sawFactorize = false;
+    for (const JsonValue& event : dump["trace"]["traceEvents"].asArray()) {
+        sawFactorize = sawFactorize || event.getString("cat", "") == "factorize";
+    }
+    EXPECT_EQ(sawFactorize, orbat::core::Tracer::compiledIn());
+
+    std::string request = R"({"op": "trace", "action": "dump", "path": "test_serve_trace.json"})";
+    EXPECT_EQ(call(service, request)["path"].asString(), "test_serve_trace.json");
+    EXPECT_TRUE(std::filesystem::remove(directory / "test_serve_trace.json"));
+    EXPECT_FALSE(call(service, R"({"op": "trace", "action": "stop"})")["tracing"].asBool());
+    EXPECT_FALSE(call(service, R"({"op": "trace", "action": "bogus"})")["ok"].asBool());
+    call(service, R"({"op": "trace", "action": "clear"})");
+}
+
+// Test the Prometheus snapshot over the protocol
+TEST(OptimizationServiceTest, Metrics) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    OptimizationService service(directory.string());
+    call(service, LOAD_MATRIX_REQUEST);
+    call(service, R"({"op": "mpt", "snapshot": "s", "returns": [0.08, 0.12]})");
+    call(service, R"({"op": "mpt", "snapshot": "missing", "returns": [0.1]})");
+
+    JsonValue snapshot = call(service, R"({"op": "metrics"})");
+    ASSERT_TRUE(snapshot["ok"].asBool());
+    std::string text = snapshot["metrics"].asString();
+    EXPECT_NE(text.find("orbat_requests_total{op=\"mpt\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("orbat_request_errors_total{op=\"mpt\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("orbat_request_duration_seconds_count{op=\"load\"} 1"),
+              std::string::npos);
+    EXPECT_NE(text.find("orbat_snapshots 1"), std::string::npos);
+#ifndef ORBAT_DISABLE_METRICS
+    EXPECT_NE(text.find("entry_point=\"MarkowitzOptimizer::minimumVariance\""),
+              std::string::npos);
+#endif
+
+    std::string request = R"({"op": "metrics", "path": "test_serve_metrics.prom"})";
+    EXPECT_EQ(call(service, request)["path"].asString(), "test_serve_metrics.prom");
+    std::ifstream file(directory / "test_serve_metrics.prom");
+    std::string first;
+    std::getline(file, first);
+    EXPECT_EQ(first.rfind("# HELP ", 0), 0u);
+    std::filesystem::remove(directory / "test_serve_metrics.prom");
+}
+
+// Test that request file paths are confined to the data directory
+TEST(OptimizationServiceTest, FilePathsStayInDataDirectory) {
+    OptimizationService closed;
+    for (const char* request :
+         {LOAD_REQUEST, R"({"op": "trace", "action": "dump", "path": "trace.json"})",
+          R"({"op": "metrics", "path": "orbat.prom"})"}) {
+        JsonValue response = call(closed, request);
+        EXPECT_FALSE(response["ok"].asBool()) << request;
+        EXPECT_NE(response["error"].asString().find("--data-dir"), std::string::npos);
+    }
+    EXPECT_TRUE(call(closed, LOAD_MATRIX_REQUEST)["ok"].asBool());
+    EXPECT_TRUE(call(closed, R"({"op": "metrics"})")["ok"].asBool());
+
+    OptimizationService service(DATA_DIR);
+    EXPECT_TRUE(call(service, LOAD_REQUEST)["ok"].asBool());
+    for (const char* path : {"../covariance.csv", "/etc/passwd", ".", ""}) {
+        std::string request =
+            std::string(R"({"op": "load", "snapshot": "x", "covariance": ")") + path + "\"}";
+        JsonValue response = call(service, request);
+        EXPECT_FALSE(response["ok"].asBool()) << path;
+        EXPECT_NE(response["error"].asString().find("outside the data directory"),
+                  std::string::npos)
+            << path;
+    }
+    EXPECT_FALSE(call(service, R"({"op": "metrics", "path": "../orbat.prom"})")["ok"].asBool());
+
+    EXPECT_THROW(OptimizationService("no-such-directory"), std::invalid_argument);
+}
+
+#ifdef ORBAT_HAS_UNIX_SOCKETS
+
+// Test a full client/server round trip over a socket
+TEST(UnixSocketServerTest, RoundTrip) {
+    std::string path = "/tmp/orbat_test_" + std::to_string(::getpid()) + ".sock";
+    OptimizationService service(DATA_DIR);
+    UnixSocketServer server(path, service, 2);
+    server.start();
+    std::thread serverThread([&server] { server.run(); });
+
+    {
+        UnixSocketClient client(path);
+        EXPECT_TRUE(JsonValue::parse(client.request(R"({"op": "ping"})"))["pong"].asBool());
+        EXPECT_TRUE(JsonValue::parse(client.request(LOAD_REQUEST))["ok"].asBool());
+
+        UnixSocketClient second(path);
+        JsonValue response = JsonValue::parse(
+            second.request(R"({"op": "mpt", "snapshot": "s", "returns": [0.08, 0.12, 0.10]})"));
+        EXPECT_TRUE(response["ok"].asBool());
+
+        // A second server cannot take over a live socket
+        OptimizationService other;
+        UnixSocketServer rival(path, other, 1);
+        EXPECT_THROW(rival.start(), std::runtime_error);
+
+        client.request(R"({"op": "shutdown"})");
+    }
+    serverThread.join();
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+}
+
+#endif  // ORBAT_HAS_UNIX_SOCKETS
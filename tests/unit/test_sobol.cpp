@@ -0,0 +1,185 @@
+#include "orbat/core/sobol.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::inverseNormalCdf;
+using orbat::core::Matrix;
+using orbat::core::SobolSequence;
+
+namespace {
+
+double normalCdf(double z) {
+    return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+// Whether every coordinate puts exactly one of the points in each interval
+// [k / N, (k + 1) / N), N = number of points
+bool stratified(const Matrix& points) {
+    const size_t n = points.rows();
+    for (size_t j = 0; j < points.cols(); ++j) {
+        std::vector<int> counts(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            ++counts[static_cast<size_t>(points(i, j) * static_cast<double>(n))];
+        }
+        for (int count : counts) {
+            if (count != 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// Test known quantiles, the round trip through Φ and the bulk version
+TEST(SobolTest, InverseNormalCdf) {
+    EXPECT_EQ(inverseNormalCdf(0.5), 0.0);
+    EXPECT_NEAR(inverseNormalCdf(0.975), 1.959963984540054, 1e-14);
+    EXPECT_NEAR(inverseNormalCdf(0.025), -1.959963984540054, 1e-14);
+    EXPECT_NEAR(inverseNormalCdf(1e-10), -6.361340902404056, 1e-12);
+    EXPECT_EQ(inverseNormalCdf(0.0), -INFINITY);
+    EXPECT_EQ(inverseNormalCdf(1.0), INFINITY);
+
+    std::vector<double> p;
+    for (double tail = 1e-300; tail < 0.5; tail *= 3.7) {
+        p.push_back(tail);
+        if (tail > 1e-15) {
+            p.push_back(1.0 - tail);
+        }
+    }
+    for (int i = 1; i < 1000; ++i) {
+        p.push_back(i / 1000.0);
+    }
+    for (double value : p) {
+        double z = inverseNormalCdf(value);
+        double back = value < 0.5 ? normalCdf(z) : normalCdf(-z);
+        double expected = value < 0.5 ? value : 1.0 - value;
+        EXPECT_NEAR(back / expected, 1.0, 1e-12) << value;
+    }
+
+    std::vector<double> bulk = p;
+    inverseNormalCdf(bulk.data(), bulk.size());
+    for (size_t i = 0; i < p.size(); ++i) {
+        EXPECT_DOUBLE_EQ(bulk[i], inverseNormalCdf(p[i])) << p[i];
+    }
+}
+
+// Test the primitive polynomials against the Joe-Kuo table
+TEST(SobolTest, PrimitivePolynomials) {
+    std::vector<uint32_t> polynomials = SobolSequence::primitivePolynomials(3666);
+    ASSERT_EQ(polynomials.size(), 3666u);
+    EXPECT_EQ(std::vector<uint32_t>(polynomials.begin(), polynomials.begin() + 12),
+              (std::vector<uint32_t>{3, 7, 11, 13, 19, 25, 37, 41, 47, 55, 59, 61}));
+    EXPECT_EQ(polynomials[99], 1019u);
+    EXPECT_EQ(polynomials[999], 15033u);
+    EXPECT_EQ(polynomials[3665], 65533u);
+}
+
+// Test the first unscrambled points in Gray code order
+TEST(SobolTest, UnscrambledPoints) {
+    SobolSequence sobol(3, false);
+    Matrix points(8, 3);
+    sobol.fillUniform(points);
+    const std::vector<std::vector<double>> expected = {
+        {0.0, 0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125},
+        {0.0, 0.5, 0.25, 0.75, 0.375, 0.875, 0.125, 0.625},
+        {0.0, 0.5, 0.25, 0.75, 0.625, 0.125, 0.875, 0.375},
+    };
+    for (size_t j = 0; j < 3; ++j) {
+        for (size_t i = 0; i < 8; ++i) {
+            EXPECT_NEAR(points(i, j), expected[j][i], 1e-9) << i << "," << j;
+        }
+    }
+    EXPECT_EQ(sobol.position(), 8u);
+}
+
+// Test that scrambled points stay stratified, in (0, 1), and depend on the seed
+TEST(SobolTest, ScrambledPoints) {
+    SobolSequence sobol(100, true, 7);
+    Matrix points(1024, 100);
+    sobol.fillUniform(points);
+    EXPECT_TRUE(stratified(points));
+    for (double value : points.data()) {
+        ASSERT_GT(value, 0.0);
+        ASSERT_LT(value, 1.0);
+    }
+
+    SobolSequence same(100, true, 7);
+    SobolSequence other(100, true, 8);
+    Matrix a(1024, 100);
+    Matrix b(1024, 100);
+    same.fillUniform(a);
+    other.fillUniform(b);
+    EXPECT_EQ(a.data(), points.data());
+    EXPECT_NE(b.data(), points.data());
+    EXPECT_TRUE(stratified(b));
+}
+
+// Test that seeking reaches the same points as stepping
+TEST(SobolTest, SkipAhead) {
+    SobolSequence sobol(20, true, 3);
+    Matrix sequential(100, 20);
+    sobol.fillUniform(sequential);
+
+    SobolSequence jump = sobol;
+    jump.seek(37);
+    Matrix block(10, 20);
+    jump.fillUniform(block);
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(block.getRow(i).data(), sequential.getRow(37 + i).data()) << i;
+    }
+    jump.discard(53);
+    EXPECT_EQ(jump.position(), 100u);
+    EXPECT_EQ(sobol.position(), 100u);
+
+    jump.seek(SobolSequence::MAX_POINTS - 1);
+    jump.fillUniform(block.data().data(), 1);
+    EXPECT_THROW(jump.fillUniform(block.data().data(), 1), std::out_of_range);
+    EXPECT_THROW(jump.seek(SobolSequence::MAX_POINTS + 1), std::out_of_range);
+}
+
+// Test thousands of dimensions
+TEST(SobolTest, HighDimensions) {
+    SobolSequence sobol(5000, true, 11);
+    Matrix points(256, 5000);
+    sobol.fillUniform(points);
+    EXPECT_TRUE(stratified(points));
+}
+
+// Test that normal points integrate far more accurately than random ones
+TEST(SobolTest, NormalPoints) {
+    SobolSequence sobol(16, true, 5);
+    Matrix z(4096, 16);
+    sobol.fillNormal(z);
+    double sumSquares = 0.0;
+    for (size_t j = 0; j < 16; ++j) {
+        double mean = 0.0;
+        for (size_t i = 0; i < 4096; ++i) {
+            mean += z(i, j) / 4096.0;
+        }
+        EXPECT_NEAR(mean, 0.0, 1e-3) << j;  // Random points: standard error 0.016
+    }
+    for (size_t i = 0; i < 4096; ++i) {
+        double sum = 0.0;
+        for (size_t j = 0; j < 8; ++j) {
+            sum += z(i, j);
+        }
+        sumSquares += sum * sum / 8.0;
+    }
+    EXPECT_NEAR(sumSquares / 4096.0, 1.0, 0.01);  // Random points: standard error 0.022
+}
+
+// Test argument validation
+TEST(SobolTest, InvalidArguments) {
+    EXPECT_THROW(SobolSequence(0), std::invalid_argument);
+    EXPECT_THROW(SobolSequence(SobolSequence::MAX_DIMENSIONS + 1), std::invalid_argument);
+    SobolSequence sobol(3);
+    Matrix wrong(4, 2);
+    EXPECT_THROW(sobol.fillUniform(wrong), std::invalid_argument);
+    EXPECT_THROW(sobol.fillNormal(wrong), std::invalid_argument);
+}
@@ -0,0 +1,133 @@
+#include "orbat/optimizer/stress_test.hpp"
+
+#include "test_utils.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::StressTestEngine;
+using orbat::optimizer::StressTestOptions;
+using orbat::optimizer::StressTestResult;
+using orbat::test::testCovariance;
+
+// Test the three kinds of scenario
+TEST(StressTestTest, Scenarios) {
+    StressTestEngine engine(testCovariance());
+    EXPECT_EQ(engine.addScenario("crash", Vector({-0.3, -0.2, -0.1, 0.05})), 0u);
+
+    Matrix history({{0.10, 0.0, -0.5, 0.2}, {-0.10, 0.05, 0.5, 0.0}, {0.3, 0.3, 0.3, 0.3}});
+    EXPECT_EQ(engine.addHistoricalScenario("history", history, 0, 2), 1u);
+    const Vector& compounded = engine.scenarioShocks(1);
+    EXPECT_NEAR(compounded[0], 1.1 * 0.9 - 1.0, 1e-15);
+    EXPECT_NEAR(compounded[1], 0.05, 1e-15);
+    EXPECT_NEAR(compounded[2], 0.5 * 1.5 - 1.0, 1e-15);
+    EXPECT_NEAR(compounded[3], 0.2, 1e-15);
+
+    // One factor: every variable moves by its regression beta Σ_i0 / Σ_00
+    EXPECT_EQ(engine.addFactorScenario("one", std::vector<size_t>{0}, Vector({-0.2})), 2u);
+    const Vector& single = engine.scenarioShocks(2);
+    EXPECT_EQ(single[0], -0.2);
+    for (size_t i = 1; i < 4; ++i) {
+        EXPECT_NEAR(single[i], testCovariance()(i, 0) / 0.040 * -0.2, 1e-15) << i;
+    }
+
+    // Two factors: s_u = Σ_us Σ_ss⁻¹ s_s, checked against the explicit inverse
+    std::vector<size_t> factors{2, 1};
+    Vector shocks({0.01, -0.03});
+    engine.addFactorScenario("two", factors, shocks);
+    Matrix ss({{0.010, 0.008}, {0.008, 0.0225}});
+    Vector solved = ss.inverse() * shocks;
+    const Vector& pair = engine.scenarioShocks(3);
+    EXPECT_EQ(pair[2], 0.01);
+    EXPECT_EQ(pair[1], -0.03);
+    for (size_t i : {0u, 3u}) {
+        double expected = testCovariance()(i, 2) * solved[0] + testCovariance()(i, 1) * solved[1];
+        EXPECT_NEAR(pair[i], expected, 1e-15) << i;
+    }
+
+    // Scenarios on the same factors share one cached partition
+    engine.addFactorScenario("two again", factors, Vector({-0.02, 0.01}));
+    EXPECT_EQ(engine.cachedPartitions(), 2u);
+    EXPECT_EQ(engine.scenarioCount(), 5u);
+    EXPECT_EQ(engine.scenarioName(4), "two again");
+}
+
+// Test that the blocked, parallel product matches a plain one for any thread count
+TEST(StressTestTest, EvaluateMatchesPlainProduct) {
+    StressTestEngine engine(testCovariance());
+    for (size_t s = 0; s < 300; ++s) {
+        double x = static_cast<double>(s);
+        engine.addScenario("s" + std::to_string(s),
+                           Vector({std::sin(x), std::cos(x), 0.01 * x, -0.5 * std::sin(2 * x)}));
+    }
+    Matrix portfolios(103, 4);
+    for (size_t p = 0; p < 103; ++p) {
+        for (size_t i = 0; i < 4; ++i) {
+            portfolios(p, i) = std::cos(static_cast<double>(7 * p + i));
+        }
+    }
+    Matrix shocks(4, 300);
+    for (size_t s = 0; s < 300; ++s) {
+        for (size_t i = 0; i < 4; ++i) {
+            shocks(i, s) = engine.scenarioShocks(s)[i];
+        }
+    }
+    Matrix expected = portfolios * shocks;
+
+    StressTestOptions options;
+    options.blockSize = 10;
+    for (size_t threads : {1u, 4u}) {
+        options.threads = threads;
+        StressTestResult result = engine.evaluate(portfolios, options);
+        ASSERT_EQ(result.portfolios(), 103u);
+        ASSERT_EQ(result.scenarios.size(), 300u);
+        EXPECT_EQ(result.returns.data(), expected.data()) << threads;
+    }
+
+    StressTestResult result = engine.evaluate(portfolios);
+    Vector single = engine.evaluate(portfolios.getRow(5));
+    size_t worst = 0;
+    for (size_t s = 0; s < 300; ++s) {
+        EXPECT_NEAR(single[s], expected(5, s), 1e-15);
+        worst = single[s] < single[worst] ? s : worst;
+    }
+    EXPECT_EQ(result.worstScenario(5), worst);
+    EXPECT_EQ(result.worstLoss(5), -expected(5, worst));
+    EXPECT_THROW(result.worstScenario(103), std::out_of_range);
+}
+
+// Test input validation
+TEST(StressTestTest, Validation) {
+    StressTestEngine engine(testCovariance());
+    StressTestResult empty = engine.evaluate(Matrix(2, 4));
+    EXPECT_EQ(empty.returns.cols(), 0u);
+    EXPECT_THROW(empty.worstScenario(0), std::out_of_range);
+
+    EXPECT_THROW(engine.addScenario("bad", Vector(3, 0.1)), std::invalid_argument);
+    EXPECT_THROW(engine.addScenario("bad", Vector({0.1, NAN, 0.0, 0.0})), std::invalid_argument);
+    Matrix history(5, 4);
+    EXPECT_THROW(engine.addHistoricalScenario("bad", history, 3, 3), std::invalid_argument);
+    EXPECT_THROW(engine.addHistoricalScenario("bad", history, 0, 6), std::invalid_argument);
+    EXPECT_THROW(engine.addHistoricalScenario("bad", Matrix(5, 3), 0, 2), std::invalid_argument);
+    EXPECT_THROW(engine.addFactorScenario("bad", std::vector<size_t>{}, Vector()),
+                 std::invalid_argument);
+    EXPECT_THROW(engine.addFactorScenario("bad", std::vector<size_t>{4}, Vector({0.1})),
+                 std::invalid_argument);
+    EXPECT_THROW(engine.addFactorScenario("bad", std::vector<size_t>{1, 1}, Vector({0.1, 0.1})),
+                 std::invalid_argument);
+    EXPECT_THROW(engine.addFactorScenario("bad", std::vector<size_t>{0, 1}, Vector({0.1})),
+                 std::invalid_argument);
+    EXPECT_EQ(engine.scenarioCount(), 0u);
+
+    engine.addScenario("ok", Vector(4, 0.0));
+    EXPECT_THROW(engine.evaluate(Matrix(2, 3)), std::invalid_argument);
+    EXPECT_THROW(engine.evaluate(Vector(3)), std::invalid_argument);
+    StressTestOptions options;
+    options.blockSize = 0;
+    EXPECT_THROW(engine.evaluate(Matrix(2, 4), options), std::invalid_argument);
+}
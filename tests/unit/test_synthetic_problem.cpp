@@ -0,0 +1,137 @@
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include "orbat/optimizer/covariance_factorization.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+using orbat::core::Matrix;
+using orbat::core::Vector;
+using orbat::optimizer::CovarianceFactorization;
+using orbat::optimizer::MarkowitzOptimizer;
+using orbat::optimizer::SyntheticOptions;
+using orbat::optimizer::SyntheticProblem;
+
+namespace {
+
+// Largest eigenvalue of a symmetric positive-definite matrix by power iteration
+double largestEigenvalue(const Matrix& m) {
+    Vector x(m.rows(), 1.0);
+    double eigenvalue = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        Vector y = m * x;
+        eigenvalue = std::sqrt(y.dot(y));
+        x = y * (1.0 / eigenvalue);
+    }
+    return eigenvalue;
+}
+
+double conditionNumber(const SyntheticProblem& problem) {
+    auto factor = CovarianceFactorization::create(problem.covariance());
+    return largestEigenvalue(problem.covariance().data()) * largestEigenvalue(factor->inverse());
+}
+
+}  // namespace
+
+// Test a factor model hits the requested condition number
+TEST(SyntheticProblemTest, FactorModelConditionNumber) {
+    SyntheticOptions options;
+    options.assets = 60;
+    options.factors = 3;
+    options.conditionNumber = 250.0;
+    SyntheticProblem problem = SyntheticProblem::generate(options);
+
+    EXPECT_EQ(problem.size(), 60u);
+    EXPECT_EQ(problem.covariance().size(), 60u);
+    EXPECT_EQ(problem.returns().labels().front(), "A01");
+    EXPECT_EQ(problem.covariance().labels().back(), "A60");
+    EXPECT_NEAR(conditionNumber(problem), 250.0, 250.0 * 1e-6);
+
+    // Assets are positively correlated through the market factor
+    const Matrix& cov = problem.covariance().data();
+    double correlation = cov(0, 1) / std::sqrt(cov(0, 0) * cov(1, 1));
+    EXPECT_GT(correlation, 0.0);
+    EXPECT_LT(correlation, 1.0);
+}
+
+// Test uncorrelated assets span the requested variance range
+TEST(SyntheticProblemTest, DiagonalConditionNumber) {
+    SyntheticOptions options;
+    options.assets = 40;
+    options.factors = 0;
+    options.conditionNumber = 1e4;
+    SyntheticProblem problem = SyntheticProblem::generate(options);
+
+    const Matrix& cov = problem.covariance().data();
+    double lo = cov(0, 0);
+    double hi = cov(0, 0);
+    for (size_t i = 0; i < 40; ++i) {
+        for (size_t j = 0; j < 40; ++j) {
+            if (i != j) {
+                EXPECT_EQ(cov(i, j), 0.0);
+            }
+        }
+        lo = std::min(lo, cov(i, i));
+        hi = std::max(hi, cov(i, i));
+    }
+    EXPECT_NEAR(hi, 0.16 * 0.16, 1e-12);
+    EXPECT_NEAR(hi / lo, 1e4, 1e-6);
+}
+
+// Test generation is deterministic in the seed
+TEST(SyntheticProblemTest, Deterministic) {
+    SyntheticOptions options;
+    options.assets = 20;
+    SyntheticProblem a = SyntheticProblem::generate(options);
+    SyntheticProblem b = SyntheticProblem::generate(options);
+    options.seed = 7;
+    SyntheticProblem c = SyntheticProblem::generate(options);
+
+    EXPECT_EQ(a.returns()[5], b.returns()[5]);
+    EXPECT_EQ(a.covariance().data()(3, 4), b.covariance().data()(3, 4));
+    EXPECT_NE(a.returns()[5], c.returns()[5]);
+    EXPECT_NEAR(a.marketWeights().sum(), 1.0, 1e-12);
+}
+
+// Test returns, weights and views make a solvable problem
+TEST(SyntheticProblemTest, ProducesSolvableProblem) {
+    SyntheticOptions options;
+    options.assets = 30;
+    SyntheticProblem problem = SyntheticProblem::generate(options);
+
+    // Higher-beta assets earn more on average
+    double meanReturn = problem.returns().data().sum() / 30.0;
+    EXPECT_GT(meanReturn, options.riskFreeRate);
+    EXPECT_LT(meanReturn, 0.25);
+
+    MarkowitzOptimizer optimizer(problem.returns(), problem.covariance());
+    EXPECT_TRUE(optimizer.minimumVariance().success());
+
+    auto views = problem.views(4);
+    ASSERT_EQ(views.size(), 4u);
+    EXPECT_DOUBLE_EQ(views[0].assets.sum(), 0.0);  // Relative view
+    EXPECT_GE(views[0].confidence, 0.2);
+    EXPECT_LE(views[0].confidence, 0.8);
+    EXPECT_EQ(problem.views(4)[2].expectedReturn, views[2].expectedReturn);
+}
+
+// Test invalid options are rejected
+TEST(SyntheticProblemTest, InvalidOptions) {
+    SyntheticOptions options;
+    options.assets = 0;
+    EXPECT_THROW(SyntheticProblem::generate(options), std::invalid_argument);
+
+    options.assets = 5;
+    options.factors = 5;
+    EXPECT_THROW(SyntheticProblem::generate(options), std::invalid_argument);
+
+    options.factors = 2;
+    options.conditionNumber = 1.0;
+    EXPECT_THROW(SyntheticProblem::generate(options), std::invalid_argument);
+
+    options.conditionNumber = 100.0;
+    options.alphaVolatility = -0.1;
+    EXPECT_THROW(SyntheticProblem::generate(options), std::invalid_argument);
+}
@@ -0,0 +1,101 @@
+#include "orbat/core/thread_pool.hpp"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::core::ThreadPool;
+
+// Test construction with explicit and default sizes
+TEST(ThreadPoolTest, Construction) {
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3);
+
+    ThreadPool defaultPool;
+    EXPECT_EQ(defaultPool.size(), ThreadPool::defaultThreadCount());
+    EXPECT_GE(ThreadPool::defaultThreadCount(), 1);
+}
+
+// Test submitted tasks return their results through futures
+TEST(ThreadPoolTest, SubmitReturnsResult) {
+    ThreadPool pool(2);
+    auto future = pool.submit([] { return 6 * 7; });
+    EXPECT_EQ(future.get(), 42);
+}
+
+// Test exceptions propagate through futures
+TEST(ThreadPoolTest, SubmitPropagatesException) {
+    ThreadPool pool(2);
+    auto future = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+
+    // The pool keeps working after a task throws
+    EXPECT_EQ(pool.submit([] { return 1; }).get(), 1);
+}
+
+// Test every task runs exactly once
+TEST(ThreadPoolTest, ManyTasks) {
+    ThreadPool pool(4);
+    std::atomic<int> counter{0};
+    for (int i = 0; i < 1000; ++i) {
+        pool.submit([&counter] { counter.fetch_add(1); });
+    }
+    pool.wait();
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+// Test the destructor drains queued tasks
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+    std::atomic<int> counter{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&counter] { counter.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(counter.load(), 100);
+}
+
+// Test parallelFor visits every index exactly once
+TEST(ThreadPoolTest, ParallelForCoversRange) {
+    ThreadPool pool(4);
+    std::vector<int> visits(1003, 0);
+    pool.parallelFor(0, visits.size(), [&visits](size_t i) { visits[i] += 1; });
+    EXPECT_EQ(std::accumulate(visits.begin(), visits.end(), 0), 1003);
+    for (int v : visits) {
+        EXPECT_EQ(v, 1);
+    }
+
+    // Empty range is a no-op
+    pool.parallelFor(5, 5, [](size_t) { FAIL(); });
+}
+
+// Test parallelFor rethrows the first exception after all chunks finish
+TEST(ThreadPoolTest, ParallelForPropagatesException) {
+    ThreadPool pool(4);
+    std::atomic<int> completed{0};
+    EXPECT_THROW(pool.parallelFor(0, 100,
+                                  [&completed](size_t i) {
+                                      if (i == 17) {
+                                          throw std::invalid_argument("bad index");
+                                      }
+                                      completed.fetch_add(1);
+                                  }),
+                 std::invalid_argument);
+    EXPECT_GE(completed.load(), 1);
+}
+
+// Test nested parallelFor runs inline instead of deadlocking
+TEST(ThreadPoolTest, NestedParallelForRunsInline) {
+    ThreadPool pool(2);
+    std::atomic<int> counter{0};
+    pool.parallelFor(0, 4, [&](size_t) {
+        EXPECT_TRUE(ThreadPool::inWorkerThread());
+        pool.parallelFor(0, 10, [&counter](size_t) { counter.fetch_add(1); });
+    });
+    EXPECT_EQ(counter.load(), 40);
+    EXPECT_FALSE(ThreadPool::inWorkerThread());
+}
@@ -0,0 +1,151 @@
+#include "cli/json_reader.hpp"
+#include "orbat/core/trace.hpp"
+#include "orbat/optimizer/markowitz.hpp"
+#include "orbat/optimizer/synthetic_problem.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using orbat::cli::JsonValue;
+using orbat::core::TraceEvent;
+using orbat::core::Tracer;
+using orbat::core::TraceSpan;
+
+namespace {
+
+// Starts each test from an empty, enabled tracer and disables it afterwards
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Tracer::setCapacity(Tracer::DEFAULT_CAPACITY);
+        Tracer::clear();
+        Tracer::enable();
+    }
+
+    void TearDown() override {
+        Tracer::disable();
+        Tracer::clear();
+    }
+
+    static std::vector<TraceEvent> named(const std::string& name) {
+        std::vector<TraceEvent> matches;
+        for (const TraceEvent& event : Tracer::events()) {
+            if (name == event.name) {
+                matches.push_back(event);
+            }
+        }
+        return matches;
+    }
+};
+
+}  // namespace
+
+TEST_F(TraceTest, RecordsNestedSpans) {
+    {
+        TraceSpan outer("outer", "solve");
+        TraceSpan inner("inner", "factorize");
+    }
+    auto outer = named("outer");
+    auto inner = named("inner");
+    ASSERT_EQ(outer.size(), 1u);
+    ASSERT_EQ(inner.size(), 1u);
+    EXPECT_STREQ(outer[0].category, "solve");
+    EXPECT_LE(outer[0].startNs, inner[0].startNs);
+    EXPECT_GE(outer[0].startNs + outer[0].durationNs, inner[0].startNs + inner[0].durationNs);
+    EXPECT_EQ(outer[0].thread, inner[0].thread);
+}
+
+// Test that nothing is recorded while disabled, decided when a span starts
+TEST_F(TraceTest, DisabledRecordsNothing) {
+    Tracer::disable();
+    {
+        TraceSpan span("off", "solve");
+        Tracer::enable();
+    }
+    {
+        TraceSpan span("on", "solve");
+        Tracer::disable();
+    }
+    EXPECT_TRUE(named("off").empty());
+    EXPECT_EQ(named("on").size(), 1u);
+}
+
+TEST_F(TraceTest, ThreadsHaveOwnIds) {
+    { TraceSpan span("main", "test"); }
+    std::thread([] { TraceSpan span("worker", "test"); }).join();
+    auto main = named("main");
+    auto worker = named("worker");
+    ASSERT_EQ(main.size(), 1u);
+    ASSERT_EQ(worker.size(), 1u);  // Kept after the thread exited
+    EXPECT_NE(main[0].thread, worker[0].thread);
+
+    Tracer::clear();  // Drops the exited thread's buffer
+    EXPECT_TRUE(Tracer::events().empty());
+}
+
+// Test that a full ring buffer keeps the newest spans and counts the rest
+TEST_F(TraceTest, RingBufferOverwritesOldest) {
+    Tracer::setCapacity(4);
+    std::thread([] {
+        static const char* names[] = {"s0", "s1", "s2", "s3", "s4", "s5"};
+        for (const char* name : names) {
+            TraceSpan span(name, "test");
+        }
+    }).join();
+    EXPECT_EQ(Tracer::dropped(), 2u);
+    EXPECT_TRUE(named("s1").empty());
+    EXPECT_EQ(named("s2").size(), 1u);
+    EXPECT_EQ(named("s5").size(), 1u);
+    EXPECT_THROW(Tracer::setCapacity(0), std::invalid_argument);
+}
+
+TEST_F(TraceTest, LibraryEntryPointsAreTraced) {
+    if (!Tracer::compiledIn()) {
+        GTEST_SKIP() << "Built with ORBAT_TRACING=OFF";
+    }
+    orbat::optimizer::SyntheticOptions options;
+    options.assets = 10;
+    auto problem = orbat::optimizer::SyntheticProblem::generate(options);
+    orbat::optimizer::MarkowitzOptimizer optimizer(problem.returns(), problem.covariance());
+    optimizer.minimumVariance();
+
+    auto solve = named("MarkowitzOptimizer::minimumVariance");
+    ASSERT_EQ(solve.size(), 1u);
+    EXPECT_STREQ(solve[0].category, "solve");
+    ASSERT_FALSE(named("CovarianceFactorization").empty());
+    EXPECT_STREQ(named("CovarianceFactorization")[0].category, "factorize");
+}
+
+// Test that the dump is valid Chrome trace JSON
+TEST_F(TraceTest, WritesChromeTrace) {
+    Tracer::setThreadName("main \"thread\"");
+    { TraceSpan span("MarkowitzOptimizer::optimize", "solve"); }
+
+    std::ostringstream out;
+    Tracer::writeChromeTrace(out);
+    JsonValue trace = JsonValue::parse(out.str());
+    const auto& events = trace["traceEvents"].asArray();
+    bool sawName = false;
+    bool sawSpan = false;
+    for (const JsonValue& event : events) {
+        if (event["ph"].asString() == "M") {
+            sawName = sawName || event["args"]["name"].asString() == "main \"thread\"";
+        } else {
+            EXPECT_EQ(event["ph"].asString(), "X");
+            EXPECT_EQ(event["name"].asString(), "MarkowitzOptimizer::optimize");
+            EXPECT_EQ(event["cat"].asString(), "solve");
+            EXPECT_GE(event["dur"].asNumber(), 0.0);
+            EXPECT_GT(event["tid"].asNumber(), 0.0);
+            sawSpan = true;
+        }
+    }
+    EXPECT_TRUE(sawName);
+    EXPECT_TRUE(sawSpan);
+    EXPECT_EQ(trace["otherData"]["droppedEvents"].asNumber(), 0.0);
+    EXPECT_THROW(Tracer::writeChromeTrace(std::string("/nonexistent/dir/trace.json")),
+                 std::runtime_error);
+}
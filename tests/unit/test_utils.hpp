@@ -0,0 +1,29 @@
+#pragma once
+
+#include "orbat/core/matrix.hpp"
+#include "orbat/core/vector.hpp"
+#include "orbat/optimizer/covariance_matrix.hpp"
+#include "orbat/optimizer/expected_returns.hpp"
+
+namespace orbat {
+namespace test {
+
+/**
+ * @brief Expected returns of the four-asset problem shared by the optimizer tests.
+ */
+inline optimizer::ExpectedReturns testReturns() {
+    return optimizer::ExpectedReturns(core::Vector({0.08, 0.12, 0.10, 0.06}));
+}
+
+/**
+ * @brief Covariance matrix of the four-asset problem shared by the optimizer tests.
+ */
+inline optimizer::CovarianceMatrix testCovariance() {
+    return optimizer::CovarianceMatrix(core::Matrix({{0.040, 0.010, 0.005, 0.002},
+                                                     {0.010, 0.0225, 0.008, 0.003},
+                                                     {0.005, 0.008, 0.010, 0.001},
+                                                     {0.002, 0.003, 0.001, 0.020}}));
+}
+
+}  // namespace test
+}  // namespace orbat
@@ -0,0 +1,155 @@
+#include "cli/file_watcher.hpp"
+#include "cli/watch_session.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace orbat::cli;
+namespace fs = std::filesystem;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// Scratch directory holding copies of the test inputs
+class WatchFixture : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() /
+               ("orbat_watch_" + std::to_string(::getpid()) + "_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        fs::remove_all(dir_);
+        fs::create_directories(dir_);
+        fs::copy_file("data/expected_returns_with_labels.csv", path("returns.csv"));
+        fs::copy_file("data/covariance.csv", path("cov.csv"));
+        fs::copy_file("data/constraints.json", path("limits.json"));
+    }
+
+    void TearDown() override { fs::remove_all(dir_); }
+
+    std::string path(const std::string& name) const { return (dir_ / name).string(); }
+
+    void write(const std::string& name, const std::string& content) const {
+        std::ofstream(path(name)) << content;
+    }
+
+    fs::path dir_;
+};
+
+const char* RETURNS = "return,label\n0.09,Stock A\n0.11,Stock B\n0.10,Stock C\n";
+const char* COVARIANCE = "0.04,0.01,0.005\n0.01,0.0225,0.008\n0.005,0.008,0.01\n";
+
+}  // namespace
+
+// Test that writes are reported with the index of the changed file
+TEST_F(WatchFixture, WatcherReportsChangedFile) {
+    FileWatcher watcher({path("returns.csv"), path("cov.csv")}, milliseconds(20));
+    EXPECT_TRUE(watcher.wait(nullptr, milliseconds(50)).empty());  // Timeout
+
+    std::thread writer([&] {
+        std::this_thread::sleep_for(milliseconds(50));
+        write("cov.csv", COVARIANCE);
+    });
+    std::vector<size_t> changed = watcher.wait(nullptr, milliseconds(5000));
+    writer.join();
+    EXPECT_EQ(changed, std::vector<size_t>({1}));
+}
+
+// Test that saving via rename (as editors do) is detected
+TEST_F(WatchFixture, WatcherSeesRenamedFile) {
+    FileWatcher watcher({path("returns.csv")}, milliseconds(20));
+    write("returns.csv.tmp", RETURNS);
+    fs::rename(path("returns.csv.tmp"), path("returns.csv"));
+    EXPECT_EQ(watcher.wait(nullptr, milliseconds(5000)), std::vector<size_t>({0}));
+
+    std::atomic<bool> stop{true};
+    EXPECT_TRUE(watcher.wait(&stop).empty());
+    EXPECT_THROW(FileWatcher({path("missing.csv")}), std::runtime_error);
+}
+
+// Test that only changed files are reloaded and the factorization is reused
+TEST_F(WatchFixture, InputsReuseFactorization) {
+    IncrementalInputs inputs(path("returns.csv"), path("cov.csv"), path("limits.json"));
+    auto first = inputs.refresh();
+    EXPECT_TRUE(first.returns && first.covariance && first.constraints && first.refactorized);
+    auto factorization = inputs.factorization();
+    ASSERT_NE(inputs.constraints().find<orbat::optimizer::PackedConstraints>(), nullptr);
+
+    write("returns.csv", RETURNS);
+    auto status = inputs.refresh({path("returns.csv")});
+    EXPECT_TRUE(status.returns);
+    EXPECT_TRUE(status.constraints);  // Re-keyed by the new labels
+    EXPECT_FALSE(status.covariance);
+    EXPECT_EQ(inputs.factorization(), factorization);
+    EXPECT_DOUBLE_EQ(inputs.returns()[0], 0.09);
+
+    // Rewriting the covariance with the same values does not refactorize
+    write("cov.csv", COVARIANCE);
+    status = inputs.refresh({path("cov.csv")});
+    EXPECT_TRUE(status.covariance);
+    EXPECT_FALSE(status.refactorized);
+    EXPECT_EQ(inputs.factorization(), factorization);
+    EXPECT_NE(status.describe().find("reused factorization"), std::string::npos);
+
+    write("cov.csv", "0.05,0.01,0.005\n0.01,0.0225,0.008\n0.005,0.008,0.01\n");
+    status = inputs.refresh({path("cov.csv")});
+    EXPECT_TRUE(status.refactorized);
+    EXPECT_NE(inputs.factorization(), factorization);
+}
+
+// Test that bad edits are reported and the previous inputs are kept
+TEST_F(WatchFixture, InputsSurviveBadEdits) {
+    IncrementalInputs inputs(path("returns.csv"), path("cov.csv"));
+    inputs.refresh();
+    auto factorization = inputs.factorization();
+
+    write("cov.csv", "0.04,0.01\n0.02,0.0225\n");  // Not symmetric
+    EXPECT_THROW(inputs.refresh({path("cov.csv")}), std::invalid_argument);
+    EXPECT_EQ(inputs.factorization(), factorization);
+    EXPECT_EQ(inputs.covariance().size(), 3u);
+
+    write("returns.csv", "0.1\n0.2\n");  // Universe shrinks before the covariance is saved
+    EXPECT_THROW(inputs.refresh({path("returns.csv")}), std::invalid_argument);
+    write("cov.csv", "0.04,0.01\n0.01,0.0225\n");
+    EXPECT_NO_THROW(inputs.refresh({path("cov.csv")}));
+    EXPECT_EQ(inputs.returns().size(), 2u);
+}
+
+// Test that the session reruns its step after a change and stops on request
+TEST_F(WatchFixture, SessionRerunsOnChange) {
+    IncrementalInputs inputs(path("returns.csv"), path("cov.csv"));
+    std::atomic<bool> stop{false};
+    std::atomic<int> runs{0};
+    std::atomic<double> firstReturn{0.0};
+    std::thread session([&] {
+        WatchSession::run(
+            inputs,
+            [&](const IncrementalInputs& current) {
+                firstReturn = current.returns()[0];
+                ++runs;
+            },
+            &stop);
+    });
+
+    auto waitFor = [&](int count) {
+        for (int i = 0; i < 500 && runs.load() < count; ++i) {
+            std::this_thread::sleep_for(milliseconds(10));
+        }
+        return runs.load() >= count;
+    };
+    ASSERT_TRUE(waitFor(1));
+    std::this_thread::sleep_for(milliseconds(50));
+    write("returns.csv", RETURNS);
+    EXPECT_TRUE(waitFor(2));
+    EXPECT_DOUBLE_EQ(firstReturn.load(), 0.09);
+
+    stop = true;
+    session.join();
+}